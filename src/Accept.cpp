@@ -99,7 +99,7 @@ std::ostream &Accept::print_(std::ostream &os) const
 Action Accept::action(
     const Packet &packet, const MAVAddress &address) const
 {
-    if (!condition_ || condition_->check(packet, address))
+    if (matches_(packet, address))
     {
         return Action::make_accept(priority_);
     }
@@ -108,6 +108,24 @@ Action Accept::action(
 }
 
 
+/** \copydoc Rule::may_accept(unsigned long,const MAVAddress&,bool)const
+ *
+ *  The packet may be accepted unless the condition can not match.
+ */
+std::optional<bool> Accept::may_accept(
+    unsigned long id, const MAVAddress &source, bool accept_by_default) const
+{
+    (void)accept_by_default;
+
+    if (check_(id, source) == false)
+    {
+        return {};
+    }
+
+    return true;
+}
+
+
 std::unique_ptr<Rule> Accept::clone() const
 {
     if (priority_)
@@ -33,7 +33,7 @@
  */
 Action::Action(
     Action::Option action, std::optional<int> priority)
-    : action_(action), priority_(std::move(priority))
+    : action_(action), priority_(std::move(priority)), rule_(0)
 {
 }
 
@@ -88,6 +88,37 @@ int Action::priority() const
 }
 
 
+/** Set the rule that decided the action.
+ *
+ *  This only has an effect if the rule has never been set before, so the
+ *  innermost rule that decided the action is kept when chains are called.
+ *
+ *  \param rule The index of the rule, this is the line of the rule in the
+ *      configuration file.  0 is used for no rule.
+ */
+void Action::rule(unsigned int rule)
+{
+    if (rule_ == 0)
+    {
+        rule_ = rule;
+    }
+}
+
+
+/** Return the rule that decided the action.
+ *
+ *  \note The rule is not considered when comparing actions.
+ *
+ *  \returns The index of the rule that decided the action, this is the line
+ *      of the rule in the configuration file.  0 if the action was not decided
+ *      by an indexed rule.
+ */
+unsigned int Action::rule() const
+{
+    return rule_;
+}
+
+
 /** Make a new action result with the Action::ACCEPT action.
  *
  *  An accept action indicates that the packet/address combination this action
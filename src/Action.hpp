@@ -53,6 +53,8 @@ class Action
         Action::Option action() const;
         void priority(int priority);
         int priority() const;
+        void rule(unsigned int rule);
+        unsigned int rule() const;
         /** Assignment operator.
          *
          * \param other Action to copy from.
@@ -77,6 +79,7 @@ class Action
         //       (see \ref Call or \ref GoTo) while if the priority has been set
         //       to 0 it should not be set again.
         std::optional<int> priority_;
+        unsigned int rule_;
         Action(Action::Option action, std::optional<int> priority = {});
 };
 
@@ -15,16 +15,25 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
+#include <atomic>
 #include <chrono>
 #include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include <signal.h>
 
 #include "App.hpp"
+#include "DecisionLog.hpp"
+#include "FlightRecorder.hpp"
 #include "Interface.hpp"
 #include "InterfaceThreader.hpp"
+#include "Logger.hpp"
+#include "StatsServer.hpp"
+#include "Tracer.hpp"
 
 
 using namespace std::chrono_literals;
@@ -36,8 +45,25 @@ using namespace std::chrono_literals;
  *  run method is called.
  *
  *  \param interfaces A vector of interfaces.
+ *  \param decision_log The log to record packet filter decisions in while
+ *      running.  The default is to not record decisions.
+ *  \param stats_server The server to serve traffic statistics from while
+ *      running.  The default is to not serve statistics.
+ *  \param flight_recorder The recorder to hold the most recent packets and
+ *      decisions in while running.  The default is to not record them.
+ *  \param tracer The tracer selecting packets to log the path of while
+ *      running.  The default is to not trace packets.
  */
-App::App(std::vector<std::unique_ptr<Interface>> interfaces)
+App::App(
+    std::vector<std::unique_ptr<Interface>> interfaces,
+    std::unique_ptr<DecisionLog> decision_log,
+    std::unique_ptr<StatsServer> stats_server,
+    std::unique_ptr<FlightRecorder> flight_recorder,
+    std::unique_ptr<Tracer> tracer)
+    : decision_log_(std::move(decision_log)),
+      stats_server_(std::move(stats_server)),
+      flight_recorder_(std::move(flight_recorder)),
+      tracer_(std::move(tracer))
 {
     // Create threader for each interface.
     for (auto &interface : interfaces)
@@ -51,13 +77,30 @@ App::App(std::vector<std::unique_ptr<Interface>> interfaces)
 
 /** Start the application.
  *
- *  This starts listening on all interfaces.
+ *  This starts listening on all interfaces, and serving statistics if the
+ *  application has a \ref StatsServer.  %If the application has a \ref
+ *  FlightRecorder it is dumped on SIGUSR1.
  *
  *  \throws std::system_error if an error is generated while waiting for Ctrl+C.
  *  \throws std::runtime_error if run on Microsoft Windows.
  */
 void App::run()
 {
+    // Record decisions while running.
+    DecisionLog::install(decision_log_.get());
+    FlightRecorder::install(flight_recorder_.get());
+    Tracer::install(tracer_.get());
+
+    #ifdef UNIX
+    // Wait for SIGINT (Ctrl+C) and SIGUSR1, blocked before the interface
+    // threads are started so that they inherit the mask.
+    sigset_t waitset;
+    sigemptyset(&waitset);
+    sigaddset(&waitset, SIGINT);
+    sigaddset(&waitset, SIGUSR1);
+    sigprocmask(SIG_BLOCK, &waitset, nullptr);
+    #endif
+
     // Start interfaces.
     for (auto &interface : threaders_)
     {
@@ -65,17 +108,61 @@ void App::run()
     }
 
     #ifdef UNIX
-    // Wait for SIGINT (Ctrl+C).
-    sigset_t waitset;
-    sigemptyset(&waitset);
-    sigaddset(&waitset, SIGINT);
-    sigprocmask(SIG_BLOCK, &waitset, nullptr);
+
+    // Serve statistics until SIGINT.
+    std::atomic<bool> running(true);
+    std::thread stats_thread;
+
+    if (stats_server_ != nullptr)
+    {
+        stats_thread = std::thread([this, &running]()
+        {
+            try
+            {
+                while (running.load())
+                {
+                    stats_server_->serve(100ms);
+                }
+            }
+            // Keep routing packets if the statistics socket fails.
+            catch (const std::system_error &e)
+            {
+                Logger::log(std::string("statistics server error: ") +
+                            e.what());
+            }
+        });
+    }
+
+    auto stop_stats = [&]()
+    {
+        running.store(false);
+
+        if (stats_thread.joinable())
+        {
+            stats_thread.join();
+        }
+    };
+
     int sig;
 
-    if (sigwait(&waitset, &sig) < 0)
+    do
     {
-        throw std::system_error(std::error_code(errno, std::system_category()));
+        if (sigwait(&waitset, &sig) < 0)
+        {
+            auto error = errno;
+            stop_stats();
+            throw std::system_error(
+                std::error_code(error, std::system_category()));
+        }
+
+        if (sig == SIGUSR1 && flight_recorder_ != nullptr)
+        {
+            dump_flight_recorder_();
+        }
     }
+    while (sig == SIGUSR1);
+
+    stop_stats();
 
     #elif WINDOWS
     throw std::runtime_error("Microsoft Windows is not currently supported.")
@@ -86,4 +173,26 @@ void App::run()
     {
         interface->shutdown();
     }
+
+    DecisionLog::install(nullptr);
+    FlightRecorder::install(nullptr);
+    Tracer::install(nullptr);
+}
+
+
+/** Dump the flight recorder, logging the result.
+ *
+ *  Errors are logged instead of thrown, so that mavtables keeps running.
+ */
+void App::dump_flight_recorder_()
+{
+    try
+    {
+        flight_recorder_->dump();
+        Logger::log("flight recorder dumped to " + flight_recorder_->path());
+    }
+    catch (const std::system_error &e)
+    {
+        Logger::log(std::string("flight recorder dump failed: ") + e.what());
+    }
 }
@@ -22,8 +22,12 @@
 #include <memory>
 #include <vector>
 
+#include "DecisionLog.hpp"
+#include "FlightRecorder.hpp"
 #include "Interface.hpp"
 #include "InterfaceThreader.hpp"
+#include "StatsServer.hpp"
+#include "Tracer.hpp"
 
 
 /** The mavtables application class.
@@ -31,11 +35,22 @@
 class App
 {
     public:
-        App(std::vector<std::unique_ptr<Interface>> interfaces);
+        App(std::vector<std::unique_ptr<Interface>> interfaces,
+            std::unique_ptr<DecisionLog> decision_log = nullptr,
+            std::unique_ptr<StatsServer> stats_server = nullptr,
+            std::unique_ptr<FlightRecorder> flight_recorder = nullptr,
+            std::unique_ptr<Tracer> tracer = nullptr);
         void run();
 
     private:
+        // Variables
         std::vector<std::unique_ptr<InterfaceThreader>> threaders_;
+        std::unique_ptr<DecisionLog> decision_log_;
+        std::unique_ptr<StatsServer> stats_server_;
+        std::unique_ptr<FlightRecorder> flight_recorder_;
+        std::unique_ptr<Tracer> tracer_;
+        // Methods
+        void dump_flight_recorder_();
 };
 
 
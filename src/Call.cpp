@@ -121,7 +121,7 @@ std::ostream &Call::print_(std::ostream &os) const
 Action Call::action(
     const Packet &packet, const MAVAddress &address) const
 {
-    if (!condition_ || condition_->check(packet, address))
+    if (matches_(packet, address))
     {
         auto result = chain_->action(packet, address);
 
@@ -139,6 +139,33 @@ Action Call::action(
 }
 
 
+/** \copydoc Rule::may_accept(unsigned long,const MAVAddress&,bool)const
+ *
+ *  The result of the called chain, unless the condition can not match.  A
+ *  rejection by the chain only holds if the condition matches for every
+ *  destination.
+ */
+std::optional<bool> Call::may_accept(
+    unsigned long id, const MAVAddress &source, bool accept_by_default) const
+{
+    auto match = check_(id, source);
+
+    if (match == false)
+    {
+        return {};
+    }
+
+    auto result = chain_->may_accept(id, source, accept_by_default);
+
+    if (result == false && !match.has_value())
+    {
+        return {};
+    }
+
+    return result;
+}
+
+
 std::unique_ptr<Rule> Call::clone() const
 {
     if (priority_)
@@ -150,6 +177,15 @@ std::unique_ptr<Rule> Call::clone() const
 }
 
 
+/** \copydoc Rule::chain()const
+ *
+ *  \returns The chain to delegate decisions to.
+ */
+const Chain *Call::chain() const
+{
+    return chain_.get();
+}
+
 /** \copydoc Rule::operator==(const Rule&)const
  *
  *  Compares the chain and priority (if set) associated with the rule as well.
@@ -15,8 +15,11 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <set>
 #include <stdexcept>
@@ -25,18 +28,32 @@
 
 #include "Action.hpp"
 #include "Chain.hpp"
+#include "Counters.hpp"
 #include "MAVAddress.hpp"
 #include "MAVSubnet.hpp"
 #include "Packet.hpp"
 #include "RecursionGuard.hpp"
 
 
+namespace
+{
+
+    // Indices of the chain's counters.
+    constexpr std::size_t PACKETS = 0;
+    constexpr std::size_t SAMPLES = 1;
+    constexpr std::size_t SAMPLE_TIME = 2;
+
+}
+
+
 /** Copy constructor.
+ *
+ *  The counters are not copied, the copy starts with none.
  *
  *  \param other Chain to copy from.
  */
 Chain::Chain(const Chain &other)
-    : name_(other.name_)
+    : name_(other.name_), indices_(other.indices_)
 {
     for (auto &rule : other.rules_)
     {
@@ -45,6 +62,19 @@ Chain::Chain(const Chain &other)
 }
 
 
+/** Move constructor.
+ *
+ *  The counters are not moved, the new chain starts with none.
+ *
+ *  \param other Chain to move from.
+ */
+Chain::Chain(Chain &&other)
+    : name_(std::move(other.name_)), rules_(std::move(other.rules_)),
+      indices_(std::move(other.indices_))
+{
+}
+
+
 /** Construct a new filter chain.
  *
  *  \note No rule in the chain may contain a \ref GoTo or \ref Call that would
@@ -58,7 +88,8 @@ Chain::Chain(const Chain &other)
  */
 Chain::Chain(
     std::string name, std::vector<std::unique_ptr<Rule>> &&rules)
-    : name_(std::move(name)), rules_(std::move(rules))
+    : name_(std::move(name)), rules_(std::move(rules)),
+      indices_(rules_.size(), 0)
 {
     if (name_.find_first_of("\t\n ") != std::string::npos)
     {
@@ -80,11 +111,16 @@ Chain::Chain(
  *  \note An error will be thrown if any \ref Call or \ref GoTo rule matches
  *      that directly or indirectly loops back to this chain.
  *
+ *  The packet is counted, see \ref packets, and if it is one of the
+ *  evaluations sampled by \ref profile the time taken is recorded.
+ *
  *  \param packet The packet to determine whether to allow or not.
  *  \param address The address the \p packet will be sent out on if the
  *      action allows it.
  *  \returns The action to take with the packet.  %If this is the accept \ref
- *      Action object, it may also contain a priority for the packet.
+ *      Action object, it may also contain a priority for the packet.  The
+ *      index of the rule that decided the action is set, see \ref
+ *      Action::rule.
  *  \throws RecursionError if a rule loops back to this chain.
  */
 Action Chain::action(
@@ -92,15 +128,44 @@ Action Chain::action(
 {
     // Prevent recursion.
     RecursionGuard recursion_guard(recursion_data_);
+    auto count = counters_.add(PACKETS);
+
+    // Time a sample of the evaluations.
+    if (sample_(count))
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto result = action_(packet, address);
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now() - start);
+        counters_.add(SAMPLES);
+        counters_.add(
+            SAMPLE_TIME, static_cast<unsigned long long>(elapsed.count()));
+        return result;
+    }
+
+    return action_(packet, address);
+}
 
+
+/** Decide what to do with a \ref Packet, without counting it.
+ *
+ *  \param packet The packet to determine whether to allow or not.
+ *  \param address The address the \p packet will be sent out on if the
+ *      action allows it.
+ *  \returns The action to take with the packet, see \ref action.
+ */
+Action Chain::action_(
+    const Packet &packet, const MAVAddress &address)
+{
     // Loop throught the rules.
-    for (auto const &rule : rules_)
+    for (std::size_t i = 0; i < rules_.size(); ++i)
     {
-        auto result = rule->action(packet, address);
+        auto result = rules_[i]->action(packet, address);
 
         // Return rule result if not CONTINUE.
         if (result.action() != Action::CONTINUE)
         {
+            result.rule(indices_[i]);
             return result;
         }
     }
@@ -109,13 +174,54 @@ Action Chain::action(
 }
 
 
+/** Decide whether a packet may be accepted, from only its header.
+ *
+ *  Each rule is checked in turn until one decides the packet, see \ref
+ *  Rule::may_accept.
+ *
+ *  \param id The packet ID (message type) of the packet.
+ *  \param source The source address of the packet.
+ *  \param accept_by_default Whether the filter accepts packets that reach the
+ *      default action.
+ *  \retval true %If the packet may be accepted for some destination.
+ *  \retval false %If the packet is rejected for every destination.
+ *  \returns Nothing if no rule decides the packet.
+ *  \throws RecursionError if a rule is encountered which calls this chain
+ *      (either directly or indirectly).
+ */
+std::optional<bool> Chain::may_accept(
+    unsigned long id, const MAVAddress &source, bool accept_by_default)
+{
+    // Prevent recursion.
+    RecursionGuard recursion_guard(recursion_data_);
+
+    // Loop throught the rules.
+    for (auto const &rule : rules_)
+    {
+        auto result = rule->may_accept(id, source, accept_by_default);
+
+        // Return rule result if evaluation can not continue.
+        if (result.has_value())
+        {
+            return result;
+        }
+    }
+
+    return {};
+}
+
+
 /** Append a new rule to the filter chain.
  *
  *  \param rule A new filter rule to append to the chain.
+ *  \param index Index used to identify the rule in decisions, this is the
+ *      line of the rule in the configuration file.  The default is 0 (no
+ *      index).
  */
-void Chain::append(std::unique_ptr<Rule> rule)
+void Chain::append(std::unique_ptr<Rule> rule, unsigned int index)
 {
     rules_.push_back(std::move(rule));
+    indices_.push_back(index);
 }
 
 
@@ -131,6 +237,63 @@ const std::string &Chain::name() const
 }
 
 
+/** Get the rules of the chain.
+ *
+ *  \returns The rules, in the order they are checked.
+ */
+const std::vector<std::unique_ptr<Rule>> &Chain::rules() const
+{
+    return rules_;
+}
+
+
+/** Get the indices of the rules of the chain.
+ *
+ *  \returns The index of each rule, in the same order as \ref rules.  These
+ *      are the lines of the rules in the configuration file, or 0 if the rule
+ *      was not given an index.
+ */
+const std::vector<unsigned int> &Chain::indices() const
+{
+    return indices_;
+}
+
+
+/** Get the number of packets evaluated by the chain.
+ *
+ *  \returns The number of calls to \ref action, from all threads.
+ */
+unsigned long long Chain::packets() const
+{
+    return counters_.value(PACKETS);
+}
+
+
+/** Get the number of evaluations sampled for profiling.
+ *
+ *  \returns The number of calls to \ref action that were timed.
+ *  \sa profile
+ */
+unsigned long long Chain::samples() const
+{
+    return counters_.value(SAMPLES);
+}
+
+
+/** Get the total time taken by the sampled evaluations.
+ *
+ *  This includes the time taken by any chains called from this chain.  The
+ *  mean cost of an evaluation is this divided by \ref samples.
+ *
+ *  \returns The time taken by the calls to \ref action that were timed.
+ *  \sa profile
+ */
+std::chrono::nanoseconds Chain::sample_time() const
+{
+    return std::chrono::nanoseconds(counters_.value(SAMPLE_TIME));
+}
+
+
 /** Assignment operator.
  *
  * \param other Chain to copy from.
@@ -138,6 +301,7 @@ const std::string &Chain::name() const
 Chain &Chain::operator=(const Chain &other)
 {
     name_ = other.name_;
+    indices_ = other.indices_;
     rules_.clear();
 
     for (auto &rule : other.rules_)
@@ -150,6 +314,54 @@ Chain &Chain::operator=(const Chain &other)
 }
 
 
+/** Assignment operator (by move semantics).
+ *
+ *  The counters are not moved, this chain keeps its own.
+ *
+ *  \param other Chain to move from.
+ */
+Chain &Chain::operator=(Chain &&other)
+{
+    name_ = std::move(other.name_);
+    rules_ = std::move(other.rules_);
+    indices_ = std::move(other.indices_);
+    recursion_data_ = std::move(other.recursion_data_);
+    return *this;
+}
+
+
+/** Set how often the evaluation time of chains is measured.
+ *
+ *  Timing every evaluation would add two clock reads to every chain a packet
+ *  passes through, so only one in every \p period evaluations of each chain
+ *  made by each thread is timed.  This applies to all chains.
+ *
+ *  \param period Time one in this many evaluations.  The default of 0
+ *      disables profiling.
+ */
+void Chain::profile(unsigned int period)
+{
+    profile_.store(period, std::memory_order_relaxed);
+}
+
+
+/** Decide whether to time the current evaluation.
+ *
+ *  The decision is made per chain, from the chain's own count, so that a
+ *  chain which always calls another chain is sampled as often as that chain.
+ *
+ *  \param count The number of evaluations of the chain made by the calling
+ *      thread (or threads sharing its counter shard), including this one.
+ *  \retval true %If the evaluation should be timed.
+ *  \retval false %If profiling is disabled or the evaluation is not sampled.
+ */
+bool Chain::sample_(unsigned long long count)
+{
+    auto period = profile_.load(std::memory_order_relaxed);
+    return period != 0 && count % period == 0;
+}
+
+
 /** Equality comparison.
  *
  *  Compares the chain name and each \ref Rule in the chain.
@@ -234,3 +446,6 @@ std::ostream &operator<<(std::ostream &os, const Chain &chain)
     os << "}";
     return os;
 }
+
+
+std::atomic<unsigned int> Chain::profile_(0);
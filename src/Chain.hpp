@@ -19,13 +19,17 @@
 #define CHAIN_HPP_
 
 
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <string>
 #include <vector>
 
 #include "Action.hpp"
 #include "config.hpp"
+#include "Counters.hpp"
 #include "MAVAddress.hpp"
 #include "Packet.hpp"
 #include "RecursionGuard.hpp"
@@ -33,29 +37,33 @@
 
 
 /** A filter chain, containing a list of rules to check packets against.
+ *
+ *  Each chain counts the packets it evaluates and, when profiling is enabled
+ *  (see \ref profile), the time taken by a sample of those evaluations.
  */
 class Chain
 {
     public:
         Chain(const Chain &other);
-        /** Move constructor.
-         *
-         *  \param other Chain to move from.
-         */
-        Chain(Chain &&other) = default;
+        Chain(Chain &&other);
         Chain(std::string name_,
               std::vector<std::unique_ptr<Rule>> &&rules = {});
         TEST_VIRTUAL ~Chain() = default;
         TEST_VIRTUAL Action action(
             const Packet &packet, const MAVAddress &address);
-        void append(std::unique_ptr<Rule> rule);
+        TEST_VIRTUAL std::optional<bool> may_accept(
+            unsigned long id, const MAVAddress &source,
+            bool accept_by_default);
+        void append(std::unique_ptr<Rule> rule, unsigned int index = 0);
         const std::string &name() const;
+        const std::vector<std::unique_ptr<Rule>> &rules() const;
+        const std::vector<unsigned int> &indices() const;
+        unsigned long long packets() const;
+        unsigned long long samples() const;
+        std::chrono::nanoseconds sample_time() const;
         Chain &operator=(const Chain &other);
-        /** Assignment operator (by move semantics).
-         *
-         * \param other Chain to move from.
-         */
-        Chain &operator=(Chain &&other) = default;
+        Chain &operator=(Chain &&other);
+        static void profile(unsigned int period);
 
         friend bool operator==(const Chain &lhs, const Chain &rhs);
         friend bool operator!=(const Chain &lhs, const Chain &rhs);
@@ -64,7 +72,12 @@ class Chain
     private:
         std::string name_;
         std::vector<std::unique_ptr<Rule>> rules_;
+        std::vector<unsigned int> indices_;
         RecursionData recursion_data_;
+        Counters<3> counters_;
+        static std::atomic<unsigned int> profile_;
+        Action action_(const Packet &packet, const MAVAddress &address);
+        static bool sample_(unsigned long long count);
 };
 
 
@@ -15,8 +15,15 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
 #include <map>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <stdexcept>
 #include <string>
@@ -31,15 +38,25 @@
 #include "config_grammar.hpp"
 #include "ConnectionFactory.hpp"
 #include "ConnectionPool.hpp"
+#include "DecisionLog.hpp"
+#include "Deduplicator.hpp"
 #include "Filter.hpp"
+#include "FlightRecorder.hpp"
 #include "GoTo.hpp"
 #include "If.hpp"
 #include "IPAddress.hpp"
+#include "IPSubnet.hpp"
+#include "mavtables_shm.h"
 #include "parse_tree.hpp"
 #include "Reject.hpp"
 #include "SerialInterface.hpp"
 #include "SerialPort.hpp"
+#include "SharedMemory.hpp"
+#include "ShmInterface.hpp"
+#include "StatsServer.hpp"
+#include "Tracer.hpp"
 #include "UDPInterface.hpp"
+#include "UnixDatagramSocket.hpp"
 #include "UnixSerialPort.hpp"
 #include "UnixUDPSocket.hpp"
 #include "utility.hpp"
@@ -199,10 +216,11 @@ void parse_chain(
             }
         }
 
-        // Create and add the new rule.
+        // Create and add the new rule, identified by its line.
         chain.append(
             parse_action(
-                *node, std::move(priority), std::move(condition), chains));
+                *node, std::move(priority), std::move(condition), chains),
+            static_cast<unsigned int>(node->begin().line));
     }
 }
 
@@ -241,7 +259,93 @@ If parse_condition(const config::parse_tree::node &root)
 }
 
 
+/** Parse decision log from AST.
+ *
+ *  \relates ConfigParser
+ *  \param root Root of configuration AST.
+ *  \returns The decision log parsed from the AST or nullptr if decisions
+ *      should not be recorded.
+ *  \throws std::invalid_argument if the path of the log is missing.
+ *  \throws std::system_error if the log file can not be created.
+ */
+std::unique_ptr<DecisionLog> parse_decision_log(
+    const config::parse_tree::node &root)
+{
+    std::unique_ptr<DecisionLog> decision_log;
+
+    // Look through top nodes.
+    for (auto &node : root.children)
+    {
+        if (node->name() == "config::decision_log")
+        {
+            std::optional<std::string> path;
+            std::size_t records = 1048576;
+            unsigned int files = 4;
+
+            // Loop over options for the decision log.
+            for (auto &child : node->children)
+            {
+                if (child->name() == "config::path")
+                {
+                    path = child->content();
+                }
+                else if (child->name() == "config::records")
+                {
+                    records = std::stoull(child->content());
+                }
+                else if (child->name() == "config::files")
+                {
+                    files = static_cast<unsigned int>(
+                                std::stoul(child->content()));
+                }
+            }
+
+            // Throw error if no path was given.
+            if (!path.has_value())
+            {
+                throw std::invalid_argument("missing decision log path");
+            }
+
+            decision_log = std::make_unique<DecisionLog>(
+                               path.value(), records, files);
+        }
+    }
+
+    return decision_log;
+}
+
+
+/** Parse duplicate packet detector from AST.
+ *
+ *  \relates ConfigParser
+ *  \param root Root of configuration AST.
+ *  \returns The duplicate packet detector parsed from the AST or nullptr if
+ *      duplicate packets should not be suppressed.
+ */
+std::unique_ptr<Deduplicator<>> parse_deduplicator(
+    const config::parse_tree::node &root)
+{
+    std::unique_ptr<Deduplicator<>> deduplicator;
+
+    // Look through top nodes.
+    for (auto &node : root.children)
+    {
+        if (node->name() == "config::deduplicate")
+        {
+            deduplicator = std::make_unique<Deduplicator<>>(
+                               std::chrono::milliseconds(
+                                   std::stoll(node->content())));
+        }
+    }
+
+    return deduplicator;
+}
+
+
 /** Parse \ref Filter from AST.
+ *
+ *  This also sets how often chain evaluations are profiled, see \ref
+ *  Chain::profile.
  *
  *  \relates ConfigParser
  *  \param root Root of configuration AST.
@@ -251,6 +355,7 @@ std::unique_ptr<Filter> parse_filter(const config::parse_tree::node &root)
 {
     Chain default_chain("default");
     bool default_action = false;
+    unsigned int profile = 0;
     std::map<std::string, std::shared_ptr<Chain>> chains = init_chains(root);
 
     // Look through top nodes.
@@ -275,35 +380,97 @@ std::unique_ptr<Filter> parse_filter(const config::parse_tree::node &root)
         {
             default_action = node->children[0]->name() == "config::accept";
         }
+        // Parse chain profiling period.
+        else if (node->name() == "config::profile")
+        {
+            profile = static_cast<unsigned int>(std::stol(node->content()));
+        }
     }
 
+    Chain::profile(profile);
+
     // Construct the filter.
     return std::make_unique<Filter>(std::move(default_chain), default_action);
 }
 
 
-/** Parse UDP and serial port interfaces from AST root.
+/** Parse flight recorder from AST.
+ *
+ *  The flight recorder is always on, the optional flight_recorder block only
+ *  sets the file it is dumped to and its number of records.
+ *
+ *  \relates ConfigParser
+ *  \param root Root of configuration AST.
+ *  \returns The flight recorder parsed from the AST.
+ *  \throws std::invalid_argument if the number of records is not a power of 2.
+ */
+std::unique_ptr<FlightRecorder> parse_flight_recorder(
+    const config::parse_tree::node &root)
+{
+    std::string path = FlightRecorder::DEFAULT_PATH;
+    std::size_t records = 65536;
+
+    // Look through top nodes.
+    for (auto &node : root.children)
+    {
+        if (node->name() == "config::flight_recorder")
+        {
+            // Loop over options for the flight recorder.
+            for (auto &child : node->children)
+            {
+                if (child->name() == "config::path")
+                {
+                    path = child->content();
+                }
+                else if (child->name() == "config::records")
+                {
+                    records = std::stoull(child->content());
+                }
+            }
+        }
+    }
+
+    return std::make_unique<FlightRecorder>(path, records);
+}
+
+
+/** Parse UDP, unix domain socket, shared memory and serial port interfaces
+ *  from AST root.
  *
  *  \relates ConfigParser
  *  \param root The root of the AST to create \ref Interface's from.
  *  \param filter The packet \ref Filter to use for the interfaces.
- *  \returns A vector of UDP and serial port interfaces.
+ *  \returns A vector of UDP, unix domain socket, shared memory and serial port
+ *      interfaces.
  */
 std::vector<std::unique_ptr<Interface>> parse_interfaces(
         const config::parse_tree::node &root, std::unique_ptr<Filter> filter)
 {
     std::shared_ptr<Filter> shared_filter = std::move(filter);
     std::vector<std::unique_ptr<Interface>> interfaces;
-    auto connection_pool = std::make_shared<ConnectionPool>();
+    auto connection_pool =
+        std::make_shared<ConnectionPool>(parse_deduplicator(root));
 
     // Loop over each node of the root AST node.
     for (auto &node : root.children)
     {
         // Parse UDP interface.
         if (node->name() == "config::udp")
+        {
+            auto udp = parse_udp(*node, shared_filter, connection_pool);
+            std::move(udp.begin(), udp.end(), std::back_inserter(interfaces));
+        }
+        // Parse unix domain socket interface.
+        else if (node->name() == "config::unix_")
+        {
+            interfaces.push_back(
+                parse_unix(*node, shared_filter, connection_pool));
+        }
+        // Parse shared memory interface.
+        else if (node->name() == "config::shm")
         {
             interfaces.push_back(
-                parse_udp(*node, shared_filter, connection_pool));
+                parse_shm(*node, shared_filter, connection_pool));
         }
         // Parse serial port interface.
         else if (node->name() == "config::serial")
@@ -337,6 +504,9 @@ std::unique_ptr<SerialInterface> parse_serial(
     unsigned long baud_rate = 9600;
     SerialPort::Feature features = SerialPort::DEFAULT;
     std::vector<MAVAddress> preload;
+    unsigned int read_min_bytes = 0;
+    std::chrono::milliseconds read_timeout(0);
+    std::size_t read_buffer_size = 1024;
 
     // Extract settings from AST.
     for (auto &node : root.children)
@@ -356,9 +526,37 @@ std::unique_ptr<SerialInterface> parse_serial(
         {
             if (to_lower(node->content()) == "yes")
             {
-                features = SerialPort::FLOW_CONTROL;
+                features = static_cast<SerialPort::Feature>(
+                               features | SerialPort::FLOW_CONTROL);
+            }
+        }
+        // Extract low latency mode.
+        else if (node->name() == "config::low_latency")
+        {
+            if (to_lower(node->content()) == "yes")
+            {
+                features = static_cast<SerialPort::Feature>(
+                               features | SerialPort::LOW_LATENCY);
             }
         }
+        // Extract minimum read size.
+        else if (node->name() == "config::read_min_bytes")
+        {
+            read_min_bytes =
+                static_cast<unsigned int>(std::stol(node->content()));
+        }
+        // Extract read timeout.
+        else if (node->name() == "config::read_timeout")
+        {
+            read_timeout = std::chrono::milliseconds(
+                               std::stol(node->content()));
+        }
+        // Extract read buffer size.
+        else if (node->name() == "config::read_buffer_size")
+        {
+            read_buffer_size =
+                static_cast<std::size_t>(std::stol(node->content()));
+        }
         // Extract preloaded address.
         else if (node->name() == "config::preload")
         {
@@ -374,7 +572,8 @@ std::unique_ptr<SerialInterface> parse_serial(
 
     // Construct serial interface.
     auto port = std::make_unique<UnixSerialPort>(
-                    device.value(), baud_rate, features);
+                    device.value(), baud_rate, features,
+                    read_min_bytes, read_timeout, read_buffer_size);
     auto connection = std::make_unique<Connection>(
                           device.value(), filter, false);
 
@@ -388,16 +587,156 @@ std::unique_ptr<SerialInterface> parse_serial(
 }
 
 
+/** Parse a shared memory interface from an AST.
+ *
+ *  \relates ConfigParser
+ *  \param root The shared memory node to parse.
+ *  \param filter The \ref Filter to use for the \ref ShmInterface.
+ *  \param pool The connection pool to add the interface's connection to.
+ *  \returns The shared memory interface parsed from the AST and using the
+ *      given filter and connection pool.
+ *  \throws std::invalid_argument if the shared memory name is missing.
+ *  \throws std::invalid_argument if the ring size is invalid.
+ */
+std::unique_ptr<ShmInterface> parse_shm(
+    const config::parse_tree::node &root,
+    std::shared_ptr<Filter> filter,
+    std::shared_ptr<ConnectionPool> pool)
+{
+    std::optional<std::string> name;
+    unsigned long long ring_size = 1048576;
+
+    // Loop over options for shared memory interface.
+    for (auto &node : root.children)
+    {
+        // Parse shared memory object name.
+        if (node->name() == "config::name")
+        {
+            name = node->content();
+        }
+        // Parse ring size.
+        else if (node->name() == "config::ring_size")
+        {
+            ring_size = std::stoull(node->content());
+        }
+    }
+
+    // Throw error if no name was given.
+    if (!name.has_value())
+    {
+        throw std::invalid_argument("missing shared memory name");
+    }
+
+    if (ring_size > std::numeric_limits<std::uint32_t>::max())
+    {
+        throw std::invalid_argument("ring size is too large");
+    }
+
+    // Construct shared memory interface.
+    auto size = static_cast<std::uint32_t>(ring_size);
+    auto memory = std::make_unique<SharedMemory>(
+                      name.value(), mavtables_shm_size(size));
+    auto connection = std::make_unique<Connection>(
+                          name.value(), filter, false);
+    return std::make_unique<ShmInterface>(
+               std::move(memory), size, pool, std::move(connection));
+}
+
+
+/** Parse the path of the statistics socket from AST.
+ *
+ *  \relates ConfigParser
+ *  \param root Root of configuration AST.
+ *  \returns The path of the unix socket to serve statistics on or {} if
+ *      statistics should not be served.
+ */
+std::optional<std::string> parse_stats(const config::parse_tree::node &root)
+{
+    std::optional<std::string> path;
+
+    // Look through top nodes.
+    for (auto &node : root.children)
+    {
+        if (node->name() == "config::stats")
+        {
+            path = node->content();
+        }
+    }
+
+    return path;
+}
+
+
+/** Parse packet tracer from AST.
+ *
+ *  \relates ConfigParser
+ *  \param root Root of configuration AST.
+ *  \returns The tracer parsed from the AST or nullptr if no packets should be
+ *      traced.
+ *  \throws std::invalid_argument if a trace period is out of range.
+ */
+std::unique_ptr<Tracer> parse_tracer(const config::parse_tree::node &root)
+{
+    std::unique_ptr<Tracer> tracer;
+
+    // Look through top nodes.
+    for (auto &node : root.children)
+    {
+        if (node->name() == "config::trace")
+        {
+            unsigned int period = 0;
+            If condition;
+
+            // Loop over options for the trace.
+            for (auto &child : node->children)
+            {
+                if (child->name() == "config::trace_period")
+                {
+                    period = static_cast<unsigned int>(
+                                 std::stoul(child->content()));
+                }
+                else if (child->name() == "config::condition")
+                {
+                    condition = parse_condition(*child);
+                }
+            }
+
+            if (tracer == nullptr)
+            {
+                tracer = std::make_unique<Tracer>();
+            }
+
+            tracer->add(period, std::move(condition));
+        }
+    }
+
+    return tracer;
+}
+
+
 /** Parse a UPD interface from an AST.
+ *
+ *  If the number of threads is greater than one, this many UDP interfaces are
+ *  constructed, each with its own socket bound to the same port (with
+ *  SO_REUSEPORT) and therefore its own receive thread and packet parser.  The
+ *  kernel distributes incoming datagrams between the sockets by address/port
+ *  pair, so each remote peer is always serviced by the same interface.
  *
  *  \relates ConfigParser
  *  \param root The UDP node to parse.
  *  \param filter The \ref Filter to use for the \ref UDPInterface.
  *  \param pool The connection pool to add the interface's connections to.
- *  \returns The UDP interface parsed from the AST and using the given filter
- *      and connection pool.
+ *  \returns The UDP interfaces parsed from the AST and using the given filter
+ *      and connection pool.  There is one interface per thread.
+ *  \throws std::invalid_argument if the number of threads is 0.
+ *  \throws std::invalid_argument if a peer weight is 0.
+ *  \throws std::invalid_argument if a multicast group is used with more than
+ *      one thread or is not a multicast address.
+ *  \throws std::invalid_argument if addresses are preloaded without a
+ *      multicast group.
+ *  \throws std::invalid_argument if the aggregation MTU is too small.
  */
-std::unique_ptr<UDPInterface> parse_udp(
+std::vector<std::unique_ptr<UDPInterface>> parse_udp(
     const config::parse_tree::node &root,
     std::shared_ptr<Filter> filter,
     std::shared_ptr<ConnectionPool> pool)
@@ -405,6 +744,16 @@ std::unique_ptr<UDPInterface> parse_udp(
     unsigned int port = 14500;
     std::optional<IPAddress> address;
     unsigned long max_bitrate = 0;
+    unsigned long peer_max_bitrate = 0;
+    unsigned long threads = 1;
+    std::vector<std::pair<IPSubnet, unsigned int>> weights;
+    std::chrono::milliseconds idle_timeout(120000);
+    bool connect_peers = false;
+    bool kernel_timestamps = false;
+    std::optional<IPAddress> multicast;
+    std::vector<MAVAddress> preload;
+    std::size_t mtu = 0;
+    std::chrono::milliseconds flush_delay(0);
 
     // Loop over options for UDP interface.
     for (auto &node : root.children)
@@ -425,13 +774,154 @@ std::unique_ptr<UDPInterface> parse_udp(
             max_bitrate = static_cast<unsigned long>(
                               std::stoll(node->content()));
         }
+        // Parse per destination bitrate limit.
+        else if (node->name() == "config::peer_max_bitrate")
+        {
+            peer_max_bitrate = static_cast<unsigned long>(
+                                   std::stoll(node->content()));
+        }
+        // Parse number of receive threads.
+        else if (node->name() == "config::threads")
+        {
+            threads = static_cast<unsigned long>(std::stol(node->content()));
+        }
+        // Parse idle connection timeout.
+        else if (node->name() == "config::idle_timeout")
+        {
+            idle_timeout = std::chrono::milliseconds(
+                               std::stoll(node->content()));
+        }
+        // Parse connected per peer sockets.
+        else if (node->name() == "config::connect_peers")
+        {
+            connect_peers = to_lower(node->content()) == "yes";
+        }
+        // Parse kernel timestamping of received datagrams.
+        else if (node->name() == "config::kernel_timestamps")
+        {
+            kernel_timestamps = to_lower(node->content()) == "yes";
+        }
+        // Parse multicast group.
+        else if (node->name() == "config::multicast")
+        {
+            multicast = IPAddress(node->content());
+        }
+        // Parse aggregation MTU.
+        else if (node->name() == "config::aggregate")
+        {
+            mtu = static_cast<std::size_t>(std::stoll(node->content()));
+        }
+        // Parse aggregation flush delay.
+        else if (node->name() == "config::aggregate_delay")
+        {
+            flush_delay = std::chrono::milliseconds(
+                              std::stoll(node->content()));
+        }
+        // Parse preloaded address of the multicast group.
+        else if (node->name() == "config::preload")
+        {
+            preload.push_back(MAVAddress(node->content()));
+        }
+        // Parse transmit weight of a subnet.
+        else if (node->name() == "config::peer_weight")
+        {
+            weights.emplace_back(
+                IPSubnet(node->children[0]->content()),
+                static_cast<unsigned int>(
+                    std::stol(node->children[1]->content())));
+        }
+    }
+
+    // Throw error if no threads were requested.
+    if (threads == 0)
+    {
+        throw std::invalid_argument("number of threads must be at least 1");
+    }
+
+    if (multicast.has_value())
+    {
+        // Each interface would send its own copy to the group.
+        if (threads > 1)
+        {
+            throw std::invalid_argument(
+                "multicast can not be used with multiple threads");
+        }
+
+        // Default to the port of the interface.
+        if (multicast->port() == 0)
+        {
+            multicast = IPAddress(multicast.value(), port);
+        }
     }
 
-    // Construct the UDP interface.
-    auto socket = std::make_unique<UnixUDPSocket>(port, address, max_bitrate);
+    // Construct the UDP interfaces.
+    std::vector<std::unique_ptr<UDPInterface>> interfaces;
+
+    for (unsigned long i = 0; i < threads; ++i)
+    {
+        auto socket = std::make_unique<UnixUDPSocket>(
+                          port, address, max_bitrate, peer_max_bitrate,
+                          threads > 1, connect_peers, kernel_timestamps);
+        auto factory = std::make_unique<ConnectionFactory<>>(filter, false);
+        interfaces.push_back(std::make_unique<UDPInterface>(
+                                 std::move(socket), pool, std::move(factory),
+                                 weights, idle_timeout, multicast,
+                                 preload, mtu, flush_delay));
+    }
+
+    return interfaces;
+}
+
+
+/** Parse a unix domain socket interface from an AST.
+ *
+ *  The interface is a \ref UDPInterface using a \ref UnixDatagramSocket, so
+ *  each peer process gets its own connection.
+ *
+ *  \relates ConfigParser
+ *  \param root The unix domain socket node to parse.
+ *  \param filter The \ref Filter to use for the \ref UDPInterface.
+ *  \param pool The connection pool to add the interface's connections to.
+ *  \returns The unix domain socket interface parsed from the AST and using
+ *      the given filter and connection pool.
+ *  \throws std::invalid_argument if the socket path is missing.
+ */
+std::unique_ptr<UDPInterface> parse_unix(
+    const config::parse_tree::node &root,
+    std::shared_ptr<Filter> filter,
+    std::shared_ptr<ConnectionPool> pool)
+{
+    std::optional<std::string> path;
+    std::chrono::milliseconds idle_timeout(120000);
+
+    // Loop over options for unix domain socket interface.
+    for (auto &node : root.children)
+    {
+        // Parse socket path.
+        if (node->name() == "config::path")
+        {
+            path = node->content();
+        }
+        // Parse idle connection timeout.
+        else if (node->name() == "config::idle_timeout")
+        {
+            idle_timeout = std::chrono::milliseconds(
+                               std::stoll(node->content()));
+        }
+    }
+
+    // Throw error if no socket path was given.
+    if (!path.has_value())
+    {
+        throw std::invalid_argument("missing socket path");
+    }
+
+    // Construct the unix domain socket interface.
+    auto socket = std::make_unique<UnixDatagramSocket>(path.value());
     auto factory = std::make_unique<ConnectionFactory<>>(filter, false);
     return std::make_unique<UDPInterface>(
-               std::move(socket), pool, std::move(factory));
+               std::move(socket), pool, std::move(factory),
+               std::vector<std::pair<IPSubnet, unsigned int>>(), idle_timeout);
 }
 
 
@@ -465,7 +955,30 @@ std::unique_ptr<App> ConfigParser::make_app()
 {
     auto filter = parse_filter(*root_);
     auto interfaces = parse_interfaces(*root_, std::move(filter));
-    return std::make_unique<App>(std::move(interfaces));
+    std::unique_ptr<StatsServer> stats_server;
+
+    if (auto path = parse_stats(*root_))
+    {
+        stats_server = std::make_unique<StatsServer>(path.value());
+    }
+
+    return std::make_unique<App>(
+               std::move(interfaces), parse_decision_log(*root_),
+               std::move(stats_server), parse_flight_recorder(*root_),
+               parse_tracer(*root_));
+}
+
+
+/** Get the path of the statistics socket from the configuration.
+ *
+ *  This is used to read the statistics of a running mavtables.
+ *
+ *  \returns The path of the unix socket statistics are served on or {} if
+ *      the configuration does not serve statistics.
+ */
+std::optional<std::string> ConfigParser::stats()
+{
+    return parse_stats(*root_);
 }
 
 
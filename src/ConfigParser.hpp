@@ -21,16 +21,23 @@
 
 #include <map>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <string>
+#include <vector>
 
 #include <pegtl.hpp>
 
 #include "App.hpp"
 #include "Chain.hpp"
+#include "DecisionLog.hpp"
+#include "Deduplicator.hpp"
 #include "Filter.hpp"
+#include "FlightRecorder.hpp"
 #include "parse_tree.hpp"
 #include "SerialInterface.hpp"
+#include "ShmInterface.hpp"
+#include "Tracer.hpp"
 #include "UDPInterface.hpp"
 
 
@@ -50,8 +57,17 @@ void parse_chain(
 
 If parse_condition(const config::parse_tree::node &root);
 
+std::unique_ptr<DecisionLog> parse_decision_log(
+    const config::parse_tree::node &root);
+
+std::unique_ptr<Deduplicator<>> parse_deduplicator(
+    const config::parse_tree::node &root);
+
 std::unique_ptr<Filter> parse_filter(const config::parse_tree::node &root);
 
+std::unique_ptr<FlightRecorder> parse_flight_recorder(
+    const config::parse_tree::node &root);
+
 std::vector<std::unique_ptr<Interface>> parse_interfaces(
         const config::parse_tree::node &root, std::unique_ptr<Filter> filter);
 
@@ -60,7 +76,21 @@ std::unique_ptr<SerialInterface> parse_serial(
     std::shared_ptr<Filter> filter,
     std::shared_ptr<ConnectionPool> pool);
 
-std::unique_ptr<UDPInterface> parse_udp(
+std::unique_ptr<ShmInterface> parse_shm(
+    const config::parse_tree::node &root,
+    std::shared_ptr<Filter> filter,
+    std::shared_ptr<ConnectionPool> pool);
+
+std::optional<std::string> parse_stats(const config::parse_tree::node &root);
+
+std::unique_ptr<Tracer> parse_tracer(const config::parse_tree::node &root);
+
+std::vector<std::unique_ptr<UDPInterface>> parse_udp(
+    const config::parse_tree::node &root,
+    std::shared_ptr<Filter> filter,
+    std::shared_ptr<ConnectionPool> pool);
+
+std::unique_ptr<UDPInterface> parse_unix(
     const config::parse_tree::node &root,
     std::shared_ptr<Filter> filter,
     std::shared_ptr<ConnectionPool> pool);
@@ -78,6 +108,7 @@ class ConfigParser
         ConfigParser(const ConfigParser &other) = delete;
         ConfigParser(ConfigParser &&other) = delete;
         std::unique_ptr<App> make_app();
+        std::optional<std::string> stats();
         ConfigParser &operator=(const ConfigParser &other) = delete;
         ConfigParser &operator=(ConfigParser &&other) = delete;
 
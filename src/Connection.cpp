@@ -16,47 +16,120 @@
 
 
 #include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
-#include <sstream>
 #include <stdexcept>
 #include <utility>
 
 #include "AddressPool.hpp"
 #include "Connection.hpp"
+#include "DecisionLog.hpp"
 #include "Filter.hpp"
+#include "FlightRecorder.hpp"
 #include "Logger.hpp"
 #include "MAVAddress.hpp"
 #include "Packet.hpp"
 #include "PacketQueue.hpp"
+#include "Stats.hpp"
+#include "Tracer.hpp"
+#include "tracepoints.hpp"
 #include "utility.hpp"
 
 
-/** Log an accepted/rejected packet to the \ref Logger.
+/** Count a packet against the connection and its message type.
+ *
+ *  \param traffic The event to count the packet under.
+ *  \param packet The packet to count.
+ */
+void Connection::count_(Traffic traffic, const Packet &packet)
+{
+    traffic_.count(traffic, packet.data().size());
+    Stats::count(traffic, packet);
+}
+
+
+/** Add an accepted packet to the queue, and count it.
+ *
+ *  \param packet The packet to add to the queue.
+ *  \param priority The priority to send the packet with.
+ */
+void Connection::enqueue_(std::shared_ptr<const Packet> packet, int priority)
+{
+    count_(Traffic::queued, *packet);
+
+    if (Tracer::traced(*packet))
+    {
+        auto connection = packet->connection();
+        Logger::trace(
+            LogEvent::queued, *packet,
+            connection == nullptr ? 0 : connection->name_id(), name_id_);
+    }
+
+    if (TRACEPOINT_ENABLED(queue_push))
+    {
+        TRACEPOINT(
+            queue_push, packet->id(), tracepoints::source(*packet),
+            tracepoints::dest(*packet), this, packet.get(), priority,
+            tracepoints::nanoseconds(packet->timestamp()),
+            tracepoints::nanoseconds(std::chrono::steady_clock::now()));
+    }
+
+    queue_->push(std::move(packet), priority);
+}
+
+
+/** Log an accepted/rejected packet to the \ref Logger and the installed
+ *  \ref DecisionLog and \ref FlightRecorder, and count it.
  *
  *  \param accept Set to true if the packet is accepted, false if the packet is
  *      rejected.
  *  \param packet The packet that is to be accepted/rejected.
+ *  \param priority The priority the packet is accepted with.
+ *  \param rule The index of the rule that decided, see \ref Action::rule.
  */
-void Connection::log_(bool accept, const Packet &packet)
+void Connection::log_(
+    bool accept, const Packet &packet, int priority, unsigned int rule)
 {
-    if (Logger::level() >= 3)
+    count_(accept ? Traffic::accepted : Traffic::rejected, packet);
+    auto connection = packet.connection();
+    auto from = connection == nullptr ? 0 : connection->name_id();
+
+    auto decisions = DecisionLog::installed();
+    auto recorder = FlightRecorder::installed();
+
+    if (decisions != nullptr || recorder != nullptr)
     {
-        std::stringstream ss;
-        ss << (accept ? "accepted " : "rejected ")
-           << packet << " source ";
-        auto connection = packet.connection();
+        auto record = DecisionRecord::make(
+                          accept ? DecisionRecord::ACCEPT :
+                          DecisionRecord::REJECT,
+                          packet, from, name_id_, priority, rule);
 
-        if (connection == nullptr)
+        if (decisions != nullptr)
         {
-            ss << "unknown";
+            decisions->record(record);
         }
-        else
+
+        if (recorder != nullptr)
         {
-            ss << *connection;
+            recorder->record(record);
         }
+    }
+
+    if (Logger::level() >= 3 || Tracer::traced(packet))
+    {
+        Logger::trace(
+            accept ? LogEvent::accepted : LogEvent::rejected, packet, from,
+            name_id_);
+    }
 
-        ss << " dest " << name_;
-        Logger::log(3, ss.str());
+    if (TRACEPOINT_ENABLED(filter_decision))
+    {
+        TRACEPOINT(
+            filter_decision, packet.id(), tracepoints::source(packet),
+            tracepoints::dest(packet), connection.get(), this, accept,
+            priority, rule);
     }
 }
 
@@ -83,17 +156,17 @@ void Connection::send_to_address_(
     if (pool_->contains(dest))
     {
         // Run packet/address combination through the filter.
-        auto [accept, priority] = filter_->will_accept(*packet, dest);
+        auto [accept, priority, rule] = filter_->will_accept(*packet, dest);
 
         // Add packet to the queue.
         if (accept)
         {
-            log_(true, *packet);
-            queue_->push(std::move(packet), priority);
+            log_(true, *packet, priority, rule);
+            enqueue_(std::move(packet), priority);
         }
         else
         {
-            log_(false, *packet);
+            log_(false, *packet, 0, rule);
         }
     }
     // If the component is not reachable, send it to all components on the
@@ -101,6 +174,7 @@ void Connection::send_to_address_(
     else
     {
         bool system_found = false;
+        unsigned int rule = 0;
 
         // Loop over addresses.
         for (const auto &addr : pool_->addresses())
@@ -109,20 +183,23 @@ void Connection::send_to_address_(
             if (addr.system() == dest.system())
             {
                 system_found = true;
-                auto [accept, priority] = filter_->will_accept(*packet, dest);
+                auto [accept, priority, rule_] =
+                    filter_->will_accept(*packet, dest);
 
                 if (accept)
                 {
-                    log_(true, *packet);
-                    queue_->push(std::move(packet), priority);
+                    log_(true, *packet, priority, rule_);
+                    enqueue_(std::move(packet), priority);
                     return;
                 }
+
+                rule = rule_;
             }
         }
 
         if (system_found)
         {
-            log_(false, *packet);
+            log_(false, *packet, 0, rule);
         }
     }
 }
@@ -142,30 +219,41 @@ void Connection::send_to_all_(std::shared_ptr<const Packet> packet)
 {
     bool accept = false;
     int priority = std::numeric_limits<int>::min();
+    unsigned int rule = 0;
 
     // Loop over addresses.
     for (const auto &addr : pool_->addresses())
     {
         // Filter packet/address combination.
-        auto [accept_, priority_] = filter_->will_accept(*packet, addr);
+        auto [accept_, priority_, rule_] =
+            filter_->will_accept(*packet, addr);
 
-        // Update accept/priority.
+        // Update accept/priority and the deciding rule.
         if (accept_)
         {
+            if (!accept || priority_ > priority)
+            {
+                rule = rule_;
+            }
+
             accept = accept_;
             priority = std::max(priority, priority_);
         }
+        else if (!accept)
+        {
+            rule = rule_;
+        }
     }
 
     // Add packet to the queue.
     if (accept)
     {
-        log_(true, *packet);
-        queue_->push(std::move(packet), priority);
+        log_(true, *packet, priority, rule);
+        enqueue_(std::move(packet), priority);
     }
     else
     {
-        log_(false, *packet);
+        log_(false, *packet, 0, rule);
     }
 }
 
@@ -186,6 +274,7 @@ void Connection::send_to_system_(
     bool system_found = false;
     bool accept = false;
     int priority = std::numeric_limits<int>::min();
+    unsigned int rule = 0;
 
     // Loop over addresses.
     for (const auto &addr : pool_->addresses())
@@ -194,14 +283,24 @@ void Connection::send_to_system_(
         {
             system_found = true;
             // Filter packet/address combination.
-            auto [accept_, priority_] = filter_->will_accept(*packet, addr);
+            auto [accept_, priority_, rule_] =
+                filter_->will_accept(*packet, addr);
 
-            // Update accept/priority.
+            // Update accept/priority and the deciding rule.
             if (accept_)
             {
+                if (!accept || priority_ > priority)
+                {
+                    rule = rule_;
+                }
+
                 accept = accept_;
                 priority = std::max(priority, priority_);
             }
+            else if (!accept)
+            {
+                rule = rule_;
+            }
         }
     }
 
@@ -210,12 +309,12 @@ void Connection::send_to_system_(
     {
         if (accept)
         {
-            log_(true, *packet);
-            queue_->push(std::move(packet), priority);
+            log_(true, *packet, priority, rule);
+            enqueue_(std::move(packet), priority);
         }
         else
         {
-            log_(false, *packet);
+            log_(false, *packet, 0, rule);
         }
     }
 }
@@ -248,7 +347,8 @@ Connection::Connection(
     std::unique_ptr<PacketQueue> queue)
     : name_(std::move(name)),
       filter_(std::move(filter)), pool_(std::move(pool)),
-      queue_(std::move(queue)), mirror_(mirror)
+      queue_(std::move(queue)), mirror_(mirror), duplicates_(0),
+      name_id_(Logger::register_name(name_))
 {
     if (filter_ == nullptr)
     {
@@ -264,6 +364,16 @@ Connection::Connection(
     {
         throw std::invalid_argument("Given queue pointer is null.");
     }
+
+    Stats::add(*this);
+}
+
+
+/** Destroy the connection, removing it from the \ref Stats.
+ */
+Connection::~Connection()
+{
+    Stats::remove(*this);
 }
 
 
@@ -289,12 +399,88 @@ void Connection::add_address(MAVAddress address)
 }
 
 
+/** Record that a duplicate packet was received on the connection.
+ *
+ *  \returns The number of duplicate packets received on the connection,
+ *      including this one.
+ *  \remarks
+ *      Threadsafe (lock-free).
+ */
+unsigned long Connection::add_duplicate()
+{
+    return ++duplicates_;
+}
+
+
+/** Discard all packets waiting to be sent on the connection.
+ *
+ *  The discarded packets are counted as dropped.
+ *
+ *  \returns The number of packets that were discarded.
+ */
+std::size_t Connection::clear()
+{
+    std::size_t count = 0;
+
+    while (auto packet = queue_->pop(std::chrono::nanoseconds::zero()))
+    {
+        count_(Traffic::dropped, *packet);
+        ++count;
+    }
+
+    return count;
+}
+
+
+/** Get the number of duplicate packets received on the connection.
+ *
+ *  \returns The number of packets received on the connection that were
+ *      suppressed because they had already been received.
+ *  \remarks
+ *      Threadsafe (lock-free).
+ */
+unsigned long Connection::duplicates() const
+{
+    return duplicates_;
+}
+
+
+/** Determine if any MAVLink addresses are reachable on the connection.
+ *
+ *  \retval true There is at least one address that has not expired.
+ *  \retval false All addresses have expired or none were ever added.
+ */
+bool Connection::has_addresses()
+{
+    return !pool_->addresses().empty();
+}
+
+
+/** Decide whether the connection may accept a packet, from only its header.
+ *
+ *  This is used to drop packets that no connection will accept before they
+ *  are fully received.  Like \ref send, packets from a source that is
+ *  reachable on this connection are never accepted.
+ *
+ *  \param id The packet ID (message type) of the packet.
+ *  \param source The source address of the packet.
+ *  \retval true %If the packet may be accepted by the connection.
+ *  \retval false %If \ref send would not accept the packet.
+ */
+bool Connection::may_accept(unsigned long id, const MAVAddress &source)
+{
+    return !pool_->contains(source) && filter_->may_accept(id, source);
+}
+
 
 /** Get next packet to send.
  *
  *  Blocks until a packet is ready to be sent or the \p timeout expires.
  *  Returns nullptr in the later case.
  *
+ *  Packets are counted as sent when they are taken from the queue, which is
+ *  also when their latency and sojourn time are recorded, see \ref latency.
+ *
  *  \param timeout How long to block waiting for a packet.  Set to 0s for non
  *      blocking.
  *  \returns The next packet to send.  Or nullptr if the call times out waiting
@@ -303,7 +489,41 @@ void Connection::add_address(MAVAddress address)
 std::shared_ptr<const Packet> Connection::next_packet(
     const std::chrono::nanoseconds &timeout)
 {
-    return queue_->pop(timeout);
+    auto queued = queue_->pop_queued(timeout);
+
+    if (!queued.has_value())
+    {
+        return nullptr;
+    }
+
+    auto packet = queued->packet();
+    auto now = std::chrono::steady_clock::now();
+    latency_.record(
+        queued->priority(), now - packet->timestamp(),
+        now - queued->timestamp());
+
+    if (Tracer::traced(*packet))
+    {
+        auto connection = packet->connection();
+        Logger::trace(
+            LogEvent::sending, *packet,
+            connection == nullptr ? 0 : connection->name_id(), name_id_,
+            static_cast<unsigned long>(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    now - queued->timestamp()).count()));
+    }
+
+    if (TRACEPOINT_ENABLED(queue_pop))
+    {
+        TRACEPOINT(
+            queue_pop, packet->id(), tracepoints::source(*packet),
+            tracepoints::dest(*packet), this, packet.get(),
+            queued->priority(), tracepoints::nanoseconds(packet->timestamp()),
+            tracepoints::nanoseconds(queued->timestamp()));
+    }
+
+    count_(Traffic::sent, *packet);
+    return packet;
 }
 
 
@@ -358,6 +578,75 @@ void Connection::send(std::shared_ptr<const Packet> packet)
 }
 
 
+/** Get the id of the connection's name in the \ref Logger.
+ *
+ *  This is used to log packet events without copying the name.
+ *
+ *  \returns The name id of the connection, see \ref Logger::register_name.
+ */
+unsigned int Connection::name_id() const
+{
+    return name_id_;
+}
+
+
+/** Get the most packets that have ever been waiting to be sent.
+ *
+ *  \returns The high-water mark of the connection's queue.
+ */
+std::size_t Connection::queue_high_water() const
+{
+    return queue_->high_water();
+}
+
+
+/** Get the number of packets waiting to be sent.
+ *
+ *  \returns The depth of the connection's queue.
+ */
+std::size_t Connection::queue_size() const
+{
+    return queue_->size();
+}
+
+
+/** Get the traffic counters of the connection.
+ *
+ *  Packets are counted as received (by the \ref ConnectionPool), accepted or
+ *  rejected by the filter, queued, sent (taken from the queue) and dropped
+ *  (duplicates received on the connection and packets discarded by \ref
+ *  clear).
+ *
+ *  \returns The traffic counters of the connection.
+ */
+TrafficCounters &Connection::traffic()
+{
+    return traffic_;
+}
+
+
+/** \copydoc traffic()
+ */
+const TrafficCounters &Connection::traffic() const
+{
+    return traffic_;
+}
+
+
+/** Get the latency histograms of the connection.
+ *
+ *  The latency (from receiving a packet to sending it) and sojourn time (spent
+ *  in the queue) of each packet taken from the queue are recorded, by the
+ *  priority the packet was queued with.
+ *
+ *  \returns The latency histograms of the connection.
+ */
+const LatencyHistograms &Connection::latency() const
+{
+    return latency_;
+}
+
+
 /** Print the connection name to the given output stream.
  *
  *  Some examples are:
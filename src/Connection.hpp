@@ -19,6 +19,8 @@
 #define CONNECTION_HPP_
 
 
+#include <atomic>
+#include <cstddef>
 #include <memory>
 #include <string>
 
@@ -28,6 +30,7 @@
 #include "MAVAddress.hpp"
 #include "Packet.hpp"
 #include "PacketQueue.hpp"
+#include "Stats.hpp"
 
 
 /** Represents a connection that packets can be sent over.
@@ -46,14 +49,24 @@ class Connection
                 std::make_unique<AddressPool<>>(),
             std::unique_ptr<PacketQueue> queue =
                 std::make_unique<PacketQueue>());
-        // LCOV_EXCL_START
-        TEST_VIRTUAL ~Connection() = default;
-        // LCOV_EXCL_STOP
+        TEST_VIRTUAL ~Connection();
         TEST_VIRTUAL void add_address(MAVAddress address);
+        TEST_VIRTUAL unsigned long add_duplicate();
+        TEST_VIRTUAL std::size_t clear();
+        TEST_VIRTUAL unsigned long duplicates() const;
+        TEST_VIRTUAL bool has_addresses();
+        TEST_VIRTUAL bool may_accept(
+            unsigned long id, const MAVAddress &source);
         TEST_VIRTUAL std::shared_ptr<const Packet> next_packet(
             const std::chrono::nanoseconds &timeout =
                 std::chrono::nanoseconds(0));
         TEST_VIRTUAL void send(std::shared_ptr<const Packet> packet);
+        const LatencyHistograms &latency() const;
+        unsigned int name_id() const;
+        std::size_t queue_high_water() const;
+        std::size_t queue_size() const;
+        TrafficCounters &traffic();
+        const TrafficCounters &traffic() const;
 
         friend std::ostream &operator<<(
             std::ostream &os, const Connection &connection);
@@ -65,8 +78,16 @@ class Connection
         std::unique_ptr<AddressPool<>> pool_;
         std::unique_ptr<PacketQueue> queue_;
         bool mirror_;
+        std::atomic<unsigned long> duplicates_;
+        unsigned int name_id_;
+        TrafficCounters traffic_;
+        LatencyHistograms latency_;
         // Methods
-        void log_(bool accept, const Packet &packet);
+        void count_(Traffic traffic, const Packet &packet);
+        void enqueue_(std::shared_ptr<const Packet> packet, int priority);
+        void log_(
+            bool accept, const Packet &packet, int priority,
+            unsigned int rule);
         void send_to_address_(
             std::shared_ptr<const Packet> packet, const MAVAddress &dest);
         void send_to_all_(std::shared_ptr<const Packet> packet);
@@ -20,7 +20,9 @@
 
 
 #include <chrono>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 
 #include "config.hpp"
@@ -38,7 +40,9 @@ class ConnectionFactory
     public:
         ConnectionFactory(std::shared_ptr<Filter> filter, bool mirror = false);
         TEST_VIRTUAL ~ConnectionFactory() = default;
-        TEST_VIRTUAL std::unique_ptr<C> get(std::string name = "unknown");
+        TEST_VIRTUAL std::unique_ptr<C> get(
+            std::string name = "unknown",
+            std::optional<std::function<void(void)>> ready_callback = {});
         TEST_VIRTUAL bool wait_for_packet(
             const std::chrono::nanoseconds &timeout);
 
@@ -81,10 +85,16 @@ ConnectionFactory<C, AP, PQ>::ConnectionFactory(
  *  made by this factory instance.
  *
  *  \param name The name of the new connection.
+ *  \param ready_callback A function to call when a packet is added to the
+ *      connection while it has no other packets waiting to be sent.  This is
+ *      called before the semaphore is notified.  The default is no callback
+ *      {}.
  *  \returns The new connection.
  */
 template <class C, class AP, class PQ>
-std::unique_ptr<C> ConnectionFactory<C, AP, PQ>::get(std::string name)
+std::unique_ptr<C> ConnectionFactory<C, AP, PQ>::get(
+    std::string name,
+    std::optional<std::function<void(void)>> ready_callback)
 {
     return std::make_unique<C>(
                name, filter_, mirror_,
@@ -92,7 +102,7 @@ std::unique_ptr<C> ConnectionFactory<C, AP, PQ>::get(std::string name)
                std::make_unique<PQ>([this]()
     {
         semaphore_.notify();
-    }));
+    }, std::move(ready_callback)));
 }
 
 
@@ -23,11 +23,29 @@
 
 #include "Connection.hpp"
 #include "ConnectionPool.hpp"
+#include "DecisionLog.hpp"
+#include "FlightRecorder.hpp"
 #include "Logger.hpp"
+#include "MAVAddress.hpp"
 #include "Packet.hpp"
+#include "Stats.hpp"
+#include "Tracer.hpp"
+#include "tracepoints.hpp"
 #include "utility.hpp"
 
 
+/** Construct a connection pool.
+ *
+ *  \param deduplicator The duplicate packet detector to check each packet
+ *      with before sending it.  %If nullptr (the default) duplicate packets
+ *      are not suppressed.
+ */
+ConnectionPool::ConnectionPool(std::unique_ptr<Deduplicator<>> deduplicator)
+    : deduplicator_(std::move(deduplicator))
+{
+}
+
+
 /** Add a connection to the pool.
  *
  *  \param connection The connection to add to the pool.
@@ -50,11 +68,47 @@ void ConnectionPool::remove(const std::weak_ptr<Connection> &connection)
 }
 
 
+/** Decide whether any connection may accept a packet, from only its header.
+ *
+ *  Interfaces use this to drop packets that would be rejected by every
+ *  connection before they are fully received, saving the cost of building,
+ *  logging and routing them.
+ *
+ *  \param id The packet ID (message type) of the packet.
+ *  \param source The source address of the packet.
+ *  \retval true %If at least one connection may accept the packet.
+ *  \retval false %If every connection will reject the packet.
+ */
+bool ConnectionPool::may_accept(unsigned long id, const MAVAddress &source)
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+
+    for (const auto &weak : connections_)
+    {
+        if (auto connection = weak.lock())
+        {
+            if (connection->may_accept(id, source))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
 /** Send a packet to every connection.
  *
  *  \note Each connection may decide to ignore the packet based on it's filter
  *      rules.
  *
+ *  The packet is counted as received by the connection it was received on (see
+ *  \ref Connection::traffic) and recorded by the installed \ref
+ *  FlightRecorder.  %If the pool has a duplicate packet detector and
+ *  the packet is a duplicate it is not sent and is counted as a dropped
+ *  duplicate against the connection it was received on.
+ *
  *  \param packet The packet to send to every connection, must not be nullptr.
  *  \throws std::invalid_argument if the \p packet pointer is null.
  */
@@ -65,22 +119,57 @@ void ConnectionPool::send(std::unique_ptr<const Packet> packet)
         throw std::invalid_argument("Given packet pointer is null.");
     }
 
-    if (Logger::level() >= 2)
+    auto connection = packet->connection();
+    Stats::count(Traffic::received, *packet);
+
+    if (TRACEPOINT_ENABLED(packet_parsed))
     {
-        std::stringstream ss;
-        ss << "received " << str(*packet) << " source ";
-        auto connection = packet->connection();
+        TRACEPOINT(
+            packet_parsed, packet->id(), tracepoints::source(*packet),
+            tracepoints::dest(*packet), connection.get(), packet.get(),
+            tracepoints::nanoseconds(packet->timestamp()));
+    }
 
-        if (connection == nullptr)
-        {
-            ss << "unknown";
-        }
-        else
+    if (connection != nullptr)
+    {
+        connection->traffic().count(Traffic::received, packet->data().size());
+    }
+
+    if (auto recorder = FlightRecorder::installed())
+    {
+        recorder->record(
+            DecisionRecord::make(
+                DecisionRecord::RECEIVED, *packet,
+                connection == nullptr ? 0 : connection->name_id()));
+    }
+
+    // Suppress copies of packets received over redundant links.
+    if (deduplicator_ != nullptr && deduplicator_->duplicate(*packet))
+    {
+        Stats::count(Traffic::dropped, *packet);
+
+        if (connection != nullptr)
         {
-            ss << *connection;
+            connection->traffic().count(
+                Traffic::dropped, packet->data().size());
+            auto count = connection->add_duplicate();
+
+            if (Logger::level() >= 2 || Tracer::traced(*packet))
+            {
+                Logger::trace(
+                    LogEvent::duplicate, *packet, connection->name_id(), 0,
+                    count);
+            }
         }
 
-        Logger::log(2, ss.str());
+        return;
+    }
+
+    if (Logger::level() >= 2 || Tracer::traced(*packet))
+    {
+        Logger::trace(
+            LogEvent::received, *packet,
+            connection == nullptr ? 0 : connection->name_id());
     }
 
     std::shared_lock<std::shared_mutex> lock(mutex_);
@@ -89,9 +178,9 @@ void ConnectionPool::send(std::unique_ptr<const Packet> packet)
     for (auto it = connections_.begin(); it != connections_.end();)
     {
         // Send packet on connection.
-        if (auto connection = it->lock())
+        if (auto destination = it->lock())
         {
-            connection->send(shared);
+            destination->send(shared);
             ++it;
         }
         // Remove connection.
@@ -25,28 +25,34 @@
 
 #include "config.hpp"
 #include "Connection.hpp"
+#include "Deduplicator.hpp"
 #include "Packet.hpp"
 
 
 /** A pool of \ref Connection's to send packets out on.
  *
  *  A connection pool stores a reference to all connections that packets can be
- *  sent out over.
+ *  sent out over.  It can optionally suppress duplicate packets, such as those
+ *  received from a vehicle over redundant links.
  */
 class ConnectionPool
 {
     public:
+        ConnectionPool(std::unique_ptr<Deduplicator<>> deduplicator = nullptr);
         // LCOV_EXCL_START
         TEST_VIRTUAL ~ConnectionPool() = default;
         // LCOV_EXCL_STOP
         TEST_VIRTUAL void add(std::weak_ptr<Connection> connection);
         TEST_VIRTUAL void remove(const std::weak_ptr<Connection> &connection);
+        TEST_VIRTUAL bool may_accept(
+            unsigned long id, const MAVAddress &source);
         TEST_VIRTUAL void send(std::unique_ptr<const Packet> packet);
 
     private:
         std::set<std::weak_ptr<Connection>,
             std::owner_less<std::weak_ptr<Connection>>> connections_;
         std::shared_mutex mutex_;
+        std::unique_ptr<Deduplicator<>> deduplicator_;
 };
 
 
@@ -0,0 +1,129 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef COUNTERS_HPP_
+#define COUNTERS_HPP_
+
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+
+/** Number of shards each \ref Counters object is split into.
+ */
+constexpr std::size_t COUNTER_SHARDS = 8;
+
+
+/** Get the shard of \ref Counters used by the calling thread.
+ *
+ *  Threads are assigned to shards round robin, the first time they count.
+ *
+ *  \returns The shard index of the calling thread, less than \ref
+ *      COUNTER_SHARDS.
+ */
+inline std::size_t counter_shard()
+{
+    static std::atomic<std::size_t> next(0);
+    thread_local std::size_t shard =
+        next.fetch_add(1, std::memory_order_relaxed) % COUNTER_SHARDS;
+    return shard;
+}
+
+
+/** A fixed set of counters, sharded by thread.
+ *
+ *  Each thread adds to its own shard of the counters, which is kept on a
+ *  separate cache line from the other shards.  Counting is therefore a single
+ *  uncontended atomic add and reading a counter sums the shards.
+ *
+ *  \remarks
+ *      Threadsafe (lock-free).
+ */
+template <std::size_t N>
+class Counters
+{
+    public:
+        Counters();
+        Counters(const Counters &other) = delete;
+        Counters(Counters &&other) = delete;
+        unsigned long long add(
+            std::size_t counter, unsigned long long value = 1);
+        unsigned long long value(std::size_t counter) const;
+        Counters &operator=(const Counters &other) = delete;
+        Counters &operator=(Counters &&other) = delete;
+
+    private:
+        struct alignas(64) Shard
+        {
+            std::array<std::atomic<unsigned long long>, N> values;
+        };
+        std::array<Shard, COUNTER_SHARDS> shards_;
+};
+
+
+/** Construct a set of counters, all starting at 0.
+ */
+template <std::size_t N>
+Counters<N>::Counters()
+{
+    for (auto &shard : shards_)
+    {
+        for (auto &value : shard.values)
+        {
+            value.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+
+/** Add to one of the counters.
+ *
+ *  \param counter The index of the counter to add to, less than \p N.
+ *  \param value The amount to add to the counter.  The default is 1.
+ *  \returns The new value of the calling thread's shard of the counter.
+ */
+template <std::size_t N>
+unsigned long long Counters<N>::add(
+    std::size_t counter, unsigned long long value)
+{
+    return shards_[counter_shard()].values[counter].fetch_add(
+               value, std::memory_order_relaxed) + value;
+}
+
+
+/** Get the value of one of the counters.
+ *
+ *  \param counter The index of the counter to read, less than \p N.
+ *  \returns The sum of the counter over all threads.
+ */
+template <std::size_t N>
+unsigned long long Counters<N>::value(std::size_t counter) const
+{
+    unsigned long long sum = 0;
+
+    for (const auto &shard : shards_)
+    {
+        sum += shard.values[counter].load(std::memory_order_relaxed);
+    }
+
+    return sum;
+}
+
+
+#endif // COUNTERS_HPP_
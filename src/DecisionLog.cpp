@@ -0,0 +1,507 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "DecisionLog.hpp"
+#include "Logger.hpp"
+#include "MAVAddress.hpp"
+#include "mavlink.hpp"
+#include "Packet.hpp"
+#include "UnixSyscalls.hpp"
+#include "utility.hpp"
+
+
+namespace
+{
+
+    const char MAGIC[8] = {'M', 'A', 'V', 'T', 'D', 'L', 'O', 'G'};
+
+}
+
+
+/** Make a record of a packet.
+ *
+ *  The record is timestamped with the current time.
+ *
+ *  \param action The action taken with the packet.
+ *  \param packet The packet to make a record of.
+ *  \param from Name id of the connection the packet was received on, 0 if
+ *      unknown.
+ *  \param to Name id of the connection the decision was made for, 0 for
+ *      received packets.
+ *  \param priority The priority the packet was accepted with, clamped to 16
+ *      bits.
+ *  \param rule Index of the rule that decided, 0 for the default action.
+ *  \returns The record of the packet.
+ */
+DecisionRecord DecisionRecord::make(
+    Action action, const Packet &packet, uint32_t from, uint32_t to,
+    int priority, uint32_t rule)
+{
+    DecisionRecord record;
+    record.time = static_cast<uint64_t>(
+                      std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::system_clock::now()
+                          .time_since_epoch()).count());
+    record.id = static_cast<uint32_t>(packet.id());
+    record.source = static_cast<uint16_t>(packet.source().address());
+    auto dest = packet.dest();
+    record.dest = static_cast<uint16_t>(dest ? dest->address() : 0);
+    record.from = from;
+    record.to = to;
+    record.rule = rule;
+    record.priority = static_cast<int16_t>(
+                          std::clamp(priority, -32768, 32767));
+    record.action = action;
+    record.flags = dest ? HAS_DEST : 0;
+    return record;
+}
+
+
+/** Create a decision log.
+ *
+ *  The log file is created (replacing any existing file) and mapped into
+ *  memory.
+ *
+ *  \param path The path of the log file.  Rotated files have .1, .2, etc.
+ *      appended to this path.
+ *  \param records The number of records each file holds before it is rotated.
+ *      The default is 1048576 (32 MiB).
+ *  \param files The number of files to keep, including the current one.  The
+ *      default is 4.
+ *  \param syscalls The object to use for unix system calls.  It is default
+ *      constructed to the production implementation.  This argument is only
+ *      used for testing.
+ *  \throws std::invalid_argument if \p records or \p files is 0.
+ *  \throws std::system_error if the file can not be created or mapped.
+ */
+DecisionLog::DecisionLog(
+    std::string path, std::size_t records, unsigned int files,
+    std::unique_ptr<UnixSyscalls> syscalls)
+    : path_(std::move(path)), records_(records), files_(files),
+      syscalls_(std::move(syscalls)), fd_(-1), data_(nullptr), next_(0)
+{
+    if (records_ == 0)
+    {
+        throw std::invalid_argument(
+            "Decision log files must hold at least 1 record.");
+    }
+
+    if (files_ == 0)
+    {
+        throw std::invalid_argument(
+            "Decision log must keep at least 1 file.");
+    }
+
+    open_();
+}
+
+
+/** Write the connection names and close the log file.
+ */
+// LCOV_EXCL_START
+DecisionLog::~DecisionLog()
+{
+    if (installed() == this)
+    {
+        install(nullptr);
+    }
+
+    close_();
+}
+// LCOV_EXCL_STOP
+
+
+/** Write the connection names, unmap and close the log file.
+ *
+ *  The unused records at the end of the file are removed.
+ */
+void DecisionLog::close_()
+{
+    auto data = data_.exchange(nullptr);
+
+    if (data == nullptr)
+    {
+        return;
+    }
+
+    // Wait for writers that loaded the mapping before it was removed.
+    for (const auto &writers : writers_)
+    {
+        while (writers.count.load() != 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    write_header(data, records_);
+    auto used = std::min(next_.load(std::memory_order_relaxed), records_);
+    syscalls_->munmap(data, HEADER_SIZE + records_ * sizeof(DecisionRecord));
+    syscalls_->ftruncate(
+        fd_, static_cast<off_t>(HEADER_SIZE + used * sizeof(DecisionRecord)));
+    syscalls_->close(fd_);
+    fd_ = -1;
+}
+
+
+/** Create and map a new log file, replacing any existing file.
+ *
+ *  \throws std::system_error if the file can not be created or mapped.
+ */
+void DecisionLog::open_()
+{
+    int fd = syscalls_->creat(path_.c_str(), 0640);
+
+    if (fd < 0)
+    {
+        throw std::system_error(std::error_code(errno, std::system_category()));
+    }
+
+    // The file must be opened for reading and writing to map it.
+    syscalls_->close(fd);
+    fd_ = syscalls_->open(path_.c_str(), O_RDWR);
+
+    if (fd_ < 0)
+    {
+        throw std::system_error(std::error_code(errno, std::system_category()));
+    }
+
+    auto size = HEADER_SIZE + records_ * sizeof(DecisionRecord);
+
+    if (syscalls_->ftruncate(fd_, static_cast<off_t>(size)) < 0)
+    {
+        auto error = errno;
+        syscalls_->close(fd_);
+        fd_ = -1;
+        throw std::system_error(std::error_code(error, std::system_category()));
+    }
+
+    auto data = syscalls_->mmap(
+                    nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+
+    if (data == MAP_FAILED)
+    {
+        auto error = errno;
+        syscalls_->close(fd_);
+        fd_ = -1;
+        throw std::system_error(std::error_code(error, std::system_category()));
+    }
+
+    write_header(data, records_);
+    next_.store(0, std::memory_order_relaxed);
+    // Publish the mapping only once it is ready for writers.
+    data_.store(data);
+}
+
+
+/** Close the full log file, shift the previous files and open a new one.
+ *
+ *  %If the new file can not be opened decisions are no longer recorded.
+ */
+void DecisionLog::rotate_()
+{
+    close_();
+
+    for (auto i = files_ - 1; i > 0; --i)
+    {
+        auto from = i == 1 ? path_ : path_ + "." + std::to_string(i - 1);
+        auto to = path_ + "." + std::to_string(i);
+        syscalls_->rename(from.c_str(), to.c_str());
+    }
+
+    try
+    {
+        open_();
+    }
+    catch (const std::system_error &e)
+    {
+        Logger::log(
+            "decision log " + path_ + " disabled: " + std::string(e.what()));
+    }
+}
+
+
+/** Write the header, including the connection names table, of a log file.
+ *
+ *  Names that do not fit in the header are left out.
+ *
+ *  \param data The start of the file, at least \ref HEADER_SIZE bytes.
+ *  \param records The number of records the file holds.
+ */
+void DecisionLog::write_header(void *data, std::size_t records)
+{
+    auto header = static_cast<DecisionLogHeader *>(data);
+    std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+    header->version = 1;
+    header->record_size = sizeof(DecisionRecord);
+    header->records = records;
+    header->reserved = 0;
+    auto table = static_cast<char *>(data) + sizeof(DecisionLogHeader);
+    auto capacity = HEADER_SIZE - sizeof(DecisionLogHeader);
+    std::size_t size = 0;
+
+    for (const auto &name : Logger::names())
+    {
+        if (size + name.size() + 1 > capacity)
+        {
+            break;
+        }
+
+        std::memcpy(table + size, name.c_str(), name.size() + 1);
+        size += name.size() + 1;
+    }
+
+    header->names_size = static_cast<uint32_t>(size);
+}
+
+
+/** Record a decision.
+ *
+ *  The file is rotated when it is full.
+ *
+ *  \param record The decision to record.
+ *  \remarks
+ *      Threadsafe (lock-free unless the file must be rotated).
+ */
+void DecisionLog::record(const DecisionRecord &record)
+{
+    auto &writers = writers_[counter_shard()].count;
+
+    while (true)
+    {
+        // Rotating waits for writers that see the old mapping, so the count
+        // must be raised before loading it.
+        writers.fetch_add(1);
+        auto data = data_.load();
+
+        if (data != nullptr)
+        {
+            auto index = next_.fetch_add(1, std::memory_order_relaxed);
+
+            if (index < records_)
+            {
+                auto slot = reinterpret_cast<DecisionRecord *>(
+                                static_cast<char *>(data) + HEADER_SIZE) +
+                            index;
+                std::memcpy(slot, &record, offsetof(DecisionRecord, action));
+                slot->flags = record.flags;
+                // Mark the record as used only after it is complete.
+                std::atomic_thread_fence(std::memory_order_release);
+                slot->action = record.action;
+                writers.fetch_sub(1);
+                return;
+            }
+        }
+
+        writers.fetch_sub(1);
+        // The file is full, being rotated or could not be opened.
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (data_.load() == nullptr)
+        {
+            return;
+        }
+
+        if (next_.load(std::memory_order_relaxed) >= records_)
+        {
+            rotate_();
+        }
+    }
+}
+
+
+/** Set the decision log used by all connections.
+ *
+ *  \param log The decision log to use, or nullptr to stop recording
+ *      decisions.  The log is not owned and must outlive its installation.
+ *  \remarks
+ *      Threadsafe (lock-free).
+ */
+void DecisionLog::install(DecisionLog *log)
+{
+    installed_.store(log, std::memory_order_release);
+}
+
+
+/** Get the decision log used by all connections.
+ *
+ *  \returns The installed decision log, or nullptr if decisions are not being
+ *      recorded.
+ *  \remarks
+ *      Threadsafe (lock-free).
+ */
+DecisionLog *DecisionLog::installed()
+{
+    return installed_.load(std::memory_order_acquire);
+}
+
+
+/** Convert a decision log file to text or CSV.
+ *
+ *  An example of the text format is:
+ *
+ *  ```
+ *  2018-06-01 12:00:00.000125  accept PING (#4) from 192.168 to 127.1 source
+ *  127.0.0.1:14500 dest /dev/ttyUSB0 priority 0 rule 12
+ *  ```
+ *
+ *  The CSV format has the columns given by \ref CSV_HEADER, the header line
+ *  itself is not written.  A rule of 0 is the default action.  Received
+ *  packets, from a \ref FlightRecorder dump, have the action "receive" and
+ *  only a source connection.
+ *
+ *  \param is The decision log file to read.
+ *  \param os The output stream to write to.
+ *  \param csv Set to true to write CSV instead of text.
+ *  \throws std::invalid_argument if \p is is not a decision log file or has an
+ *      unsupported version.
+ */
+void DecisionLog::dump(std::istream &is, std::ostream &os, bool csv)
+{
+    DecisionLogHeader header;
+
+    if (!is.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+            std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        throw std::invalid_argument("Not a mavtables decision log.");
+    }
+
+    if (header.version != 1 || header.record_size != sizeof(DecisionRecord))
+    {
+        throw std::invalid_argument(
+            "Unsupported decision log version (" +
+            std::to_string(header.version) + ").");
+    }
+
+    // Read the connection names table.
+    std::vector<char> table(
+        std::min<std::size_t>(
+            header.names_size, HEADER_SIZE - sizeof(DecisionLogHeader)));
+    is.read(table.data(), static_cast<std::streamsize>(table.size()));
+    std::vector<std::string> names;
+
+    for (auto it = table.begin(); it != table.end();)
+    {
+        auto end = std::find(it, table.end(), '\0');
+        names.emplace_back(it, end);
+        it = end == table.end() ? end : end + 1;
+    }
+
+    auto name = [&](uint32_t id)
+    {
+        if (id == 0)
+        {
+            return std::string("unknown");
+        }
+
+        return id < names.size() ? names[id] : "#" + std::to_string(id);
+    };
+
+    is.seekg(static_cast<std::streamoff>(HEADER_SIZE));
+
+    DecisionRecord record;
+
+    while (is.read(reinterpret_cast<char *>(&record), sizeof(record)))
+    {
+        if (record.action == DecisionRecord::EMPTY)
+        {
+            continue;
+        }
+
+        auto seconds = static_cast<std::time_t>(record.time / 1000000000);
+        auto tm = *std::localtime(&seconds);
+        auto info = mavlink_get_message_info_by_id(record.id);
+        std::string action =
+            record.action == DecisionRecord::ACCEPT ? "accept" :
+            record.action == DecisionRecord::REJECT ? "reject" : "receive";
+        std::string dest;
+
+        if (record.flags & DecisionRecord::HAS_DEST)
+        {
+            dest = str(MAVAddress(record.dest));
+        }
+
+        os << std::put_time(&tm, "%Y-%m-%d %H:%M:%S") << "."
+           << std::setfill('0') << std::setw(6)
+           << (record.time % 1000000000) / 1000 << std::setfill(' ');
+
+        if (csv)
+        {
+            os << "," << action << "," << record.id << ","
+               << (info != nullptr ? info->name : "UNKNOWN") << ","
+               << MAVAddress(record.source) << "," << dest << ","
+               << name(record.from) << "," << name(record.to) << ","
+               << record.priority << "," << record.rule << "\n";
+        }
+        else
+        {
+            os << "  " << action << " "
+               << (info != nullptr ? info->name : "UNKNOWN")
+               << " (#" << record.id << ") from " << MAVAddress(record.source);
+
+            if (!dest.empty())
+            {
+                os << " to " << dest;
+            }
+
+            os << " source " << name(record.from);
+
+            if (record.action == DecisionRecord::RECEIVED)
+            {
+                os << "\n";
+                continue;
+            }
+
+            os << " dest " << name(record.to)
+               << " priority " << record.priority << " rule ";
+
+            if (record.rule == 0)
+            {
+                os << "default";
+            }
+            else
+            {
+                os << record.rule;
+            }
+
+            os << "\n";
+        }
+    }
+}
+
+
+std::atomic<DecisionLog *> DecisionLog::installed_(nullptr);
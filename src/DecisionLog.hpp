@@ -0,0 +1,192 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef DECISIONLOG_HPP_
+#define DECISIONLOG_HPP_
+
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+#include "config.hpp"
+#include "Counters.hpp"
+#include "UnixSyscalls.hpp"
+
+
+class Packet;
+
+
+/** A packet filter decision, as stored in a \ref DecisionLog file.
+ *
+ *  Records have a fixed size of 32 bytes and are stored in host byte order.
+ *  They are also used by the \ref FlightRecorder, which additionally records
+ *  received packets.
+ */
+struct DecisionRecord
+{
+    /** Action taken with the packet.
+     */
+    enum Action : uint8_t
+    {
+        EMPTY = 0,  //!< Unused record.
+        ACCEPT = 1, //!< The packet was accepted.
+        REJECT = 2, //!< The packet was rejected.
+        RECEIVED = 3    //!< The packet was received (flight recorder only).
+    };
+    /** Flag set when the packet has a destination address.
+     */
+    static constexpr uint8_t HAS_DEST = 0x01;
+    /** Time of the decision, in nanoseconds since the Unix epoch.
+     */
+    uint64_t time;
+    /** Numeric MAVLink ID of the packet.
+     */
+    uint32_t id;
+    /** Source MAVLink address of the packet.
+     */
+    uint16_t source;
+    /** Destination MAVLink address of the packet, if it has one.
+     */
+    uint16_t dest;
+    /** Name id of the connection the packet was received on, 0 if unknown.
+     */
+    uint32_t from;
+    /** Name id of the connection the decision was made for.
+     */
+    uint32_t to;
+    /** Index (configuration line) of the rule that decided, 0 for the default
+     *  action.
+     */
+    uint32_t rule;
+    /** Priority the packet was accepted with.
+     */
+    int16_t priority;
+    /** Action taken with the packet, this is written last.
+     */
+    Action action;
+    /** Packet flags, see \ref HAS_DEST.
+     */
+    uint8_t flags;
+    static DecisionRecord make(
+        Action action, const Packet &packet, uint32_t from, uint32_t to = 0,
+        int priority = 0, uint32_t rule = 0);
+};
+
+
+/** Header at the start of every \ref DecisionLog file.
+ *
+ *  The header is followed by the connection names table and then the
+ *  records, starting at DecisionLog::HEADER_SIZE bytes from the start of the
+ *  file.
+ */
+struct DecisionLogHeader
+{
+    /** File magic, "MAVTDLOG".
+     */
+    char magic[8];
+    /** Version of the file format, currently 1.
+     */
+    uint32_t version;
+    /** Size of each record in bytes.
+     */
+    uint32_t record_size;
+    /** Number of records the file can hold.
+     */
+    uint64_t records;
+    /** Size of the connection names table in bytes.  The table holds null
+     *  terminated names in the order of their ids.
+     */
+    uint32_t names_size;
+    /** Reserved, always 0.
+     */
+    uint32_t reserved;
+};
+
+
+/** An append only, memory mapped log of packet filter decisions.
+ *
+ *  Decisions are written as fixed size \ref DecisionRecord's into a memory
+ *  mapped file, so recording a decision is a copy into memory.  When the file
+ *  is full it is rotated, the previous files are renamed with the suffixes .1,
+ *  .2, etc. and the oldest is removed.  The mavtables-logdump tool converts
+ *  the files to text or CSV.
+ *
+ *  Connections are identified by the ids from \ref Logger::register_name, the
+ *  names are written into each file when it is opened and again when it is
+ *  closed.
+ */
+class DecisionLog
+{
+    public:
+        /** Size of the file header and names table in bytes.
+         */
+        static constexpr std::size_t HEADER_SIZE = 65536;
+        /** Header line of the CSV format written by \ref dump.
+         */
+        static constexpr char CSV_HEADER[] =
+            "time,action,id,name,source,dest,from,to,priority,rule";
+        DecisionLog(
+            std::string path, std::size_t records = 1048576,
+            unsigned int files = 4,
+            std::unique_ptr<UnixSyscalls> syscalls =
+                std::make_unique<UnixSyscalls>());
+        DecisionLog(const DecisionLog &other) = delete;
+        DecisionLog(DecisionLog &&other) = delete;
+        TEST_VIRTUAL ~DecisionLog();
+        TEST_VIRTUAL void record(const DecisionRecord &record);
+        DecisionLog &operator=(const DecisionLog &other) = delete;
+        DecisionLog &operator=(DecisionLog &&other) = delete;
+        static void install(DecisionLog *log);
+        static DecisionLog *installed();
+        static void dump(std::istream &is, std::ostream &os, bool csv = false);
+        static void write_header(void *data, std::size_t records);
+
+    private:
+        // Types
+        /** Number of threads writing to the mapped file, sharded by thread.
+         */
+        struct alignas(64) Writers
+        {
+            std::atomic<unsigned int> count{0};
+        };
+        // Variables
+        std::string path_;
+        std::size_t records_;
+        unsigned int files_;
+        std::unique_ptr<UnixSyscalls> syscalls_;
+        int fd_;
+        std::atomic<void *> data_;
+        std::atomic<std::size_t> next_;
+        std::array<Writers, COUNTER_SHARDS> writers_;
+        std::mutex mutex_;
+        static std::atomic<DecisionLog *> installed_;
+        // Methods
+        void close_();
+        void open_();
+        void rotate_();
+};
+
+
+#endif // DECISIONLOG_HPP_
@@ -0,0 +1,193 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef DEDUPLICATOR_HPP_
+#define DEDUPLICATOR_HPP_
+
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "config.hpp"
+#include "MAVAddress.hpp"
+#include "Packet.hpp"
+
+
+/** A lock-free detector of duplicate packets.
+ *
+ *  When a vehicle is reachable over redundant links every packet it sends is
+ *  received more than once.  A packet is a duplicate of another if it has the
+ *  same source address, sequence number, message ID and checksum and was
+ *  received within a short window of it.
+ *
+ *  Each source address has its own window, holding the last packet seen with
+ *  each sequence number.  Windows are allocated the first time a source is
+ *  seen and only use atomic operations, so any number of interfaces can check
+ *  packets at the same time.
+ */
+template <class TC = std::chrono::steady_clock>
+class Deduplicator
+{
+    public:
+        Deduplicator(std::chrono::milliseconds window =
+                         std::chrono::milliseconds(500));
+        Deduplicator(const Deduplicator &other) = delete;
+        Deduplicator(Deduplicator &&other) = delete;
+        TEST_VIRTUAL ~Deduplicator();
+        TEST_VIRTUAL bool duplicate(const Packet &packet);
+        Deduplicator &operator=(const Deduplicator &other) = delete;
+        Deduplicator &operator=(Deduplicator &&other) = delete;
+
+    private:
+        // Types
+        /** Last packet seen with each sequence number from a source.
+         *
+         *  Each entry packs the message ID (bits 0 to 23), the checksum (bits
+         *  24 to 39) and the receive time in milliseconds (bits 40 to 62).
+         *  Bit 63 is set once the entry has been used.
+         */
+        using Window = std::array<std::atomic<uint64_t>, 256>;
+        // Constants
+        static const uint64_t USED = uint64_t(1) << 63;
+        static const uint64_t KEY_MASK = (uint64_t(1) << 40) - 1;
+        static const uint64_t TIME_MASK = (uint64_t(1) << 23) - 1;
+        static const std::size_t NUM_SOURCES = 65536;
+        // Variables
+        std::chrono::milliseconds window_;
+        std::unique_ptr<std::atomic<Window *>[]> windows_;
+        // Methods
+        Window &source_window_(const MAVAddress &source);
+};
+
+
+/** Construct a duplicate packet detector.
+ *
+ *  \param window The amount of time (in milliseconds) after a packet is
+ *      received that a copy of it is considered a duplicate.
+ *  \throws std::invalid_argument if the \p window is not between 1 and
+ *      1000000 milliseconds.
+ */
+template <class TC>
+Deduplicator<TC>::Deduplicator(std::chrono::milliseconds window)
+    : window_(std::move(window)),
+      windows_(new std::atomic<Window *>[NUM_SOURCES]())
+{
+    if (window_.count() < 1 || window_.count() > 1000000)
+    {
+        throw std::invalid_argument(
+            "Deduplication window (" + std::to_string(window_.count()) +
+            " ms) must be between 1 and 1000000 ms.");
+    }
+}
+
+
+/** Destroy the duplicate packet detector, freeing the window of each source.
+ */
+template <class TC>
+Deduplicator<TC>::~Deduplicator()
+{
+    for (std::size_t i = 0; i < NUM_SOURCES; ++i)
+    {
+        delete windows_[i].load();
+    }
+}
+
+
+/** Determine whether a packet is a duplicate of a recently seen packet.
+ *
+ *  The first copy of a packet is recorded and is not a duplicate.  Further
+ *  copies received within the window (measured from the first copy) are
+ *  duplicates.
+ *
+ *  \param packet The packet to check.
+ *  \retval true %If \p packet is a copy of a packet seen within the window.
+ *  \retval false %If \p packet has not been seen within the window.
+ *  \remarks
+ *      Threadsafe (lock-free).
+ */
+template <class TC>
+bool Deduplicator<TC>::duplicate(const Packet &packet)
+{
+    auto &slot = source_window_(packet.source())[packet.sequence() & 0xFF];
+    const uint64_t key =
+        (packet.id() & 0xFFFFFF) | (uint64_t(packet.checksum()) << 24);
+    const uint64_t now = static_cast<uint64_t>(
+                             std::chrono::duration_cast<
+                             std::chrono::milliseconds>(
+                                 TC::now().time_since_epoch()).count()) &
+                         TIME_MASK;
+    const uint64_t entry = USED | (now << 40) | key;
+    auto current = slot.load(std::memory_order_acquire);
+
+    do
+    {
+        if ((current & USED) && (current & KEY_MASK) == key)
+        {
+            // Time since the first copy, allowing for the clock wrapping.
+            auto age = (now - ((current >> 40) & TIME_MASK)) & TIME_MASK;
+
+            if (age < static_cast<uint64_t>(window_.count()))
+            {
+                return true;
+            }
+        }
+    }
+    while (!slot.compare_exchange_weak(
+                current, entry,
+                std::memory_order_acq_rel, std::memory_order_acquire));
+
+    return false;
+}
+
+
+/** Get the window of a source address, allocating it if needed.
+ *
+ *  \param source The source address to get the window of.
+ *  \returns The window of the given \p source address.
+ */
+template <class TC>
+typename Deduplicator<TC>::Window &Deduplicator<TC>::source_window_(
+    const MAVAddress &source)
+{
+    auto &pointer = windows_[source.address()];
+    auto window = pointer.load(std::memory_order_acquire);
+
+    if (window == nullptr)
+    {
+        auto created = std::make_unique<Window>();
+
+        // Another thread may have allocated the window first.
+        if (pointer.compare_exchange_strong(
+                    window, created.get(),
+                    std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            window = created.release();
+        }
+    }
+
+    return *window;
+}
+
+
+#endif // DEDUPLICATOR_HPP_
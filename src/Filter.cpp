@@ -16,6 +16,8 @@
 
 
 #include <memory>
+#include <optional>
+#include <tuple>
 #include <utility>
 
 #include "Action.hpp"
@@ -23,6 +25,7 @@
 #include "Filter.hpp"
 #include "MAVAddress.hpp"
 #include "Packet.hpp"
+#include "Stats.hpp"
 
 
 /** Construct a new packet filter.
@@ -37,6 +40,41 @@ Filter::Filter(Chain default_chain, bool accept_by_default)
     : default_chain_(std::move(default_chain)),
       accept_by_default_(accept_by_default)
 {
+    Stats::add(*this);
+}
+
+
+/** Copy constructor.
+ *
+ *  \param other Filter to copy from.
+ */
+Filter::Filter(const Filter &other)
+    : default_chain_(other.default_chain_),
+      accept_by_default_(other.accept_by_default_)
+{
+    Stats::add(*this);
+}
+
+
+/** Move constructor.
+ *
+ *  \param other Filter to move from.
+ */
+Filter::Filter(Filter &&other)
+    : default_chain_(std::move(other.default_chain_)),
+      accept_by_default_(other.accept_by_default_)
+{
+    Stats::add(*this);
+}
+
+
+/** Filter destructor.
+ *
+ *  Unregisters the filter from the \ref Stats.
+ */
+Filter::~Filter()
+{
+    Stats::remove(*this);
 }
 
 
@@ -45,12 +83,13 @@ Filter::Filter(Chain default_chain, bool accept_by_default)
  *  \param packet The packet to determine whether to allow or not.
  *  \param address The address the \p packet will be sent out on if the
  *      action allows it.
- *  \returns A pair (tuple) with the first value being whether to accept the
- *      packet or not and the second being the priority to use when sending the
- *      packet.  The second value is only defined if the first value is true
- *      (accept).
+ *  \returns A tuple with the first value being whether to accept the packet
+ *      or not, the second being the priority to use when sending the packet
+ *      and the third being the rule that decided, see \ref Action::rule.  The
+ *      second value is only defined if the first value is true (accept).  The
+ *      third value is 0 if no rule decided the packet.
  */
-std::pair<bool, int> Filter::will_accept(
+std::tuple<bool, int, unsigned int> Filter::will_accept(
     const Packet &packet, const MAVAddress &address)
 {
     Action result = default_chain_.action(packet, address);
@@ -58,9 +97,9 @@ std::pair<bool, int> Filter::will_accept(
     switch (result.action())
     {
         case Action::ACCEPT:
-            return {true, result.priority()};
+            return {true, result.priority(), result.rule()};
         case Action::REJECT:
-            return {false, 0};
+            return {false, 0, result.rule()};
         case Action::CONTINUE:
             break;
 
@@ -68,7 +107,36 @@ std::pair<bool, int> Filter::will_accept(
             break;
     }
 
-    return {accept_by_default_, 0};
+    return {accept_by_default_, 0, result.rule()};
+}
+
+
+/** Decide whether a packet may be accepted, from only its header.
+ *
+ *  This is a conservative version of \ref will_accept for use before the
+ *  packet has been fully received and its destination is known.  It only
+ *  returns false if the packet would be rejected for every possible
+ *  destination address, so the packet can be dropped early.
+ *
+ *  \param id The packet ID (message type) of the packet.
+ *  \param source The source address of the packet.
+ *  \retval true %If the packet may be accepted for some destination.
+ *  \retval false %If the packet will be rejected for every destination.
+ */
+bool Filter::may_accept(unsigned long id, const MAVAddress &source)
+{
+    return default_chain_.may_accept(id, source, accept_by_default_)
+           .value_or(accept_by_default_);
+}
+
+
+/** Get the chain that all filtering begins with.
+ *
+ *  \returns The default chain.
+ */
+const Chain &Filter::default_chain() const
+{
+    return default_chain_;
 }
 
 
@@ -20,6 +20,7 @@
 
 
 #include <memory>
+#include <tuple>
 #include <utility>
 
 #include "Action.hpp"
@@ -30,6 +31,9 @@
 
 
 /** The filter used to determine whether to accept or reject a packet.
+ *
+ *  Filters are registered with \ref Stats while they exist, so the counters
+ *  of their chains and rules are included in the statistics.
  *
  *  \sa Chain
  *  \sa Rule
@@ -38,22 +42,15 @@
 class Filter
 {
     public:
-        /** Copy constructor.
-         *
-         *  \param other Filter to copy from.
-         */
-        Filter(const Filter &other) = default;
-        /** Move constructor.
-         *
-         *  \param other Filter to move from.
-         */
-        Filter(Filter &&other) = default;
+        Filter(const Filter &other);
+        Filter(Filter &&other);
         Filter(Chain default_chain, bool accept_by_default = false);
-        // LCOV_EXCL_START
-        TEST_VIRTUAL ~Filter() = default;
-        // LCOV_EXCL_STOP
-        TEST_VIRTUAL std::pair<bool, int> will_accept(
+        TEST_VIRTUAL ~Filter();
+        TEST_VIRTUAL std::tuple<bool, int, unsigned int> will_accept(
             const Packet &packet, const MAVAddress &address);
+        TEST_VIRTUAL bool may_accept(
+            unsigned long id, const MAVAddress &source);
+        const Chain &default_chain() const;
         /** Assignment operator.
          *
          * \param other Filter to copy from.
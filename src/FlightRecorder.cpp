@@ -0,0 +1,226 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "DecisionLog.hpp"
+#include "FlightRecorder.hpp"
+#include "Logger.hpp"
+
+
+static_assert(sizeof(DecisionRecord) % 8 == 0,
+              "DecisionRecord must be a whole number of 64 bit words.");
+
+
+/** Create a flight recorder.
+ *
+ *  \param path The path of the file to dump the recorder to, it is replaced
+ *      on every dump.  The default is /tmp/mavtables.flight.
+ *  \param records The number of records to hold, the memory used is 40 bytes
+ *      per record.  This must be a power of 2.  The default is 65536
+ *      (2.5 MiB).
+ *  \throws std::invalid_argument if \p records is not a power of 2.
+ */
+FlightRecorder::FlightRecorder(std::string path, std::size_t records)
+    : path_(std::move(path)), slots_(records), mask_(records - 1), next_(0)
+{
+    if (records == 0 || (records & (records - 1)) != 0)
+    {
+        throw std::invalid_argument(
+            "Flight recorder size (" + std::to_string(records) +
+            ") is not a power of 2.");
+    }
+}
+
+
+/** Uninstall the flight recorder, if it is installed.
+ */
+// LCOV_EXCL_START
+FlightRecorder::~FlightRecorder()
+{
+    if (installed() == this)
+    {
+        install(nullptr);
+    }
+}
+// LCOV_EXCL_STOP
+
+
+/** Record a packet or decision, overwriting the oldest record.
+ *
+ *  \param record The packet or decision to record.
+ *  \remarks
+ *      Threadsafe (lock-free, unless the ring wraps around during a write).
+ */
+void FlightRecorder::record(const DecisionRecord &record)
+{
+    auto &slot = slots_[next_.fetch_add(1, std::memory_order_relaxed) & mask_];
+    uint64_t data[sizeof(DecisionRecord) / 8];
+    std::memcpy(data, &record, sizeof(record));
+    // Make the sequence number odd while the record is overwritten.  It is
+    // only already odd if the ring wrapped around during another write.
+    auto sequence = slot.sequence.load(std::memory_order_relaxed);
+    sequence &= ~std::size_t{1};
+
+    while (!slot.sequence.compare_exchange_weak(
+                sequence, sequence + 1, std::memory_order_acquire,
+                std::memory_order_relaxed))
+    {
+        sequence &= ~std::size_t{1};
+    }
+
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (std::size_t i = 0; i < std::size(data); ++i)
+    {
+        slot.data[i].store(data[i], std::memory_order_relaxed);
+    }
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+
+/** Dump the records to the file given on construction.
+ *
+ *  The file is replaced.
+ *
+ *  \throws std::system_error if the file can not be written.
+ *  \remarks
+ *      Threadsafe (locking).
+ */
+void FlightRecorder::dump()
+{
+    std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+
+    if (!file)
+    {
+        throw std::system_error(std::error_code(errno, std::system_category()));
+    }
+
+    dump(file);
+    file.flush();
+
+    if (!file)
+    {
+        throw std::system_error(std::error_code(errno, std::system_category()));
+    }
+}
+
+
+/** Dump the records, oldest first, in the \ref DecisionLog file format.
+ *
+ *  Records being written while they are dumped are left out.
+ *
+ *  \param os The output stream to dump the records to.
+ *  \remarks
+ *      Threadsafe (locking).
+ */
+void FlightRecorder::dump(std::ostream &os)
+{
+    std::lock_guard<std::mutex> lock(dump_mutex_);
+    auto next = next_.load(std::memory_order_relaxed);
+    auto count = std::min(next, slots_.size());
+    std::vector<DecisionRecord> records;
+    records.reserve(count);
+
+    for (auto i = next - count; i < next; ++i)
+    {
+        auto &slot = slots_[i & mask_];
+        uint64_t data[sizeof(DecisionRecord) / 8];
+        auto sequence = slot.sequence.load(std::memory_order_acquire);
+
+        for (std::size_t j = 0; j < std::size(data); ++j)
+        {
+            data[j] = slot.data[j].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // Skip records that were never written or changed while copied.
+        if (sequence == 0 || (sequence & 1) != 0 ||
+                slot.sequence.load(std::memory_order_relaxed) != sequence)
+        {
+            continue;
+        }
+
+        records.emplace_back();
+        std::memcpy(&records.back(), data, sizeof(data));
+    }
+
+    std::vector<char> header(DecisionLog::HEADER_SIZE, '\0');
+    DecisionLog::write_header(header.data(), records.size());
+    os.write(header.data(), static_cast<std::streamsize>(header.size()));
+    os.write(
+        reinterpret_cast<const char *>(records.data()),
+        static_cast<std::streamsize>(
+            records.size() * sizeof(DecisionRecord)));
+}
+
+
+/** Get the path of the file the recorder is dumped to.
+ *
+ *  \returns The path given on construction.
+ */
+const std::string &FlightRecorder::path() const
+{
+    return path_;
+}
+
+
+/** Set the flight recorder used by all connections.
+ *
+ *  \param recorder The flight recorder to use, or nullptr to stop recording.
+ *      The recorder is not owned and must outlive its installation.
+ *  \remarks
+ *      Threadsafe (lock-free).
+ */
+void FlightRecorder::install(FlightRecorder *recorder)
+{
+    installed_.store(recorder, std::memory_order_release);
+}
+
+
+/** Get the flight recorder used by all connections.
+ *
+ *  \returns The installed flight recorder, or nullptr if packets are not being
+ *      recorded.
+ *  \remarks
+ *      Threadsafe (lock-free).
+ */
+FlightRecorder *FlightRecorder::installed()
+{
+    return installed_.load(std::memory_order_acquire);
+}
+
+
+std::atomic<FlightRecorder *> FlightRecorder::installed_(nullptr);
@@ -0,0 +1,85 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+
+#ifndef FLIGHTRECORDER_HPP_
+#define FLIGHTRECORDER_HPP_
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "config.hpp"
+#include "DecisionLog.hpp"
+
+
+/** An in memory ring of the most recent packets and filter decisions.
+ *
+ *  The recorder is always on and holds a fixed number of \ref DecisionRecord's
+ *  (40 bytes each), overwriting the oldest.  Recording is a copy into memory,
+ *  so the recorder can be left running where the \ref Logger or a \ref
+ *  DecisionLog would be too costly.  The ring is only written out (in the \ref
+ *  DecisionLog file format, readable with mavtables-logdump) when \ref dump is
+ *  called, on SIGUSR1 or when an interface fails.
+ */
+class FlightRecorder
+{
+    public:
+        /** The default path to dump the recorder to.
+         */
+        static constexpr char DEFAULT_PATH[] = "/tmp/mavtables.flight";
+        FlightRecorder(
+            std::string path = DEFAULT_PATH, std::size_t records = 65536);
+        FlightRecorder(const FlightRecorder &other) = delete;
+        FlightRecorder(FlightRecorder &&other) = delete;
+        TEST_VIRTUAL ~FlightRecorder();
+        TEST_VIRTUAL void record(const DecisionRecord &record);
+        TEST_VIRTUAL void dump();
+        void dump(std::ostream &os);
+        const std::string &path() const;
+        FlightRecorder &operator=(const FlightRecorder &other) = delete;
+        FlightRecorder &operator=(FlightRecorder &&other) = delete;
+        static void install(FlightRecorder *recorder);
+        static FlightRecorder *installed();
+
+    private:
+        // Types
+        /** A record guarded by a sequence number, which is odd while the
+         *  record is being written (a seqlock).
+         */
+        struct Slot
+        {
+            std::atomic<std::size_t> sequence{0};
+            std::atomic<uint64_t> data[sizeof(DecisionRecord) / 8] = {};
+        };
+        // Variables
+        std::string path_;
+        std::vector<Slot> slots_;
+        std::size_t mask_;
+        alignas(64) std::atomic<std::size_t> next_;
+        std::mutex dump_mutex_;
+        static std::atomic<FlightRecorder *> installed_;
+};
+
+
+#endif // FLIGHTRECORDER_HPP_
@@ -120,7 +120,7 @@ std::ostream &GoTo::print_(std::ostream &os) const
 Action GoTo::action(
     const Packet &packet, const MAVAddress &address) const
 {
-    if (!condition_ || condition_->check(packet, address))
+    if (matches_(packet, address))
     {
         auto result = chain_->action(packet, address);
 
@@ -144,6 +144,34 @@ Action GoTo::action(
 }
 
 
+/** \copydoc Rule::may_accept(unsigned long,const MAVAddress&,bool)const
+ *
+ *  The result of the chain, using the default action if the chain does not
+ *  decide, unless the condition can not match.  A rejection only holds if the
+ *  condition matches for every destination.
+ */
+std::optional<bool> GoTo::may_accept(
+    unsigned long id, const MAVAddress &source, bool accept_by_default) const
+{
+    auto match = check_(id, source);
+
+    if (match == false)
+    {
+        return {};
+    }
+
+    auto result = chain_->may_accept(id, source, accept_by_default)
+                  .value_or(accept_by_default);
+
+    if (!result && !match.has_value())
+    {
+        return {};
+    }
+
+    return result;
+}
+
+
 std::unique_ptr<Rule> GoTo::clone() const
 {
     if (priority_)
@@ -155,6 +183,15 @@ std::unique_ptr<Rule> GoTo::clone() const
 }
 
 
+/** \copydoc Rule::chain() const
+ *
+ *  \returns The chain to delegate decisions to.
+ */
+const Chain *GoTo::chain() const
+{
+    return chain_.get();
+}
+
 /** \copydoc Rule::operator==(const Rule &) const
  *
  *  Compares the chain and priority (if set) associated with the rule as well.
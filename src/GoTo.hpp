@@ -50,7 +50,11 @@ class GoTo : public Rule
              std::optional<If> condition = {});
         virtual Action action(
             const Packet &packet, const MAVAddress &address) const;
+        virtual std::optional<bool> may_accept(
+            unsigned long id, const MAVAddress &source,
+            bool accept_by_default) const;
         virtual std::unique_ptr<Rule> clone() const;
+        virtual const Chain *chain() const;
         virtual bool operator==(const Rule &other) const;
         virtual bool operator!=(const Rule &other) const;
 
@@ -0,0 +1,184 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+
+#include "Histogram.hpp"
+
+
+/** Construct an empty histogram.
+ */
+Histogram::Histogram()
+    : count_(0), max_(0), sum_(0)
+{
+    for (auto &bucket : buckets_)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+
+/** Get the bucket a value is counted in.
+ *
+ *  Values less than 16 have a bucket each.  Larger values are bucketed by
+ *  their highest set bit and the 4 bits following it.
+ *
+ *  \param value The value to get the bucket of (in nanoseconds).
+ *  \returns The index of the bucket.
+ */
+std::size_t Histogram::bucket_(unsigned long long value)
+{
+    if (value < SUB_BUCKETS)
+    {
+        return static_cast<std::size_t>(value);
+    }
+
+    if (value >> MAX_BITS)
+    {
+        return BUCKETS - 1;
+    }
+
+    auto bit = 63 - static_cast<unsigned int>(__builtin_clzll(value));
+    auto shift = bit - SUB_BITS;
+    return (shift + 1) * SUB_BUCKETS +
+           static_cast<std::size_t>((value >> shift) - SUB_BUCKETS);
+}
+
+
+/** Get the highest value counted in a bucket.
+ *
+ *  \param bucket The index of the bucket.
+ *  \returns The highest value (in nanoseconds) that is counted in \p bucket.
+ */
+unsigned long long Histogram::highest_(std::size_t bucket)
+{
+    if (bucket < SUB_BUCKETS)
+    {
+        return bucket;
+    }
+
+    auto shift = bucket / SUB_BUCKETS - 1;
+    auto lowest = static_cast<unsigned long long>(
+                      bucket % SUB_BUCKETS + SUB_BUCKETS) << shift;
+    return lowest + (1ULL << shift) - 1;
+}
+
+
+/** Record a duration.
+ *
+ *  \param duration The duration to record.  Negative durations are recorded
+ *      as 0.
+ */
+void Histogram::record(std::chrono::nanoseconds duration)
+{
+    auto value = static_cast<unsigned long long>(
+                     std::max(duration, std::chrono::nanoseconds::zero())
+                     .count());
+    buckets_[bucket_(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    auto max = max_.load(std::memory_order_relaxed);
+
+    while (value > max && !max_.compare_exchange_weak(
+                max, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+
+/** Get the number of recorded durations.
+ *
+ *  \returns The number of durations recorded.
+ */
+unsigned long long Histogram::count() const
+{
+    return count_.load(std::memory_order_relaxed);
+}
+
+
+/** Get the longest recorded duration.
+ *
+ *  \returns The longest duration recorded, or 0 if none have been.
+ */
+std::chrono::nanoseconds Histogram::max() const
+{
+    return std::chrono::nanoseconds(max_.load(std::memory_order_relaxed));
+}
+
+
+/** Get a quantile of the recorded durations.
+ *
+ *  The highest value of the bucket the quantile falls in is returned, so the
+ *  result may be slightly high but never low (unless it is the maximum).
+ *
+ *  \param quantile The quantile to get, from 0 to 1.  For example, 0.99 for
+ *      the 99th percentile.
+ *  \returns The duration that \p quantile of the recorded durations are less
+ *      than or equal to, or 0 if none have been recorded.
+ */
+std::chrono::nanoseconds Histogram::quantile(double quantile) const
+{
+    // Count from the buckets, count_ may be ahead of them.
+    std::array<unsigned long long, BUCKETS> counts;
+    unsigned long long total = 0;
+
+    for (std::size_t i = 0; i < BUCKETS; ++i)
+    {
+        counts[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    if (total == 0)
+    {
+        return std::chrono::nanoseconds::zero();
+    }
+
+    auto rank = std::max(
+                    static_cast<unsigned long long>(std::ceil(
+                        std::clamp(quantile, 0.0, 1.0) *
+                        static_cast<double>(total))), 1ULL);
+    unsigned long long seen = 0;
+    std::size_t i = 0;
+
+    for (; i < BUCKETS - 1; ++i)
+    {
+        seen += counts[i];
+
+        if (seen >= rank)
+        {
+            break;
+        }
+    }
+
+    auto value = std::min(highest_(i), max_.load(std::memory_order_relaxed));
+    return std::chrono::nanoseconds(value);
+}
+
+
+/** Get the sum of the recorded durations.
+ *
+ *  \returns The total of all the durations recorded.
+ */
+std::chrono::nanoseconds Histogram::sum() const
+{
+    return std::chrono::nanoseconds(sum_.load(std::memory_order_relaxed));
+}
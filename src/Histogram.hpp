@@ -0,0 +1,71 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef HISTOGRAM_HPP_
+#define HISTOGRAM_HPP_
+
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+
+/** A log-linear histogram of durations.
+ *
+ *  Durations are counted in buckets that grow with the duration, in the style
+ *  of an HDR histogram.  Each power of two (in nanoseconds) is split into 16
+ *  equal buckets, so a quantile is never off by more than 1/16th (6.25%) of
+ *  its value.  Durations of 2^36 nanoseconds (about 68 seconds) or more are
+ *  counted in the last bucket.
+ *
+ *  \remarks
+ *      Threadsafe (lock-free).
+ */
+class Histogram
+{
+    public:
+        Histogram();
+        Histogram(const Histogram &other) = delete;
+        Histogram(Histogram &&other) = delete;
+        void record(std::chrono::nanoseconds duration);
+        unsigned long long count() const;
+        std::chrono::nanoseconds max() const;
+        std::chrono::nanoseconds quantile(double quantile) const;
+        std::chrono::nanoseconds sum() const;
+        Histogram &operator=(const Histogram &other) = delete;
+        Histogram &operator=(Histogram &&other) = delete;
+
+    private:
+        static constexpr unsigned int SUB_BITS = 4;
+        static constexpr unsigned int MAX_BITS = 36;
+        static constexpr std::size_t SUB_BUCKETS = 1 << SUB_BITS;
+        static constexpr std::size_t BUCKETS =
+            (MAX_BITS - SUB_BITS + 1) * SUB_BUCKETS;
+        // Variables
+        std::array<std::atomic<unsigned long long>, BUCKETS> buckets_;
+        std::atomic<unsigned long long> count_;
+        std::atomic<unsigned long long> max_;
+        std::atomic<unsigned long long> sum_;
+        // Methods
+        static std::size_t bucket_(unsigned long long value);
+        static unsigned long long highest_(std::size_t bucket);
+};
+
+
+#endif // HISTOGRAM_HPP_
@@ -0,0 +1,179 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+#include "IPAddress.hpp"
+#include "IPSubnet.hpp"
+
+
+/** Get the bit mask corresponding to the prefix length.
+ *
+ *  \returns The 32-bit mask with the leading \ref prefix_length bits set.
+ */
+unsigned long IPSubnet::mask_() const
+{
+    if (prefix_length_ == 0)
+    {
+        return 0;
+    }
+
+    return (0xFFFFFFFFUL << (32 - prefix_length_)) & 0xFFFFFFFFUL;
+}
+
+
+/** Construct an IP subnet from an IP address and prefix length.
+ *
+ *  \param address IP address of the subnet, the port number is discarded.
+ *  \param prefix_length Number of leading bits of an IP address that must
+ *      match \p address for it to be contained within the subnet (0 - 32).
+ *      The default is 32, which only contains \p address itself.
+ *  \throws std::out_of_range if the prefix length is greater than 32.
+ *  \sa Check if an \ref IPAddress is within the subnet with \ref contains.
+ */
+IPSubnet::IPSubnet(const IPAddress &address, unsigned int prefix_length)
+    : address_(address, 0), prefix_length_(prefix_length)
+{
+    if (prefix_length_ > 32)
+    {
+        throw std::out_of_range(
+            "Prefix length (" + std::to_string(prefix_length_) +
+            ") is outside of the allowed range (0 - 32).");
+    }
+}
+
+
+/** Construct an IP subnet from a string.
+ *
+ *  Parse a string of the form "<IP Address>" or "<IP Address>/<Prefix
+ *  Length>".
+ *
+ *  Some examples are:
+ *      - "192.168.1.7"
+ *      - "192.168.0.0/16"
+ *      - "0.0.0.0/0"
+ *
+ *  %If no prefix length is given 32 is used, which only contains the given
+ *  address.
+ *
+ *  \param subnet String representing the IP subnet.
+ *  \throws std::invalid_argument if the string does not represent a valid IP
+ *      subnet.
+ *  \throws std::out_of_range if an address octet or the prefix length is out
+ *      of range.
+ */
+IPSubnet::IPSubnet(std::string subnet)
+    : address_(0), prefix_length_(32)
+{
+    auto slash = subnet.find('/');
+
+    if (slash != std::string::npos)
+    {
+        auto prefix = subnet.substr(slash + 1);
+
+        if (prefix.empty() || prefix.size() > 2 ||
+                prefix.find_first_not_of("0123456789") != std::string::npos)
+        {
+            throw std::invalid_argument("Invalid IP subnet string.");
+        }
+
+        prefix_length_ = static_cast<unsigned int>(std::stoul(prefix));
+        subnet.erase(slash);
+    }
+
+    if (subnet.find(':') != std::string::npos)
+    {
+        throw std::invalid_argument("Invalid IP subnet string.");
+    }
+
+    *this = IPSubnet(IPAddress(subnet), prefix_length_);
+}
+
+
+/** Determine if an IP address is contained within the subnet.
+ *
+ *  \param address The IP address to check, the port number is ignored.
+ *  \retval true The \p address is in the subnet.
+ *  \retval false The \p address is not in the subnet.
+ */
+bool IPSubnet::contains(const IPAddress &address) const
+{
+    return (address.address() & mask_()) == (address_.address() & mask_());
+}
+
+
+/** Return the prefix length.
+ *
+ *  \returns The number of leading bits an address must match (0 - 32).
+ */
+unsigned int IPSubnet::prefix_length() const
+{
+    return prefix_length_;
+}
+
+
+/** Equality comparison.
+ *
+ *  \relates IPSubnet
+ *  \param lhs The left hand side IP subnet.
+ *  \param rhs The right hand side IP subnet.
+ *  \retval true if \p lhs and \p rhs contain the same addresses.
+ *  \retval false if \p lhs and \p rhs do not contain the same addresses.
+ */
+bool operator==(const IPSubnet &lhs, const IPSubnet &rhs)
+{
+    return lhs.prefix_length_ == rhs.prefix_length_ &&
+           (lhs.address_.address() & lhs.mask_()) ==
+           (rhs.address_.address() & rhs.mask_());
+}
+
+
+/** Inequality comparison.
+ *
+ *  \relates IPSubnet
+ *  \param lhs The left hand side IP subnet.
+ *  \param rhs The right hand side IP subnet.
+ *  \retval true if \p lhs and \p rhs do not contain the same addresses.
+ *  \retval false if \p lhs and \p rhs contain the same addresses.
+ */
+bool operator!=(const IPSubnet &lhs, const IPSubnet &rhs)
+{
+    return !(lhs == rhs);
+}
+
+
+/** Print the IP subnet to the given output stream.
+ *
+ *  The format is "<IP Address>/<Prefix Length>".
+ *
+ *  Some examples are:
+ *      - `192.168.1.7/32`
+ *      - `192.168.0.0/16`
+ *      - `0.0.0.0/0`
+ *
+ *  \relates IPSubnet
+ *  \param os The output stream to print to.
+ *  \param ipsubnet The IP subnet to print.
+ *  \returns The output stream.
+ */
+std::ostream &operator<<(std::ostream &os, const IPSubnet &ipsubnet)
+{
+    os << ipsubnet.address_ << "/" << ipsubnet.prefix_length_;
+    return os;
+}
@@ -0,0 +1,80 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef IPSUBNET_HPP_
+#define IPSUBNET_HPP_
+
+
+#include <ostream>
+#include <string>
+
+#include "IPAddress.hpp"
+
+
+/** An IP subnet.
+ *
+ *  A range of IP addresses given by an address and the number of leading bits
+ *  (prefix length) that must match it.  The port number is ignored.
+ *
+ *  \sa IPAddress
+ */
+class IPSubnet
+{
+    public:
+        /** Copy constructor.
+         *
+         * \param other IP subnet to copy from.
+         */
+        IPSubnet(const IPSubnet &other) = default;
+        /** Move constructor.
+         *
+         * \param other IP subnet to move from.
+         */
+        IPSubnet(IPSubnet &&other) = default;
+        IPSubnet(const IPAddress &address, unsigned int prefix_length = 32);
+        IPSubnet(std::string subnet);
+        bool contains(const IPAddress &address) const;
+        unsigned int prefix_length() const;
+        /** Assignment operator.
+         *
+         * \param other IP subnet to copy from.
+         */
+        IPSubnet &operator=(const IPSubnet &other) = default;
+        /** Assignment operator (by move semantics).
+         *
+         * \param other IP subnet to move from.
+         */
+        IPSubnet &operator=(IPSubnet &&other) = default;
+
+        friend bool operator==(const IPSubnet &lhs, const IPSubnet &rhs);
+        friend bool operator!=(const IPSubnet &lhs, const IPSubnet &rhs);
+        friend std::ostream &operator<<(
+            std::ostream &os, const IPSubnet &ipsubnet);
+
+    private:
+        IPAddress address_;
+        unsigned int prefix_length_;
+        unsigned long mask_() const;
+};
+
+
+bool operator==(const IPSubnet &lhs, const IPSubnet &rhs);
+bool operator!=(const IPSubnet &lhs, const IPSubnet &rhs);
+std::ostream &operator<<(std::ostream &os, const IPSubnet &ipsubnet);
+
+
+#endif // IPSUBNET_HPP_
@@ -183,6 +183,34 @@ bool If::check(const Packet &packet, const MAVAddress &address) const
 }
 
 
+/** Check whether a packet, without knowing its destination, matches.
+ *
+ *  This is used to decide what to do with a packet from only its header,
+ *  before the destination it is to be sent to is known.
+ *
+ *  \param id The packet ID (message type) of the packet.
+ *  \param source The source address of the packet.
+ *  \retval true %If the packet matches regardless of destination.
+ *  \retval false %If the packet does not match the type or source subnet.
+ *  \returns Nothing if whether the packet matches depends on the destination.
+ */
+std::optional<bool> If::check(
+    unsigned long id, const MAVAddress &source) const
+{
+    if ((id_ && id != id_) || (source_ && !source_->contains(source)))
+    {
+        return false;
+    }
+
+    if (dest_)
+    {
+        return {};
+    }
+
+    return true;
+}
+
+
 /** Equality comparison.
  *
  *  \relates If
@@ -55,6 +55,8 @@ class If
         If &to(MAVSubnet subnet);
         If &to(const std::string &subnet);
         bool check(const Packet &packet, const MAVAddress &address) const;
+        std::optional<bool> check(
+            unsigned long id, const MAVAddress &source) const;
         /** Assignment operator.
          *
          * \param other If to copy from.
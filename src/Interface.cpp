@@ -20,6 +20,7 @@
 
 #include "ConnectionPool.hpp"
 #include "Interface.hpp"
+#include "Stats.hpp"
 
 
 // Placed here to avoid weak-vtables error.
@@ -30,6 +31,19 @@ Interface::~Interface()
 // LCOV_EXCL_STOP
 
 
+/** Get the traffic counters of the interface.
+ *
+ *  Interfaces count the packets they receive, the packets they send and the
+ *  packets they drop because they could not be sent.
+ *
+ *  \returns The traffic counters of the interface.
+ */
+const TrafficCounters &Interface::traffic() const
+{
+    return traffic_;
+}
+
+
 /** Print the given \ref Interface to the given output stream.
  *
  *  \note This is a polymorphic print.  Therefore, it can print any derived
@@ -23,12 +23,14 @@
 #include <memory>
 
 #include "ConnectionPool.hpp"
+#include "Stats.hpp"
 
 
 /** The base class for all interfaces.
  *
  *  Derived classes should add one or more connections to queue packets for
- *  sending.
+ *  sending.  They should also count the packets they receive, send and drop in
+ *  the interface's traffic counters.
  */
 class Interface
 {
@@ -49,11 +51,13 @@ class Interface
          */
         virtual void receive_packet(
             const std::chrono::nanoseconds &timeout) = 0;
+        const TrafficCounters &traffic() const;
 
         friend std::ostream &operator<<(
             std::ostream &os, const Interface &interface);
 
     protected:
+        TrafficCounters traffic_;
         /** Print the interface to the given output stream.
          *
          *  \param os The output stream to print to.
@@ -16,50 +16,104 @@
 
 
 #include <chrono>
+#include <exception>
 #include <memory>
 #include <stdexcept>
+#include <string>
 #include <utility>
 
+#include "FlightRecorder.hpp"
 #include "Interface.hpp"
 #include "InterfaceThreader.hpp"
+#include "Logger.hpp"
 #include "PartialSendError.hpp"
+#include "Stats.hpp"
+
+
+// Private functions.
+namespace
+{
+
+    /** Dump the installed \ref FlightRecorder after an interface failed.
+     *
+     *  Errors while dumping are logged, as the interface error is more
+     *  important.
+     */
+    void dump_flight_recorder()
+    {
+        if (auto recorder = FlightRecorder::installed())
+        {
+            try
+            {
+                recorder->dump();
+                Logger::log(
+                    "interface failed, flight recorder dumped to " +
+                    recorder->path());
+            }
+            catch (const std::exception &e)
+            {
+                Logger::log(
+                    std::string("flight recorder dump failed: ") + e.what());
+            }
+        }
+    }
+
+}
 
 
 /** The transmitting thread runner.
  *
- *  This handles all transmission related tasks in a separate thread.
+ *  This handles all transmission related tasks in a separate thread.  The
+ *  installed \ref FlightRecorder is dumped if an error escapes the interface.
  */
 void InterfaceThreader::tx_runner_()
 {
-    while (running_.load())
+    try
     {
-        try
-        {
-            interface_->send_packet(timeout_);
-        }
-        // Ignore partial write errors on shutdown.
-        // TODO: A better way to handle this error might be in order.  Not even
-        //       sure exactly why it happens on close.
-        catch (const PartialSendError &)
+        while (running_.load())
         {
-            if (running_.load())
+            try
             {
-                throw;
+                interface_->send_packet(timeout_);
+            }
+            // Ignore partial write errors on shutdown.
+            // TODO: A better way to handle this error might be in order.  Not
+            //       even sure exactly why it happens on close.
+            catch (const PartialSendError &)
+            {
+                if (running_.load())
+                {
+                    throw;
+                }
             }
         }
     }
+    catch (...)
+    {
+        dump_flight_recorder();
+        throw;
+    }
 }
 
 
 /** The receiving thread runner.
  *
- *  This handles all receiving related tasks in a separate thread.
+ *  This handles all receiving related tasks in a separate thread.  The
+ *  installed \ref FlightRecorder is dumped if an error escapes the interface.
  */
 void InterfaceThreader::rx_runner_()
 {
-    while (running_.load())
+    try
+    {
+        while (running_.load())
+        {
+            interface_->receive_packet(timeout_);
+        }
+    }
+    catch (...)
     {
-        interface_->receive_packet(timeout_);
+        dump_flight_recorder();
+        throw;
     }
 }
 
@@ -68,7 +122,8 @@ void InterfaceThreader::rx_runner_()
  *
  *  \param interface The \ref Interface to run in TX/RX threads.  It's \ref
  *      Interface::send_packet and \ref Interface::receive_packet methods will
- *      be called repeatedly in two separate worker threads.
+ *      be called repeatedly in two separate worker threads.  The interface is
+ *      registered with the \ref Stats while it is owned by the threader.
  *  \param timeout The maximum amount of time to wait for incoming data or a
  *      packet to transmit.  The default value is 100000 us (100 ms).
  *  \param start_threads Set to \ref InterfaceThreader::START (the default
@@ -85,6 +140,8 @@ InterfaceThreader::InterfaceThreader(
       timeout_(std::move(timeout)),
       running_(false)
 {
+    Stats::add(*interface_);
+
     if (start_threads == InterfaceThreader::START)
     {
         start();
@@ -97,6 +154,7 @@ InterfaceThreader::InterfaceThreader(
 InterfaceThreader::~InterfaceThreader()
 {
     shutdown();
+    Stats::remove(*interface_);
 }
 
 
@@ -0,0 +1,193 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+#include <string>
+
+#include "LogRing.hpp"
+
+
+/** Construct a log ring.
+ *
+ *  \param size The number of records the ring can hold.  This must be a power
+ *      of 2.
+ *  \throws std::invalid_argument if the \p size is not a power of 2.
+ */
+LogRing::LogRing(std::size_t size)
+    : records_(size), mask_(size - 1), head_(0), pushing_(false), tail_(0),
+      dropped_(0)
+{
+    if (size == 0 || (size & (size - 1)) != 0)
+    {
+        throw std::invalid_argument(
+            "Log ring size (" + std::to_string(size) +
+            ") must be a power of 2.");
+    }
+}
+
+
+/** Add a record to the ring.
+ *
+ *  \note Only one thread may push to a ring.
+ *
+ *  \param record The record to add, only the first \ref LogRecord::length
+ *      bytes of the message are copied.
+ *  \retval true %If the record was added to the ring.
+ *  \retval false %If the ring was full and the record was dropped.
+ *  \remarks
+ *      Threadsafe (lock-free).
+ */
+bool LogRing::push(const LogRecord &record)
+{
+    auto head = head_.load(std::memory_order_relaxed);
+
+    if (head - tail_.load(std::memory_order_acquire) > mask_)
+    {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    auto &slot = records_[head & mask_];
+    auto length = std::min(record.length, sizeof(slot.message));
+    std::memcpy(&slot, &record, offsetof(LogRecord, message));
+    std::memcpy(slot.message, record.message, length);
+    slot.length = length;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+
+/** Add a message to the ring.
+ *
+ *  \note Only one thread may push to a ring.
+ *
+ *  \param time The time the message was logged.
+ *  \param message The message to log, truncated if longer than a \ref
+ *      LogRecord can hold.
+ *  \retval true %If the message was added to the ring.
+ *  \retval false %If the ring was full and the message was dropped.
+ *  \remarks
+ *      Threadsafe (lock-free).
+ */
+bool LogRing::push(std::time_t time, const std::string &message)
+{
+    auto head = head_.load(std::memory_order_relaxed);
+
+    if (head - tail_.load(std::memory_order_acquire) > mask_)
+    {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    auto &record = records_[head & mask_];
+    record.time = time;
+    record.event = LogEvent::message;
+    record.length = std::min(message.size(), sizeof(record.message));
+    std::memcpy(record.message, message.data(), record.length);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+
+/** Get a record from the ring without removing it.
+ *
+ *  \note Only one thread may read from a ring.
+ *
+ *  \param index The index of the record, 0 is the oldest record in the ring.
+ *  \returns The record at \p index, or nullptr if the ring does not hold that
+ *      many records.  The record remains valid until it is removed with \ref
+ *      pop.
+ *  \remarks
+ *      Threadsafe (lock-free).
+ */
+const LogRecord *LogRing::peek(std::size_t index) const
+{
+    auto tail = tail_.load(std::memory_order_relaxed);
+
+    if (head_.load(std::memory_order_acquire) - tail <= index)
+    {
+        return nullptr;
+    }
+
+    return &records_[(tail + index) & mask_];
+}
+
+
+/** Remove the oldest records from the ring.
+ *
+ *  \note Only one thread may read from a ring, and only records that \ref
+ *      peek has returned may be removed.
+ *
+ *  \param count The number of records to remove.
+ *  \remarks
+ *      Threadsafe (lock-free).
+ */
+void LogRing::pop(std::size_t count)
+{
+    tail_.store(
+        tail_.load(std::memory_order_relaxed) + count,
+        std::memory_order_release);
+}
+
+
+/** Get and reset the number of dropped messages.
+ *
+ *  \returns The number of messages dropped because the ring was full, since
+ *      the last call.
+ *  \remarks
+ *      Threadsafe (lock-free).
+ */
+unsigned long LogRing::dropped()
+{
+    return dropped_.exchange(0, std::memory_order_relaxed);
+}
+
+
+/** Mark whether the owning thread is about to push to the ring.
+ *
+ *  This allows the \ref Logger to wait for pushes that started before
+ *  asynchronous logging was disabled.
+ *
+ *  \note Only the thread that pushes to the ring may call this.
+ *
+ *  \param pushing True before checking whether to push, false afterwards.
+ *  \remarks
+ *      Threadsafe (lock-free).
+ */
+void LogRing::pushing(bool pushing)
+{
+    pushing_.store(pushing);
+}
+
+
+/** Determine whether the owning thread may be pushing to the ring.
+ *
+ *  \retval true %If the owning thread may be pushing to the ring.
+ *  \retval false %If the owning thread is not pushing to the ring.
+ *  \remarks
+ *      Threadsafe (lock-free).
+ */
+bool LogRing::pushing() const
+{
+    return pushing_.load();
+}
@@ -0,0 +1,125 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef LOGRING_HPP_
+#define LOGRING_HPP_
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+
+/** The kind of event a \ref LogRecord holds.
+ */
+enum class LogEvent : uint8_t
+{
+    message,    //!< A text message.
+    accepted,   //!< A packet was accepted by a connection.
+    rejected,   //!< A packet was rejected by a connection.
+    received,   //!< A packet was received by the connection pool.
+    duplicate,  //!< A duplicate packet was suppressed.
+    queued,     //!< A traced packet was added to a connection's queue.
+    sending     //!< A traced packet was taken from a queue to be sent.
+};
+
+
+/** A log event waiting to be written by the \ref Logger.
+ *
+ *  Records have a fixed size so they can be stored in a \ref LogRing without
+ *  allocating.  Packet events only store the packet header fields and
+ *  connection name ids, they are rendered to text by \ref Logger::render.
+ *  Messages longer than the record are truncated.
+ */
+struct LogRecord
+{
+    /** Time the event was logged.
+     */
+    std::time_t time;
+    /** The kind of event.
+     */
+    LogEvent event;
+    /** True if the packet has a destination address.
+     */
+    bool has_dest;
+    /** Packet version, see \ref Packet::Version.
+     */
+    uint16_t version;
+    /** Numeric MAVLink ID of the packet.
+     */
+    uint32_t id;
+    /** Source MAVLink address of the packet.
+     */
+    uint16_t source;
+    /** Destination MAVLink address of the packet, if \ref has_dest is true.
+     */
+    uint16_t dest;
+    /** Name id of the connection the packet was received on, 0 if unknown.
+     */
+    unsigned int from;
+    /** Name id of the connection the packet is sent to, 0 if none.
+     */
+    unsigned int to;
+    /** Event specific count, such as the number of duplicates.
+     */
+    unsigned long count;
+    /** Length of the message in bytes, 0 for packet events.
+     */
+    std::size_t length;
+    /** The message (not null terminated).
+     */
+    char message[240];
+};
+
+
+/** A lock-free single producer, single consumer ring of log records.
+ *
+ *  Each thread that logs asynchronously owns one ring, which the \ref Logger's
+ *  writer thread empties.  Records logged while the ring is full are dropped
+ *  and counted.
+ */
+class LogRing
+{
+    public:
+        LogRing(std::size_t size = 1024);
+        LogRing(const LogRing &other) = delete;
+        LogRing(LogRing &&other) = delete;
+        bool push(const LogRecord &record);
+        bool push(std::time_t time, const std::string &message);
+        const LogRecord *peek(std::size_t index = 0) const;
+        void pop(std::size_t count = 1);
+        unsigned long dropped();
+        void pushing(bool pushing);
+        bool pushing() const;
+        LogRing &operator=(const LogRing &other) = delete;
+        LogRing &operator=(LogRing &&other) = delete;
+
+    private:
+        std::vector<LogRecord> records_;
+        std::size_t mask_;
+        alignas(64) std::atomic<std::size_t> head_;
+        std::atomic<bool> pushing_;
+        alignas(64) std::atomic<std::size_t> tail_;
+        std::atomic<unsigned long> dropped_;
+};
+
+
+#endif // LOGRING_HPP_
@@ -15,13 +15,227 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <ctime>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include "Logger.hpp"
+#include "LogRing.hpp"
+#include "MAVAddress.hpp"
+#include "mavlink.hpp"
+#include "Packet.hpp"
+#include "utility.hpp"
+
+
+using namespace std::chrono_literals;
+
+
+/** Get the log ring of the calling thread, creating it if needed.
+ *
+ *  \returns The calling thread's log ring.
+ */
+LogRing &Logger::ring_()
+{
+    thread_local std::shared_ptr<LogRing> ring;
+
+    if (ring == nullptr)
+    {
+        ring = std::make_shared<LogRing>();
+        std::lock_guard<std::mutex> lock(mutex_);
+        rings_.push_back(ring);
+    }
+
+    return *ring;
+}
+
+
+/** Write a message to stdout immediately.
+ *
+ *  \param time The time the message was logged.
+ *  \param message The message to write.
+ */
+void Logger::output_(std::time_t time, const std::string &message)
+{
+    auto tm = *std::localtime(&time);
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::cout << std::put_time(&tm, "%Y-%m-%d %H:%M:%S") << "  "
+              << message << std::endl;
+}
+
+
+/** Add a packet event to the calling thread's ring, if asynchronous.
+ *
+ *  \param record The packet event to add.
+ *  \retval true %If the event was added to the ring (or dropped because the
+ *      ring is full).
+ *  \retval false %If asynchronous logging is disabled, in which case the
+ *      caller must write the event.
+ */
+bool Logger::push_(const LogRecord &record)
+{
+    if (!async_.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    // Disabling asynchronous logging waits until the ring is not pushing, so
+    // the flag must be set before checking again.
+    auto &ring = ring_();
+    ring.pushing(true);
+    bool async = async_.load();
+
+    if (async)
+    {
+        ring.push(record);
+    }
+
+    ring.pushing(false);
+    return async;
+}
+
+
+/** Add a message to the calling thread's ring, if asynchronous.
+ *
+ *  \param time The time the message was logged.
+ *  \param message The message to add.
+ *  \retval true %If the message was added to the ring (or dropped because the
+ *      ring is full).
+ *  \retval false %If asynchronous logging is disabled, in which case the
+ *      caller must write the message.
+ */
+bool Logger::push_(std::time_t time, const std::string &message)
+{
+    if (!async_.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    // Disabling asynchronous logging waits until the ring is not pushing, so
+    // the flag must be set before checking again.
+    auto &ring = ring_();
+    ring.pushing(true);
+    bool async = async_.load();
+
+    if (async)
+    {
+        ring.push(time, message);
+    }
+
+    ring.pushing(false);
+    return async;
+}
+
+
+/** Write all messages waiting in the log rings to stdout.
+ *
+ *  The messages are only removed from the rings after they have been written
+ *  and stdout has been flushed.
+ *
+ *  \param last_time The time of the cached timestamp.
+ *  \param timestamp The cached timestamp, only reformatted when the time
+ *      changes.
+ *  \retval true %If any messages were written.
+ *  \retval false %If there were no messages to write.
+ */
+bool Logger::write_(std::time_t &last_time, std::string &timestamp)
+{
+    std::vector<std::shared_ptr<LogRing>> rings;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Forget the rings of threads that have exited.
+        rings_.erase(
+            std::remove_if(rings_.begin(), rings_.end(), [](const auto & ring)
+        {
+            return ring.use_count() == 1 && ring->peek() == nullptr;
+        }), rings_.end());
+        rings = rings_;
+    }
+
+    auto format = [&](std::time_t time) -> const std::string &
+    {
+        if (time != last_time)
+        {
+            auto tm = *std::localtime(&time);
+            char buffer[32];
+            std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S  ", &tm);
+            timestamp = buffer;
+            last_time = time;
+        }
+
+        return timestamp;
+    };
+    std::string output;
+    std::vector<std::size_t> counts(rings.size(), 0);
+
+    for (std::size_t i = 0; i < rings.size(); ++i)
+    {
+        if (auto dropped = rings[i]->dropped())
+        {
+            output += format(std::time(nullptr));
+            output += "dropped " + std::to_string(dropped) +
+                      " log messages\n";
+        }
+
+        while (auto record = rings[i]->peek(counts[i]))
+        {
+            output += format(record->time);
+            output += render(*record);
+            output += '\n';
+            ++counts[i];
+        }
+    }
+
+    if (output.empty())
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::cout << output << std::flush;
+    }
+
+    for (std::size_t i = 0; i < rings.size(); ++i)
+    {
+        rings[i]->pop(counts[i]);
+    }
+
+    return true;
+}
+
+
+/** Write logged messages until asynchronous logging is disabled.
+ *
+ *  Any messages still waiting when asynchronous logging is disabled are
+ *  written before returning.
+ */
+void Logger::run_writer_()
+{
+    std::time_t last_time = -1;
+    std::string timestamp;
+
+    while (async_.load(std::memory_order_acquire))
+    {
+        if (!write_(last_time, timestamp))
+        {
+            std::this_thread::sleep_for(10ms);
+        }
+    }
+
+    while (write_(last_time, timestamp))
+    {
+    }
+}
 
 
 /** Log a message with timestamp (at level 1).
@@ -53,7 +267,7 @@ void Logger::log(std::string message)
  *      65535, a value of 0 will be corrected to 1.
  *  \param message The message to log.
  *  \remarks
- *      Threadsafe (locking).
+ *      Threadsafe (locking, lock-free when asynchronous).
  */
 void Logger::log(unsigned int level, std::string message)
 {
@@ -65,11 +279,238 @@ void Logger::log(unsigned int level, std::string message)
     if (level_ >= level)
     {
         auto t = std::time(nullptr);
-        auto tm = *std::localtime(&t);
+
+        if (!push_(t, message))
+        {
+            output_(t, message);
+        }
+    }
+}
+
+
+/** Log a packet event with timestamp at the given level.
+ *
+ *  Only the packet header fields are recorded, the text of the event is
+ *  rendered by \ref render when it is written.  This makes logging packet
+ *  events cheap when asynchronous logging is enabled.
+ *
+ *  \param level The level to log the event at.  If the logger's level is
+ *      lower than this, the event will be discarded.  A value of 0 will be
+ *      corrected to 1.
+ *  \param event The kind of packet event, must not be \ref
+ *      LogEvent::message.
+ *  \param packet The packet the event is about.
+ *  \param from Name id of the connection the packet was received on, 0 if
+ *      unknown.  See \ref register_name.
+ *  \param to Name id of the connection the packet is being sent to, 0 if not
+ *      applicable.
+ *  \param count Event specific count, such as the number of duplicates.
+ *  \remarks
+ *      Threadsafe (locking, lock-free when asynchronous).
+ */
+void Logger::log(
+    unsigned int level, LogEvent event, const Packet &packet,
+    unsigned int from, unsigned int to, unsigned long count)
+{
+    if (level < 1)
+    {
+        level = 1;
+    }
+
+    if (level_ >= level)
+    {
+        log_(event, packet, from, to, count);
+    }
+}
+
+
+/** Log a packet event of a traced packet with timestamp.
+ *
+ *  Unlike \ref log the event is logged at any log level, even 0.  This is
+ *  used for the packets selected by the installed \ref Tracer.
+ *
+ *  \param event The kind of packet event, must not be \ref
+ *      LogEvent::message.
+ *  \param packet The packet the event is about.
+ *  \param from Name id of the connection the packet was received on, 0 if
+ *      unknown.  See \ref register_name.
+ *  \param to Name id of the connection the packet is being sent to, 0 if not
+ *      applicable.
+ *  \param count Event specific count, such as the microseconds the packet
+ *      was queued for.
+ *  \remarks
+ *      Threadsafe (locking, lock-free when asynchronous).
+ */
+void Logger::trace(
+    LogEvent event, const Packet &packet, unsigned int from, unsigned int to,
+    unsigned long count)
+{
+    log_(event, packet, from, to, count);
+}
+
+
+/** Log a packet event with timestamp, regardless of the log level.
+ *
+ *  \param event The kind of packet event.
+ *  \param packet The packet the event is about.
+ *  \param from Name id of the connection the packet was received on.
+ *  \param to Name id of the connection the packet is being sent to.
+ *  \param count Event specific count.
+ */
+void Logger::log_(
+    LogEvent event, const Packet &packet, unsigned int from, unsigned int to,
+    unsigned long count)
+{
+    LogRecord record;
+    record.time = std::time(nullptr);
+    record.event = event;
+    record.version = static_cast<uint16_t>(packet.version());
+    record.id = static_cast<uint32_t>(packet.id());
+    record.source = static_cast<uint16_t>(packet.source().address());
+    auto dest = packet.dest();
+    record.has_dest = dest.has_value();
+    record.dest =
+        static_cast<uint16_t>(dest ? dest->address() : 0);
+    record.from = from;
+    record.to = to;
+    record.count = count;
+    record.length = 0;
+
+    if (!push_(record))
+    {
+        output_(record.time, render(record));
+    }
+}
+
+
+/** Get the id of a connection name, for use in packet events.
+ *
+ *  The name is added to the logger's table of names if it is not already
+ *  there.  Names are never removed, but registering the same name again
+ *  returns the same id.
+ *
+ *  \param name The name to get the id of.
+ *  \returns The id of the name, never 0 (which is used for unknown).
+ *  \remarks
+ *      Threadsafe (locking).
+ */
+unsigned int Logger::register_name(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto [it, inserted] = name_ids_.try_emplace(
+                              name, static_cast<unsigned int>(names_.size()));
+
+    if (inserted)
+    {
+        names_.push_back(name);
+    }
+
+    return it->second;
+}
+
+
+/** Get all registered names.
+ *
+ *  \returns The registered names, indexed by their id.  The name with id 0
+ *      is "unknown".
+ *  \remarks
+ *      Threadsafe (locking).
+ */
+std::vector<std::string> Logger::names()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return names_;
+}
+
+
+/** Render a log record to text (without timestamp).
+ *
+ *  Some examples are:
+ *      - `received PING (#4) from 192.168 to 127.1 (v2.0) source SOURCE`
+ *      - `accepted HEARTBEAT (#0) from 127.1 (v1.0) source SOURCE dest DEST`
+ *      - `suppressed duplicate PING (#4) from 192.168 (v2.0) source LINK2 (1
+ *        duplicates)`
+ *      - `sending PING (#4) from 192.168 (v2.0) source SOURCE dest DEST
+ *        (queued 120 us)`
+ *
+ *  \param record The record to render.
+ *  \returns The text of the log message.
+ *  \remarks
+ *      Threadsafe (locking).
+ */
+std::string Logger::render(const LogRecord &record)
+{
+    if (record.event == LogEvent::message)
+    {
+        return std::string(record.message, record.length);
+    }
+
+    auto name = [](unsigned int id)
+    {
         std::lock_guard<std::mutex> lock(mutex_);
-        std::cout << std::put_time(&tm, "%Y-%m-%d %H:%M:%S") << "  "
-                  << message << std::endl;
+        return id != 0 && id < names_.size() ? names_[id] : "unknown";
+    };
+    std::string text;
+
+    switch (record.event)
+    {
+        case LogEvent::accepted:
+            text = "accepted ";
+            break;
+
+        case LogEvent::rejected:
+            text = "rejected ";
+            break;
+
+        case LogEvent::received:
+            text = "received ";
+            break;
+
+        case LogEvent::queued:
+            text = "queued ";
+            break;
+
+        case LogEvent::sending:
+            text = "sending ";
+            break;
+
+        default:
+            text = "suppressed duplicate ";
+            break;
+    }
+
+    auto info = mavlink_get_message_info_by_id(record.id);
+    text += info != nullptr ? info->name : "UNKNOWN";
+    text += " (#" + std::to_string(record.id) + ") from " +
+            str(MAVAddress(record.source));
+
+    if (record.has_dest)
+    {
+        text += " to " + str(MAVAddress(record.dest));
+    }
+
+    text += " (v" + std::to_string(record.version >> 8) + "." +
+            std::to_string(record.version & 0xFF) + ") source " +
+            name(record.from);
+
+    if (record.event == LogEvent::accepted ||
+            record.event == LogEvent::rejected ||
+            record.event == LogEvent::queued ||
+            record.event == LogEvent::sending)
+    {
+        text += " dest " + name(record.to);
+    }
+
+    if (record.event == LogEvent::sending)
+    {
+        text += " (queued " + std::to_string(record.count) + " us)";
+    }
+    else if (record.event == LogEvent::duplicate)
+    {
+        text += " (" + std::to_string(record.count) + " duplicates)";
     }
+
+    return text;
 }
 
 
@@ -99,7 +540,89 @@ unsigned int Logger::level()
 }
 
 
+/** Enable or disable asynchronous logging.
+ *
+ *  When enabled, messages are added to a lock-free ring owned by the logging
+ *  thread and written to stdout by a separate writer thread.  Disabling
+ *  asynchronous logging writes any waiting messages and stops the writer
+ *  thread.
+ *
+ *  \note Asynchronous logging must be disabled before the program exits.
+ *
+ *  \param enabled Set to true to enable asynchronous logging or false to
+ *      write messages as they are logged (the default).
+ */
+void Logger::async(bool enabled)
+{
+    if (enabled && !writer_.joinable())
+    {
+        async_.store(true, std::memory_order_release);
+        writer_ = std::thread(&Logger::run_writer_);
+    }
+    else if (!enabled && writer_.joinable())
+    {
+        async_.store(false);
+        writer_.join();
+
+        // Write messages pushed after the writer's last pass, by threads
+        // that saw asynchronous logging still enabled.
+        std::vector<std::shared_ptr<LogRing>> rings;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            rings = rings_;
+        }
+
+        for (const auto &ring : rings)
+        {
+            while (ring->pushing())
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        std::time_t last_time = -1;
+        std::string timestamp;
+
+        while (write_(last_time, timestamp))
+        {
+        }
+    }
+}
+
+
+/** Wait for all asynchronously logged messages to be written.
+ *
+ *  Returns immediately if asynchronous logging is not enabled.
+ */
+void Logger::flush()
+{
+    while (async_.load(std::memory_order_acquire))
+    {
+        std::vector<std::shared_ptr<LogRing>> rings;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            rings = rings_;
+        }
+
+        auto empty = [](const auto & ring)
+        {
+            return ring->peek() == nullptr;
+        };
+
+        if (std::all_of(rings.begin(), rings.end(), empty))
+        {
+            return;
+        }
+
+        std::this_thread::sleep_for(1ms);
+    }
+}
+
+
 unsigned int Logger::level_ = 0;
+std::atomic<bool> Logger::async_(false);
 
 
 #ifdef __clang__
@@ -109,6 +632,14 @@ unsigned int Logger::level_ = 0;
 #endif
 
 std::mutex Logger::mutex_;
+std::vector<std::shared_ptr<LogRing>> Logger::rings_;
+std::thread Logger::writer_;
+// Id 0 is reserved for unknown connections.
+std::vector<std::string> Logger::names_ = {"unknown"};
+std::unordered_map<std::string, unsigned int> Logger::name_ids_ =
+{
+    {"unknown", 0}
+};
 
 #ifdef __clang__
     #pragma clang diagnostic pop
@@ -19,21 +19,51 @@
 #define LOGGER_HPP_
 
 
+#include <atomic>
+#include <ctime>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "LogRing.hpp"
+#include "Packet.hpp"
 
 
 /** A global static logger for use by all of mavtables.
  *
  *  \note Only supports writing to stdout.
+ *
+ *  By default messages are written as they are logged.  In asynchronous mode
+ *  each thread instead adds its messages to its own \ref LogRing and a single
+ *  writer thread formats them and writes them to stdout in batches, so logging
+ *  never blocks the threads routing packets.
+ *
+ *  Packet events are logged as binary records holding the packet header
+ *  fields and the ids of the connection names involved (see \ref
+ *  register_name).  They are only rendered to text when written.
  */
 class Logger
 {
     public:
         static void log(std::string message);
         static void log(unsigned int level, std::string message);
+        static void log(
+            unsigned int level, LogEvent event, const Packet &packet,
+            unsigned int from = 0, unsigned int to = 0,
+            unsigned long count = 0);
+        static void trace(
+            LogEvent event, const Packet &packet, unsigned int from = 0,
+            unsigned int to = 0, unsigned long count = 0);
+        static unsigned int register_name(const std::string &name);
+        static std::vector<std::string> names();
+        static std::string render(const LogRecord &record);
         static void level(unsigned int level);
         static unsigned int level();
+        static void async(bool enabled);
+        static void flush();
 
     private:
         Logger(const Logger &logger) = delete;
@@ -41,6 +71,20 @@ class Logger
         Logger() = default;
         static unsigned int level_;
         static std::mutex mutex_;
+        static std::atomic<bool> async_;
+        static std::vector<std::shared_ptr<LogRing>> rings_;
+        static std::thread writer_;
+        static std::vector<std::string> names_;
+        static std::unordered_map<std::string, unsigned int> name_ids_;
+        static void log_(
+            LogEvent event, const Packet &packet, unsigned int from,
+            unsigned int to, unsigned long count);
+        static void output_(std::time_t time, const std::string &message);
+        static bool push_(const LogRecord &record);
+        static bool push_(std::time_t time, const std::string &message);
+        static LogRing &ring_();
+        static bool write_(std::time_t &last_time, std::string &timestamp);
+        static void run_writer_();
 };
 
 
@@ -54,6 +54,8 @@ Options::Options(
     ("help,h", "print this message")
     ("config", po::value<std::string>(), "specify configuration file")
     ("ast", "print AST of configuration file (do not run)")
+    ("stats", "print statistics of the running mavtables")
+    ("rules", "print rule hit counts of the running mavtables")
     ("version", "print version and license information")
     ("loglevel", po::value<unsigned int>(),
      "level of logging, between 0 and 3");
@@ -123,7 +125,9 @@ Options::Options(
 
     // Determine actions.
     print_ast_ = vm.count("ast");
-    run_firewall_ = !print_ast_;
+    print_stats_ = vm.count("stats");
+    print_rules_ = vm.count("rules");
+    run_firewall_ = !print_ast_ && !print_stats_ && !print_rules_;
 }
 
 
@@ -170,6 +174,31 @@ bool Options::run()
 }
 
 
+/** Determine whether to print the filter rules of the running firewall/router.
+ *
+ *  \retval true Print the filter rules, with the number of packets matched by
+ *      each rule, from the statistics served on the socket given by the
+ *      configuration file's `stats` statement.
+ *  \retval false Don't print the filter rules.
+ */
+bool Options::rules()
+{
+    return print_rules_;
+}
+
+
+/** Determine whether to print the statistics of the running firewall/router.
+ *
+ *  \retval true Print the statistics served on the socket given by the
+ *      configuration file's `stats` statement.
+ *  \retval false Don't print the statistics.
+ */
+bool Options::stats()
+{
+    return print_stats_;
+}
+
+
 /** Determine if the \ref Options object is valid.
  *
  *  \retval true %If the options object successfully parsed the command line
@@ -35,6 +35,8 @@
  *  -h [ --help ]         print this message
  *  --config arg          specify configuration file
  *  --ast                 print AST of configuration file (do not run)
+ *  --stats               print statistics of the running mavtables
+ *  --rules               print rule hit counts of the running mavtables
  *  --version             print version and license information
  *  --loglevel arg        level of logging, between 0 and 3
  *  ```
@@ -48,7 +50,9 @@ class Options
         bool ast();
         unsigned int loglevel();
         std::string config_file();
+        bool rules();
         bool run();
+        bool stats();
         explicit operator bool() const;
 
     private:
@@ -56,6 +60,8 @@ class Options
         unsigned int loglevel_;
         std::string config_file_;
         bool print_ast_;
+        bool print_stats_;
+        bool print_rules_;
         bool run_firewall_;
 };
 
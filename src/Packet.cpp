@@ -15,6 +15,7 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -27,11 +28,13 @@
 
 
 /** Construct a packet.
+ *
+ *  The receive timestamp is set to the current time.
  *
  *  \param data Raw packet data.
  */
 Packet::Packet(std::vector<uint8_t> data)
-    : data_(std::move(data))
+    : data_(std::move(data)), timestamp_(std::chrono::steady_clock::now())
 {
 }
 
@@ -78,6 +81,32 @@ const std::shared_ptr<Connection> Packet::connection() const
 }
 
 
+/** Set the time the packet was received.
+ *
+ *  This is used by interfaces that know when the packet arrived more precisely
+ *  than when it was parsed, such as from a kernel timestamp.
+ *
+ *  \param time The (monotonic) time the packet was received.
+ *  \sa timestamp()
+ */
+void Packet::timestamp(std::chrono::steady_clock::time_point time)
+{
+    timestamp_ = time;
+}
+
+
+/** Get the time the packet was received.
+ *
+ *  \returns The (monotonic) time the packet was received, which defaults to
+ *      the time it was constructed.
+ *  \sa timestamp(std::chrono::steady_clock::time_point)
+ */
+std::chrono::steady_clock::time_point Packet::timestamp() const
+{
+    return timestamp_;
+}
+
+
 /** Equality comparison.
  *
  *  Compares the raw packet data.
@@ -19,6 +19,7 @@
 #define PACKET_HPP_
 
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -96,9 +97,23 @@ class Packet
          *      address then {} will be returned.
          */
         virtual std::optional<MAVAddress> dest() const = 0;
+        /** Return sequence number.
+         *
+         *  \returns The sequence number of the packet (0 to 255), set by the
+         *      sender and incremented for each packet it sends.
+         */
+        virtual unsigned int sequence() const = 0;
+        /** Return packet checksum.
+         *
+         *  \returns The CRC-16/MCRF4XX checksum of the packet, as sent on the
+         *      wire.
+         */
+        virtual uint16_t checksum() const = 0;
         void connection(std::weak_ptr<Connection> connection);
         const std::shared_ptr<Connection> connection() const;
         const std::vector<uint8_t> &data() const;
+        void timestamp(std::chrono::steady_clock::time_point time);
+        std::chrono::steady_clock::time_point timestamp() const;
         /** Assignment operator.
          *
          *  \param other Packet to copy from.
@@ -113,6 +128,7 @@ class Packet
     private:
         std::vector<uint8_t> data_;
         std::weak_ptr<Connection> connection_;
+        std::chrono::steady_clock::time_point timestamp_;
 };
 
 
@@ -15,12 +15,14 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <stdexcept>
 #include <utility>
 
 #include "InvalidPacketIDError.hpp"
+#include "MAVAddress.hpp"
 #include "mavlink.hpp"
 #include "PacketParser.hpp"
 #include "PacketVersion1.hpp"
@@ -30,7 +32,8 @@
 /** Construct a \ref PacketParser.
  */
 PacketParser::PacketParser()
-    : state_(WAITING_FOR_START_BYTE)
+    : state_(WAITING_FOR_START_BYTE), payload_remaining_(0), crc_(0),
+      checksum_(0)
 {
     clear();
 }
@@ -86,12 +89,42 @@ std::unique_ptr<Packet> PacketParser::parse_byte(uint8_t byte)
 
         case WAITING_FOR_PACKET:
             packet = waiting_for_packet_(byte);
+            break;
+
+        case SKIPPING_PACKET:
+            skipping_packet_(byte);
     }
 
     return packet;
 }
 
 
+/** Set a filter to apply to each packet as soon as it's header is parsed.
+ *
+ *  The \p prefilter is called with the packet ID and source address of each
+ *  packet once it's header has been received.  %If it returns false the rest
+ *  of the packet is skipped and no \ref Packet is constructed for it.
+ *
+ *  The checksum of a skipped packet is still computed as it is skipped.  %If
+ *  the packet ID is known and the checksum is valid, \p skipped is called with
+ *  the source address of the packet once it's last byte has been parsed.  This
+ *  allows the address to be learned without trusting line noise, truncated
+ *  packets or packets with unknown IDs.
+ *
+ *  \param prefilter Function deciding whether a packet should be parsed.  An
+ *      empty function parses every packet.
+ *  \param skipped Function called with the source address of each valid
+ *      packet that was skipped.
+ */
+void PacketParser::prefilter(
+    std::function<bool(unsigned long, const MAVAddress &)> prefilter,
+    std::function<void(const MAVAddress &)> skipped)
+{
+    prefilter_ = std::move(prefilter);
+    skipped_ = std::move(skipped);
+}
+
+
 /** Check for start of packet.
  *
  *  Start packet parsing if the given \p byte is a start byte for either v1.0 or
@@ -121,7 +154,7 @@ void PacketParser::waiting_for_start_byte_(uint8_t byte)
 /** Parser header byte.
  *
  *  Next state will be `WAITING_FOR_PACKET` if the given \p byte completes the
- *  header.
+ *  header, or `SKIPPING_PACKET` if the packet is rejected by the prefilter.
  *
  *  \param byte The byte to attempt parsing.
  */
@@ -136,9 +169,16 @@ void PacketParser::waiting_for_header_(uint8_t byte)
             {
                 // Set number of expected bytes and start waiting for
                 // remainder of packet.
-                bytes_remaining_ = packet_v1::header(buffer_)->len +
-                                   packet_v1::CHECKSUM_LENGTH;
+                const auto header = packet_v1::header(buffer_);
+                bytes_remaining_ = header->len + packet_v1::CHECKSUM_LENGTH;
                 state_ = WAITING_FOR_PACKET;
+
+                if (prefilter_ && !prefilter_(
+                            header->msgid,
+                            MAVAddress(header->sysid, header->compid)))
+                {
+                    start_skipping_();
+                }
             }
 
             break;
@@ -148,8 +188,8 @@ void PacketParser::waiting_for_header_(uint8_t byte)
             {
                 // Set number of expected bytes and start waiting for
                 // remainder of packet.
-                bytes_remaining_ = packet_v2::header(buffer_)->len +
-                                   packet_v2::CHECKSUM_LENGTH;
+                const auto header = packet_v2::header(buffer_);
+                bytes_remaining_ = header->len + packet_v2::CHECKSUM_LENGTH;
 
                 if (packet_v2::is_signed(buffer_))
                 {
@@ -157,6 +197,13 @@ void PacketParser::waiting_for_header_(uint8_t byte)
                 }
 
                 state_ = WAITING_FOR_PACKET;
+
+                if (prefilter_ && !prefilter_(
+                            header->msgid,
+                            MAVAddress(header->sysid, header->compid)))
+                {
+                    start_skipping_();
+                }
             }
 
             break;
@@ -210,3 +257,118 @@ std::unique_ptr<Packet> PacketParser::waiting_for_packet_(uint8_t byte)
 
     return nullptr;
 }
+
+
+/** Discard the bytes of a packet rejected by the prefilter.
+ *
+ *  The bytes are not buffered, but the payload is added to the running
+ *  checksum and the packet's checksum is kept.  Once the last byte of the
+ *  packet is consumed the source address is passed to the skipped packet
+ *  function, if the checksum is valid, and the parser is reset (next state
+ *  WAITING_FOR_START_BYTE).
+ *
+ *  \param byte The byte to discard.
+ */
+void PacketParser::skipping_packet_(uint8_t byte)
+{
+    if (payload_remaining_ > 0)
+    {
+        crc_accumulate(byte, &crc_);
+        --payload_remaining_;
+    }
+    else
+    {
+        // The checksum is the first two (little endian) bytes after the
+        // payload, followed by the signature (if any).
+        auto trailer = packet_v2::CHECKSUM_LENGTH;
+
+        if (version_ == packet_v2::VERSION && packet_v2::is_signed(buffer_))
+        {
+            trailer += packet_v2::SIGNATURE_LENGTH;
+        }
+
+        auto index = trailer - bytes_remaining_;
+
+        if (index < 2)
+        {
+            checksum_ |= static_cast<uint16_t>(byte << (8 * index));
+        }
+    }
+
+    --bytes_remaining_;
+
+    if (bytes_remaining_ == 0)
+    {
+        const mavlink_msg_entry_t *msg_entry = nullptr;
+
+        switch (version_)
+        {
+            case packet_v1::VERSION:
+                msg_entry = mavlink_get_msg_entry(
+                                packet_v1::header(buffer_)->msgid);
+                break;
+
+            case packet_v2::VERSION:
+                msg_entry = mavlink_get_msg_entry(
+                                packet_v2::header(buffer_)->msgid);
+                break;
+        }
+
+        if (msg_entry != nullptr)
+        {
+            crc_accumulate(msg_entry->crc_extra, &crc_);
+
+            if (crc_ == checksum_ && skipped_)
+            {
+                skipped_(source_());
+            }
+        }
+
+        clear();
+    }
+}
+
+
+/** Get the source address from the buffered header.
+ *
+ *  \returns The source address of the packet being parsed.
+ */
+MAVAddress PacketParser::source_() const
+{
+    if (version_ == packet_v1::VERSION)
+    {
+        const auto header = packet_v1::header(buffer_);
+        return MAVAddress(header->sysid, header->compid);
+    }
+
+    const auto header = packet_v2::header(buffer_);
+    return MAVAddress(header->sysid, header->compid);
+}
+
+
+/** Start skipping a packet rejected by the prefilter.
+ *
+ *  Starts the running checksum with the buffered header, which is kept until
+ *  the packet has been skipped.  Next state will be `SKIPPING_PACKET`.
+ */
+void PacketParser::start_skipping_()
+{
+    state_ = SKIPPING_PACKET;
+    checksum_ = 0;
+    crc_init(&crc_);
+
+    // The checksum covers the header, except for the start byte.
+    for (auto it = buffer_.begin() + 1; it != buffer_.end(); ++it)
+    {
+        crc_accumulate(*it, &crc_);
+    }
+
+    if (version_ == packet_v1::VERSION)
+    {
+        payload_remaining_ = packet_v1::header(buffer_)->len;
+    }
+    else
+    {
+        payload_remaining_ = packet_v2::header(buffer_)->len;
+    }
+}
@@ -19,8 +19,11 @@
 #define PACKETPARSER_HPP_
 
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 
+#include "MAVAddress.hpp"
 #include "Packet.hpp"
 #include "PacketVersion1.hpp"
 #include "PacketVersion2.hpp"
@@ -39,6 +42,9 @@ class PacketParser
         size_t bytes_parsed() const;
         void clear();
         std::unique_ptr<Packet> parse_byte(uint8_t byte);
+        void prefilter(
+            std::function<bool(unsigned long, const MAVAddress &)> prefilter,
+            std::function<void(const MAVAddress &)> skipped = {});
         PacketParser &operator=(const PacketParser &other) = delete;
         PacketParser &operator=(PacketParser &&other) = delete;
 
@@ -50,17 +56,26 @@ class PacketParser
         {
             WAITING_FOR_START_BYTE,  //!< Waiting for a magic start byte.
             WAITING_FOR_HEADER,      //!< Waiting for complete header.
-            WAITING_FOR_PACKET       //!< Waitinf for complete packet.
+            WAITING_FOR_PACKET,      //!< Waitinf for complete packet.
+            SKIPPING_PACKET          //!< Discarding a rejected packet.
         };
         // Variables
         std::vector<uint8_t> buffer_;
         PacketParser::State state_;
         Packet::Version version_;
         size_t bytes_remaining_;
+        std::function<bool(unsigned long, const MAVAddress &)> prefilter_;
+        std::function<void(const MAVAddress &)> skipped_;
+        size_t payload_remaining_;
+        uint16_t crc_;
+        uint16_t checksum_;
         // Methods
+        MAVAddress source_() const;
+        void start_skipping_();
         void waiting_for_start_byte_(uint8_t byte);
         void waiting_for_header_(uint8_t byte);
         std::unique_ptr<Packet> waiting_for_packet_(uint8_t byte);
+        void skipping_packet_(uint8_t byte);
 };
 
 
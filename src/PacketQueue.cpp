@@ -15,7 +15,9 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
+#include <algorithm>
 #include <condition_variable>
+#include <cstddef>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -54,9 +56,17 @@ std::shared_ptr<const Packet> PacketQueue::get_packet_()
  *  \param callback A function to call whenever a new packet is added to the
  *      queue.  This allows the queue to signal when it has become non empty.
  *      The default is no callback {}.
+ *  \param ready_callback A function to call when a packet is added to an
+ *      empty queue.  This is called before \p callback and allows a consumer
+ *      of many queues to keep track of which ones have packets.  The default
+ *      is no callback {}.
  */
-PacketQueue::PacketQueue(std::optional<std::function<void(void)>> callback)
-    : callback_(std::move(callback)), ticket_(0), running_(true)
+PacketQueue::PacketQueue(
+    std::optional<std::function<void(void)>> callback,
+    std::optional<std::function<void(void)>> ready_callback)
+    : callback_(std::move(callback)),
+      ready_callback_(std::move(ready_callback)), ticket_(0), high_water_(0),
+      running_(true)
 {
 }
 
@@ -91,6 +101,19 @@ bool PacketQueue::empty()
 }
 
 
+/** Get the most packets that have ever been waiting in the queue.
+ *
+ *  \returns The high-water mark of the queue's \ref size.
+ *  \remarks
+ *      Threadsafe (locking).
+ */
+std::size_t PacketQueue::high_water()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return high_water_;
+}
+
+
 /** Remove and return the packet at the front of the queue.
  *
  *  This version will block on an empty queue and will not return until the
@@ -131,6 +154,30 @@ std::shared_ptr<const Packet> PacketQueue::pop()
  */
 std::shared_ptr<const Packet> PacketQueue::pop(
     const std::chrono::nanoseconds &timeout)
+{
+    if (auto queued = pop_queued(timeout))
+    {
+        return queued->packet();
+    }
+
+    return nullptr;
+}
+
+
+/** Remove and return the queue entry at the front of the queue.
+ *
+ *  This is the same as \ref pop(const std::chrono::nanoseconds &) but also
+ *  returns the priority of the packet and the time it was queued.
+ *
+ *  \param timeout How long to block waiting for an empty queue.  Set to 0s for
+ *      non blocking.
+ *  \returns The queue entry that was at the front of the queue, or {} if the
+ *      queue was closed or the timeout expired.
+ *  \remarks
+ *      Threadsafe (locking).
+ */
+std::optional<QueuedPacket> PacketQueue::pop_queued(
+    const std::chrono::nanoseconds &timeout)
 {
     std::unique_lock<std::mutex> lock(mutex_);
 
@@ -143,8 +190,15 @@ std::shared_ptr<const Packet> PacketQueue::pop(
         });
     }
 
-    // Return the packet if the queue is running and is not empty.
-    return get_packet_();
+    // Return the entry if the queue is running and is not empty.
+    if (running_ && !queue_.empty())
+    {
+        QueuedPacket queued = queue_.top();
+        queue_.pop();
+        return queued;
+    }
+
+    return {};
 }
 
 
@@ -168,17 +222,40 @@ void PacketQueue::push(std::shared_ptr<const Packet> packet, int priority)
         throw std::invalid_argument("Given packet pointer is null.");
     }
 
+    bool was_empty;
+
     // Add the packet to the queue.
     {
         std::lock_guard<std::mutex> lock(mutex_);
+        was_empty = queue_.empty();
         queue_.emplace(std::move(packet), priority, ticket_++);
+        high_water_ = std::max(high_water_, queue_.size());
     }
     // Notify a waiting pop.
     cv_.notify_one();
 
+    // Trigger the ready callback.
+    if (was_empty && ready_callback_)
+    {
+        (*ready_callback_)();
+    }
+
     // Trigger the callback.
     if (callback_)
     {
         (*callback_)();
     }
 }
+
+
+/** Get the number of packets waiting in the queue.
+ *
+ *  \returns The number of packets in the queue.
+ *  \remarks
+ *      Threadsafe (locking).
+ */
+std::size_t PacketQueue::size()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
@@ -20,6 +20,7 @@
 
 
 #include <condition_variable>
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -45,22 +46,30 @@
 class PacketQueue
 {
     public:
-        PacketQueue(std::optional<std::function<void(void)>> callback = {});
+        PacketQueue(
+            std::optional<std::function<void(void)>> callback = {},
+            std::optional<std::function<void(void)>> ready_callback = {});
         // LCOV_EXCL_START
         TEST_VIRTUAL ~PacketQueue() = default;
         // LCOV_EXCL_STOP
         TEST_VIRTUAL void close();
         TEST_VIRTUAL bool empty();
+        TEST_VIRTUAL std::size_t high_water();
         TEST_VIRTUAL std::shared_ptr<const Packet> pop();
         TEST_VIRTUAL std::shared_ptr<const Packet> pop(
             const std::chrono::nanoseconds &timeout);
+        TEST_VIRTUAL std::optional<QueuedPacket> pop_queued(
+            const std::chrono::nanoseconds &timeout);
         TEST_VIRTUAL void push(
             std::shared_ptr<const Packet> packet, int priority = 0);
+        TEST_VIRTUAL std::size_t size();
 
     private:
         // Variables.
         std::optional<std::function<void(void)>> callback_;
+        std::optional<std::function<void(void)>> ready_callback_;
         unsigned long long ticket_;
+        std::size_t high_water_;
         bool running_;
         std::priority_queue<QueuedPacket> queue_;
         std::mutex mutex_;
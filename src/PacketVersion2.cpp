@@ -147,6 +147,20 @@ namespace packet_v2
     }
 
 
+    unsigned int Packet::sequence() const
+    {
+        return header(data())->seq;
+    }
+
+
+    uint16_t Packet::checksum() const
+    {
+        // The checksum is little endian and immediately follows the payload.
+        auto i = HEADER_LENGTH + header(data())->len;
+        return static_cast<uint16_t>(data()[i] | (data()[i + 1] << 8));
+    }
+
+
     /** \copydoc ::Packet::dest()
      *
      *  \thanks The [mavlink-router](https://github.com/intel/mavlink-router)
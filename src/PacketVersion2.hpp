@@ -77,6 +77,8 @@ namespace packet_v2
             virtual std::string name() const;
             virtual MAVAddress source() const;
             virtual std::optional<MAVAddress> dest() const;
+            virtual unsigned int sequence() const;
+            virtual uint16_t checksum() const;
             /** Assignment operator.
              *
              *  \param other Packet to copy from.
@@ -15,6 +15,7 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
+#include <chrono>
 #include <limits>
 #include <memory>
 #include <ostream>
@@ -24,6 +25,8 @@
 
 
 /** Construct a queued packet.
+ *
+ *  The queue timestamp is set to the current time.
  *
  *  \param packet The packet to store in the queue.
  *  \param priority The priority to send the packet with, higher numbers result
@@ -37,7 +40,8 @@ QueuedPacket::QueuedPacket(
     std::shared_ptr<const Packet> packet, int priority,
     unsigned long long ticket_number)
     : packet_(std::move(packet)), priority_(priority),
-      ticket_number_(ticket_number)
+      ticket_number_(ticket_number),
+      timestamp_(std::chrono::steady_clock::now())
 {
     if (packet_ == nullptr)
     {
@@ -56,6 +60,26 @@ std::shared_ptr<const Packet> QueuedPacket::packet() const
 }
 
 
+/** Return the priority of the packet.
+ *
+ *  \returns The priority the packet was queued with.
+ */
+int QueuedPacket::priority() const
+{
+    return priority_;
+}
+
+
+/** Return the time the packet was queued.
+ *
+ *  \returns The (monotonic) time the packet was added to the queue.
+ */
+std::chrono::steady_clock::time_point QueuedPacket::timestamp() const
+{
+    return timestamp_;
+}
+
+
 /** Equality comparison.
  *
  *  \note It should never be the case that two queued packets have the same
@@ -19,6 +19,7 @@
 #define QUEUEDPACKET_HPP_
 
 
+#include <chrono>
 #include <memory>
 #include <ostream>
 
@@ -32,7 +33,8 @@
  *  This is the data structure used in the priority queues used by the \ref
  *  Connection class.  It stores a MAVLink packet as well as a priority and
  *  ticket number used to maintain packet order in the priority queue when
- *  packets have the same priority.
+ *  packets have the same priority.  The time the packet was queued is also
+ *  stored, so the time it spent in the queue can be measured.
  *
  *  \sa PacketQueue
  */
@@ -53,6 +55,8 @@ class QueuedPacket
             std::shared_ptr<const Packet> packet, int priority,
             unsigned long long ticket_number);
         std::shared_ptr<const Packet> packet() const;
+        int priority() const;
+        std::chrono::steady_clock::time_point timestamp() const;
         /** Assignment operator.
          *
          * \param other QueuedPacket to copy from.
@@ -83,6 +87,7 @@ class QueuedPacket
         std::shared_ptr<const Packet> packet_;
         int priority_;
         unsigned long long ticket_number_;
+        std::chrono::steady_clock::time_point timestamp_;
 };
 
 bool operator==(const QueuedPacket &lhs, const QueuedPacket &rhs);
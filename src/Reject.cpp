@@ -72,7 +72,7 @@ std::ostream &Reject::print_(std::ostream &os) const
 Action Reject::action(
     const Packet &packet, const MAVAddress &address) const
 {
-    if (!condition_ || condition_->check(packet, address))
+    if (matches_(packet, address))
     {
         return Action::make_reject();
     }
@@ -81,6 +81,24 @@ Action Reject::action(
 }
 
 
+/** \copydoc Rule::may_accept(unsigned long,const MAVAddress&,bool)const
+ *
+ *  The packet is rejected if the condition matches for every destination.
+ */
+std::optional<bool> Reject::may_accept(
+    unsigned long id, const MAVAddress &source, bool accept_by_default) const
+{
+    (void)accept_by_default;
+
+    if (check_(id, source) == true)
+    {
+        return false;
+    }
+
+    return {};
+}
+
+
 std::unique_ptr<Rule> Reject::clone() const
 {
     return std::make_unique<Reject>(condition_);
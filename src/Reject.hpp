@@ -38,6 +38,9 @@ class Reject : public Rule
         Reject(std::optional<If> condition = {});
         virtual Action action(
             const Packet &packet, const MAVAddress &address) const;
+        virtual std::optional<bool> may_accept(
+            unsigned long id, const MAVAddress &source,
+            bool accept_by_default) const;
         virtual std::unique_ptr<Rule> clone() const;
         virtual bool operator==(const Rule &other) const;
         virtual bool operator!=(const Rule &other) const;
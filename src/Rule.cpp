@@ -19,6 +19,7 @@
 #include <ostream>
 #include <utility>
 
+#include "Counters.hpp"
 #include "Rule.hpp"
 
 
@@ -36,6 +37,18 @@ Rule::Rule(std::optional<If> condition)
 }
 
 
+/** Copy constructor.
+ *
+ *  Only the condition is copied, the copy starts with no hits.
+ *
+ *  \param other Rule to copy from.
+ */
+Rule::Rule(const Rule &other)
+    : condition_(other.condition_)
+{
+}
+
+
 // GCC generates a seemingly uncallable destructor for pure virtual classes.
 // Therefore, it must be excluded from test coverage.
 // LCOV_EXCL_START
@@ -45,6 +58,116 @@ Rule::~Rule()
 // LCOV_EXCL_STOP
 
 
+/** Decide whether a packet may be accepted, from only its header.
+ *
+ *  This is a conservative version of \ref action for when the destination of
+ *  the packet is not yet known.  It is used to drop packets that can not be
+ *  accepted for any destination before they are fully received.
+ *
+ *  The base implementation assumes the packet may be accepted.
+ *
+ *  \param id The packet ID (message type) of the packet.
+ *  \param source The source address of the packet.
+ *  \param accept_by_default Whether the filter accepts packets that reach the
+ *      default action.
+ *  \retval true %If the packet may be accepted for some destination.
+ *  \retval false %If the packet is rejected for every destination.
+ *  \returns Nothing if the packet is not accepted by this rule for any
+ *      destination and evaluation may continue with the next rule.
+ */
+std::optional<bool> Rule::may_accept(
+    unsigned long id, const MAVAddress &source, bool accept_by_default) const
+{
+    (void)id;
+    (void)source;
+    (void)accept_by_default;
+    return true;
+}
+
+
+/** Get the \ref Chain this rule delegates to.
+ *
+ *  The base implementation does not delegate to a chain.
+ *
+ *  \returns The chain given to a \ref Call or \ref GoTo rule, or nullptr for
+ *      rules that decide packets themselves.
+ */
+const Chain *Rule::chain() const
+{
+    return nullptr;
+}
+
+
+/** Get the number of packets the rule has matched.
+ *
+ *  A packet matches a rule if the rule has no condition or its condition
+ *  matches the packet/address combination given to \ref action, even if the
+ *  rule does not decide the packet (such as a \ref Call to a chain that
+ *  returns the continue action).
+ *
+ *  \returns The number of matched packets, from all threads.
+ */
+unsigned long long Rule::hits() const
+{
+    return hits_.value(0);
+}
+
+
+/** Assignment operator.
+ *
+ *  Only the condition is copied, the hits are kept.
+ *
+ *  \param other Rule to copy from.
+ */
+Rule &Rule::operator=(const Rule &other)
+{
+    condition_ = other.condition_;
+    return *this;
+}
+
+
+/** Check the condition of the rule, from only the header of a packet.
+ *
+ *  \param id The packet ID (message type) of the packet.
+ *  \param source The source address of the packet.
+ *  \retval true %If the condition is not set or matches for every
+ *      destination.
+ *  \retval false %If the condition does not match for any destination.
+ *  \returns Nothing if the condition depends on the destination.
+ */
+std::optional<bool> Rule::check_(
+    unsigned long id, const MAVAddress &source) const
+{
+    if (!condition_)
+    {
+        return true;
+    }
+
+    return condition_->check(id, source);
+}
+
+
+/** Check the condition of the rule, counting the packet if it matches.
+ *
+ *  \param packet The packet to check the condition against.
+ *  \param address The address the \p packet will be sent out on.
+ *  \retval true %If the condition is not set or matches the packet/address
+ *      combination.
+ *  \retval false %If the condition does not match.
+ *  \sa hits
+ */
+bool Rule::matches_(const Packet &packet, const MAVAddress &address) const
+{
+    if (condition_ && !condition_->check(packet, address))
+    {
+        return false;
+    }
+
+    hits_.add(0);
+    return true;
+}
+
+
 /** Print the given rule to the given output stream.
  *
  *  \note This is a polymorphic print, it will work on any child of \ref Rule
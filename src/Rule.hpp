@@ -24,21 +24,28 @@
 #include <ostream>
 
 #include "Action.hpp"
+#include "Counters.hpp"
 #include "If.hpp"
 #include "MAVAddress.hpp"
 #include "Packet.hpp"
 
 
+class Chain;
+
+
 /** Base class of all rules, used in filter \ref Chain's.
  *
  *  \ref Rule's are used to determine an \ref Action to take with a packet based
  *  on its type, source address, and destination address.  They are very much
  *  like the rules found in a typical software defined firewalls.
+ *
+ *  Each rule counts the packets its condition matched, see \ref hits.
  */
 class Rule
 {
     public:
         Rule(std::optional<If> condition = {});
+        Rule(const Rule &other);
         virtual ~Rule();  // Clang does not like pure virtual destructors.
         /** Decide what to do with a \ref Packet.
          *
@@ -55,6 +62,9 @@ class Rule
          */
         virtual Action action(
             const Packet &packet, const MAVAddress &address) const = 0;
+        virtual std::optional<bool> may_accept(
+            unsigned long id, const MAVAddress &source,
+            bool accept_by_default) const;
         /** Return a copy of the Rule polymorphically.
          *
          *  This allows Rule's to be copied without knowing the derived type.
@@ -63,6 +73,9 @@ class Rule
          *      is an exact copy of this one.
          */
         virtual std::unique_ptr<Rule> clone() const = 0;
+        virtual const Chain *chain() const;
+        unsigned long long hits() const;
+        Rule &operator=(const Rule &other);
         /** Equality comparison.
          *
          *  Compares the type of the \ref Rule and the condition (\ref If) if
@@ -90,12 +103,18 @@ class Rule
         // Variables
         std::optional<If> condition_;
         // Methods
+        std::optional<bool> check_(
+            unsigned long id, const MAVAddress &source) const;
+        bool matches_(const Packet &packet, const MAVAddress &address) const;
         /** Print the rule to the given output stream.
          *
          *  \param os The output stream to print to.
          *  \returns The output stream.
          */
         virtual std::ostream &print_(std::ostream &os) const = 0;
+
+    private:
+        mutable Counters<1> hits_;
 };
 
 
@@ -15,14 +15,26 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
+#include <algorithm>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <stdexcept>
+#include <vector>
 
 #include "Connection.hpp"
 #include "ConnectionPool.hpp"
+#include "MAVAddress.hpp"
+#include "Packet.hpp"
 #include "SerialInterface.hpp"
 #include "SerialPort.hpp"
+#include "Stats.hpp"
+#include "tracepoints.hpp"
+
+
+using namespace std::chrono_literals;
 
 
 /** Construct a serial port interface using a given device.
@@ -32,6 +44,12 @@
  *      interface has received and to register the \p connection with.
  *  \param connection The connection to get packets to send packets from.  This
  *      will be registered with the given \ref ConnectionPool.
+ *  \param max_queued The maximum number of bytes to keep in the serial port's
+ *      output buffer.  This is also the most data (beyond the first packet)
+ *      that will be combined into a single write.  Keeping this small ensures
+ *      packets are reordered by priority in mavtables instead of being stuck
+ *      behind lower priority packets in the operating system's buffer.  The
+ *      default is 256 bytes.
  *  \throws std::invalid_argument if the serial \p port device pointer is null.
  *  \throws std::invalid_argument if the \p connection_pool pointer is null.
  *  \throws std::invalid_argument if the \p connection pointer is null.
@@ -39,10 +57,12 @@
 SerialInterface::SerialInterface(
     std::unique_ptr<SerialPort> port,
     std::shared_ptr<ConnectionPool> connection_pool,
-    std::unique_ptr<Connection> connection)
+    std::unique_ptr<Connection> connection,
+    std::size_t max_queued)
     : port_(std::move(port)),
       connection_pool_(std::move(connection_pool)),
-      connection_(std::move(connection))
+      connection_(std::move(connection)),
+      max_queued_(max_queued), offset_(0)
 {
     if (port_ == nullptr)
     {
@@ -60,20 +80,108 @@ SerialInterface::SerialInterface(
     }
 
     connection_pool_->add(connection_);
+    // Only parse packets that some connection may accept, but still learn
+    // the addresses of valid packets that are skipped.
+    parser_.prefilter(
+        [this](unsigned long id, const MAVAddress &source)
+    {
+        return connection_pool_->may_accept(id, source);
+    },
+    [this](const MAVAddress &source)
+    {
+        connection_->add_address(source);
+    });
 }
 
 
 /** \copydoc Interface::send_packet(const std::chrono::nanoseconds &)
  *
- *  Writes up to one packet from the contained connection to the serial port.
+ *  Waits for the serial port's output buffer to drain and then writes the next
+ *  packet from the contained connection, along with any other queued packets
+ *  that fit, to the serial port in a single write.  If only part of the data
+ *  could be written the rest is written on the next call (before any new
+ *  packets).  The time spent waiting for the output buffer counts against the
+ *  \p timeout.
  */
 void SerialInterface::send_packet(const std::chrono::nanoseconds &timeout)
 {
-    auto packet = connection_->next_packet(timeout);
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    // Keep the serial port's output buffer shallow.
+    if (!port_->wait_for_output(max_queued_, timeout))
+    {
+        return;
+    }
+
+    // Wait for a packet if there is nothing left over from the last write.
+    if (pending_.empty())
+    {
+        auto remaining = std::max(
+                             std::chrono::nanoseconds(0),
+                             std::chrono::duration_cast<
+                             std::chrono::nanoseconds>(
+                                 deadline - std::chrono::steady_clock::now()));
+        auto packet = connection_->next_packet(remaining);
+
+        if (packet == nullptr)
+        {
+            return;
+        }
+
+        pending_.push_back(std::move(packet));
+    }
+
+    // Combine any other waiting packets into the same write.
+    std::size_t bytes = 0;
+
+    for (const auto &packet : pending_)
+    {
+        bytes += packet->data().size();
+    }
 
-    if (packet != nullptr)
+    bytes -= offset_;
+
+    while (bytes < max_queued_)
+    {
+        auto packet = connection_->next_packet(0s);
+
+        if (packet == nullptr)
+        {
+            break;
+        }
+
+        bytes += packet->data().size();
+        pending_.push_back(std::move(packet));
+    }
+
+    // Write the packets.
+    std::vector<std::reference_wrapper<const std::vector<uint8_t>>> buffers;
+    buffers.reserve(pending_.size());
+
+    for (const auto &packet : pending_)
     {
-        port_->write(packet->data());
+        buffers.push_back(std::cref(packet->data()));
+    }
+
+    offset_ += port_->write_some(buffers, offset_);
+
+    // Discard completely written packets.
+    while (!pending_.empty() && offset_ >= pending_.front()->data().size())
+    {
+        const auto &packet = *pending_.front();
+        offset_ -= packet.data().size();
+        traffic_.count(Traffic::sent, packet.data().size());
+
+        if (TRACEPOINT_ENABLED(packet_sent))
+        {
+            TRACEPOINT(
+                packet_sent, packet.id(), tracepoints::source(packet),
+                tracepoints::dest(packet), connection_.get(), &packet,
+                packet.data().size(),
+                tracepoints::nanoseconds(packet.timestamp()));
+        }
+
+        pending_.pop_front();
     }
 }
 
@@ -82,6 +190,8 @@ void SerialInterface::send_packet(const std::chrono::nanoseconds &timeout)
  *
  *  Reads the data in the serial port's receive buffer or waits for up to \p
  *  timeout until data arrives if no data is present in the serial port buffer.
+ *  Packets that no connection may accept are skipped without being
+ *  constructed.
  */
 void SerialInterface::receive_packet(const std::chrono::nanoseconds &timeout)
 {
@@ -96,6 +206,7 @@ void SerialInterface::receive_packet(const std::chrono::nanoseconds &timeout)
 
             if (packet != nullptr)
             {
+                traffic_.count(Traffic::received, packet->data().size());
                 packet->connection(connection_);
                 connection_->add_address(packet->source());
                 connection_pool_->send(std::move(packet));
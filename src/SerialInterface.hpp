@@ -20,11 +20,14 @@
 
 
 #include <chrono>
+#include <cstddef>
+#include <deque>
 #include <memory>
 
 #include "Connection.hpp"
 #include "ConnectionPool.hpp"
 #include "Interface.hpp"
+#include "Packet.hpp"
 #include "PacketParser.hpp"
 #include "SerialPort.hpp"
 
@@ -40,7 +43,8 @@ class SerialInterface : public Interface
         SerialInterface(
             std::unique_ptr<SerialPort> port,
             std::shared_ptr<ConnectionPool> connection_pool,
-            std::unique_ptr<Connection> connection);
+            std::unique_ptr<Connection> connection,
+            std::size_t max_queued = 256);
         // LCOV_EXCL_START
         ~SerialInterface() = default;
         // LCOV_EXCL_STOP
@@ -56,6 +60,9 @@ class SerialInterface : public Interface
         std::shared_ptr<ConnectionPool> connection_pool_;
         std::shared_ptr<Connection> connection_;
         PacketParser parser_;
+        std::size_t max_queued_;
+        std::deque<std::shared_ptr<const Packet>> pending_;
+        std::size_t offset_;
 };
 
 
@@ -17,7 +17,9 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <iterator>
 #include <ostream>
 #include <utility>
@@ -96,6 +98,78 @@ void SerialPort::write(
 }
 
 
+/** Write data from multiple buffers to the serial port.
+ *
+ *  The buffers are written in order, as if they were a single buffer, which
+ *  allows multiple packets to be sent with a single write.  Unlike \ref write
+ *  this may write only part of the data, in which case the remaining data
+ *  should be written with another call to this method (using \p offset).
+ *
+ *  The base \ref SerialPort class implementation combines the buffers and
+ *  calls \ref write(const std::vector<uint8_t> &).
+ *
+ *  \param buffers The buffers to write.
+ *  \param offset The number of bytes (from the start of the first buffer) to
+ *      skip.  This is used to resume a partial write.  The default is 0.
+ *  \returns The number of bytes written, not including \p offset.
+ */
+std::size_t SerialPort::write_some(
+    const std::vector<std::reference_wrapper<
+        const std::vector<uint8_t>>> &buffers,
+    std::size_t offset)
+{
+    std::vector<uint8_t> vec;
+
+    for (const auto &buffer : buffers)
+    {
+        const std::vector<uint8_t> &data = buffer;
+        auto skip = std::min(offset, data.size());
+        offset -= skip;
+        std::copy(data.begin() + static_cast<long>(skip), data.end(),
+                  std::back_inserter(vec));
+    }
+
+    write(vec);
+    return vec.size();
+}
+
+
+/** Get the number of bytes waiting to be transmitted by the serial port.
+ *
+ *  This is the data that has been written, but is still in the operating
+ *  system's (or device's) output buffer.  The base \ref SerialPort class
+ *  has no output buffer and always returns 0.
+ *
+ *  \returns The number of bytes in the serial port's output buffer.
+ */
+std::size_t SerialPort::output_queue_size()
+{
+    return 0;
+}
+
+
+/** Wait for the serial port's output buffer to drain.
+ *
+ *  This is used to keep the output buffer shallow, so that packets wait in
+ *  mavtables' priority queues (where they can be reordered) instead of the
+ *  operating system's first in first out buffer.  The base \ref SerialPort
+ *  class has no output buffer and returns immediately.
+ *
+ *  \param max_queued Wait until there are at most this many bytes in the
+ *      output buffer.
+ *  \param timeout The maximum amount of time to wait.
+ *  \retval true There are at most \p max_queued bytes in the output buffer.
+ *  \retval false The timeout was reached first.
+ */
+bool SerialPort::wait_for_output(
+    std::size_t max_queued, const std::chrono::nanoseconds &timeout)
+{
+    (void)max_queued;
+    (void)timeout;
+    return true;
+}
+
+
 /** Print the serial port to the given output stream.
  *
  *  \param os The output stream to print to.
@@ -20,6 +20,8 @@
 
 
 #include <chrono>
+#include <cstddef>
+#include <functional>
 #include <iterator>
 #include <ostream>
 #include <string>
@@ -59,7 +61,8 @@ class SerialPort
         enum Feature
         {
             DEFAULT = 0,            //!< No special features.
-            FLOW_CONTROL = 1 << 0   //!< Enable flow control.
+            FLOW_CONTROL = 1 << 0,  //!< Enable flow control.
+            LOW_LATENCY = 1 << 1    //!< Enable driver low latency mode.
         };
         virtual ~SerialPort();
         virtual std::vector<uint8_t> read(
@@ -73,6 +76,13 @@ class SerialPort
         virtual void write(
             std::vector<uint8_t>::const_iterator first,
             std::vector<uint8_t>::const_iterator last);
+        virtual std::size_t write_some(
+            const std::vector<std::reference_wrapper<
+                const std::vector<uint8_t>>> &buffers,
+            std::size_t offset = 0);
+        virtual std::size_t output_queue_size();
+        virtual bool wait_for_output(
+            std::size_t max_queued, const std::chrono::nanoseconds &timeout);
 
         friend std::ostream &operator<<(
             std::ostream &os, const SerialPort &serial_port);
@@ -0,0 +1,118 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <errno.h>
+
+#include "SharedMemory.hpp"
+#include "UnixSyscalls.hpp"
+
+
+/** Create and map a shared memory object.
+ *
+ *  The object can be read and written by the owner and group of the process.
+ *
+ *  \param name The name of the shared memory object, this must start with a
+ *      slash and not contain any other slashes, such as "/mavtables".
+ *  \param size The size of the shared memory object in bytes.
+ *  \param syscalls The object to use for unix system calls.  It is default
+ *      constructed to the production implementation.  This argument is only
+ *      used for testing.
+ *  \throws std::system_error if a system call produces an error.
+ */
+SharedMemory::SharedMemory(
+    std::string name, std::size_t size, std::unique_ptr<UnixSyscalls> syscalls)
+    : name_(std::move(name)), size_(size), syscalls_(std::move(syscalls)),
+      data_(nullptr)
+{
+    // Replace the object of a previous run, clients may still be using it.
+    syscalls_->shm_unlink(name_.c_str());
+    int fd = syscalls_->shm_open(
+                 name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0660);
+
+    if (fd < 0)
+    {
+        throw std::system_error(std::error_code(errno, std::system_category()));
+    }
+
+    if (syscalls_->ftruncate(fd, static_cast<off_t>(size_)) < 0)
+    {
+        auto error = errno;
+        syscalls_->close(fd);
+        syscalls_->shm_unlink(name_.c_str());
+        throw std::system_error(std::error_code(error, std::system_category()));
+    }
+
+    data_ = syscalls_->mmap(
+                nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    auto error = errno;
+    // The mapping keeps the object open.
+    syscalls_->close(fd);
+
+    if (data_ == MAP_FAILED)
+    {
+        syscalls_->shm_unlink(name_.c_str());
+        throw std::system_error(std::error_code(error, std::system_category()));
+    }
+}
+
+
+/** Unmap and remove the shared memory object.
+ */
+// LCOV_EXCL_START
+SharedMemory::~SharedMemory()
+{
+    syscalls_->munmap(data_, size_);
+    syscalls_->shm_unlink(name_.c_str());
+}
+// LCOV_EXCL_STOP
+
+
+/** Get the mapped memory.
+ *
+ *  \returns A pointer to the start of the shared memory.
+ */
+void *SharedMemory::data() const
+{
+    return data_;
+}
+
+
+/** Get the name of the shared memory object.
+ *
+ *  \returns The name the shared memory object was created with.
+ */
+const std::string &SharedMemory::name() const
+{
+    return name_;
+}
+
+
+/** Get the size of the shared memory.
+ *
+ *  \returns The size of the shared memory object in bytes.
+ */
+std::size_t SharedMemory::size() const
+{
+    return size_;
+}
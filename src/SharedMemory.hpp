@@ -0,0 +1,60 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef SHAREDMEMORY_HPP_
+#define SHAREDMEMORY_HPP_
+
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "UnixSyscalls.hpp"
+
+
+/** A POSIX shared memory object, mapped into memory.
+ *
+ *  The object is created on construction, replacing any existing object with
+ *  the same name, and removed on destruction.  Processes that have mapped the
+ *  object keep their mapping until they unmap it.
+ */
+class SharedMemory
+{
+    public:
+        SharedMemory(
+            std::string name, std::size_t size,
+            std::unique_ptr<UnixSyscalls> syscalls =
+                std::make_unique<UnixSyscalls>());
+        SharedMemory(const SharedMemory &other) = delete;
+        SharedMemory(SharedMemory &&other) = delete;
+        ~SharedMemory();
+        void *data() const;
+        const std::string &name() const;
+        std::size_t size() const;
+        SharedMemory &operator=(const SharedMemory &other) = delete;
+        SharedMemory &operator=(SharedMemory &&other) = delete;
+
+    private:
+        std::string name_;
+        std::size_t size_;
+        std::unique_ptr<UnixSyscalls> syscalls_;
+        void *data_;
+};
+
+
+#endif // SHAREDMEMORY_HPP_
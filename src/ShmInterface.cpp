@@ -0,0 +1,221 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "Connection.hpp"
+#include "ConnectionPool.hpp"
+#include "MAVAddress.hpp"
+#include "mavtables_shm.h"
+#include "Packet.hpp"
+#include "SharedMemory.hpp"
+#include "ShmInterface.hpp"
+#include "Stats.hpp"
+#include "tracepoints.hpp"
+
+
+using namespace std::chrono_literals;
+
+
+/** Construct a shared memory interface.
+ *
+ *  The shared memory is initialized with an empty pair of rings.
+ *
+ *  \param memory The shared memory object to place the rings in.  It must be
+ *      at least `mavtables_shm_size(ring_size)` bytes.
+ *  \param ring_size The size of each ring in bytes.  This must be a power of 2
+ *      and at least 1024 bytes.
+ *  \param connection_pool The connection pool to use for sending packets the
+ *      interface has received and to register the \p connection with.
+ *  \param connection The connection to get packets to send packets from.  This
+ *      will be registered with the given \ref ConnectionPool.
+ *  \throws std::invalid_argument if the shared \p memory pointer is null.
+ *  \throws std::invalid_argument if the \p connection_pool pointer is null.
+ *  \throws std::invalid_argument if the \p connection pointer is null.
+ *  \throws std::invalid_argument if the \p ring_size is not a power of 2 of at
+ *      least 1024 bytes.
+ *  \throws std::invalid_argument if the shared \p memory is too small for the
+ *      \p ring_size.
+ */
+ShmInterface::ShmInterface(
+    std::unique_ptr<SharedMemory> memory, std::uint32_t ring_size,
+    std::shared_ptr<ConnectionPool> connection_pool,
+    std::unique_ptr<Connection> connection)
+    : memory_(std::move(memory)), ring_size_(ring_size),
+      connection_pool_(std::move(connection_pool)),
+      connection_(std::move(connection)),
+      to_client_(nullptr), from_client_(nullptr)
+{
+    if (memory_ == nullptr)
+    {
+        throw std::invalid_argument("Given shared memory pointer is null.");
+    }
+
+    if (connection_pool_ == nullptr)
+    {
+        throw std::invalid_argument("Given connection pool pointer is null.");
+    }
+
+    if (connection_ == nullptr)
+    {
+        throw std::invalid_argument("Given connection pointer is null.");
+    }
+
+    if (ring_size_ < 1024 || (ring_size_ & (ring_size_ - 1)) != 0)
+    {
+        throw std::invalid_argument(
+            "Ring size (" + std::to_string(ring_size_) +
+            ") must be a power of 2 of at least 1024 bytes.");
+    }
+
+    if (memory_->size() < mavtables_shm_size(ring_size_))
+    {
+        throw std::invalid_argument(
+            "Shared memory is too small for the ring size.");
+    }
+
+    auto shm = static_cast<mavtables_shm *>(memory_->data());
+    mavtables_shm_init(shm, ring_size_);
+    to_client_ = mavtables_shm_to_client(shm);
+    from_client_ = mavtables_shm_from_client(shm);
+    connection_pool_->add(connection_);
+    // Only parse packets that some connection may accept, but still learn
+    // the addresses of valid packets that are skipped.
+    parser_.prefilter(
+        [this](unsigned long id, const MAVAddress &source)
+    {
+        return connection_pool_->may_accept(id, source);
+    },
+    [this](const MAVAddress &source)
+    {
+        connection_->add_address(source);
+    });
+}
+
+
+/** \copydoc Interface::send_packet(const std::chrono::nanoseconds &)
+ *
+ *  Waits for a packet from the contained connection and then writes it, along
+ *  with any other queued packets, to the ring read by the client.  This never
+ *  waits for the client, packets that do not fit in the ring are dropped (and
+ *  counted as such).
+ */
+void ShmInterface::send_packet(const std::chrono::nanoseconds &timeout)
+{
+    auto packet = connection_->next_packet(timeout);
+
+    while (packet != nullptr)
+    {
+        const auto &data = packet->data();
+
+        if (mavtables_shm_write_sized(
+                    to_client_, ring_size_, data.data(),
+                    static_cast<std::uint32_t>(data.size())) == 0)
+        {
+            traffic_.count(Traffic::sent, data.size());
+
+            if (TRACEPOINT_ENABLED(packet_sent))
+            {
+                TRACEPOINT(
+                    packet_sent, packet->id(), tracepoints::source(*packet),
+                    tracepoints::dest(*packet), connection_.get(),
+                    packet.get(), data.size(),
+                    tracepoints::nanoseconds(packet->timestamp()));
+            }
+        }
+        else
+        {
+            traffic_.count(Traffic::dropped, data.size());
+        }
+
+        packet = connection_->next_packet(0s);
+    }
+}
+
+
+/** \copydoc Interface::receive_packet(const std::chrono::nanoseconds &)
+ *
+ *  Waits for up to \p timeout for the client to write to its ring and then
+ *  parses everything in the ring.  Packets that no connection may accept are
+ *  skipped without being constructed.
+ *
+ *  The ring is in memory the client can write to, so each record is checked
+ *  against the ring size given to the constructor.  A corrupt record drops
+ *  everything in the ring.
+ */
+void ShmInterface::receive_packet(const std::chrono::nanoseconds &timeout)
+{
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    struct timespec ts;
+    ts.tv_sec = static_cast<std::time_t>(seconds.count());
+    ts.tv_nsec = static_cast<long>((timeout - seconds).count());
+
+    if (!mavtables_shm_wait(from_client_, &ts))
+    {
+        return;
+    }
+
+    std::uint32_t length;
+    const std::uint8_t *data;
+
+    while ((data = mavtables_shm_peek_sized(
+                       from_client_, ring_size_, &length)) != nullptr)
+    {
+        for (std::uint32_t i = 0; i < length; ++i)
+        {
+            auto packet = parser_.parse_byte(data[i]);
+
+            if (packet != nullptr)
+            {
+                traffic_.count(Traffic::received, packet->data().size());
+                packet->connection(connection_);
+                connection_->add_address(packet->source());
+                connection_pool_->send(std::move(packet));
+            }
+        }
+
+        mavtables_shm_consume(from_client_, length);
+    }
+}
+
+
+/** \copydoc Interface::print_(std::ostream &os)const
+ *
+ *  Example:
+ *  ```
+ *  shm {
+ *      name /mavtables;
+ *      ring_size 1048576;
+ *  }
+ *  ```
+ *
+ *  \param os The output stream to print to.
+ */
+std::ostream &ShmInterface::print_(std::ostream &os) const
+{
+    os << "shm {" << std::endl;
+    os << "    name " << memory_->name() << ";" << std::endl;
+    os << "    ring_size " << ring_size_ << ";" << std::endl;
+    os << "}";
+    return os;
+}
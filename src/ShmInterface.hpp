@@ -0,0 +1,76 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef SHMINTERFACE_HPP_
+#define SHMINTERFACE_HPP_
+
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "Connection.hpp"
+#include "ConnectionPool.hpp"
+#include "Interface.hpp"
+#include "PacketParser.hpp"
+#include "SharedMemory.hpp"
+
+
+struct mavtables_shm_ring;
+
+
+/** A shared memory interface, for a single client on the same machine.
+ *
+ *  Packets are exchanged with the client through a pair of single producer,
+ *  single consumer ring buffers in a shared memory object, see
+ *  mavtables_shm.h for the layout and the functions clients use to attach to
+ *  it.  Each packet is copied once, into the ring, and the client can read it
+ *  in place.
+ *
+ *  If the client does not keep up, packets that do not fit in the ring are
+ *  dropped (and counted in the ring) instead of delaying the interface.
+ */
+class ShmInterface : public Interface
+{
+    public:
+        ShmInterface(
+            std::unique_ptr<SharedMemory> memory, std::uint32_t ring_size,
+            std::shared_ptr<ConnectionPool> connection_pool,
+            std::unique_ptr<Connection> connection);
+        // LCOV_EXCL_START
+        ~ShmInterface() = default;
+        // LCOV_EXCL_STOP
+        void send_packet(const std::chrono::nanoseconds &timeout) final;
+        void receive_packet(const std::chrono::nanoseconds &timeout) final;
+
+    protected:
+        std::ostream &print_(std::ostream &os) const final;
+
+    private:
+        // Variables.
+        std::unique_ptr<SharedMemory> memory_;
+        std::uint32_t ring_size_;
+        std::shared_ptr<ConnectionPool> connection_pool_;
+        std::shared_ptr<Connection> connection_;
+        PacketParser parser_;
+        mavtables_shm_ring *to_client_;
+        mavtables_shm_ring *from_client_;
+};
+
+
+#endif // SHMINTERFACE_HPP_
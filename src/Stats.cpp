@@ -0,0 +1,940 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Chain.hpp"
+#include "Connection.hpp"
+#include "Filter.hpp"
+#include "Histogram.hpp"
+#include "Interface.hpp"
+#include "mavlink.hpp"
+#include "Packet.hpp"
+#include "Rule.hpp"
+#include "Stats.hpp"
+#include "utility.hpp"
+
+
+namespace
+{
+
+    // Names of the traffic events, in the order of the Traffic enum.
+    const std::array<const char *, TRAFFIC_EVENTS> EVENTS =
+    {
+        "received", "accepted", "rejected", "queued", "sent", "dropped"
+    };
+
+
+    // Events counted by interfaces.
+    const std::array<Traffic, 3> INTERFACE_EVENTS =
+    {
+        Traffic::received, Traffic::sent, Traffic::dropped
+    };
+
+
+    // Quantiles written for each latency histogram.
+    const std::array<std::pair<const char *, double>, 5> QUANTILES =
+    {{
+        {"0.5", 0.5}, {"0.9", 0.9}, {"0.99", 0.99}, {"0.999", 0.999},
+        {"1", 1.0}
+    }};
+
+
+    // Escape a string for use as a Prometheus label value.
+    std::string escape(const std::string &value)
+    {
+        std::string escaped;
+        escaped.reserve(value.size());
+
+        for (auto c : value)
+        {
+            if (c == '\\' || c == '"')
+            {
+                escaped.push_back('\\');
+                escaped.push_back(c);
+            }
+            else if (c == '\n')
+            {
+                escaped.append("\\n");
+            }
+            else
+            {
+                escaped.push_back(c);
+            }
+        }
+
+        return escaped;
+    }
+
+
+    // Collapse a printed interface onto a single line.
+    std::string one_line(const std::string &text)
+    {
+        std::string line;
+        bool space = false;
+
+        for (auto c : text)
+        {
+            if (c == ' ' || c == '\n')
+            {
+                space = true;
+                continue;
+            }
+
+            if (space && !line.empty())
+            {
+                line.push_back(' ');
+            }
+
+            space = false;
+            line.push_back(c);
+        }
+
+        return line;
+    }
+
+
+    // Write the header of a metric.
+    void header(
+        std::ostream &os, const std::string &name, const std::string &type,
+        const std::string &help)
+    {
+        os << "# HELP " << name << " " << help << "\n";
+        os << "# TYPE " << name << " " << type << "\n";
+    }
+
+
+    // Write a histogram as a Prometheus summary (in seconds).
+    void summary(
+        std::ostream &os, const std::string &name, const std::string &labels,
+        const Histogram &histogram)
+    {
+        using seconds = std::chrono::duration<double>;
+
+        for (const auto &[label, quantile] : QUANTILES)
+        {
+            os << name << "{" << labels << ",quantile=\"" << label << "\"} "
+               << seconds(histogram.quantile(quantile)).count() << "\n";
+        }
+
+        os << name << "_sum{" << labels << "} "
+           << seconds(histogram.sum()).count() << "\n";
+        os << name << "_count{" << labels << "} " << histogram.count()
+           << "\n";
+    }
+
+
+    // Add a chain and the chains it calls (or goes to) to a list of chains.
+    void reachable(const Chain &chain, std::vector<const Chain *> &chains)
+    {
+        if (std::find(chains.begin(), chains.end(), &chain) != chains.end())
+        {
+            return;
+        }
+
+        chains.push_back(&chain);
+
+        for (const auto &rule : chain.rules())
+        {
+            if (auto next = rule->chain())
+            {
+                reachable(*next, chains);
+            }
+        }
+    }
+
+
+    // A sample read from the Prometheus text exposition format.
+    struct Sample
+    {
+        std::string name;
+        std::map<std::string, std::string> labels;
+        std::string value;
+    };
+
+
+    // Parse a line of the Prometheus text exposition format, returning
+    // nothing if it is a comment or invalid.
+    std::optional<Sample> parse_sample(const std::string &line)
+    {
+        Sample sample;
+        auto i = line.find_first_of("{ ");
+
+        if (line.empty() || line[0] == '#' || i == std::string::npos)
+        {
+            return {};
+        }
+
+        sample.name = line.substr(0, i);
+
+        // Labels.
+        if (line[i] == '{')
+        {
+            ++i;
+
+            while (i < line.size() && line[i] != '}')
+            {
+                auto equals = line.find('=', i);
+
+                if (equals == std::string::npos ||
+                        equals + 1 >= line.size() || line[equals + 1] != '"')
+                {
+                    return {};
+                }
+
+                auto label = line.substr(i, equals - i);
+                std::string value;
+
+                for (i = equals + 2; i < line.size() && line[i] != '"'; ++i)
+                {
+                    if (line[i] == '\\' && i + 1 < line.size())
+                    {
+                        ++i;
+                        value.push_back(line[i] == 'n' ? '\n' : line[i]);
+                    }
+                    else
+                    {
+                        value.push_back(line[i]);
+                    }
+                }
+
+                sample.labels[label] = value;
+
+                // Skip closing quote and separating comma.
+                if (++i < line.size() && line[i] == ',')
+                {
+                    ++i;
+                }
+            }
+
+            if (i >= line.size())
+            {
+                return {};
+            }
+
+            ++i;
+        }
+
+        // Value.
+        auto begin = line.find_first_not_of(' ', i);
+
+        if (begin == std::string::npos)
+        {
+            return {};
+        }
+
+        sample.value = line.substr(begin, line.find(' ', begin) - begin);
+        return sample;
+    }
+
+
+    std::size_t packets_index(Traffic traffic)
+    {
+        return 2 * static_cast<std::size_t>(traffic);
+    }
+
+
+    std::size_t bytes_index(Traffic traffic)
+    {
+        return 2 * static_cast<std::size_t>(traffic) + 1;
+    }
+
+}
+
+
+/** Count a packet.
+ *
+ *  \param traffic The event to count the packet under.
+ *  \param bytes The size of the packet in bytes.
+ */
+void TrafficCounters::count(Traffic traffic, std::size_t bytes)
+{
+    counters_.add(packets_index(traffic));
+    counters_.add(bytes_index(traffic), bytes);
+}
+
+
+/** Get the number of packets counted under an event.
+ *
+ *  \param traffic The event to get the packet count of.
+ *  \returns The number of packets counted under \p traffic.
+ */
+unsigned long long TrafficCounters::packets(Traffic traffic) const
+{
+    return counters_.value(packets_index(traffic));
+}
+
+
+/** Get the number of bytes counted under an event.
+ *
+ *  \param traffic The event to get the byte count of.
+ *  \returns The total size (in bytes) of the packets counted under \p
+ *      traffic.
+ */
+unsigned long long TrafficCounters::bytes(Traffic traffic) const
+{
+    return counters_.value(bytes_index(traffic));
+}
+
+
+/** Record the latency and sojourn time of a sent packet.
+ *
+ *  \param priority The priority the packet was sent with.
+ *  \param latency The time from receiving the packet to sending it.
+ *  \param sojourn The time the packet spent in the queue.
+ */
+void LatencyHistograms::record(
+    int priority, std::chrono::nanoseconds latency,
+    std::chrono::nanoseconds sojourn)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &histograms = histograms_[priority];
+    histograms.latency.record(latency);
+    histograms.sojourn.record(sojourn);
+}
+
+
+/** Get the priorities that packets have been sent with.
+ *
+ *  \returns The priorities with recorded durations, in ascending order.
+ */
+std::vector<int> LatencyHistograms::priorities() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<int> priorities;
+
+    for (const auto &histograms : histograms_)
+    {
+        priorities.push_back(histograms.first);
+    }
+
+    return priorities;
+}
+
+
+/** Get the latency histogram of a priority.
+ *
+ *  \param priority The priority to get the histogram of.
+ *  \returns The times from receiving to sending packets of \p priority.
+ *  \throws std::out_of_range if no packet has been sent with \p priority.
+ */
+const Histogram &LatencyHistograms::latency(int priority) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return histograms_.at(priority).latency;
+}
+
+
+/** Get the sojourn time histogram of a priority.
+ *
+ *  \param priority The priority to get the histogram of.
+ *  \returns The times packets of \p priority spent in the queue.
+ *  \throws std::out_of_range if no packet has been sent with \p priority.
+ */
+const Histogram &LatencyHistograms::sojourn(int priority) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return histograms_.at(priority).sojourn;
+}
+
+
+/** Get the message type table of the calling thread.
+ *
+ *  The table is created and registered the first time a thread counts a
+ *  packet.  Tables are kept after their thread exits so no counts are lost.
+ *
+ *  \returns The calling thread's table of message type counters.
+ */
+Stats::Shard &Stats::shard_()
+{
+    thread_local std::shared_ptr<Shard> shard;
+
+    if (shard == nullptr)
+    {
+        shard = std::make_shared<Shard>();
+        std::lock_guard<std::mutex> lock(mutex_);
+        shards_.push_back(shard);
+    }
+
+    return *shard;
+}
+
+
+/** Sum the message type tables of all threads.
+ *
+ *  \returns The counters of each message type that has been counted.
+ */
+Stats::Table Stats::messages_()
+{
+    std::vector<std::shared_ptr<Shard>> shards;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shards = shards_;
+    }
+
+    Table messages;
+
+    for (auto &shard : shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+
+        for (const auto &[id, counts] : shard->table)
+        {
+            auto &sum = messages[id];
+
+            for (std::size_t i = 0; i < counts.size(); ++i)
+            {
+                sum[i] += counts[i];
+            }
+        }
+    }
+
+    return messages;
+}
+
+
+/** Register a connection so its statistics are written.
+ *
+ *  \param connection The connection to register.  It must be removed with
+ *      \ref remove before it is destroyed.
+ *  \remarks
+ *      Threadsafe (locking).
+ */
+void Stats::add(const Connection &connection)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    connections_.insert(&connection);
+}
+
+
+/** Register a filter so the counters of its chains and rules are written.
+ *
+ *  \param filter The filter to register.  It must be removed with \ref
+ *      remove before it is destroyed.
+ *  \remarks
+ *      Threadsafe (locking).
+ */
+void Stats::add(const Filter &filter)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    filters_.insert(&filter);
+}
+
+
+/** Register an interface so its statistics are written.
+ *
+ *  \param interface The interface to register.  It must be removed with \ref
+ *      remove before it is destroyed.
+ *  \remarks
+ *      Threadsafe (locking).
+ */
+void Stats::add(const Interface &interface)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    interfaces_.insert(&interface);
+}
+
+
+/** Unregister a connection.
+ *
+ *  \param connection The connection to stop writing the statistics of.
+ *  \remarks
+ *      Threadsafe (locking).
+ */
+void Stats::remove(const Connection &connection)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    connections_.erase(&connection);
+}
+
+
+/** Unregister a filter.
+ *
+ *  \param filter The filter to stop writing the counters of.
+ *  \remarks
+ *      Threadsafe (locking).
+ */
+void Stats::remove(const Filter &filter)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    filters_.erase(&filter);
+}
+
+
+/** Unregister an interface.
+ *
+ *  \param interface The interface to stop writing the statistics of.
+ *  \remarks
+ *      Threadsafe (locking).
+ */
+void Stats::remove(const Interface &interface)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    interfaces_.erase(&interface);
+}
+
+
+/** Count a packet against its message type.
+ *
+ *  \param traffic The event to count the packet under.
+ *  \param packet The packet to count.
+ *  \remarks
+ *      Threadsafe (locking).  The lock is only contended while the statistics
+ *      are being written.
+ */
+void Stats::count(Traffic traffic, const Packet &packet)
+{
+    auto &shard = shard_();
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto &counts = shard.table[packet.id()];
+    counts[packets_index(traffic)] += 1;
+    counts[bytes_index(traffic)] += packet.data().size();
+}
+
+
+/** Get the number of packets of a message type counted under an event.
+ *
+ *  \param traffic The event to get the packet count of.
+ *  \param id The packet ID (message type).
+ *  \returns The number of packets with ID \p id counted under \p traffic.
+ *  \remarks
+ *      Threadsafe (locking).
+ */
+unsigned long long Stats::packets(Traffic traffic, unsigned long id)
+{
+    auto messages = messages_();
+    auto it = messages.find(id);
+    return it == messages.end() ? 0 : it->second[packets_index(traffic)];
+}
+
+
+/** Get the number of bytes of a message type counted under an event.
+ *
+ *  \param traffic The event to get the byte count of.
+ *  \param id The packet ID (message type).
+ *  \returns The total size (in bytes) of the packets with ID \p id counted
+ *      under \p traffic.
+ *  \remarks
+ *      Threadsafe (locking).
+ */
+unsigned long long Stats::bytes(Traffic traffic, unsigned long id)
+{
+    auto messages = messages_();
+    auto it = messages.find(id);
+    return it == messages.end() ? 0 : it->second[bytes_index(traffic)];
+}
+
+
+/** Write all statistics in the Prometheus text exposition format.
+ *
+ *  Connections are labeled with their name, interfaces with their
+ *  configuration (on one line) and message types with their name.  An
+ *  example of some of the output is:
+ *  ```
+ *  # HELP mavtables_connection_packets_total Packets handled by each ...
+ *  # TYPE mavtables_connection_packets_total counter
+ *  mavtables_connection_packets_total{connection="127.0.0.1:14550",...} 12
+ *  ...
+ *  # HELP mavtables_connection_queue_depth Packets waiting to be sent ...
+ *  # TYPE mavtables_connection_queue_depth gauge
+ *  mavtables_connection_queue_depth{connection="127.0.0.1:14550"} 0
+ *  ...
+ *  # HELP mavtables_connection_latency_seconds Time from receiving a ...
+ *  # TYPE mavtables_connection_latency_seconds summary
+ *  mavtables_connection_latency_seconds{...,priority="0",quantile="0.5"} ...
+ *  ```
+ *
+ *  Latencies are written as summaries, per connection and priority, with the
+ *  0.5, 0.9, 0.99, 0.999 and 1 (maximum) quantiles.
+ *
+ *  Filter chains are labeled with their name and rules with their chain, the
+ *  line they were given on in the configuration file and the rule itself.
+ *  Chains and rules are written in the order they are checked, see \ref
+ *  write_rules.
+ *
+ *  \param os The output stream to write to.
+ *  \remarks
+ *      Threadsafe (locking).
+ */
+void Stats::write(std::ostream &os)
+{
+    auto messages = messages_();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Order connections and interfaces by their labels.
+    std::vector<std::pair<std::string, const Connection *>> connections;
+
+    for (auto connection : connections_)
+    {
+        connections.emplace_back(escape(str(*connection)), connection);
+    }
+
+    std::sort(connections.begin(), connections.end());
+    std::vector<std::pair<std::string, const Interface *>> interfaces;
+
+    for (auto interface : interfaces_)
+    {
+        interfaces.emplace_back(
+            escape(one_line(str(*interface))), interface);
+    }
+
+    std::sort(interfaces.begin(), interfaces.end());
+
+    // Connections.
+    header(os, "mavtables_connection_packets_total", "counter",
+           "Packets handled by each connection.");
+
+    for (const auto &[name, connection] : connections)
+    {
+        for (std::size_t i = 0; i < TRAFFIC_EVENTS; ++i)
+        {
+            os << "mavtables_connection_packets_total{connection=\"" << name
+               << "\",event=\"" << EVENTS[i] << "\"} "
+               << connection->traffic().packets(static_cast<Traffic>(i))
+               << "\n";
+        }
+    }
+
+    header(os, "mavtables_connection_bytes_total", "counter",
+           "Bytes handled by each connection.");
+
+    for (const auto &[name, connection] : connections)
+    {
+        for (std::size_t i = 0; i < TRAFFIC_EVENTS; ++i)
+        {
+            os << "mavtables_connection_bytes_total{connection=\"" << name
+               << "\",event=\"" << EVENTS[i] << "\"} "
+               << connection->traffic().bytes(static_cast<Traffic>(i))
+               << "\n";
+        }
+    }
+
+    header(os, "mavtables_connection_queue_depth", "gauge",
+           "Packets waiting to be sent on each connection.");
+
+    for (const auto &[name, connection] : connections)
+    {
+        os << "mavtables_connection_queue_depth{connection=\"" << name
+           << "\"} " << connection->queue_size() << "\n";
+    }
+
+    header(os, "mavtables_connection_queue_high_water", "gauge",
+           "Most packets ever waiting to be sent on each connection.");
+
+    for (const auto &[name, connection] : connections)
+    {
+        os << "mavtables_connection_queue_high_water{connection=\"" << name
+           << "\"} " << connection->queue_high_water() << "\n";
+    }
+
+    header(os, "mavtables_connection_latency_seconds", "summary",
+           "Time from receiving a packet to sending it on each connection.");
+
+    for (const auto &[name, connection] : connections)
+    {
+        const auto &latency = connection->latency();
+
+        for (auto priority : latency.priorities())
+        {
+            summary(os, "mavtables_connection_latency_seconds",
+                    "connection=\"" + name + "\",priority=\"" +
+                    std::to_string(priority) + "\"",
+                    latency.latency(priority));
+        }
+    }
+
+    header(os, "mavtables_connection_queue_seconds", "summary",
+           "Time packets spent in the queue of each connection.");
+
+    for (const auto &[name, connection] : connections)
+    {
+        const auto &latency = connection->latency();
+
+        for (auto priority : latency.priorities())
+        {
+            summary(os, "mavtables_connection_queue_seconds",
+                    "connection=\"" + name + "\",priority=\"" +
+                    std::to_string(priority) + "\"",
+                    latency.sojourn(priority));
+        }
+    }
+
+    // Interfaces.
+    header(os, "mavtables_interface_packets_total", "counter",
+           "Packets received and sent by each interface.");
+
+    for (const auto &[name, interface] : interfaces)
+    {
+        for (auto traffic : INTERFACE_EVENTS)
+        {
+            os << "mavtables_interface_packets_total{interface=\"" << name
+               << "\",event=\"" << EVENTS[static_cast<std::size_t>(traffic)]
+               << "\"} " << interface->traffic().packets(traffic) << "\n";
+        }
+    }
+
+    header(os, "mavtables_interface_bytes_total", "counter",
+           "Bytes received and sent by each interface.");
+
+    for (const auto &[name, interface] : interfaces)
+    {
+        for (auto traffic : INTERFACE_EVENTS)
+        {
+            os << "mavtables_interface_bytes_total{interface=\"" << name
+               << "\",event=\"" << EVENTS[static_cast<std::size_t>(traffic)]
+               << "\"} " << interface->traffic().bytes(traffic) << "\n";
+        }
+    }
+
+    // Filters.
+    std::vector<const Chain *> chains;
+
+    for (auto filter : filters_)
+    {
+        reachable(filter->default_chain(), chains);
+    }
+
+    header(os, "mavtables_chain_packets_total", "counter",
+           "Packets evaluated by each filter chain.");
+
+    for (auto chain : chains)
+    {
+        os << "mavtables_chain_packets_total{chain=\"" << escape(chain->name())
+           << "\"} " << chain->packets() << "\n";
+    }
+
+    header(os, "mavtables_chain_evaluation_seconds", "summary",
+           "Time taken to evaluate sampled packets by each filter chain.");
+
+    for (auto chain : chains)
+    {
+        using seconds = std::chrono::duration<double>;
+        os << "mavtables_chain_evaluation_seconds_sum{chain=\""
+           << escape(chain->name()) << "\"} "
+           << seconds(chain->sample_time()).count() << "\n";
+        os << "mavtables_chain_evaluation_seconds_count{chain=\""
+           << escape(chain->name()) << "\"} " << chain->samples() << "\n";
+    }
+
+    header(os, "mavtables_rule_packets_total", "counter",
+           "Packets matched by each filter rule.");
+
+    for (auto chain : chains)
+    {
+        for (std::size_t i = 0; i < chain->rules().size(); ++i)
+        {
+            const auto &rule = *chain->rules()[i];
+            os << "mavtables_rule_packets_total{chain=\""
+               << escape(chain->name()) << "\",line=\""
+               << chain->indices()[i] << "\",rule=\"" << escape(str(rule))
+               << "\"} " << rule.hits() << "\n";
+        }
+    }
+
+    // Message types.
+    std::map<unsigned long, std::string> names;
+
+    for (const auto &message : messages)
+    {
+        try
+        {
+            names[message.first] = mavlink::name(message.first);
+        }
+        // LCOV_EXCL_START
+        catch (const std::invalid_argument &)
+        {
+            names[message.first] = "#" + std::to_string(message.first);
+        }
+        // LCOV_EXCL_STOP
+    }
+
+    header(os, "mavtables_message_packets_total", "counter",
+           "Packets handled of each message type.");
+
+    for (const auto &[id, name] : names)
+    {
+        const auto &counts = messages[id];
+
+        for (std::size_t i = 0; i < TRAFFIC_EVENTS; ++i)
+        {
+            os << "mavtables_message_packets_total{message=\"" << name
+               << "\",event=\"" << EVENTS[i] << "\"} "
+               << counts[packets_index(static_cast<Traffic>(i))] << "\n";
+        }
+    }
+
+    header(os, "mavtables_message_bytes_total", "counter",
+           "Bytes handled of each message type.");
+
+    for (const auto &[id, name] : names)
+    {
+        const auto &counts = messages[id];
+
+        for (std::size_t i = 0; i < TRAFFIC_EVENTS; ++i)
+        {
+            os << "mavtables_message_bytes_total{message=\"" << name
+               << "\",event=\"" << EVENTS[i] << "\"} "
+               << counts[bytes_index(static_cast<Traffic>(i))] << "\n";
+        }
+    }
+}
+
+
+/** Write the filter rules, annotated with their counters.
+ *
+ *  This reads the chain and rule counters from statistics written by \ref
+ *  write (such as those read with \ref StatsServer::fetch) and prints them
+ *  like `iptables -L -v` does.  An example is:
+ *  ```
+ *  chain default (1024 packets, 0.412 us per packet)
+ *       pkts  line  rule
+ *        512    12  reject if HEARTBEAT from 10.10;
+ *        498    13  call ap-in if from 192.168;
+ *         14    14  accept;
+ *
+ *  chain ap-in (498 packets)
+ *       pkts  line  rule
+ *        498    18  accept with priority 3;
+ *  ```
+ *  The time per packet is the mean of the sampled evaluations and is only
+ *  given if the chain was profiled.  It includes the time taken by any chains
+ *  called from the chain.
+ *
+ *  \param os The output stream to write to.
+ *  \param metrics The statistics to read the counters from, in the Prometheus
+ *      text exposition format.
+ */
+void Stats::write_rules(std::ostream &os, std::istream &metrics)
+{
+    struct Rules
+    {
+        std::string packets = "0";
+        double seconds = 0.0;
+        unsigned long long samples = 0;
+        std::vector<std::array<std::string, 3>> rules;
+    };
+    std::vector<std::string> names;
+    std::map<std::string, Rules> chains;
+    auto chain = [&](const std::string &name) -> Rules &
+    {
+        if (chains.count(name) == 0)
+        {
+            names.push_back(name);
+        }
+
+        return chains[name];
+    };
+
+    // Read the counters.
+    std::string line;
+
+    while (std::getline(metrics, line))
+    {
+        auto sample = parse_sample(line);
+
+        if (!sample || sample->labels.count("chain") == 0)
+        {
+            continue;
+        }
+
+        auto &rules = chain(sample->labels["chain"]);
+
+        if (sample->name == "mavtables_chain_packets_total")
+        {
+            rules.packets = sample->value;
+        }
+        else if (sample->name == "mavtables_chain_evaluation_seconds_sum")
+        {
+            rules.seconds = std::stod(sample->value);
+        }
+        else if (sample->name == "mavtables_chain_evaluation_seconds_count")
+        {
+            rules.samples = std::stoull(sample->value);
+        }
+        else if (sample->name == "mavtables_rule_packets_total")
+        {
+            rules.rules.push_back(
+                {{sample->value, sample->labels["line"],
+                  sample->labels["rule"]}});
+        }
+    }
+
+    // Print the chains.
+    for (const auto &name : names)
+    {
+        const auto &rules = chains[name];
+
+        if (&name != &names.front())
+        {
+            os << "\n";
+        }
+
+        os << "chain " << name << " (" << rules.packets << " packets";
+
+        if (rules.samples > 0)
+        {
+            std::ostringstream cost;
+            cost << std::fixed << std::setprecision(3)
+                 << 1e6 * rules.seconds / static_cast<double>(rules.samples);
+            os << ", " << cost.str() << " us per packet";
+        }
+
+        os << ")\n";
+        os << std::setw(9) << "pkts" << std::setw(6) << "line" << "  rule\n";
+
+        for (const auto &[packets, index, rule] : rules.rules)
+        {
+            os << std::setw(9) << packets << std::setw(6) << index << "  "
+               << rule << ";\n";
+        }
+    }
+}
+
+
+#ifdef __clang__
+    #pragma clang diagnostic push
+    #pragma clang diagnostic ignored "-Wglobal-constructors"
+    #pragma clang diagnostic ignored "-Wexit-time-destructors"
+#endif
+
+std::mutex Stats::mutex_;
+std::set<const Connection *> Stats::connections_;
+std::set<const Filter *> Stats::filters_;
+std::set<const Interface *> Stats::interfaces_;
+std::vector<std::shared_ptr<Stats::Shard>> Stats::shards_;
+
+#ifdef __clang__
+    #pragma clang diagnostic pop
+#endif
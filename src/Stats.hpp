@@ -0,0 +1,158 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef STATS_HPP_
+#define STATS_HPP_
+
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Counters.hpp"
+#include "Histogram.hpp"
+#include "Packet.hpp"
+
+
+class Connection;
+class Filter;
+class Interface;
+
+
+/** The events that packets are counted by.
+ */
+enum class Traffic : std::size_t
+{
+    received,   //!< Received from a connection/interface.
+    accepted,   //!< Accepted by the filter of a connection.
+    rejected,   //!< Rejected by the filter of a connection.
+    queued,     //!< Added to the queue of a connection.
+    sent,       //!< Taken from a queue to be sent.
+    dropped     //!< Discarded without being routed or sent.
+};
+
+
+/** Number of \ref Traffic events.
+ */
+constexpr std::size_t TRAFFIC_EVENTS = 6;
+
+
+/** Packet and byte counters for each \ref Traffic event.
+ *
+ *  \remarks
+ *      Threadsafe (lock-free).
+ */
+class TrafficCounters
+{
+    public:
+        void count(Traffic traffic, std::size_t bytes);
+        unsigned long long packets(Traffic traffic) const;
+        unsigned long long bytes(Traffic traffic) const;
+
+    private:
+        Counters<2 * TRAFFIC_EVENTS> counters_;
+};
+
+
+/** Latency histograms of the packets sent on a connection, by priority.
+ *
+ *  Two durations are recorded for each packet: the latency, from when the
+ *  packet was received to when it was sent, and the sojourn time, from when it
+ *  was queued to when it was sent.
+ *
+ *  \remarks
+ *      Threadsafe (locking).
+ */
+class LatencyHistograms
+{
+    public:
+        void record(
+            int priority, std::chrono::nanoseconds latency,
+            std::chrono::nanoseconds sojourn);
+        std::vector<int> priorities() const;
+        const Histogram &latency(int priority) const;
+        const Histogram &sojourn(int priority) const;
+
+    private:
+        struct Histograms
+        {
+            Histogram latency;
+            Histogram sojourn;
+        };
+        mutable std::mutex mutex_;
+        std::map<int, Histograms> histograms_;
+};
+
+
+/** Global traffic statistics.
+ *
+ *  Connections and interfaces keep their own \ref TrafficCounters and are
+ *  registered here so the statistics can be written out together.  Filters
+ *  are registered so the counters of their chains and rules can be written.
+ *  The counters of each message type are kept here, with each thread counting
+ *  into its own table.
+ *
+ *  Statistics are written in the Prometheus text exposition format.
+ */
+class Stats
+{
+    public:
+        static void add(const Connection &connection);
+        static void add(const Filter &filter);
+        static void add(const Interface &interface);
+        static void remove(const Connection &connection);
+        static void remove(const Filter &filter);
+        static void remove(const Interface &interface);
+        static void count(Traffic traffic, const Packet &packet);
+        static unsigned long long packets(Traffic traffic, unsigned long id);
+        static unsigned long long bytes(Traffic traffic, unsigned long id);
+        static void write(std::ostream &os);
+        static void write_rules(std::ostream &os, std::istream &metrics);
+
+    private:
+        using Table = std::unordered_map<
+                      unsigned long,
+                      std::array<unsigned long long, 2 * TRAFFIC_EVENTS>>;
+        struct Shard
+        {
+            std::mutex mutex;
+            Table table;
+        };
+        Stats(const Stats &stats) = delete;
+        void operator=(const Stats &stats) = delete;
+        Stats() = default;
+        static std::mutex mutex_;
+        static std::set<const Connection *> connections_;
+        static std::set<const Filter *> filters_;
+        static std::set<const Interface *> interfaces_;
+        static std::vector<std::shared_ptr<Shard>> shards_;
+        static Shard &shard_();
+        static Table messages_();
+};
+
+
+#endif // STATS_HPP_
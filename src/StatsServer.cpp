@@ -0,0 +1,243 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <errno.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "Stats.hpp"
+#include "StatsServer.hpp"
+#include "unix_socket.hpp"
+#include "UnixSyscalls.hpp"
+
+
+using namespace std::chrono_literals;
+
+
+// Private functions.
+namespace
+{
+
+    /** Throw the error of the last system call.
+     *
+     *  \throws std::system_error always.
+     */
+    [[noreturn]] void throw_errno()
+    {
+        throw std::system_error(std::error_code(errno, std::system_category()));
+    }
+
+}
+
+
+/** Construct a statistics server listening on a unix socket.
+ *
+ *  Any existing socket at \p path (such as the socket of a previous run) is
+ *  removed before binding to it.
+ *
+ *  \param path The filesystem path to bind the socket to.
+ *  \param syscalls The object to use for unix system calls.  It is default
+ *      constructed to the production implementation.  This argument is only
+ *      used for testing.
+ *  \throws std::invalid_argument if the \p path is empty, too long or is an
+ *      existing file that is not a socket.
+ *  \throws std::system_error if a system call produces an error.
+ */
+StatsServer::StatsServer(
+    std::string path, std::unique_ptr<UnixSyscalls> syscalls)
+    : path_(std::move(path)), syscalls_(std::move(syscalls)), socket_(-1)
+{
+    struct sockaddr_un addr;
+    auto addrlen = unix_address(path_, addr);
+
+    // Remove the socket of a previous run, bind fails if it exists.
+    if (!remove_socket(*syscalls_, path_))
+    {
+        throw std::invalid_argument(
+            "Socket path (" + path_ + ") exists and is not a socket.");
+    }
+
+    if ((socket_ = syscalls_->socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+    {
+        throw_errno();
+    }
+
+    if (syscalls_->bind(
+                socket_, reinterpret_cast<struct sockaddr *>(&addr),
+                addrlen) < 0 || syscalls_->listen(socket_, 4) < 0)
+    {
+        auto error = errno;
+        syscalls_->close(socket_);
+        throw std::system_error(std::error_code(error, std::system_category()));
+    }
+}
+
+
+/** The server destructor.
+ *
+ *  Closes the socket and removes it from the filesystem.
+ */
+// LCOV_EXCL_START
+StatsServer::~StatsServer()
+{
+    syscalls_->close(socket_);
+    remove_socket(*syscalls_, path_);
+}
+// LCOV_EXCL_STOP
+
+
+/** Serve the statistics to the next client.
+ *
+ *  Waits up to \p timeout for a client to connect, sends it the statistics and
+ *  closes the connection.  Errors while sending are ignored, as they are
+ *  caused by the client.  Sending is given up after one second, so a client
+ *  that does not read can not block the server.
+ *
+ *  \param timeout How long to wait for a client.  Set to 0s for non blocking.
+ *  \retval true %If a client was sent the statistics.
+ *  \retval false %If no client connected before the \p timeout.
+ *  \throws std::system_error if a system call produces an error.
+ */
+bool StatsServer::serve(const std::chrono::nanoseconds &timeout)
+{
+    struct pollfd fds = {socket_, POLLIN, 0};
+    auto result = syscalls_->poll(
+                      &fds, 1, static_cast<int>(
+                          std::chrono::duration_cast<std::chrono::milliseconds>(
+                              timeout).count()));
+
+    if (result < 0)
+    {
+        // Interrupted by a signal.
+        if (errno == EINTR)
+        {
+            return false;
+        }
+
+        throw_errno();
+    }
+
+    if (result == 0 || !(fds.revents & POLLIN))
+    {
+        return false;
+    }
+
+    int client = syscalls_->accept(socket_, nullptr, nullptr);
+
+    if (client < 0)
+    {
+        return false;
+    }
+
+    // Give up on clients that stop reading, otherwise they could block the
+    // server (and mavtables from shutting down) once the socket buffer fills.
+    struct timeval send_timeout = {1, 0};
+
+    if (syscalls_->setsockopt(
+                client, SOL_SOCKET, SO_SNDTIMEO,
+                &send_timeout, sizeof(send_timeout)) < 0)
+    {
+        syscalls_->close(client);
+        return true;
+    }
+
+    std::ostringstream os;
+    Stats::write(os);
+    auto text = os.str();
+    std::size_t sent = 0;
+    auto deadline = std::chrono::steady_clock::now() + 1s;
+
+    while (sent < text.size() && std::chrono::steady_clock::now() < deadline)
+    {
+        auto size = syscalls_->sendto(
+                        client, text.data() + sent, text.size() - sent,
+                        MSG_NOSIGNAL, nullptr, 0);
+
+        if (size <= 0)
+        {
+            break;
+        }
+
+        sent += static_cast<std::size_t>(size);
+    }
+
+    syscalls_->close(client);
+    return true;
+}
+
+
+/** Read the statistics from a running \ref StatsServer.
+ *
+ *  \param path The filesystem path of the server's socket.
+ *  \param syscalls The object to use for unix system calls.  It is default
+ *      constructed to the production implementation.  This argument is only
+ *      used for testing.
+ *  \returns The statistics, in the Prometheus text exposition format.
+ *  \throws std::invalid_argument if the \p path is empty or too long.
+ *  \throws std::system_error if a system call produces an error, such as when
+ *      mavtables is not running.
+ */
+std::string StatsServer::fetch(
+    const std::string &path, std::unique_ptr<UnixSyscalls> syscalls)
+{
+    struct sockaddr_un addr;
+    auto addrlen = unix_address(path, addr);
+    int socket;
+
+    if ((socket = syscalls->socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+    {
+        throw_errno();
+    }
+
+    if (syscalls->connect(
+                socket, reinterpret_cast<struct sockaddr *>(&addr),
+                addrlen) < 0)
+    {
+        auto error = errno;
+        syscalls->close(socket);
+        throw std::system_error(std::error_code(error, std::system_category()));
+    }
+
+    std::string text;
+    char buffer[4096];
+    ssize_t size;
+
+    while ((size = syscalls->read(socket, buffer, sizeof(buffer))) > 0)
+    {
+        text.append(buffer, static_cast<std::size_t>(size));
+    }
+
+    auto error = errno;
+    syscalls->close(socket);
+
+    if (size < 0)
+    {
+        throw std::system_error(std::error_code(error, std::system_category()));
+    }
+
+    return text;
+}
@@ -0,0 +1,63 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef STATSSERVER_HPP_
+#define STATSSERVER_HPP_
+
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "config.hpp"
+#include "UnixSyscalls.hpp"
+
+
+/** A unix domain stream socket that serves the \ref Stats.
+ *
+ *  Each client that connects is sent the current statistics, in the
+ *  Prometheus text exposition format, and the connection is then closed.  The
+ *  statistics can be read with `mavtables --stats` (see \ref fetch) or any
+ *  tool that can read from a unix socket, such as `socat`.
+ */
+class StatsServer
+{
+    public:
+        StatsServer(
+            std::string path,
+            std::unique_ptr<UnixSyscalls> syscalls =
+                std::make_unique<UnixSyscalls>());
+        StatsServer(const StatsServer &other) = delete;
+        StatsServer(StatsServer &&other) = delete;
+        TEST_VIRTUAL ~StatsServer();
+        TEST_VIRTUAL bool serve(const std::chrono::nanoseconds &timeout);
+        StatsServer &operator=(const StatsServer &other) = delete;
+        StatsServer &operator=(StatsServer &&other) = delete;
+        static std::string fetch(
+            const std::string &path,
+            std::unique_ptr<UnixSyscalls> syscalls =
+                std::make_unique<UnixSyscalls>());
+
+    private:
+        std::string path_;
+        std::unique_ptr<UnixSyscalls> syscalls_;
+        int socket_;
+};
+
+
+#endif // STATSSERVER_HPP_
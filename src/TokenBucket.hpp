@@ -0,0 +1,138 @@
+// MAVLink router and firewall.
+// Copyright (C) 2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef TOKENBUCKET_HPP_
+#define TOKENBUCKET_HPP_
+
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+
+/** A token bucket rate limiter that never blocks.
+ *
+ *  The bucket fills with bits at a constant rate, up to a maximum burst size.
+ *  Sending data removes bits from the bucket and is allowed to overdraw it,
+ *  which means a packet can always be sent when the bucket is not empty.  The
+ *  caller uses \ref delay to find out how long it must wait before the bucket
+ *  is no longer in debt and so can defer the data instead of sleeping.
+ *
+ *  This is implemented as a virtual scheduling algorithm, storing only the
+ *  time at which the bucket will be full again.
+ *
+ *  \note This class is not threadsafe.
+ */
+template <class TC = std::chrono::steady_clock>
+class TokenBucket
+{
+    public:
+        TokenBucket(unsigned long rate, unsigned long burst = 0);
+        void consume(unsigned long bits);
+        std::chrono::nanoseconds delay() const;
+        bool full() const;
+
+    private:
+        unsigned long rate_;
+        std::chrono::nanoseconds burst_;
+        std::chrono::time_point<TC> full_time_;
+        std::chrono::nanoseconds cost_(unsigned long bits) const;
+};
+
+
+/** Construct a token bucket.
+ *
+ *  The bucket starts out full.
+ *
+ *  \param rate The rate (in bits per second) that the bucket is filled at.
+ *  \param burst The maximum number of bits that can be sent at once, after
+ *      the bucket has had time to fill.  The default is 0, which allows a
+ *      single packet (of any size) to be sent at a time.
+ *  \throws std::invalid_argument if the \p rate is 0.
+ */
+template <class TC>
+TokenBucket<TC>::TokenBucket(unsigned long rate, unsigned long burst)
+    : rate_(rate), burst_(0), full_time_(TC::now())
+{
+    if (rate_ == 0)
+    {
+        throw std::invalid_argument("Token bucket rate must be non-zero.");
+    }
+
+    burst_ = cost_(burst);
+}
+
+
+/** Remove bits from the bucket.
+ *
+ *  The bucket is allowed to go into debt, see \ref delay.
+ *
+ *  \param bits The number of bits that were sent.
+ */
+template <class TC>
+void TokenBucket<TC>::consume(unsigned long bits)
+{
+    full_time_ = std::max(full_time_, TC::now()) + cost_(bits);
+}
+
+
+/** Get the time until more data can be sent.
+ *
+ *  \returns The amount of time before the bucket is no longer empty (in debt).
+ *      This is 0 if data can be sent now.
+ */
+template <class TC>
+std::chrono::nanoseconds TokenBucket<TC>::delay() const
+{
+    auto wait = full_time_ - burst_ - TC::now();
+    return std::max(
+               std::chrono::duration_cast<std::chrono::nanoseconds>(wait),
+               std::chrono::nanoseconds::zero());
+}
+
+
+/** Determine if the bucket is full.
+ *
+ *  A full bucket is the same as a newly constructed bucket and can therefore
+ *  be discarded.
+ *
+ *  \retval true The bucket is full.
+ *  \retval false The bucket is not full.
+ */
+template <class TC>
+bool TokenBucket<TC>::full() const
+{
+    return full_time_ <= TC::now();
+}
+
+
+/** Time required to refill the bucket with a number of bits.
+ *
+ *  \param bits The number of bits.
+ *  \returns The amount of time to refill \p bits into the bucket.
+ */
+template <class TC>
+std::chrono::nanoseconds TokenBucket<TC>::cost_(unsigned long bits) const
+{
+    return std::chrono::nanoseconds(
+               static_cast<std::chrono::nanoseconds::rep>(
+                   (static_cast<unsigned long long>(bits) * 1000000000ULL) /
+                   rate_));
+}
+
+
+#endif // TOKENBUCKET_HPP_
@@ -0,0 +1,118 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "If.hpp"
+#include "MAVAddress.hpp"
+#include "Packet.hpp"
+#include "Tracer.hpp"
+
+
+/** Add a sample of packets to trace.
+ *
+ *  \param period Trace one in this many of the packets matching the \p
+ *      condition, from 1 (every packet) to 65536.
+ *  \param condition The packets to sample from.  The default is all packets.
+ *      Packets without a destination address have a destination of 0.0 when
+ *      checking the condition.
+ *  \throws std::invalid_argument if the \p period is out of range.
+ */
+void Tracer::add(unsigned int period, If condition)
+{
+    if (period < 1 || period > 65536)
+    {
+        throw std::invalid_argument(
+            "Trace period (" + std::to_string(period) +
+            ") must be between 1 and 65536.");
+    }
+
+    samples_.emplace_back(period, std::move(condition));
+}
+
+
+/** Determine whether a packet is traced.
+ *
+ *  \param packet The packet to check.
+ *  \retval true %If the packet is selected by any of the samples.
+ *  \retval false %If the packet is not traced.
+ *  \remarks
+ *      Threadsafe (lock-free).
+ */
+bool Tracer::check(const Packet &packet) const
+{
+    for (const auto &[period, condition] : samples_)
+    {
+        auto dest = packet.dest();
+
+        if (condition.check(packet, dest ? *dest : MAVAddress(0, 0)) &&
+                (period == 1 || packet.checksum() % period == 0))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/** Set the tracer used by all connections.
+ *
+ *  \param tracer The tracer to use, or nullptr to stop tracing packets.  The
+ *      tracer is not owned and must outlive its installation.
+ *  \remarks
+ *      Threadsafe (lock-free).
+ */
+void Tracer::install(Tracer *tracer)
+{
+    installed_.store(tracer, std::memory_order_release);
+}
+
+
+/** Get the tracer used by all connections.
+ *
+ *  \returns The installed tracer, or nullptr if packets are not traced.
+ *  \remarks
+ *      Threadsafe (lock-free).
+ */
+Tracer *Tracer::installed()
+{
+    return installed_.load(std::memory_order_acquire);
+}
+
+
+/** Determine whether a packet is traced by the installed tracer.
+ *
+ *  \param packet The packet to check.
+ *  \retval true %If a tracer is installed and it traces the \p packet.
+ *  \retval false %If the packet is not traced.
+ *  \remarks
+ *      Threadsafe (lock-free).
+ */
+bool Tracer::traced(const Packet &packet)
+{
+    auto tracer = installed();
+    return tracer != nullptr && tracer->check(packet);
+}
+
+
+std::atomic<Tracer *> Tracer::installed_(nullptr);
@@ -0,0 +1,59 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+
+#ifndef TRACER_HPP_
+#define TRACER_HPP_
+
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "If.hpp"
+#include "Packet.hpp"
+
+
+/** Selects packets to trace through the filter and queues.
+ *
+ *  A traced packet is logged when it is received, for every connection's
+ *  filter decision, when it is queued and when it is taken to be sent, at any
+ *  log level (see \ref Logger::trace).  Packets are selected by one or more
+ *  samples, each tracing one in a given number of the packets matching a
+ *  condition.
+ *
+ *  The selection is made from the packet's checksum instead of a counter, so
+ *  every stage of the packet's path makes the same decision without the
+ *  packet having to be marked.
+ */
+class Tracer
+{
+    public:
+        void add(unsigned int period, If condition = If());
+        bool check(const Packet &packet) const;
+        static void install(Tracer *tracer);
+        static Tracer *installed();
+        static bool traced(const Packet &packet);
+
+    private:
+        std::vector<std::pair<unsigned int, If>> samples_;
+        static std::atomic<Tracer *> installed_;
+};
+
+
+#endif // TRACER_HPP_
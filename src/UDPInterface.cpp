@@ -15,15 +15,30 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
+#include <algorithm>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
 #include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "Connection.hpp"
 #include "ConnectionFactory.hpp"
 #include "ConnectionPool.hpp"
 #include "Interface.hpp"
 #include "IPAddress.hpp"
+#include "IPSubnet.hpp"
+#include "Logger.hpp"
+#include "MAVAddress.hpp"
+#include "mavlink.hpp"
+#include "Stats.hpp"
+#include "tracepoints.hpp"
 #include "UDPInterface.hpp"
 #include "UDPSocket.hpp"
 #include "utility.hpp"
@@ -32,28 +47,305 @@
 using namespace std::chrono_literals;
 
 
-/** Update connections.
+/** Count a packet as sent to a peer.
  *
- *  Adds a MAVLink address to the connection corresponding to the given IP
- *  address.  If this connection does not exist, it will be constructed using
- *  the \ref UDPInterface's connection factory.
+ *  \param peer The peer the packet was sent to.
+ *  \param packet The packet that was sent.
+ */
+void UDPInterface::count_sent_(const Peer &peer, const Packet &packet)
+{
+    (void)peer; // only used by the tracepoint
+    traffic_.count(Traffic::sent, packet.data().size());
+
+    if (TRACEPOINT_ENABLED(packet_sent))
+    {
+        TRACEPOINT(
+            packet_sent, packet.id(), tracepoints::source(packet),
+            tracepoints::dest(packet), peer.connection.get(), &packet,
+            packet.data().size(), tracepoints::nanoseconds(packet.timestamp()));
+    }
+}
+
+
+/** Construct the connection of a peer.
+ *
+ *  The connection is constructed using the \ref UDPInterface's connection
+ *  factory and added to the connection pool.
+ *
+ *  \param peer The peer to construct a connection for.
+ *  \param ip_address The IP address of the peer.
+ */
+void UDPInterface::create_connection_(Peer &peer, const IPAddress &ip_address)
+{
+    peer.connection = connection_factory_->get(
+                          str(ip_address), [this, ip_address]()
+    {
+        std::lock_guard<std::mutex> lock(ready_mutex_);
+        ready_.insert(ip_address);
+    });
+    connection_pool_->add(peer.connection);
+    peer.quantum = weight_(ip_address) * MAVLINK_MAX_PACKET_LEN;
+}
+
+
+/** Remove connections that have been idle for longer than the idle timeout.
+ *
+ *  A connection is idle when no UDP packets have been received from its peer
+ *  for the idle timeout and none of its MAVLink addresses are reachable.  Idle
+ *  connections, and connections whose peer the socket reports as unreachable,
+ *  are removed from the connection pool and any packets still waiting to be
+ *  sent on them, including aggregated packets that have not been flushed, are
+ *  discarded (and counted as dropped).
+ *
+ *  This only checks the connections once per second (or once per idle
+ *  timeout, if shorter) to keep the cost of the check low.  The connection of
+ *  a multicast group is never removed.
+ *
+ *  \note The internal mutex must be locked before calling.
+ */
+void UDPInterface::expire_connections_()
+{
+    auto now = std::chrono::steady_clock::now();
+
+    if (now < next_expiry_)
+    {
+        return;
+    }
+
+    next_expiry_ = now + std::chrono::seconds(1);
+
+    if (idle_timeout_ != std::chrono::milliseconds::zero())
+    {
+        next_expiry_ = now + std::min<std::chrono::milliseconds>(
+                           idle_timeout_, std::chrono::seconds(1));
+    }
+
+    for (auto it = connections_.begin(); it != connections_.end();)
+    {
+        auto &peer = it->second;
+
+        if (it->first == group_)
+        {
+            ++it;
+            continue;
+        }
+
+        bool idle = idle_timeout_ != std::chrono::milliseconds::zero() &&
+                    now - peer.last_receive > idle_timeout_ &&
+                    (peer.connection == nullptr ||
+                     !peer.connection->has_addresses());
+
+        if (!idle && socket_->reachable(it->first))
+        {
+            ++it;
+            continue;
+        }
+
+        if (peer.connection != nullptr)
+        {
+            connection_pool_->remove(peer.connection);
+
+            // Drain the queue.
+            if (peer.next_packet != nullptr)
+            {
+                traffic_.count(
+                    Traffic::dropped, peer.next_packet->data().size());
+                release_packet_();
+            }
+
+            for (auto count = peer.connection->clear(); count > 0; --count)
+            {
+                release_packet_();
+            }
+
+            for (const auto &packet : peer.buffered)
+            {
+                traffic_.count(Traffic::dropped, packet->data().size());
+            }
+
+            Logger::log(1, "expired connection " + str(it->first));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(ready_mutex_);
+            ready_.erase(it->first);
+        }
+
+        socket_->forget(it->first);
+        it = connections_.erase(it);
+    }
+}
+
+
+/** Send the packets waiting in a peer's buffer as a single UDP packet.
+ *
+ *  \note The internal mutex must be locked before calling.
+ *
+ *  \param peer The peer to send the buffered packets to.
+ *  \param ip_address The IP address of the peer.
+ */
+void UDPInterface::flush_(Peer &peer, const IPAddress &ip_address)
+{
+    socket_->send(peer.buffer, ip_address);
+
+    for (const auto &packet : peer.buffered)
+    {
+        count_sent_(peer, *packet);
+    }
+
+    peer.buffer.clear();
+    peer.buffered.clear();
+}
+
+
+/** Account for a packet that has been removed from a connection's queue.
+ *
+ *  Consumes the packet's notification of the connection factory's semaphore,
+ *  either from the packets already waited for or by decrementing the
+ *  semaphore.
+ */
+void UDPInterface::release_packet_()
+{
+    if (pending_ > 0)
+    {
+        --pending_;
+    }
+    else
+    {
+        // Decrement semaphore once for each extra packet.
+        connection_factory_->wait_for_packet(0s);
+    }
+}
+
+
+/** Send packets from a peer's connection for one round of deficit round robin.
+ *
+ *  The peer's quantum is added to its deficit and packets are sent until the
+ *  next one is larger than the remaining deficit, the connection runs out of
+ *  packets, or the destination becomes rate limited.
+ *
+ *  When aggregating, packets are added to the peer's buffer instead, which is
+ *  sent when the next packet does not fit in the MTU or, once the connection
+ *  has been drained, when the flush deadline of the oldest buffered packet
+ *  has passed.
+ *
+ *  \note The internal mutex must be locked before calling.
  *
+ *  \param peer The peer to send packets to.
+ *  \param ip_address The IP address of the peer.
+ *  \retval true The peer's connection may still have packets to send.
+ *  \retval false The peer's connection has been drained.
+ */
+bool UDPInterface::send_round_(Peer &peer, const IPAddress &ip_address)
+{
+    peer.deficit += peer.quantum;
+
+    while (true)
+    {
+        if (peer.next_packet == nullptr)
+        {
+            peer.next_packet = peer.connection->next_packet();
+
+            // An idle connection does not keep its deficit.
+            if (peer.next_packet == nullptr)
+            {
+                peer.deficit = 0;
+
+                if (!peer.buffer.empty() &&
+                        std::chrono::steady_clock::now() >= peer.flush_time)
+                {
+                    flush_(peer, ip_address);
+                }
+
+                return false;
+            }
+        }
+
+        const auto &data = peer.next_packet->data();
+        auto size = data.size();
+
+        if (size > peer.deficit)
+        {
+            return true;
+        }
+
+        if (mtu_ == 0)
+        {
+            socket_->send(data, ip_address);
+            count_sent_(peer, *peer.next_packet);
+        }
+        else
+        {
+            if (!peer.buffer.empty() && peer.buffer.size() + size > mtu_)
+            {
+                flush_(peer, ip_address);
+            }
+
+            if (peer.buffer.empty())
+            {
+                peer.flush_time =
+                    std::chrono::steady_clock::now() + flush_delay_;
+            }
+
+            peer.buffer.insert(peer.buffer.end(), data.begin(), data.end());
+            peer.buffered.push_back(peer.next_packet);
+        }
+
+        peer.next_packet = nullptr;
+        peer.deficit -= size;
+        release_packet_();
+
+        if (socket_->send_delay(ip_address) > std::chrono::nanoseconds::zero())
+        {
+            return true;
+        }
+    }
+}
+
+
+/** Update the connection of a peer.
+ *
+ *  Adds a MAVLink address to the connection of the given peer.  If the peer
+ *  does not yet have a connection, it will be constructed using the \ref
+ *  UDPInterface's connection factory.
+ *
+ *  \param peer The peer the packet was received from.
  *  \param mav_address The MAVLink address of the received packet.
  *  \param ip_address The IP address the packet was received on.
  */
-void UDPInterface::update_connections_(
-    const MAVAddress &mav_address, const IPAddress &ip_address)
+void UDPInterface::update_connection_(
+    Peer &peer, const MAVAddress &mav_address, const IPAddress &ip_address)
+{
+    if (peer.connection == nullptr)
+    {
+        create_connection_(peer, ip_address);
+    }
+
+    peer.connection->add_address(mav_address);
+}
+
+
+/** Get the transmit weight of a peer.
+ *
+ *  \param ip_address The IP address of the peer.
+ *  \returns The weight of the most specific subnet containing \p ip_address or
+ *      1 if no subnet contains it.
+ */
+unsigned int UDPInterface::weight_(const IPAddress &ip_address) const
 {
-    auto it = connections_.find(ip_address);
+    const std::pair<IPSubnet, unsigned int> *match = nullptr;
 
-    if (it == connections_.end())
+    for (const auto &weight : weights_)
     {
-        it = connections_.insert(
-        {ip_address, connection_factory_->get(str(ip_address))}).first;
-        connection_pool_->add(it->second);
+        if (weight.first.contains(ip_address) &&
+                (match == nullptr ||
+                 weight.first.prefix_length() > match->first.prefix_length()))
+        {
+            match = &weight;
+        }
     }
 
-    it->second->add_address(mav_address);
+    return match == nullptr ? 1 : match->second;
 }
 
 
@@ -64,18 +356,62 @@ void UDPInterface::update_connections_(
  *      register new connections with.
  *  \param connection_factory The connection factory to use for constructing
  *      new connections when an outside connection is made.
+ *  \param weights Transmit weights of the peers within each IP subnet.  A peer
+ *      with a weight of 2 may send twice as many bytes as a peer with a weight
+ *      of 1 when both have packets waiting.  Peers use the weight of the most
+ *      specific subnet that contains them, or 1 if there is none.  The default
+ *      is no weights {}.
+ *  \param idle_timeout The amount of time (in milliseconds) without receiving
+ *      from a peer, and with none of its MAVLink addresses reachable, before
+ *      its connection is removed.  Set to 0 to never remove connections.  The
+ *      default is 120 seconds, which is the same as the time it takes for
+ *      MAVLink addresses to expire.
+ *  \param group Multicast group (with port) to transmit to.  When given, the
+ *      interface has a single connection that sends each packet once to the
+ *      group, instead of a connection per peer.  Packets received from any
+ *      peer are routed as if they came from the group, so subscribers should
+ *      only need to receive.  The default is no multicast group {}.
+ *  \param preload MAVLink addresses to add to the connection of the multicast
+ *      group, so that packets are sent to subscribers that never transmit.
+ *      The default is no addresses {}.
+ *  \param mtu Maximum size (in bytes) of the UDP packets to aggregate MAVLink
+ *      packets into.  When non-zero, multiple MAVLink packets queued for the
+ *      same peer are sent in a single UDP packet of up to this size, which
+ *      reduces the number of UDP packets on links with a high per packet
+ *      cost.  The default is 0, sending each MAVLink packet in its own UDP
+ *      packet.
+ *  \param flush_delay The longest time (in milliseconds) a MAVLink packet is
+ *      held to aggregate it with later packets, when \p mtu is non-zero.  The
+ *      default is 0, only aggregating packets that are already queued.
  *  \throws std::invalid_argument if the serial \p port device pointer is null.
  *  \throws std::invalid_argument if the \p connection_pool pointer is null.
  *  \throws std::invalid_argument if the \p connection_factory pointer is null.
+ *  \throws std::invalid_argument if any of the \p weights are 0.
+ *  \throws std::invalid_argument if the \p group is not a multicast address
+ *      or does not have a port.
+ *  \throws std::invalid_argument if addresses are preloaded without a \p
+ *      group.
+ *  \throws std::invalid_argument if the \p mtu is non-zero and too small to
+ *      hold a MAVLink packet.
  */
 UDPInterface::UDPInterface(
     std::unique_ptr<UDPSocket> socket,
     std::shared_ptr<ConnectionPool> connection_pool,
-    std::unique_ptr<ConnectionFactory<>> connection_factory)
+    std::unique_ptr<ConnectionFactory<>> connection_factory,
+    std::vector<std::pair<IPSubnet, unsigned int>> weights,
+    std::chrono::milliseconds idle_timeout,
+    std::optional<IPAddress> group,
+    std::vector<MAVAddress> preload, std::size_t mtu,
+    std::chrono::milliseconds flush_delay)
     : socket_(std::move(socket)),
       connection_pool_(std::move(connection_pool)),
       connection_factory_(std::move(connection_factory)),
-      last_ip_address_(IPAddress(0))
+      weights_(std::move(weights)), pending_(0),
+      retry_delay_(std::chrono::nanoseconds::zero()),
+      idle_timeout_(std::move(idle_timeout)),
+      next_expiry_(std::chrono::steady_clock::now()),
+      group_(std::move(group)), mtu_(mtu),
+      flush_delay_(std::move(flush_delay)), holding_(false)
 {
     if (socket_ == nullptr)
     {
@@ -92,40 +428,167 @@ UDPInterface::UDPInterface(
         throw std::invalid_argument(
             "Given connection factory pointer is null.");
     }
+
+    for (const auto &weight : weights_)
+    {
+        if (weight.second == 0)
+        {
+            throw std::invalid_argument("Peer weight must be non-zero.");
+        }
+    }
+
+    if (mtu_ != 0 && mtu_ < MAVLINK_MAX_PACKET_LEN)
+    {
+        throw std::invalid_argument(
+            "MTU (" + std::to_string(mtu_) + ") must be at least " +
+            std::to_string(MAVLINK_MAX_PACKET_LEN) + " bytes.");
+    }
+
+    if (!group_.has_value() && !preload.empty())
+    {
+        throw std::invalid_argument(
+            "Preloaded addresses require a multicast group.");
+    }
+
+    if (group_.has_value())
+    {
+        if (!IPSubnet(IPAddress(0xE0000000), 4).contains(group_.value()))
+        {
+            throw std::invalid_argument(
+                "Multicast group (" + str(group_.value()) +
+                ") is not a multicast address.");
+        }
+
+        if (group_->port() == 0)
+        {
+            throw std::invalid_argument(
+                "Multicast group (" + str(group_.value()) +
+                ") must have a port.");
+        }
+
+        // The group's connection exists for the life of the interface.
+        auto &peer = connections_[group_.value()];
+        create_connection_(peer, group_.value());
+
+        for (const auto &address : preload)
+        {
+            peer.connection->add_address(address);
+        }
+    }
 }
 
 
 /** \copydoc Interface::send_packet(const std::chrono::nanoseconds &)
  *
- *  Sends up to one packet from each connection, belonging to the interface,
- *  over the UDP socket.
+ *  Sends packets from each connection, belonging to the interface, over the
+ *  UDP socket using deficit round robin.  Each call is one round, in which a
+ *  connection may send up to its weight times the maximum MAVLink packet size
+ *  in bytes (plus whatever it did not use in the previous round).  This keeps
+ *  a peer with a constantly full queue from delaying the packets of other
+ *  peers.  Only connections that have had packets added to them since they
+ *  were last drained are visited.
+ *
+ *  Connections whose destination is being rate limited by the socket are
+ *  skipped, leaving their packets in the connection's priority queue.  While
+ *  such deferred packets exist this will only wait until the earliest of them
+ *  can be sent (or \p timeout, whichever is shorter) for a new packet.
+ *  Likewise, while aggregated packets are being held this will only wait
+ *  until the earliest of their flush deadlines.
  */
 void UDPInterface::send_packet(const std::chrono::nanoseconds &timeout)
 {
-    bool not_first = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        expire_connections_();
+    }
 
-    // Wait for a packet on any of the interface's connections.
-    if (connection_factory_->wait_for_packet(timeout))
+    // Wait for a packet on any of the interface's connections, or until the
+    // aggregated packets of a connection must be sent.
+    if (pending_ == 0 && !holding_)
     {
-        for (auto &conn : connections_)
+        if (!connection_factory_->wait_for_packet(timeout))
         {
-            auto packet = conn.second->next_packet();
+            return;
+        }
 
-            // If connection has a packet send it.
-            if (packet != nullptr)
-            {
-                socket_->send(packet->data(), conn.first);
+        pending_ = 1;
+    }
+    else if (connection_factory_->wait_for_packet(
+                 std::min(timeout, retry_delay_)))
+    {
+        ++pending_;
+    }
 
-                if (not_first)
-                {
-                    // Decrement semaphore once for each extra packet.
-                    connection_factory_->wait_for_packet(0s);
-                }
+    // Take the connections that have packets waiting.
+    std::set<IPAddress> ready;
+    {
+        std::lock_guard<std::mutex> lock(ready_mutex_);
+        ready.swap(ready_);
+    }
+
+    auto retry_delay = std::chrono::nanoseconds::max();
+    auto now = std::chrono::steady_clock::now();
+    holding_ = false;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (auto it = ready.begin(); it != ready.end();)
+    {
+        // Skip connections that are being rate limited.
+        auto delay = socket_->send_delay(*it);
+
+        if (delay > std::chrono::nanoseconds::zero())
+        {
+            retry_delay = std::min(retry_delay, delay);
+            ++it;
+            continue;
+        }
 
-                not_first = true;
+        auto peer = connections_.find(*it);
+
+        // Forget the connection once it has been drained (or expired).
+        if (peer == connections_.end() || peer->second.connection == nullptr)
+        {
+            it = ready.erase(it);
+            continue;
+        }
+
+        if (!send_round_(peer->second, *it))
+        {
+            // Keep the connection until its aggregated packets are sent.
+            if (peer->second.buffer.empty())
+            {
+                it = ready.erase(it);
+                continue;
             }
+
+            holding_ = true;
+            retry_delay = std::min<std::chrono::nanoseconds>(
+                              retry_delay, peer->second.flush_time - now);
+        }
+
+        ++it;
+    }
+
+    // Connections that may still have packets remain ready.
+    {
+        std::lock_guard<std::mutex> ready_lock(ready_mutex_);
+        ready_.merge(ready);
+
+        // Without ready connections any pending count is left over from
+        // packets discarded by expired connections.
+        if (ready_.empty())
+        {
+            pending_ = 0;
         }
     }
+
+    // Retry immediately if packets are left but none were rate limited.
+    if (retry_delay == std::chrono::nanoseconds::max())
+    {
+        retry_delay = std::chrono::nanoseconds::zero();
+    }
+
+    retry_delay_ = retry_delay;
 }
 
 
@@ -134,6 +597,18 @@ void UDPInterface::send_packet(const std::chrono::nanoseconds &timeout)
  *  Receives up to one UDP packet worth of data and parses it into MAVLink
  *  packets before passing these packets onto the connection pool.  Will wait up
  *  to \p timeout for a UDP packet to be received.
+ *
+ *  Each IP address has its own parser, so MAVLink packets split across
+ *  multiple UDP packets are reassembled even when other peers are sending at
+ *  the same time.  When transmitting to a multicast group the packets are
+ *  routed as if they came from the group.
+ *
+ *  Packets that no connection may accept are skipped without being
+ *  constructed.  The MAVLink addresses of skipped packets are still learned,
+ *  but only once the packet's checksum has been verified.
+ *
+ *  Packets are timestamped with the time the UDP packet completing them was
+ *  received, by the kernel if the socket supports it.
  */
 void UDPInterface::receive_packet(const std::chrono::nanoseconds &timeout)
 {
@@ -141,25 +616,43 @@ void UDPInterface::receive_packet(const std::chrono::nanoseconds &timeout)
 
     if (!buffer.empty())
     {
-        // Clear the parser if the IP address is different from the last UDP
-        // packet received (we want complete MAVLink packets).
-        if (ip_address != last_ip_address_)
+        auto now = std::chrono::steady_clock::now();
+        // Prefer the time the kernel received the datagram.
+        auto received = socket_->timestamp().value_or(now);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto [it, inserted] = connections_.try_emplace(ip_address);
+        auto &peer = it->second;
+        peer.last_receive = now;
+        // With a multicast group all peers share the group's connection.
+        auto &route =
+            group_.has_value() ? connections_[group_.value()] : peer;
+
+        if (inserted)
         {
-            parser_.clear();
-            last_ip_address_ = ip_address;
+            // Only parse packets that some connection may accept, but still
+            // learn the addresses of valid packets that are skipped.
+            peer.parser.prefilter(
+                [this](unsigned long id, const MAVAddress &source)
+            {
+                return connection_pool_->may_accept(id, source);
+            },
+            [this, &route, ip_address](const MAVAddress &source)
+            {
+                update_connection_(route, source, ip_address);
+            });
         }
 
         // Parse the bytes.
         for (auto byte : buffer)
         {
-            auto packet = parser_.parse_byte(byte);
+            auto packet = peer.parser.parse_byte(byte);
 
             if (packet != nullptr)
             {
-                update_connections_(packet->source(), ip_address);
-                // It is a post condition of update_connections_ that there is a
-                // connection for ip_address.
-                packet->connection(connections_[ip_address]);
+                traffic_.count(Traffic::received, packet->data().size());
+                update_connection_(route, packet->source(), ip_address);
+                packet->timestamp(received);
+                packet->connection(route.connection);
                 connection_pool_->send(std::move(packet));
             }
         }
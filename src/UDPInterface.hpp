@@ -20,14 +20,24 @@
 
 
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <utility>
+#include <vector>
 
 #include "Connection.hpp"
 #include "ConnectionFactory.hpp"
 #include "ConnectionPool.hpp"
 #include "Interface.hpp"
 #include "IPAddress.hpp"
+#include "IPSubnet.hpp"
+#include "MAVAddress.hpp"
+#include "Packet.hpp"
 #include "PacketParser.hpp"
 #include "UDPSocket.hpp"
 
@@ -43,7 +53,15 @@ class UDPInterface : public Interface
         UDPInterface(
             std::unique_ptr<UDPSocket> socket,
             std::shared_ptr<ConnectionPool> connection_pool,
-            std::unique_ptr<ConnectionFactory<>> connection_factory);
+            std::unique_ptr<ConnectionFactory<>> connection_factory,
+            std::vector<std::pair<IPSubnet, unsigned int>> weights = {},
+            std::chrono::milliseconds idle_timeout =
+                std::chrono::milliseconds(120000),
+            std::optional<IPAddress> group = {},
+            std::vector<MAVAddress> preload = {},
+            std::size_t mtu = 0,
+            std::chrono::milliseconds flush_delay =
+                std::chrono::milliseconds::zero());
         // LCOV_EXCL_START
         ~UDPInterface() = default;
         // LCOV_EXCL_STOP
@@ -54,16 +72,69 @@ class UDPInterface : public Interface
         std::ostream &print_(std::ostream &os) const final;
 
     private:
+        // Types
+        /** State kept for each remote IP address.
+         */
+        struct Peer
+        {
+            /** Connection used to route packets to the peer, null until a
+             *  complete packet has been received from it.
+             */
+            std::shared_ptr<Connection> connection;
+            /** Parser for the bytes received from the peer.
+             */
+            PacketParser parser;
+            /** Bytes added to the deficit each round.
+             */
+            unsigned long quantum = 0;
+            /** Bytes that can be sent before the peer's turn is over.
+             */
+            unsigned long deficit = 0;
+            /** Packet taken from the connection that did not fit in the
+             *  deficit, sent first on the next round.
+             */
+            std::shared_ptr<const Packet> next_packet;
+            /** Time the last UDP packet was received from the peer.
+             */
+            std::chrono::steady_clock::time_point last_receive;
+            /** Packets waiting to be sent together in a single UDP packet.
+             */
+            std::vector<uint8_t> buffer;
+            /** Packets in the buffer, counted as sent once the buffer is.
+             */
+            std::vector<std::shared_ptr<const Packet>> buffered;
+            /** Time the packets in the buffer must be sent by.
+             */
+            std::chrono::steady_clock::time_point flush_time;
+        };
         // Variables.
         std::unique_ptr<UDPSocket> socket_;
         std::shared_ptr<ConnectionPool> connection_pool_;
         std::unique_ptr<ConnectionFactory<>> connection_factory_;
-        IPAddress last_ip_address_;
-        std::map<IPAddress, std::shared_ptr<Connection>> connections_;
-        PacketParser parser_;
+        std::vector<std::pair<IPSubnet, unsigned int>> weights_;
+        std::map<IPAddress, Peer> connections_;
+        std::mutex mutex_;
+        std::set<IPAddress> ready_;
+        std::mutex ready_mutex_;
+        unsigned long pending_;
+        std::chrono::nanoseconds retry_delay_;
+        std::chrono::milliseconds idle_timeout_;
+        std::chrono::steady_clock::time_point next_expiry_;
+        std::optional<IPAddress> group_;
+        std::size_t mtu_;
+        std::chrono::milliseconds flush_delay_;
+        bool holding_;
         // Methods
-        void update_connections_(
-            const MAVAddress &mav_address, const IPAddress &ip_address);
+        void count_sent_(const Peer &peer, const Packet &packet);
+        void create_connection_(Peer &peer, const IPAddress &ip_address);
+        void expire_connections_();
+        void flush_(Peer &peer, const IPAddress &ip_address);
+        void release_packet_();
+        bool send_round_(Peer &peer, const IPAddress &ip_address);
+        void update_connection_(
+            Peer &peer, const MAVAddress &mav_address,
+            const IPAddress &ip_address);
+        unsigned int weight_(const IPAddress &ip_address) const;
 };
 
 
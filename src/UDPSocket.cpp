@@ -19,6 +19,7 @@
 #include <chrono>
 #include <cstdint>
 #include <iterator>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -64,6 +65,55 @@ void UDPSocket::send(
 }
 
 
+/** Release any resources held for the given address.
+ *
+ *  Called when an address is no longer being communicated with.  The base
+ *  \ref UDPSocket class does not hold any per address resources and does
+ *  nothing.
+ *
+ *  \param address The IP address (with port number) to forget.
+ */
+void UDPSocket::forget(const IPAddress &address)
+{
+    (void)address;
+}
+
+
+/** Determine if the given address is reachable.
+ *
+ *  Sockets that can detect unreachable destinations (such as by ICMP port
+ *  unreachable errors) should override this so callers can stop sending to
+ *  them.  The base \ref UDPSocket class cannot detect this and always returns
+ *  true.
+ *
+ *  \param address The IP address (with port number) to check.
+ *  \retval true No error has been reported for \p address.
+ *  \retval false The \p address has been reported to be unreachable.
+ */
+bool UDPSocket::reachable(const IPAddress &address)
+{
+    (void)address;
+    return true;
+}
+
+
+/** Get the time before data can be sent to the given address.
+ *
+ *  Sockets that rate limit transmission should override this so callers can
+ *  defer packets to a rate limited address instead of blocking in \ref send.
+ *  The base \ref UDPSocket class does not rate limit and always returns 0.
+ *
+ *  \param address The IP address (with port number) to check.
+ *  \returns How long to wait before sending to \p address, 0 if data can be
+ *      sent immediately.
+ */
+std::chrono::nanoseconds UDPSocket::send_delay(const IPAddress &address)
+{
+    (void)address;
+    return std::chrono::nanoseconds::zero();
+}
+
+
 /** Receive data on the socket.
  *
  *  \note The \p timeout is not guaranteed to be up to nanosecond precision, the
@@ -104,6 +154,21 @@ IPAddress UDPSocket::receive(
 }
 
 
+/** Get the time the last received datagram arrived.
+ *
+ *  Sockets that can read the time the kernel received a datagram should
+ *  override this, as it is more precise than the time \ref receive returns.
+ *  The base \ref UDPSocket class cannot and always returns {}.
+ *
+ *  \returns The (monotonic) time the kernel received the datagram last
+ *      returned by \ref receive, or {} if it is not known.
+ */
+std::optional<std::chrono::steady_clock::time_point> UDPSocket::timestamp()
+{
+    return {};
+}
+
+
 /** Print the UDP socket to the given output stream.
  *
  *  \param os The output stream to print to.
@@ -47,12 +47,15 @@ class UDPSocket
 {
     public:
         virtual ~UDPSocket();
+        virtual void forget(const IPAddress &address);
+        virtual bool reachable(const IPAddress &address);
         virtual void send(
             const std::vector<uint8_t> &data, const IPAddress &address);
         virtual void send(
             std::vector<uint8_t>::const_iterator first,
             std::vector<uint8_t>::const_iterator last,
             const IPAddress &address);
+        virtual std::chrono::nanoseconds send_delay(const IPAddress &address);
         virtual std::pair<std::vector<uint8_t>, IPAddress> receive(
             const std::chrono::nanoseconds &timeout =
                 std::chrono::nanoseconds::zero());
@@ -60,6 +63,8 @@ class UDPSocket
             std::back_insert_iterator<std::vector<uint8_t>> it,
             const std::chrono::nanoseconds &timeout =
                 std::chrono::nanoseconds::zero());
+        virtual std::optional<std::chrono::steady_clock::time_point>
+        timestamp();
 
         friend std::ostream &operator<<(
             std::ostream &os, const UDPSocket &udp_socket);
@@ -0,0 +1,362 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <errno.h>
+#include <sys/un.h>
+
+#include "IPAddress.hpp"
+#include "Logger.hpp"
+#include "unix_socket.hpp"
+#include "UnixDatagramSocket.hpp"
+#include "UnixSyscalls.hpp"
+
+
+/** Construct a unix domain datagram socket.
+ *
+ *  Any existing socket at \p path (such as the socket of a previous run) is
+ *  removed before binding to it.
+ *
+ *  \param path The filesystem path to bind the socket to.
+ *  \param syscalls The object to use for unix system calls.  It is default
+ *      constructed to the production implementation.  This argument is only
+ *      used for testing.
+ *  \throws std::invalid_argument if the \p path is empty, too long or is an
+ *      existing file that is not a socket.
+ *  \throws std::system_error if a system call produces an error.
+ */
+UnixDatagramSocket::UnixDatagramSocket(
+    std::string path, std::unique_ptr<UnixSyscalls> syscalls)
+    : path_(std::move(path)), syscalls_(std::move(syscalls)), socket_(-1),
+      next_port_(1)
+{
+    create_socket_();
+}
+
+
+/** The socket destructor.
+ *
+ *  Closes the underlying file descriptor of the socket and removes it from the
+ *  filesystem.
+ */
+// LCOV_EXCL_START
+UnixDatagramSocket::~UnixDatagramSocket()
+{
+    syscalls_->close(socket_);
+    remove_socket(*syscalls_, path_);
+}
+// LCOV_EXCL_STOP
+
+
+/** \copydoc UDPSocket::forget(const IPAddress &)
+ *
+ *  The placeholder address of the peer is released, so it may be given to
+ *  another peer.
+ */
+void UnixDatagramSocket::forget(const IPAddress &address)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    unreachable_.erase(address);
+    auto it = paths_.find(address);
+
+    if (it != paths_.end())
+    {
+        addresses_.erase(it->second);
+        paths_.erase(it);
+    }
+}
+
+
+/** \copydoc UDPSocket::reachable(const IPAddress &)
+ *
+ *  A peer is unreachable once it's socket has been closed or removed.
+ */
+bool UnixDatagramSocket::reachable(const IPAddress &address)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return unreachable_.count(address) == 0;
+}
+
+
+/** \copydoc UDPSocket::send(const std::vector<uint8_t> &, const IPAddress &)
+ *
+ *  This never blocks.  If the peer is not reading it's socket fast enough
+ *  (it's receive queue is full) the data is dropped, as it would be on a
+ *  congested network.  Data for an unknown or unreachable peer is also
+ *  dropped.
+ *
+ *  \throws std::system_error if a system call produces an error.
+ */
+void UnixDatagramSocket::send(
+    const std::vector<uint8_t> &data, const IPAddress &address)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = paths_.find(address);
+
+    if (it == paths_.end() || unreachable_.count(address) != 0)
+    {
+        return;
+    }
+
+    struct sockaddr_un addr;
+    socklen_t addrlen;
+
+    try
+    {
+        addrlen = unix_address(it->second, addr);
+    }
+    // The peer's path fills the socket address, so it can not be replied to.
+    catch (const std::invalid_argument &)
+    {
+        unreachable_.insert(address);
+        return;
+    }
+
+    auto err = syscalls_->sendto(
+                   socket_, data.data(), data.size(), MSG_DONTWAIT,
+                   reinterpret_cast<struct sockaddr *>(&addr), addrlen);
+
+    if (err < 0)
+    {
+        // The peer's socket has been closed or removed.
+        if (errno == ECONNREFUSED || errno == ENOENT)
+        {
+            unreachable_.insert(address);
+            return;
+        }
+
+        // The peer's receive queue is full.
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            return;
+        }
+
+        throw std::system_error(std::error_code(errno, std::system_category()));
+    }
+}
+
+
+/** \copydoc UDPSocket::receive(const std::chrono::nanoseconds &)
+ *
+ *  \note The timeout precision of this implementation is 1 millisecond.
+ *
+ *  \throws std::system_error if a system call produces an error.
+ */
+std::pair<std::vector<uint8_t>, IPAddress> UnixDatagramSocket::receive(
+    const std::chrono::nanoseconds &timeout)
+{
+    std::chrono::milliseconds timeout_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(timeout);
+    struct pollfd fds = {socket_, POLLIN, 0};
+    auto result = syscalls_->poll(
+                      &fds, 1, static_cast<int>(timeout_ms.count()));
+
+    // Poll error
+    if (result < 0)
+    {
+        throw std::system_error(std::error_code(errno, std::system_category()));
+    }
+    // Success
+    else if (result > 0)
+    {
+        // Socket error
+        if (fds.revents & POLLERR)
+        {
+            syscalls_->close(socket_);
+            create_socket_();
+            return {std::vector<uint8_t>(), IPAddress(0)};
+        }
+        // Datagram available for reading.
+        else if (fds.revents & POLLIN)
+        {
+            return receive_();
+        }
+    }
+
+    // Timed out
+    return {std::vector<uint8_t>(), IPAddress(0)};
+}
+
+
+/** Create socket using the `path_` member variable.
+ *
+ *  \throws std::invalid_argument if the path is a file that is not a socket.
+ *  \throws std::system_error if a system call produces an error.
+ */
+void UnixDatagramSocket::create_socket_()
+{
+    socket_ = -1;
+    struct sockaddr_un addr;
+    auto addrlen = unix_address(path_, addr);
+
+    // Remove the socket of a previous run, bind fails if it exists.
+    if (!remove_socket(*syscalls_, path_))
+    {
+        throw std::invalid_argument(
+            "Socket path (" + path_ + ") exists and is not a socket.");
+    }
+
+    // Create socket.
+    if ((socket_ = syscalls_->socket(AF_UNIX, SOCK_DGRAM, 0)) < 0)
+    {
+        throw std::system_error(std::error_code(errno, std::system_category()));
+    }
+
+    // Bind socket to path.
+    if ((syscalls_->bind(socket_, reinterpret_cast<struct sockaddr *>(&addr),
+                         addrlen)) < 0)
+    {
+        throw std::system_error(std::error_code(errno, std::system_category()));
+    }
+}
+
+
+/** Get the placeholder IP address of a peer.
+ *
+ *  A new placeholder address is assigned if the peer does not have one.
+ *
+ *  \param path The path (or abstract name) of the peer's socket.
+ *  \returns The placeholder IP address of the peer, or nothing if all
+ *      placeholder addresses are in use.
+ */
+std::optional<IPAddress> UnixDatagramSocket::peer_(const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = addresses_.find(path);
+
+    if (it != addresses_.end())
+    {
+        return it->second;
+    }
+
+    for (unsigned int i = 0; i < 65535; ++i)
+    {
+        IPAddress address(0, next_port_);
+        next_port_ = next_port_ % 65535 + 1;
+
+        if (paths_.count(address) == 0)
+        {
+            addresses_.emplace(path, address);
+            paths_.emplace(address, path);
+            return address;
+        }
+    }
+
+    return {};
+}
+
+
+/** Read data from socket.
+ *
+ *  \note There must be a packet to receive, otherwise calling this method is
+ *      undefined.
+ *
+ *  Datagrams from unnamed peers, or from new peers when all placeholder
+ *  addresses are in use, are dropped.
+ *
+ *  \returns The data read from the socket and the placeholder IP address of
+ *      the peer it was sent from.  The data is empty if the datagram was
+ *      dropped.
+ *  \throws std::system_error if a system call produces an error.
+ */
+std::pair<std::vector<uint8_t>, IPAddress> UnixDatagramSocket::receive_()
+{
+    // Get needed buffer size.
+    int packet_size;
+
+    if ((syscalls_->ioctl(socket_, FIONREAD, &packet_size)) < 0)
+    {
+        throw std::system_error(std::error_code(errno, std::system_category()));
+    }
+
+    // Read datagram.
+    std::vector<uint8_t> buffer;
+    buffer.resize(static_cast<size_t>(packet_size));
+    struct sockaddr_un addr;
+    socklen_t addrlen = sizeof(addr);
+    auto size = syscalls_->recvfrom(
+                    socket_, buffer.data(), buffer.size(), 0,
+                    reinterpret_cast<struct sockaddr *>(&addr), &addrlen);
+
+    // Handle errors and extract the peer's path.
+    if (size < 0)
+    {
+        throw std::system_error(std::error_code(errno, std::system_category()));
+    }
+    else if (size > 0)
+    {
+        auto offset = offsetof(struct sockaddr_un, sun_path);
+
+        // Unnamed sockets cannot be replied to.
+        if (addrlen > offset && addrlen <= sizeof(addr) &&
+                addr.sun_family == AF_UNIX)
+        {
+            std::string path(addr.sun_path, addrlen - offset);
+
+            // Remove null terminator(s) from filesystem paths.
+            if (path[0] != '\0')
+            {
+                path.erase(path.find_last_not_of('\0') + 1);
+            }
+
+            if (auto address = peer_(path))
+            {
+                return {buffer, address.value()};
+            }
+
+            // Placeholder addresses are released when peers are forgotten.
+            Logger::log(
+                "dropped datagram from " + path +
+                ", too many unix domain socket peers");
+        }
+    }
+
+    // Failed to read datagram.
+    return {std::vector<uint8_t>(), IPAddress(0)};
+}
+
+
+/** \copydoc UDPSocket::print_(std::ostream &os)const
+ *
+ *  An example:
+ *  ```
+ *  unix {
+ *      path /run/mavtables.sock;
+ *  }
+ *  ```
+ *
+ *  \param os The output stream to print to.
+ */
+std::ostream &UnixDatagramSocket::print_(std::ostream &os) const
+{
+    os << "unix {" << std::endl;
+    os << "    path " << path_ << ";" << std::endl;
+    os << "}";
+    return os;
+}
@@ -0,0 +1,87 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef UNIXDATAGRAMSOCKET_HPP_
+#define UNIXDATAGRAMSOCKET_HPP_
+
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "IPAddress.hpp"
+#include "UDPSocket.hpp"
+#include "UnixSyscalls.hpp"
+
+
+/** A unix domain datagram socket, bound to a path on the filesystem.
+ *
+ *  This allows processes on the same machine to exchange packets with
+ *  mavtables without the overhead of the IP stack.  It is used by \ref
+ *  UDPInterface in the same way as a UDP socket.  Each peer (the path of the
+ *  socket a datagram was sent from) is given a placeholder IP address of
+ *  0.0.0.0 and a port number that is unique to the peer, so that the interface
+ *  can keep a separate connection for each peer.
+ *
+ *  Peers must bind their sockets to a path (or abstract name), otherwise they
+ *  cannot be replied to and their datagrams are ignored.
+ */
+class UnixDatagramSocket : public UDPSocket
+{
+    public:
+        UnixDatagramSocket(
+            std::string path,
+            std::unique_ptr<UnixSyscalls> syscalls =
+                std::make_unique<UnixSyscalls>());
+        virtual ~UnixDatagramSocket();
+        virtual void forget(const IPAddress &address) final;
+        virtual bool reachable(const IPAddress &address) final;
+        virtual void send(
+            const std::vector<uint8_t> &data, const IPAddress &address) final;
+        virtual std::pair<std::vector<uint8_t>, IPAddress> receive(
+            const std::chrono::nanoseconds &timeout =
+                std::chrono::nanoseconds::zero()) final;
+
+    protected:
+        std::ostream &print_(std::ostream &os) const final;
+
+    private:
+        // Variables
+        std::string path_;
+        std::unique_ptr<UnixSyscalls> syscalls_;
+        int socket_;
+        std::map<std::string, IPAddress> addresses_;
+        std::map<IPAddress, std::string> paths_;
+        std::set<IPAddress> unreachable_;
+        unsigned int next_port_;
+        std::mutex mutex_;
+        // Methods
+        void create_socket_();
+        std::optional<IPAddress> peer_(const std::string &path);
+        std::pair<std::vector<uint8_t>, IPAddress> receive_();
+};
+
+
+#endif // UNIXDATAGRAMSOCKET_HPP_
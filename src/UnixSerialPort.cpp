@@ -17,14 +17,26 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <iomanip>
 #include <iterator>
 #include <memory>
+#include <sstream>
 #include <stdexcept>
 #include <system_error>
+#include <thread>
 #include <utility>
 #include <vector>
 
+#include <limits.h>
+
+#ifdef __linux__
+#include <linux/serial.h>
+#endif
+
+#include "Logger.hpp"
 #include "PartialSendError.hpp"
 #include "UnixSerialPort.hpp"
 #include "UnixSyscalls.hpp"
@@ -38,20 +50,63 @@
  *      bps.
  *  \param features A bitflag of the features to enable, default is to not
  *      enable any features.  See \ref SerialPort::Feature for flags.
+ *  \param read_min_bytes The minimum number of bytes to collect before a read
+ *      returns (VMIN), up to 255.  Once data has started to arrive a read will
+ *      wait for this many bytes, or for \p read_timeout to pass without a new
+ *      byte arriving.  The default is 0, return as soon as any data is
+ *      available.
+ *  \param read_timeout The time to wait between bytes before returning a
+ *      partial read (VTIME), rounded up to the nearest 100 milliseconds with a
+ *      maximum of 25.5 seconds.  Must be non-zero if \p read_min_bytes is
+ *      non-zero.  The default is 0.
+ *  \param read_buffer_size The maximum number of bytes to read at a time.
+ *      The default is 1024 bytes.
  *  \param syscalls The object to use for unix system calls.  It is default
  *      constructed to the production implementation.  This argument is only
  *      used for testing.
  *  \throws std::invalid_argument if the baud rate is not supported.
+ *  \throws std::invalid_argument if the read settings are invalid.
  *  \throws std::system_error if a system call produces an error.
  */
 UnixSerialPort::UnixSerialPort(
     std::string device,
     unsigned long baud_rate,
     SerialPort::Feature features,
+    unsigned int read_min_bytes,
+    std::chrono::milliseconds read_timeout,
+    std::size_t read_buffer_size,
     std::unique_ptr<UnixSyscalls> syscalls)
     : device_(std::move(device)), baud_rate_(baud_rate),
-      features_(features), syscalls_(std::move(syscalls)), port_(-1)
+      features_(features), read_min_bytes_(read_min_bytes),
+      read_timeout_(read_timeout), read_buffer_size_(read_buffer_size),
+      syscalls_(std::move(syscalls)), port_(-1), read_calls_(0),
+      read_bytes_(0), read_report_time_(std::chrono::steady_clock::now())
 {
+    if (read_min_bytes_ > 255)
+    {
+        throw std::invalid_argument(
+            "Minimum read size must be no more than 255 bytes.");
+    }
+
+    if (read_timeout_ < std::chrono::milliseconds::zero() ||
+            read_timeout_ > std::chrono::milliseconds(25500))
+    {
+        throw std::invalid_argument(
+            "Read timeout must be between 0 and 25500 milliseconds.");
+    }
+
+    if (read_min_bytes_ > 0 &&
+            read_timeout_ == std::chrono::milliseconds::zero())
+    {
+        throw std::invalid_argument(
+            "A minimum read size requires a non-zero read timeout.");
+    }
+
+    if (read_buffer_size_ == 0)
+    {
+        throw std::invalid_argument("Read buffer size must be non-zero.");
+    }
+
     open_port_();
 }
 
@@ -133,6 +188,120 @@ void UnixSerialPort::write(const std::vector<uint8_t> &data)
     }
 }
 
+
+/** \copydoc SerialPort::write_some(const std::vector<std::reference_wrapper<const std::vector<uint8_t>>> &, std::size_t)
+ *
+ *  The buffers are written with a single `writev` system call.
+ *
+ *  \throws std::system_error if a system call produces an error.
+ */
+std::size_t UnixSerialPort::write_some(
+    const std::vector<std::reference_wrapper<
+        const std::vector<uint8_t>>> &buffers,
+    std::size_t offset)
+{
+    std::vector<struct iovec> iov;
+    iov.reserve(buffers.size());
+
+    for (const auto &buffer : buffers)
+    {
+        const std::vector<uint8_t> &data = buffer;
+
+        // Skip data that has already been written.
+        if (offset >= data.size())
+        {
+            offset -= data.size();
+            continue;
+        }
+
+        iov.push_back(
+        {
+            const_cast<uint8_t *>(data.data() + offset), data.size() - offset
+        });
+        offset = 0;
+
+        if (iov.size() >= IOV_MAX)
+        {
+            break;
+        }
+    }
+
+    if (iov.empty())
+    {
+        return 0;
+    }
+
+    // Write the data.
+    auto err = syscalls_->writev(
+                   port_, iov.data(), static_cast<int>(iov.size()));
+
+    // Handle system call errors.
+    if (err < 0)
+    {
+        throw std::system_error(std::error_code(errno, std::system_category()));
+    }
+
+    return static_cast<std::size_t>(err);
+}
+
+
+/** \copydoc SerialPort::output_queue_size()
+ *
+ *  \throws std::system_error if a system call produces an error.
+ */
+std::size_t UnixSerialPort::output_queue_size()
+{
+    int queued = 0;
+
+    if (syscalls_->ioctl(port_, TIOCOUTQ, &queued) < 0)
+    {
+        throw std::system_error(std::error_code(errno, std::system_category()));
+    }
+
+    return static_cast<std::size_t>(std::max(queued, 0));
+}
+
+
+/** \copydoc SerialPort::wait_for_output(std::size_t, const std::chrono::nanoseconds &)
+ *
+ *  The time to sleep is estimated from the baud rate, assuming 10 bits per
+ *  byte (8N1).
+ *
+ *  \throws std::system_error if a system call produces an error.
+ */
+bool UnixSerialPort::wait_for_output(
+    std::size_t max_queued, const std::chrono::nanoseconds &timeout)
+{
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    while (true)
+    {
+        auto queued = output_queue_size();
+
+        if (queued <= max_queued)
+        {
+            return true;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+
+        if (now >= deadline || baud_rate_ == 0)
+        {
+            return false;
+        }
+
+        // Sleep until the excess bytes should have been transmitted.
+        auto drain = std::chrono::nanoseconds(
+                         static_cast<std::chrono::nanoseconds::rep>(
+                             ((queued - max_queued) * 10 * 1000000000ULL) /
+                             baud_rate_));
+        std::this_thread::sleep_for(
+            std::min(drain, std::chrono::duration_cast<
+                     std::chrono::nanoseconds>(deadline - now)));
+    }
+}
+
+
 /** Configure serial port.
  *
  *  \param baud_rate The bitrate to configure for the port.
@@ -199,16 +368,45 @@ void UnixSerialPort::configure_port_(
     tty.c_iflag &= static_cast<tcflag_t>(~(IXON | IXOFF | IXANY));
     // Use raw output.
     tty.c_oflag &= static_cast<tcflag_t>(~OPOST);
-    // Non blocking mode, using poll.
+    // Non blocking mode by default, using poll.  A read started after poll
+    // reports data can optionally wait (VTIME deciseconds between bytes) for
+    // more bytes (up to VMIN) to reduce the number of read system calls.
     // See: http://unixwiz.net/techtips/termios-vmin-vtime.html
-    tty.c_cc[VMIN] = 0;
-    tty.c_cc[VTIME] = 0;
+    tty.c_cc[VMIN] = static_cast<cc_t>(read_min_bytes_);
+    tty.c_cc[VTIME] = static_cast<cc_t>((read_timeout_.count() + 99) / 100);
 
     // Apply settings to serial port.
     if (syscalls_->tcsetattr(port_, TCSANOW, &tty) < 0)
     {
         throw std::system_error(std::error_code(errno, std::system_category()));
     }
+
+    // Enable low latency mode (disables the latency timer of USB serial
+    // adapters such as FTDI).
+    if (features & SerialPort::LOW_LATENCY)
+    {
+#ifdef ASYNC_LOW_LATENCY
+        struct serial_struct serial;
+
+        if (syscalls_->ioctl(port_, TIOCGSERIAL, &serial) < 0)
+        {
+            throw std::system_error(
+                std::error_code(errno, std::system_category()));
+        }
+
+        serial.flags |= ASYNC_LOW_LATENCY;
+
+        if (syscalls_->ioctl(port_, TIOCSSERIAL, &serial) < 0)
+        {
+            throw std::system_error(
+                std::error_code(errno, std::system_category()));
+        }
+
+#else
+        throw std::invalid_argument(
+            "Low latency mode is not supported on this platform.");
+#endif
+    }
 }
 
 
@@ -248,13 +446,14 @@ void UnixSerialPort::open_port_()
  *  \warning There must be data to read, otherwise calling this method is
  *      undefined.
  *
- *  \returns The data read from the port, up to 1024 bytes at a time.
+ *  \returns The data read from the port, up to the read buffer size (given in
+ *      the constructor) at a time.
  *  \throws std::system_error if a system call produces an error.
  */
 std::vector<uint8_t> UnixSerialPort::read_()
 {
     std::vector<uint8_t> buffer;
-    buffer.resize(1024);
+    buffer.resize(read_buffer_size_);
     auto size = syscalls_->read(port_, buffer.data(), buffer.size());
 
     if (size < 0)
@@ -263,10 +462,45 @@ std::vector<uint8_t> UnixSerialPort::read_()
     }
 
     buffer.resize(static_cast<size_t>(size));
+    ++read_calls_;
+    read_bytes_ += buffer.size();
+    report_reads_();
     return buffer;
 }
 
 
+/** Log the average number of bytes per read system call.
+ *
+ *  This is logged (at level 2) at most once every 10 seconds and is used to
+ *  tune the read settings of the port.  Fewer bytes per read means more system
+ *  calls (CPU usage) but lower latency.
+ */
+void UnixSerialPort::report_reads_()
+{
+    auto now = std::chrono::steady_clock::now();
+
+    if (now - read_report_time_ < std::chrono::seconds(10))
+    {
+        return;
+    }
+
+    if (Logger::level() >= 2)
+    {
+        std::stringstream ss;
+        ss << device_ << ": " << read_bytes_ << " bytes in " << read_calls_
+           << " reads (" << std::fixed << std::setprecision(1)
+           << static_cast<double>(read_bytes_) /
+           static_cast<double>(read_calls_)
+           << " bytes/read)";
+        Logger::log(2, ss.str());
+    }
+
+    read_calls_ = 0;
+    read_bytes_ = 0;
+    read_report_time_ = now;
+}
+
+
 /** Convert integer to termios baud rate constant.
  *
  *  See \ref UnixSerialPort::UnixSerialPort for valid baud rates.
@@ -352,6 +586,10 @@ speed_t UnixSerialPort::speed_constant_(unsigned long baud_rate)
  *      device /dev/ttyUSB0;
  *      baudrate 115200;
  *      flow_control yes;
+ *      low_latency yes;
+ *      read_min_bytes 64;
+ *      read_timeout 100;
+ *      read_buffer_size 4096;
  *  }
  *  ```
  *
@@ -372,6 +610,26 @@ std::ostream &UnixSerialPort::print_(std::ostream &os) const
         os << "    flow_control no;" << std::endl;
     }
 
+    if ((features_ & SerialPort::LOW_LATENCY) != 0)
+    {
+        os << "    low_latency yes;" << std::endl;
+    }
+
+    if (read_min_bytes_ != 0)
+    {
+        os << "    read_min_bytes " << read_min_bytes_ << ";" << std::endl;
+    }
+
+    if (read_timeout_ != std::chrono::milliseconds::zero())
+    {
+        os << "    read_timeout " << read_timeout_.count() << ";" << std::endl;
+    }
+
+    if (read_buffer_size_ != 1024)
+    {
+        os << "    read_buffer_size " << read_buffer_size_ << ";" << std::endl;
+    }
+
     os << "}";
     return os;
 }
@@ -20,6 +20,8 @@
 
 
 #include <chrono>
+#include <cstddef>
+#include <functional>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -38,6 +40,10 @@ class UnixSerialPort : public SerialPort
             std::string device,
             unsigned long baud_rate = 9600,
             SerialPort::Feature features = SerialPort::DEFAULT,
+            unsigned int read_min_bytes = 0,
+            std::chrono::milliseconds read_timeout =
+                std::chrono::milliseconds::zero(),
+            std::size_t read_buffer_size = 1024,
             std::unique_ptr<UnixSyscalls> syscalls =
                 std::make_unique<UnixSyscalls>());
         virtual ~UnixSerialPort();
@@ -45,6 +51,14 @@ class UnixSerialPort : public SerialPort
             const std::chrono::nanoseconds &timeout =
                 std::chrono::nanoseconds::zero()) final;
         virtual void write(const std::vector<uint8_t> &data) final;
+        virtual std::size_t write_some(
+            const std::vector<std::reference_wrapper<
+                const std::vector<uint8_t>>> &buffers,
+            std::size_t offset = 0) final;
+        virtual std::size_t output_queue_size() final;
+        virtual bool wait_for_output(
+            std::size_t max_queued,
+            const std::chrono::nanoseconds &timeout) final;
 
     protected:
         std::ostream &print_(std::ostream &os) const final;
@@ -54,13 +68,20 @@ class UnixSerialPort : public SerialPort
         std::string device_;
         unsigned long baud_rate_;
         SerialPort::Feature features_;
+        unsigned int read_min_bytes_;
+        std::chrono::milliseconds read_timeout_;
+        std::size_t read_buffer_size_;
         std::unique_ptr<UnixSyscalls> syscalls_;
         int port_;
+        unsigned long read_calls_;
+        unsigned long read_bytes_;
+        std::chrono::time_point<std::chrono::steady_clock> read_report_time_;
         // Methods
         void configure_port_(
             unsigned long baud_rate, SerialPort::Feature features);
         void open_port_();
         std::vector<uint8_t> read_();
+        void report_reads_();
         speed_t speed_constant_(unsigned long baud_rate);
 };
 
@@ -15,19 +15,38 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
-#include <fcntl.h>      // open, fnctl
+#include <fcntl.h>      // open, creat, fnctl
 #include <netinet/in.h> // sockaddr_in
+#include <stdio.h>      // rename
 #include <sys/ioctl.h>  // ioctl
+#include <sys/mman.h>   // mmap, munmap, shm_open, shm_unlink
 #include <sys/poll.h>   // poll
-#include <sys/socket.h> // socket, bind, sendto, recvfrom
-#include <sys/stat.h>   // fstat
+#include <sys/socket.h> // socket, bind, listen, accept, connect, sendto, ...
+#include <sys/stat.h>   // fstat, lstat
 #include <sys/types.h>  // socklen_t type on old BSD systems
+#include <sys/uio.h>    // writev
 #include <termios.h>    // terminal control
-#include <unistd.h>     // read, write, close
+#include <unistd.h>     // read, write, close, unlink, ftruncate
 
 #include "UnixSyscalls.hpp"
 
 
+/** Accept a connection on a socket.
+ *
+ *  See [man 2 accept](http://man7.org/linux/man-pages/man2/accept.2.html) for
+ *  documentation.
+ *
+ *  \param sockfd Listening socket file descriptor.
+ *  \param addr Structure to store the address of the peer in, may be nullptr.
+ *  \param addrlen Size of the address structure in bytes, may be nullptr.
+ */
+int UnixSyscalls::accept(
+    int sockfd, struct sockaddr *addr, socklen_t *addrlen)
+{
+    return ::accept(sockfd, addr, addrlen);
+}
+
+
 /** Bind a name to a socket.
  *
  *  See [man 2 bind](http://man7.org/linux/man-pages/man2/bind.2.html) for
@@ -57,6 +76,50 @@ int UnixSyscalls::close(int fd)
 }
 
 
+/** Connect a socket to an address.
+ *
+ *  See [man 2 connect](http://man7.org/linux/man-pages/man2/connect.2.html)
+ *  for documentation.
+ *
+ *  \param sockfd Socket file descriptor.
+ *  \param addr Address to connect the socket to.
+ *  \param addrlen Size of address structure in bytes.
+ */
+int UnixSyscalls::connect(
+    int sockfd, const struct sockaddr *addr, socklen_t addrlen)
+{
+    return ::connect(sockfd, addr, addrlen);
+}
+
+
+/** Create (or truncate) a file.
+ *
+ *  See [man 2 creat](http://man7.org/linux/man-pages/man2/open.2.html) for
+ *  documentation.
+ *
+ *  \param pathname The path of the file to create.
+ *  \param mode The permissions to create the file with.
+ */
+int UnixSyscalls::creat(const char *pathname, mode_t mode)
+{
+    return ::creat(pathname, mode);
+}
+
+
+/** Truncate a file to a specified length.
+ *
+ *  See [man 2 ftruncate](http://man7.org/linux/man-pages/man2/ftruncate.2.html)
+ *  for documentation.
+ *
+ *  \param fd The file descriptor of the file to resize.
+ *  \param length The new size of the file in bytes.
+ */
+int UnixSyscalls::ftruncate(int fd, off_t length)
+{
+    return ::ftruncate(fd, length);
+}
+
+
 /** Control device.
  *
  *  See [man 2 ioctl](http://man7.org/linux/man-pages/man2/ioctl.2.html) for
@@ -72,6 +135,57 @@ int UnixSyscalls::ioctl(int fd, unsigned long request, void *argp)
 }
 
 
+/** Listen for connections on a socket.
+ *
+ *  See [man 2 listen](http://man7.org/linux/man-pages/man2/listen.2.html) for
+ *  documentation.
+ *
+ *  \param sockfd Socket file descriptor.
+ *  \param backlog Maximum number of pending connections.
+ */
+int UnixSyscalls::listen(int sockfd, int backlog)
+{
+    return ::listen(sockfd, backlog);
+}
+
+
+/** Get the status of a file, without following symbolic links.
+ *
+ *  See [man 2 lstat](http://man7.org/linux/man-pages/man2/stat.2.html) for
+ *  documentation.
+ *
+ *  \param pathname The path of the file.
+ *  \param statbuf The structure to store the status in.
+ */
+int UnixSyscalls::lstat(const char *pathname, struct stat *statbuf)
+{
+    return ::lstat(pathname, statbuf);
+}
+
+
+/** Map a file into memory.
+ *
+ *  See [man 2 mmap](http://man7.org/linux/man-pages/man2/mmap.2.html) for
+ *  documentation.
+ */
+void *UnixSyscalls::mmap(
+    void *addr, size_t length, int prot, int flags, int fd, off_t offset)
+{
+    return ::mmap(addr, length, prot, flags, fd, offset);
+}
+
+
+/** Unmap a file from memory.
+ *
+ *  See [man 2 munmap](http://man7.org/linux/man-pages/man2/munmap.2.html) for
+ *  documentation.
+ */
+int UnixSyscalls::munmap(void *addr, size_t length)
+{
+    return ::munmap(addr, length);
+}
+
+
 /** Open and possibly create a file.
  *
  *  See [man 2 open](http://man7.org/linux/man-pages/man2/open.2.html) for
@@ -131,6 +245,37 @@ ssize_t UnixSyscalls::recvfrom(
 }
 
 
+/** Receive a message, and its ancillary data, from a socket.
+ *
+ *  See [man 2 recvmsg](http://man7.org/linux/man-pages/man2/recv.2.html) for
+ *  documentation.
+ *
+ *  \param sockfd Socket file descriptor to receive data on.
+ *  \param msg The message header, holding the buffers to write the data,
+ *      source address and ancillary data into.
+ *  \param flags Option flags.
+ *  \returns The number of bytes received or -1 if an error occurred.
+ */
+ssize_t UnixSyscalls::recvmsg(int sockfd, struct msghdr *msg, int flags)
+{
+    return ::recvmsg(sockfd, msg, flags);
+}
+
+
+/** Rename a file.
+ *
+ *  See [man 2 rename](http://man7.org/linux/man-pages/man2/rename.2.html) for
+ *  documentation.
+ *
+ *  \param oldpath The current path of the file.
+ *  \param newpath The new path of the file, replaced if it exists.
+ */
+int UnixSyscalls::rename(const char *oldpath, const char *newpath)
+{
+    return ::rename(oldpath, newpath);
+}
+
+
 /** Send a message on a socket.
  *
  *  See [man 2 sendto](http://man7.org/linux/man-pages/man2/send.2.html) for
@@ -144,6 +289,48 @@ ssize_t UnixSyscalls::sendto(
 }
 
 
+/** Set options on a socket.
+ *
+ *  See
+ *  [man 2 setsockopt](http://man7.org/linux/man-pages/man2/setsockopt.2.html)
+ *  for documentation.
+ *
+ *  \param sockfd Socket file descriptor.
+ *  \param level The protocol level the option resides at.
+ *  \param optname The option to set.
+ *  \param optval Pointer to the new value of the option.
+ *  \param optlen Size of the option value in bytes.
+ */
+int UnixSyscalls::setsockopt(
+    int sockfd, int level, int optname,
+    const void *optval, socklen_t optlen)
+{
+    return ::setsockopt(sockfd, level, optname, optval, optlen);
+}
+
+
+/** Create or open a POSIX shared memory object.
+ *
+ *  See [man 3 shm_open](http://man7.org/linux/man-pages/man3/shm_open.3.html)
+ *  for documentation.
+ */
+int UnixSyscalls::shm_open(const char *name, int oflag, mode_t mode)
+{
+    return ::shm_open(name, oflag, mode);
+}
+
+
+/** Remove a POSIX shared memory object.
+ *
+ *  See [man 3 shm_unlink](http://man7.org/linux/man-pages/man3/shm_open.3.html)
+ *  for documentation.
+ */
+int UnixSyscalls::shm_unlink(const char *name)
+{
+    return ::shm_unlink(name);
+}
+
+
 /** Create an endpoint for communication.
  *
  *  See [man 2 socket](http://man7.org/linux/man-pages/man2/socket.2.html) for
@@ -182,6 +369,19 @@ int UnixSyscalls::tcsetattr(
 }
 
 
+/** Delete a name from the filesystem.
+ *
+ *  See [man 2 unlink](http://man7.org/linux/man-pages/man2/unlink.2.html) for
+ *  documentation.
+ *
+ *  \param pathname The path to delete.
+ */
+int UnixSyscalls::unlink(const char *pathname)
+{
+    return ::unlink(pathname);
+}
+
+
 /** Write to a file descriptor.
  *
  *  See [man 2 write](http://man7.org/linux/man-pages/man2/write.2.html) for
@@ -191,3 +391,18 @@ ssize_t UnixSyscalls::write(int fd, const void *buf, size_t count)
 {
     return ::write(fd, buf, count);
 }
+
+
+/** Write data from multiple buffers to a file descriptor.
+ *
+ *  See [man 2 writev](http://man7.org/linux/man-pages/man2/writev.2.html) for
+ *  documentation.
+ *
+ *  \param fd The file descriptor to write to.
+ *  \param iov Array of buffers to write, in order.
+ *  \param iovcnt The number of buffers in \p iov.
+ */
+ssize_t UnixSyscalls::writev(int fd, const struct iovec *iov, int iovcnt)
+{
+    return ::writev(fd, iov, iovcnt);
+}
@@ -19,15 +19,18 @@
 #define UNIXSYSCALLS_HPP_
 
 
-#include <fcntl.h>      // open, fnctl
+#include <fcntl.h>      // open, creat, fnctl
 #include <netinet/in.h> // sockaddr_in
+#include <stdio.h>      // rename
 #include <sys/ioctl.h>  // ioctl
+#include <sys/mman.h>   // mmap, munmap, shm_open, shm_unlink
 #include <sys/poll.h>   // poll
-#include <sys/socket.h> // socket, bind, sendto, recvfrom
-#include <sys/stat.h>   // fstat
+#include <sys/socket.h> // socket, bind, listen, accept, sendto, recv*
+#include <sys/stat.h>   // fstat, lstat
 #include <sys/types.h>  // socklen_t type on old BSD systems
+#include <sys/uio.h>    // writev
 #include <termios.h>    // terminal control
-#include <unistd.h>     // read, write, close
+#include <unistd.h>     // read, write, close, unlink, ftruncate
 
 #include "config.hpp"
 
@@ -37,42 +40,78 @@
  *  The purpose of this is to allow system calls to be mocked during testing.
  *
  *  See the following man pages for documentation:
+ *  * [man 2 accept](http://man7.org/linux/man-pages/man2/accept.2.html)
  *  * [man 2 bind](http://man7.org/linux/man-pages/man2/bind.2.html)
  *  * [man 2 close](http://man7.org/linux/man-pages/man2/close.2.html)
+ *  * [man 2 connect](http://man7.org/linux/man-pages/man2/connect.2.html)
+ *  * [man 2 creat](http://man7.org/linux/man-pages/man2/open.2.html)
+ *  * [man 2 ftruncate](http://man7.org/linux/man-pages/man2/ftruncate.2.html)
+ *  * [man 2 mmap](http://man7.org/linux/man-pages/man2/mmap.2.html)
+ *  * [man 2 munmap](http://man7.org/linux/man-pages/man2/munmap.2.html)
+ *  * [man 3 shm_open](http://man7.org/linux/man-pages/man3/shm_open.3.html)
  *  * [man 2 socket](http://man7.org/linux/man-pages/man2/socket.2.html)
  *  * [man 2 ioctl](http://man7.org/linux/man-pages/man2/ioctl.2.html)
  *  * [man 7 ip](http://man7.org/linux/man-pages/man7/ip.7.html)
+ *  * [man 2 listen](http://man7.org/linux/man-pages/man2/listen.2.html)
+ *  * [man 2 lstat](http://man7.org/linux/man-pages/man2/stat.2.html)
  *  * [man 2 open](http://man7.org/linux/man-pages/man2/open.2.html)
  *  * [man 2 poll](http://man7.org/linux/man-pages/man2/poll.2.html)
  *  * [man 2 read](http://man7.org/linux/man-pages/man2/read.2.html)
  *  * [man 2 recvfrom](http://man7.org/linux/man-pages/man2/recv.2.html)
+ *  * [man 2 recvmsg](http://man7.org/linux/man-pages/man2/recv.2.html)
+ *  * [man 2 rename](http://man7.org/linux/man-pages/man2/rename.2.html)
  *  * [man 2 sendto](http://man7.org/linux/man-pages/man2/send.2.html)
+ *  * [man 2 setsockopt](http://man7.org/linux/man-pages/man2/setsockopt.2.html)
  *  * [man 2 termios](http://man7.org/linux/man-pages/man3/termios.3.html)
+ *  * [man 2 unlink](http://man7.org/linux/man-pages/man2/unlink.2.html)
  *  * [man 2 write](http://man7.org/linux/man-pages/man2/write.2.html)
+ *  * [man 2 writev](http://man7.org/linux/man-pages/man2/writev.2.html)
  *
  */
 class UnixSyscalls
 {
     public:
         TEST_VIRTUAL ~UnixSyscalls() = default;
+        TEST_VIRTUAL int accept(
+            int sockfd, struct sockaddr *addr, socklen_t *addrlen);
         TEST_VIRTUAL int bind(
             int sockfd, const struct sockaddr *addr, socklen_t addrlen);
         TEST_VIRTUAL int close(int fd);
+        TEST_VIRTUAL int connect(
+            int sockfd, const struct sockaddr *addr, socklen_t addrlen);
+        TEST_VIRTUAL int creat(const char *pathname, mode_t mode);
+        TEST_VIRTUAL int ftruncate(int fd, off_t length);
         TEST_VIRTUAL int ioctl(int fd, unsigned long request, void *argp);
+        TEST_VIRTUAL int listen(int sockfd, int backlog);
+        TEST_VIRTUAL int lstat(const char *pathname, struct stat *statbuf);
+        TEST_VIRTUAL void *mmap(
+            void *addr, size_t length, int prot, int flags, int fd,
+            off_t offset);
+        TEST_VIRTUAL int munmap(void *addr, size_t length);
         TEST_VIRTUAL int open(const char *pathname, int flags);
         TEST_VIRTUAL int poll(struct pollfd *fds, nfds_t nfds, int timeout);
         TEST_VIRTUAL ssize_t read(int fd, void *buf, size_t count);
         TEST_VIRTUAL ssize_t recvfrom(
             int sockfd, void *buf, size_t len, int flags,
             struct sockaddr *src_addr, socklen_t *addrlen);
+        TEST_VIRTUAL ssize_t recvmsg(int sockfd, struct msghdr *msg, int flags);
         TEST_VIRTUAL ssize_t sendto(
             int sockfd, const void *buf, size_t len, int flags,
             const struct sockaddr *dest_addr, socklen_t addrlen);
+        TEST_VIRTUAL int rename(const char *oldpath, const char *newpath);
+        TEST_VIRTUAL int setsockopt(
+            int sockfd, int level, int optname,
+            const void *optval, socklen_t optlen);
+        TEST_VIRTUAL int shm_open(const char *name, int oflag, mode_t mode);
+        TEST_VIRTUAL int shm_unlink(const char *name);
         TEST_VIRTUAL int socket(int domain, int type, int protocol);
         TEST_VIRTUAL int tcgetattr(int fd, struct termios *termios_p);
         TEST_VIRTUAL int tcsetattr(
             int fd, int optional_actions, const struct termios *termios_p);
+        TEST_VIRTUAL int unlink(const char *pathname);
         TEST_VIRTUAL ssize_t write(int fd, const void *buf, size_t count);
+        TEST_VIRTUAL ssize_t writev(
+            int fd, const struct iovec *iov, int iovcnt);
 };
 
 
@@ -17,14 +17,16 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <stdexcept>
+#include <string>
 #include <system_error>
-#include <thread>
 #include <utility>
 #include <vector>
 
@@ -32,8 +34,10 @@
 #include <errno.h>
 
 #include "IPAddress.hpp"
+#include "Logger.hpp"
 #include "UnixSyscalls.hpp"
 #include "UnixUDPSocket.hpp"
+#include "utility.hpp"
 
 
 using namespace std::chrono_literals;
@@ -46,6 +50,22 @@ using namespace std::chrono_literals;
  *      ignored).  The default is to listen on any address.
  *  \param max_bitrate The maximum number of bits per second to transmit on the
  *      UDP interface.  The default is 0, which indicates no limit.
+ *  \param peer_max_bitrate The maximum number of bits per second to transmit
+ *      to any single IP address/port.  The default is 0, which indicates no
+ *      limit.
+ *  \param reuse_port Set to true to allow other sockets (also created with
+ *      this option) to bind to the same address and port.  The kernel will
+ *      then distribute incoming datagrams across these sockets, keeping each
+ *      remote address/port pair on the same socket.  The default is false.
+ *  \param connect_peers Set to true to give each destination its own socket,
+ *      bound to the same address and port and connected to the destination.
+ *      This saves a route lookup on every packet sent and allows ICMP errors
+ *      to be attributed to a single destination, see \ref reachable.  The
+ *      default is false.
+ *  \param kernel_timestamps Set to true to have the kernel timestamp each
+ *      datagram as it is received, see \ref timestamp.  This excludes the
+ *      time a datagram waits in the socket's receive buffer from the latency of
+ *      its packets.  The default is false.
  *  \param syscalls The object to use for unix system calls.  It is default
  *      constructed to the production implementation.  This argument is only
  *      used for testing.
@@ -53,45 +73,107 @@ using namespace std::chrono_literals;
  */
 UnixUDPSocket::UnixUDPSocket(
     unsigned int port, std::optional<IPAddress> address,
-    unsigned long max_bitrate, std::unique_ptr<UnixSyscalls> syscalls)
+    unsigned long max_bitrate, unsigned long peer_max_bitrate, bool reuse_port,
+    bool connect_peers, bool kernel_timestamps,
+    std::unique_ptr<UnixSyscalls> syscalls)
     : port_(port), address_(std::move(address)), max_bitrate_(max_bitrate),
-      syscalls_(std::move(syscalls)), socket_(-1),
-      next_time_(std::chrono::steady_clock::now())
+      peer_max_bitrate_(peer_max_bitrate), reuse_port_(reuse_port),
+      connect_peers_(connect_peers), kernel_timestamps_(kernel_timestamps),
+      syscalls_(std::move(syscalls)), socket_(-1), next_poll_(0)
 {
+    if (max_bitrate_ != 0)
+    {
+        bucket_.emplace(max_bitrate_);
+    }
+
     create_socket_();
 }
 
 
 /** The socket destructor.
  *
- *  Closes the underlying file descriptor of the UDP socket.
+ *  Closes the underlying file descriptors of the UDP socket.
  */
 // LCOV_EXCL_START
 UnixUDPSocket::~UnixUDPSocket()
 {
     syscalls_->close(socket_);
+
+    for (auto &peer : peer_sockets_)
+    {
+        syscalls_->close(peer.second);
+    }
+
+    for (auto fd : closing_)
+    {
+        syscalls_->close(fd);
+    }
 }
 // LCOV_EXCL_STOP
 
 
+/** \copydoc UDPSocket::forget(const IPAddress &)
+ *
+ *  This closes the connected socket of the destination (if there is one) and
+ *  clears it's unreachable status.  The socket is closed by the next call to
+ *  \ref receive, so that it is never closed while being polled.
+ */
+void UnixUDPSocket::forget(const IPAddress &address)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    unreachable_.erase(address);
+    auto it = peer_sockets_.find(address);
+
+    if (it != peer_sockets_.end())
+    {
+        closing_.push_back(it->second);
+        peer_sockets_.erase(it);
+    }
+}
+
+
+/** \copydoc UDPSocket::reachable(const IPAddress &)
+ *
+ *  A destination is only marked as unreachable when connected sockets are
+ *  enabled (connect_peers) and the kernel reports an error, such as an ICMP
+ *  port unreachable, on the destination's socket.
+ */
+bool UnixUDPSocket::reachable(const IPAddress &address)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return unreachable_.count(address) == 0;
+}
+
+
 /** \copydoc UDPSocket::send(const std::vector<uint8_t> &, const IPAddress &)
+ *
+ *  This never blocks to enforce the bitrate limits.  Instead the data is
+ *  charged against the interface's and the destination's token buckets and
+ *  \ref send_delay will report how long to wait before sending again.
  *
  *  \throws PartialSendError if it fails to write all the data it is given.
  */
 void UnixUDPSocket::send(
     const std::vector<uint8_t> &data, const IPAddress &address)
 {
-    if (max_bitrate_ != 0)
+    auto bits = static_cast<unsigned long>(data.size() * 8);
+
+    // Charge the rate limits.
+    if (bucket_.has_value())
     {
-        // Implement rate limit.
-        auto now = std::chrono::steady_clock::now();
+        bucket_->consume(bits);
+    }
 
-        if (now < next_time_)
-        {
-            std::this_thread::sleep_for(next_time_ - now);
-        }
+    if (peer_max_bitrate_ != 0)
+    {
+        peer_buckets_.try_emplace(address, peer_max_bitrate_)
+        .first->second.consume(bits);
+    }
 
-        next_time_ = now + (1000 * 1000 * data.size() * 8) / max_bitrate_ * 1us;
+    if (connect_peers_)
+    {
+        send_connected_(data, address);
+        return;
     }
 
     // Destination address structure.
@@ -113,6 +195,39 @@ void UnixUDPSocket::send(
 }
 
 
+/** \copydoc UDPSocket::send_delay(const IPAddress &)
+ *
+ *  This is the larger of the interface's (max_bitrate) and the destination's
+ *  (peer_max_bitrate) delays.  Destinations that have recovered their full
+ *  bitrate are forgotten.
+ */
+std::chrono::nanoseconds UnixUDPSocket::send_delay(const IPAddress &address)
+{
+    auto delay = std::chrono::nanoseconds::zero();
+
+    if (bucket_.has_value())
+    {
+        delay = bucket_->delay();
+    }
+
+    auto it = peer_buckets_.find(address);
+
+    if (it != peer_buckets_.end())
+    {
+        if (it->second.full())
+        {
+            peer_buckets_.erase(it);
+        }
+        else
+        {
+            delay = std::max(delay, it->second.delay());
+        }
+    }
+
+    return delay;
+}
+
+
 /** \copydoc UDPSocket::receive(const std::chrono::nanoseconds &)
  *
  *  \note The timeout precision of this implementation is 1 millisecond.
@@ -124,6 +239,12 @@ std::pair<std::vector<uint8_t>, IPAddress> UnixUDPSocket::receive(
 {
     std::chrono::milliseconds timeout_ms =
         std::chrono::duration_cast<std::chrono::milliseconds>(timeout);
+
+    if (connect_peers_)
+    {
+        return receive_connected_(static_cast<int>(timeout_ms.count()));
+    }
+
     struct pollfd fds = {socket_, POLLIN, 0};
     auto result = syscalls_->poll(
                       &fds, 1, static_cast<int>(timeout_ms.count()));
@@ -146,7 +267,7 @@ std::pair<std::vector<uint8_t>, IPAddress> UnixUDPSocket::receive(
         // Datagram available for reading.
         else if (fds.revents & POLLIN)
         {
-            return receive_();
+            return receive_(socket_);
         }
     }
 
@@ -155,6 +276,51 @@ std::pair<std::vector<uint8_t>, IPAddress> UnixUDPSocket::receive(
 }
 
 
+/** \copydoc UDPSocket::timestamp()
+ *
+ *  The time is only known if the socket was constructed with
+ *  kernel_timestamps enabled.
+ *
+ *  \remarks
+ *      Not threadsafe, this must be called from the thread that called \ref
+ *      receive.
+ */
+std::optional<std::chrono::steady_clock::time_point> UnixUDPSocket::timestamp()
+{
+    return timestamp_;
+}
+
+
+/** Create a socket connected to a destination.
+ *
+ *  The socket is bound to the same address and port as the main socket.
+ *
+ *  \param address The IP address/port to connect to.
+ *  \returns The file descriptor of the connected socket.
+ *  \throws std::system_error if a system call produces an error.
+ */
+int UnixUDPSocket::connect_(const IPAddress &address)
+{
+    int fd = open_socket_();
+    struct sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(address.port()));
+    addr.sin_addr.s_addr =
+        htonl(static_cast<uint32_t>(address.address()));
+    std::memset(addr.sin_zero, '\0', sizeof(addr.sin_zero));
+
+    if ((syscalls_->connect(fd, reinterpret_cast<struct sockaddr *>(&addr),
+                            sizeof(addr))) < 0)
+    {
+        auto error = errno;
+        syscalls_->close(fd);
+        throw std::system_error(std::error_code(error, std::system_category()));
+    }
+
+    return fd;
+}
+
+
 /** Create socket using the `port_` and `address_` member variables.
  *
  *  \throws std::system_error if a system call produces an error.
@@ -162,13 +328,86 @@ std::pair<std::vector<uint8_t>, IPAddress> UnixUDPSocket::receive(
 void UnixUDPSocket::create_socket_()
 {
     socket_ = -1;
+    socket_ = open_socket_();
+}
+
+
+/** Open a socket bound to the `port_` and `address_` member variables.
+ *
+ *  \returns The file descriptor of the new socket.
+ *  \throws std::system_error if a system call produces an error.
+ */
+int UnixUDPSocket::open_socket_()
+{
+    int fd;
 
     // Create socket.
-    if ((socket_ = syscalls_->socket(AF_INET, SOCK_DGRAM, 0)) < 0)
+    if ((fd = syscalls_->socket(AF_INET, SOCK_DGRAM, 0)) < 0)
     {
         throw std::system_error(std::error_code(errno, std::system_category()));
     }
 
+    // Close the socket before throwing the error of the last system call.
+    auto fail = [&]()
+    {
+        auto error = errno;
+        syscalls_->close(fd);
+        throw std::system_error(std::error_code(error, std::system_category()));
+    };
+
+    // Allow the connected sockets to share the address of the main socket.
+    if (connect_peers_)
+    {
+        int enable = 1;
+
+        if (syscalls_->setsockopt(
+                    fd, SOL_SOCKET, SO_REUSEADDR,
+                    &enable, sizeof(enable)) < 0)
+        {
+            fail();
+        }
+    }
+
+    // Allow multiple sockets to share the port.
+    if (reuse_port_)
+    {
+#ifdef SO_REUSEPORT
+        int enable = 1;
+
+        if (syscalls_->setsockopt(
+                    fd, SOL_SOCKET, SO_REUSEPORT,
+                    &enable, sizeof(enable)) < 0)
+        {
+            fail();
+        }
+
+#else
+        syscalls_->close(fd);
+        throw std::runtime_error(
+            "SO_REUSEPORT is not supported on this platform.");
+#endif
+    }
+
+    // Timestamp datagrams as they are received.
+    if (kernel_timestamps_)
+    {
+#ifdef SO_TIMESTAMPNS
+        int enable = 1;
+
+        if (syscalls_->setsockopt(
+                    fd, SOL_SOCKET, SO_TIMESTAMPNS,
+                    &enable, sizeof(enable)) < 0)
+        {
+            fail();
+        }
+
+#else
+        syscalls_->close(fd);
+        throw std::runtime_error(
+            "SO_TIMESTAMPNS is not supported on this platform.");
+#endif
+    }
+
     // Bind socket to port (and optionally an IP address).
     struct sockaddr_in addr;
     addr.sin_family = AF_INET;
@@ -186,11 +425,13 @@ void UnixUDPSocket::create_socket_()
 
     std::memset(addr.sin_zero, '\0', sizeof(addr.sin_zero));
 
-    if ((syscalls_->bind(socket_, reinterpret_cast<struct sockaddr *>(&addr),
+    if ((syscalls_->bind(fd, reinterpret_cast<struct sockaddr *>(&addr),
                          sizeof(addr))) < 0)
     {
-        throw std::system_error(std::error_code(errno, std::system_category()));
+        fail();
     }
+
+    return fd;
 }
 
 
@@ -199,15 +440,16 @@ void UnixUDPSocket::create_socket_()
  *  \note There must be a packet to receive, otherwise calling this method is
  *      undefined.
  *
+ *  \param fd The file descriptor of the socket to read from.
  *  \returns The data read from the socket and the IP address it was sent from.
  *  \throws std::system_error if a system call produces an error.
  */
-std::pair<std::vector<uint8_t>, IPAddress> UnixUDPSocket::receive_()
+std::pair<std::vector<uint8_t>, IPAddress> UnixUDPSocket::receive_(int fd)
 {
     // Get needed buffer size.
     int packet_size;
 
-    if ((syscalls_->ioctl(socket_, FIONREAD, &packet_size)) < 0)
+    if ((syscalls_->ioctl(fd, FIONREAD, &packet_size)) < 0)
     {
         throw std::system_error(std::error_code(errno, std::system_category()));
     }
@@ -217,9 +459,19 @@ std::pair<std::vector<uint8_t>, IPAddress> UnixUDPSocket::receive_()
     buffer.resize(static_cast<size_t>(packet_size));
     struct sockaddr_in addr;
     socklen_t addrlen = sizeof(addr);
-    auto size = syscalls_->recvfrom(
-                    socket_, buffer.data(), buffer.size(), 0,
-                    reinterpret_cast<struct sockaddr *>(&addr), &addrlen);
+    ssize_t size;
+    timestamp_.reset();
+
+    if (kernel_timestamps_)
+    {
+        size = receive_timestamped_(fd, buffer, addr, addrlen);
+    }
+    else
+    {
+        size = syscalls_->recvfrom(
+                   fd, buffer.data(), buffer.size(), 0,
+                   reinterpret_cast<struct sockaddr *>(&addr), &addrlen);
+    }
 
     // Handle errors and extract IP address.
     if (size < 0)
@@ -241,6 +493,224 @@ std::pair<std::vector<uint8_t>, IPAddress> UnixUDPSocket::receive_()
 }
 
 
+/** Read a datagram, and the time the kernel received it, from a socket.
+ *
+ *  The time is stored for \ref timestamp.
+ *
+ *  \param fd The file descriptor of the socket to read from.
+ *  \param buffer The buffer to read the datagram into.
+ *  \param addr The address structure to read the source address into.
+ *  \param addrlen The length of \p addr, updated to the length of the source
+ *      address.
+ *  \returns The number of bytes read or -1 if an error occurred.
+ */
+ssize_t UnixUDPSocket::receive_timestamped_(
+    int fd, std::vector<uint8_t> &buffer, struct sockaddr_in &addr,
+    socklen_t &addrlen)
+{
+    struct iovec iov = {buffer.data(), buffer.size()};
+    alignas(struct cmsghdr) char control[
+        CMSG_SPACE(sizeof(struct timespec))];
+    struct msghdr msg;
+    std::memset(&msg, '\0', sizeof(msg));
+    msg.msg_name = &addr;
+    msg.msg_namelen = addrlen;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    auto size = syscalls_->recvmsg(fd, &msg, 0);
+    addrlen = msg.msg_namelen;
+
+    if (size < 0)
+    {
+        return size;
+    }
+
+#ifdef SO_TIMESTAMPNS
+
+    for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr;
+            cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+        if (cmsg->cmsg_level == SOL_SOCKET &&
+                cmsg->cmsg_type == SCM_TIMESTAMPNS)
+        {
+            struct timespec time;
+            std::memcpy(&time, CMSG_DATA(cmsg), sizeof(time));
+            // The kernel uses the realtime clock, convert it to the steady
+            // clock by the age of the datagram.
+            auto now = std::chrono::steady_clock::now();
+            auto realtime = std::chrono::system_clock::now();
+            auto age = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           realtime.time_since_epoch()) -
+                       (std::chrono::seconds(time.tv_sec) +
+                        std::chrono::nanoseconds(time.tv_nsec));
+            timestamp_ = now - std::max(age, std::chrono::nanoseconds::zero());
+        }
+    }
+
+#endif
+    return size;
+}
+
+
+/** Receive from the main socket and all connected sockets.
+ *
+ *  Datagrams from a connected destination are only delivered to the
+ *  destination's socket, so all sockets must be polled.  Polling starts with a
+ *  different socket each time, so a busy socket cannot starve the others.
+ *
+ *  An error on a connected socket (such as an ICMP port unreachable) marks the
+ *  destination as unreachable and closes the socket.
+ *
+ *  \param timeout The poll timeout in milliseconds.
+ *  \returns The data read from a socket and the IP address it was sent from.
+ *      The data is empty if no datagram was received.
+ *  \throws std::system_error if a system call produces an error.
+ */
+std::pair<std::vector<uint8_t>, IPAddress> UnixUDPSocket::receive_connected_(
+    int timeout)
+{
+    std::vector<struct pollfd> fds;
+    std::vector<IPAddress> peers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        for (auto fd : closing_)
+        {
+            syscalls_->close(fd);
+        }
+
+        closing_.clear();
+        fds.push_back({socket_, POLLIN, 0});
+
+        for (auto &peer : peer_sockets_)
+        {
+            fds.push_back({peer.second, POLLIN, 0});
+            peers.push_back(peer.first);
+        }
+    }
+    auto result = syscalls_->poll(fds.data(), fds.size(), timeout);
+
+    // Poll error
+    if (result < 0)
+    {
+        throw std::system_error(std::error_code(errno, std::system_category()));
+    }
+
+    // Timed out
+    if (result == 0)
+    {
+        return {std::vector<uint8_t>(), IPAddress(0)};
+    }
+
+    for (std::size_t i = 0; i < fds.size(); ++i)
+    {
+        auto n = (next_poll_ + i) % fds.size();
+
+        if (fds[n].revents == 0)
+        {
+            continue;
+        }
+
+        next_poll_ = n + 1;
+
+        // Main socket.
+        if (n == 0)
+        {
+            if (fds[n].revents & POLLERR)
+            {
+                syscalls_->close(socket_);
+                create_socket_();
+                return {std::vector<uint8_t>(), IPAddress(0)};
+            }
+
+            return receive_(socket_);
+        }
+
+        // Connected socket error, the destination is unreachable.
+        if (fds[n].revents & POLLERR)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = peer_sockets_.find(peers[n - 1]);
+
+            if (it != peer_sockets_.end() && it->second == fds[n].fd)
+            {
+                unreachable_.insert(it->first);
+                closing_.push_back(it->second);
+                peer_sockets_.erase(it);
+            }
+
+            return {std::vector<uint8_t>(), IPAddress(0)};
+        }
+
+        return receive_(fds[n].fd);
+    }
+
+    return {std::vector<uint8_t>(), IPAddress(0)};
+}
+
+
+/** Send data to a destination on it's connected socket.
+ *
+ *  The connected socket is created on the first send to the destination.
+ *  Data sent to an unreachable destination is dropped.  A destination is
+ *  marked as unreachable if its connected socket can not be created.
+ *
+ *  \param data The bytes to send.
+ *  \param address The IP address/port to send the data to.
+ *  \throws std::system_error if a system call produces an error.
+ */
+void UnixUDPSocket::send_connected_(
+    const std::vector<uint8_t> &data, const IPAddress &address)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (unreachable_.count(address) != 0)
+    {
+        return;
+    }
+
+    auto it = peer_sockets_.find(address);
+
+    if (it == peer_sockets_.end())
+    {
+        int fd;
+
+        // Failing to reach one destination (such as ENETUNREACH) must not
+        // stop sending to the others.
+        try
+        {
+            fd = connect_(address);
+        }
+        catch (const std::system_error &e)
+        {
+            unreachable_.insert(address);
+            Logger::log(
+                "can not connect to " + str(address) + ": " + e.what());
+            return;
+        }
+
+        it = peer_sockets_.emplace(address, fd).first;
+    }
+
+    auto err = syscalls_->sendto(
+                   it->second, data.data(), data.size(), 0, nullptr, 0);
+
+    if (err < 0)
+    {
+        // Reported by an ICMP error in response to an earlier datagram.
+        if (errno == ECONNREFUSED)
+        {
+            unreachable_.insert(address);
+            return;
+        }
+
+        throw std::system_error(std::error_code(errno, std::system_category()));
+    }
+}
+
+
 /** \copydoc UDPSocket::print_(std::ostream &os)const
  *
  *  An example:
@@ -249,6 +719,8 @@ std::pair<std::vector<uint8_t>, IPAddress> UnixUDPSocket::receive_()
  *      port 14555;
  *      address 127.0.0.1;
  *      max_bitrate 262144;
+ *      peer_max_bitrate 65536;
+ *      connect_peers yes;
  *  }
  *  ```
  *
@@ -269,6 +741,21 @@ std::ostream &UnixUDPSocket::print_(std::ostream &os) const
         os << "    max_bitrate " << max_bitrate_ << ";" << std::endl;
     }
 
+    if (peer_max_bitrate_ != 0)
+    {
+        os << "    peer_max_bitrate " << peer_max_bitrate_ << ";" << std::endl;
+    }
+
+    if (connect_peers_)
+    {
+        os << "    connect_peers yes;" << std::endl;
+    }
+
+    if (kernel_timestamps_)
+    {
+        os << "    kernel_timestamps yes;" << std::endl;
+    }
+
     os << "}";
     return os;
 }
@@ -20,13 +20,18 @@
 
 
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <iterator>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <set>
 #include <vector>
 
 #include "IPAddress.hpp"
+#include "TokenBucket.hpp"
 #include "UDPSocket.hpp"
 #include "UnixSyscalls.hpp"
 
@@ -39,14 +44,24 @@ class UnixUDPSocket : public UDPSocket
         UnixUDPSocket(
             unsigned int port, std::optional<IPAddress> address = {},
             unsigned long max_bitrate = 0,
+            unsigned long peer_max_bitrate = 0,
+            bool reuse_port = false,
+            bool connect_peers = false,
+            bool kernel_timestamps = false,
             std::unique_ptr<UnixSyscalls> syscalls =
                 std::make_unique<UnixSyscalls>());
         virtual ~UnixUDPSocket();
+        virtual void forget(const IPAddress &address) final;
+        virtual bool reachable(const IPAddress &address) final;
         virtual void send(
             const std::vector<uint8_t> &data, const IPAddress &address) final;
+        virtual std::chrono::nanoseconds send_delay(
+            const IPAddress &address) final;
         virtual std::pair<std::vector<uint8_t>, IPAddress> receive(
             const std::chrono::nanoseconds &timeout =
                 std::chrono::nanoseconds::zero()) final;
+        virtual std::optional<std::chrono::steady_clock::time_point>
+        timestamp() final;
 
     protected:
         std::ostream &print_(std::ostream &os) const final;
@@ -56,12 +71,32 @@ class UnixUDPSocket : public UDPSocket
         unsigned int port_;
         std::optional<IPAddress> address_;
         unsigned long max_bitrate_;
+        unsigned long peer_max_bitrate_;
+        bool reuse_port_;
+        bool connect_peers_;
+        bool kernel_timestamps_;
         std::unique_ptr<UnixSyscalls> syscalls_;
         int socket_;
-        std::chrono::time_point<std::chrono::steady_clock> next_time_;
+        std::optional<TokenBucket<>> bucket_;
+        std::map<IPAddress, TokenBucket<>> peer_buckets_;
+        std::map<IPAddress, int> peer_sockets_;
+        std::set<IPAddress> unreachable_;
+        std::vector<int> closing_;
+        std::size_t next_poll_;
+        std::optional<std::chrono::steady_clock::time_point> timestamp_;
+        std::mutex mutex_;
         // Methods
+        int connect_(const IPAddress &address);
         void create_socket_();
-        std::pair<std::vector<uint8_t>, IPAddress> receive_();
+        int open_socket_();
+        std::pair<std::vector<uint8_t>, IPAddress> receive_(int fd);
+        std::pair<std::vector<uint8_t>, IPAddress> receive_connected_(
+            int timeout);
+        ssize_t receive_timestamped_(
+            int fd, std::vector<uint8_t> &buffer, struct sockaddr_in &addr,
+            socklen_t &addrlen);
+        void send_connected_(
+            const std::vector<uint8_t> &data, const IPAddress &address);
 };
 
 
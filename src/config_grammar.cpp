@@ -65,6 +65,22 @@ namespace config
     const std::string error<default_action_option>::error_message =
         "expected 'accept' or 'reject'";
 
+    template<>
+    const std::string error<deduplicate>::error_message =
+        "expected a valid window in milliseconds";
+
+    template<>
+    const std::string error<profile>::error_message =
+        "expected a valid sampling period";
+
+    template<>
+    const std::string error<trace_period>::error_message =
+        "expected a valid trace period";
+
+    template<>
+    const std::string error<stats>::error_message =
+        "expected a valid socket path";
+
     template<>
     const std::string error<port>::error_message =
         "expected a valid port number";
@@ -77,6 +93,66 @@ namespace config
     const std::string error<max_bitrate>::error_message =
         "expected a valid bitrate";
 
+    template<>
+    const std::string error<peer_max_bitrate>::error_message =
+        "expected a valid bitrate";
+
+    template<>
+    const std::string error<threads>::error_message =
+        "expected a valid number of threads";
+
+    template<>
+    const std::string error<idle_timeout>::error_message =
+        "expected a valid timeout in milliseconds";
+
+    template<>
+    const std::string error<connect_peers>::error_message =
+        "expected 'yes' or 'no'";
+
+    template<>
+    const std::string error<kernel_timestamps>::error_message =
+        "expected 'yes' or 'no'";
+
+    template<>
+    const std::string error<aggregate>::error_message =
+        "expected a valid number of bytes";
+
+    template<>
+    const std::string error<aggregate_delay>::error_message =
+        "expected a valid delay in milliseconds";
+
+    template<>
+    const std::string error<multicast>::error_message =
+        "expected a valid multicast group";
+
+    template<>
+    const std::string error<subnet>::error_message =
+        "expected a valid IP subnet";
+
+    template<>
+    const std::string error<weight>::error_message =
+        "expected a valid weight";
+
+    template<>
+    const std::string error<path>::error_message =
+        "expected a valid socket path";
+
+    template<>
+    const std::string error<name>::error_message =
+        "expected a valid shared memory name";
+
+    template<>
+    const std::string error<ring_size>::error_message =
+        "expected a valid ring size";
+
+    template<>
+    const std::string error<records>::error_message =
+        "expected a valid number of records";
+
+    template<>
+    const std::string error<files>::error_message =
+        "expected a valid number of files";
+
     template<>
     const std::string error<device>::error_message =
         "expected a valid serial port device name";
@@ -93,6 +169,22 @@ namespace config
     const std::string error<preload>::error_message =
         "expected a valid MAVLink address";
 
+    template<>
+    const std::string error<low_latency>::error_message =
+        "expected 'yes' or 'no'";
+
+    template<>
+    const std::string error<read_min_bytes>::error_message =
+        "expected a valid number of bytes";
+
+    template<>
+    const std::string error<read_timeout>::error_message =
+        "expected a valid timeout in milliseconds";
+
+    template<>
+    const std::string error<read_buffer_size>::error_message =
+        "expected a valid number of bytes";
+
     template<>
     const std::string error<chain_name>::error_message =
         "expected a valid chain name";
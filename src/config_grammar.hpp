@@ -147,6 +147,64 @@ namespace config
     struct max_bitrate : integer {};
     template<> struct store<max_bitrate> : yes<max_bitrate> {};
 
+    // Maximum bitrate number (per destination).
+    struct peer_max_bitrate : integer {};
+    template<> struct store<peer_max_bitrate> : yes<peer_max_bitrate> {};
+
+    // Number of receive threads (sockets sharing the port).
+    struct threads : integer {};
+    template<> struct store<threads> : yes<threads> {};
+
+    // Time before an idle peer's connection is removed (in milliseconds).
+    struct idle_timeout : integer {};
+    template<> struct store<idle_timeout> : yes<idle_timeout> {};
+
+    // Use a connected socket for each peer.
+    struct connect_peers : yesno {};
+    template<> struct store<connect_peers> : yes<connect_peers> {};
+
+    // Timestamp received datagrams in the kernel.
+    struct kernel_timestamps : yesno {};
+    template<> struct store<kernel_timestamps> : yes<kernel_timestamps> {};
+
+    // Aggregate packets into UDP packets of up to this size (in bytes).
+    struct aggregate : integer {};
+    template<> struct store<aggregate> : yes<aggregate> {};
+
+    // Time to hold packets for aggregation (in milliseconds).
+    struct aggregate_delay : integer {};
+    template<> struct store<aggregate_delay> : yes<aggregate_delay> {};
+
+    // Multicast group to transmit to (IP address and optionally port number).
+    struct multicast
+        : seq<integer, rep<3, seq<one<'.'>, integer>>,
+          opt<one<':'>, integer>> {};
+    template<> struct store<multicast> : yes<multicast> {};
+
+    // Transmit weight of the peers within an IP subnet.
+    struct subnet
+        : seq<integer, rep<3, seq<one<'.'>, integer>>,
+          opt<one<'/'>, integer>> {};
+    template<> struct store<subnet> : yes<subnet> {};
+    struct weight : integer {};
+    template<> struct store<weight> : yes<weight> {};
+
+    // Unix domain socket path.
+    struct path : plus<sor<alnum, one<'.', '_', '-', '/'>>> {};
+    template<> struct store<path> : yes<path> {};
+
+    // Shared memory object name and ring size.
+    struct name : seq<one<'/'>, plus<sor<alnum, one<'.', '_', '-'>>>> {};
+    template<> struct store<name> : yes<name> {};
+    struct ring_size : integer {};
+    template<> struct store<ring_size> : yes<ring_size> {};
+
+    // Decision log records per file and number of files.
+    struct records : integer {};
+    template<> struct store<records> : yes<records> {};
+    struct files : integer {};
+    template<> struct store<files> : yes<files> {};
+
     // Serial port device name.
     struct device : plus<sor<alnum, one<'.', '_', '/'>>> {};
     template<> struct store<device> : yes<device> {};
@@ -159,7 +217,23 @@ namespace config
     struct flow_control : yesno {};
     template<> struct store<flow_control> : yes<flow_control> {};
 
-    // Serial port address preload.
+    // Serial port driver low latency mode.
+    struct low_latency : yesno {};
+    template<> struct store<low_latency> : yes<low_latency> {};
+
+    // Serial port minimum read size (VMIN).
+    struct read_min_bytes : integer {};
+    template<> struct store<read_min_bytes> : yes<read_min_bytes> {};
+
+    // Serial port inter-byte read timeout in milliseconds (VTIME).
+    struct read_timeout : integer {};
+    template<> struct store<read_timeout> : yes<read_timeout> {};
+
+    // Serial port read buffer size.
+    struct read_buffer_size : integer {};
+    template<> struct store<read_buffer_size> : yes<read_buffer_size> {};
+
+    // Address preload (serial port or multicast group).
     struct preload : mavaddr {};
     template<> struct store<preload> : yes<preload> {};
 
@@ -254,30 +328,121 @@ namespace config
     template<> struct store<default_action>
         : yes_without_content<default_action> {};
 
+    // Window to suppress duplicate packets within (in milliseconds).
+    struct deduplicate : integer {};
+    template<> struct store<deduplicate> : yes<deduplicate> {};
+    struct s_deduplicate
+    : a1_statement<TAO_PEGTL_STRING("deduplicate"), deduplicate> {};
+
+    // Time one in this many filter chain evaluations.
+    struct profile : integer {};
+    template<> struct store<profile> : yes<profile> {};
+    struct s_profile
+    : a1_statement<TAO_PEGTL_STRING("profile"), profile> {};
+
+    // Trace one in this many packets, optionally only those matching a
+    // condition.
+    struct trace_period : integer {};
+    template<> struct store<trace_period> : yes<trace_period> {};
+    struct trace
+    : seq<TAO_PEGTL_STRING("trace"), p<must<trace_period>>, opt<p<condition>>,
+      p<must<eos>>> {};
+    template<> struct store<trace> : yes_without_content<trace> {};
+
+    // Unix domain socket to serve statistics on.
+    struct stats : path {};
+    template<> struct store<stats> : yes<stats> {};
+    struct s_stats : a1_statement<TAO_PEGTL_STRING("stats"), stats> {};
+
     // UDP connection block.
     struct s_port : a1_statement<TAO_PEGTL_STRING("port"), port> {};
     struct s_address : a1_statement<TAO_PEGTL_STRING("address"), address> {};
     struct s_max_bitrate
     : a1_statement<TAO_PEGTL_STRING("max_bitrate"), max_bitrate> {};
+    struct s_peer_max_bitrate
+    : a1_statement<TAO_PEGTL_STRING("peer_max_bitrate"), peer_max_bitrate> {};
+    struct s_threads : a1_statement<TAO_PEGTL_STRING("threads"), threads> {};
+    struct s_idle_timeout
+    : a1_statement<TAO_PEGTL_STRING("idle_timeout"), idle_timeout> {};
+    struct s_connect_peers
+    : a1_statement<TAO_PEGTL_STRING("connect_peers"), connect_peers> {};
+    struct s_kernel_timestamps
+    : a1_statement<TAO_PEGTL_STRING("kernel_timestamps"), kernel_timestamps> {};
+    struct s_aggregate
+    : a1_statement<TAO_PEGTL_STRING("aggregate"), aggregate> {};
+    struct s_aggregate_delay
+    : a1_statement<TAO_PEGTL_STRING("aggregate_delay"), aggregate_delay> {};
+    struct s_multicast
+    : a1_statement<TAO_PEGTL_STRING("multicast"), multicast> {};
+    struct s_preload : a1_statement<TAO_PEGTL_STRING("preload"), preload> {};
+    struct peer_weight
+    : seq<TAO_PEGTL_STRING("weight"), p<must<subnet>>, p<must<weight>>,
+      p<must<eos>>> {};
+    template<> struct store<peer_weight> : yes_without_content<peer_weight> {};
+    // NOTE: s_aggregate_delay must come before s_aggregate, which is a prefix.
     struct udp
     : t_block<TAO_PEGTL_STRING("udp"),
-      s_port, s_address, s_max_bitrate, s_catch> {};
+      s_port, s_address, s_max_bitrate, s_peer_max_bitrate, s_threads,
+      peer_weight, s_idle_timeout, s_connect_peers, s_kernel_timestamps,
+      s_multicast, s_preload, s_aggregate_delay, s_aggregate, s_catch> {};
     template<> struct store<udp> : yes_without_content<udp> {};
 
+    // Unix domain socket block.
+    struct s_path : a1_statement<TAO_PEGTL_STRING("path"), path> {};
+    struct unix_
+    : t_block<TAO_PEGTL_STRING("unix"), s_path, s_idle_timeout, s_catch> {};
+    template<> struct store<unix_> : yes_without_content<unix_> {};
+
+    // Shared memory block.
+    struct s_name : a1_statement<TAO_PEGTL_STRING("name"), name> {};
+    struct s_ring_size
+    : a1_statement<TAO_PEGTL_STRING("ring_size"), ring_size> {};
+    struct shm
+    : t_block<TAO_PEGTL_STRING("shm"), s_name, s_ring_size, s_catch> {};
+    template<> struct store<shm> : yes_without_content<shm> {};
+
     // Serial port block.
     struct s_device : a1_statement<TAO_PEGTL_STRING("device"), device> {};
     struct s_baudrate : a1_statement<TAO_PEGTL_STRING("baudrate"), baudrate> {};
     struct s_flow_control
     : a1_statement<TAO_PEGTL_STRING("flow_control"), flow_control> {};
-    struct s_preload : a1_statement<TAO_PEGTL_STRING("preload"), preload> {};
+    struct s_low_latency
+    : a1_statement<TAO_PEGTL_STRING("low_latency"), low_latency> {};
+    struct s_read_min_bytes
+    : a1_statement<TAO_PEGTL_STRING("read_min_bytes"), read_min_bytes> {};
+    struct s_read_timeout
+    : a1_statement<TAO_PEGTL_STRING("read_timeout"), read_timeout> {};
+    struct s_read_buffer_size
+    : a1_statement<TAO_PEGTL_STRING("read_buffer_size"), read_buffer_size> {};
     struct serial
     : t_block<TAO_PEGTL_STRING("serial"),
-      s_device, s_baudrate, s_flow_control, s_preload, s_catch> {};
+      s_device, s_baudrate, s_flow_control, s_preload, s_low_latency,
+      s_read_min_bytes, s_read_timeout, s_read_buffer_size, s_catch> {};
     template<> struct store<serial> : yes_without_content<serial> {};
 
+    // Decision log block.
+    struct s_records : a1_statement<TAO_PEGTL_STRING("records"), records> {};
+    struct s_files : a1_statement<TAO_PEGTL_STRING("files"), files> {};
+    struct decision_log
+    : t_block<TAO_PEGTL_STRING("decision_log"),
+      s_path, s_records, s_files, s_catch> {};
+    template<> struct store<decision_log>
+        : yes_without_content<decision_log> {};
+
+    // Flight recorder block.
+    struct flight_recorder
+    : t_block<TAO_PEGTL_STRING("flight_recorder"),
+      s_path, s_records, s_catch> {};
+    template<> struct store<flight_recorder>
+        : yes_without_content<flight_recorder> {};
+
     // Combine grammar.
-    struct block : sor<udp, serial, chain_container> {};
-    struct statement : sor<default_action, s_catch> {};
+    struct block
+        : sor<udp, unix_, shm, serial, decision_log, flight_recorder,
+          chain_container> {};
+    struct statement
+        : sor<default_action, s_deduplicate, s_profile, s_stats, trace,
+          s_catch> {};
     struct element : sor<comment, block, statement> {};
     struct elements : plus<pad<element, ignored>> {};
     struct grammar : seq<must<elements>, eof> {};
@@ -305,6 +470,18 @@ namespace config
     template<>
     const std::string error<default_action_option>::error_message;
 
+    template<>
+    const std::string error<deduplicate>::error_message;
+
+    template<>
+    const std::string error<profile>::error_message;
+
+    template<>
+    const std::string error<trace_period>::error_message;
+
+    template<>
+    const std::string error<stats>::error_message;
+
     template<>
     const std::string error<port>::error_message;
 
@@ -314,6 +491,51 @@ namespace config
     template<>
     const std::string error<max_bitrate>::error_message;
 
+    template<>
+    const std::string error<peer_max_bitrate>::error_message;
+
+    template<>
+    const std::string error<threads>::error_message;
+
+    template<>
+    const std::string error<idle_timeout>::error_message;
+
+    template<>
+    const std::string error<connect_peers>::error_message;
+
+    template<>
+    const std::string error<kernel_timestamps>::error_message;
+
+    template<>
+    const std::string error<aggregate>::error_message;
+
+    template<>
+    const std::string error<aggregate_delay>::error_message;
+
+    template<>
+    const std::string error<multicast>::error_message;
+
+    template<>
+    const std::string error<subnet>::error_message;
+
+    template<>
+    const std::string error<weight>::error_message;
+
+    template<>
+    const std::string error<path>::error_message;
+
+    template<>
+    const std::string error<name>::error_message;
+
+    template<>
+    const std::string error<ring_size>::error_message;
+
+    template<>
+    const std::string error<records>::error_message;
+
+    template<>
+    const std::string error<files>::error_message;
+
     template<>
     const std::string error<device>::error_message;
 
@@ -326,6 +548,18 @@ namespace config
     template<>
     const std::string error<preload>::error_message;
 
+    template<>
+    const std::string error<low_latency>::error_message;
+
+    template<>
+    const std::string error<read_min_bytes>::error_message;
+
+    template<>
+    const std::string error<read_timeout>::error_message;
+
+    template<>
+    const std::string error<read_buffer_size>::error_message;
+
     template<>
     const std::string error<chain_name>::error_message;
 
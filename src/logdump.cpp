@@ -0,0 +1,88 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "DecisionLog.hpp"
+
+
+namespace po = boost::program_options;
+
+
+/** mavtables-logdump: Convert mavtables decision logs to text or CSV.
+ *
+ *  Each file given on the command line is written to stdout in order.
+ */
+int main(int argc, const char *argv[])
+{
+    try
+    {
+        po::options_description options(
+            "usage: " + std::string(argv[0]) + " [--csv] FILE...");
+        options.add_options()
+        ("help,h", "print this message")
+        ("csv", "write CSV instead of text")
+        ("file", po::value<std::vector<std::string>>(), "decision log file");
+        po::positional_options_description positional;
+        positional.add("file", -1);
+        po::variables_map vm;
+        po::store(
+            po::command_line_parser(argc, argv)
+            .options(options).positional(positional).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help") || !vm.count("file"))
+        {
+            std::cout << options << std::endl;
+            return vm.count("help") ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        bool csv = vm.count("csv") > 0;
+
+        if (csv)
+        {
+            std::cout << DecisionLog::CSV_HEADER << "\n";
+        }
+
+        for (const auto &path : vm["file"].as<std::vector<std::string>>())
+        {
+            std::ifstream file(path, std::ios::binary);
+
+            if (!file)
+            {
+                throw std::runtime_error("could not open " + path);
+            }
+
+            DecisionLog::dump(file, std::cout, csv);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -18,6 +18,8 @@
 #include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 
 #include <boost/program_options.hpp>
@@ -27,6 +29,8 @@
 #include "ConfigParser.hpp"
 #include "Logger.hpp"
 #include "Options.hpp"
+#include "Stats.hpp"
+#include "StatsServer.hpp"
 #include "utility.hpp"
 
 
@@ -51,16 +55,44 @@ int main(int argc, const char *argv[])
                 std::cout << *config;
             }
 
+            if (options.stats() || options.rules())
+            {
+                auto path = config->stats();
+
+                if (!path.has_value())
+                {
+                    throw std::runtime_error(
+                        "the configuration file has no 'stats' statement");
+                }
+
+                auto stats = StatsServer::fetch(path.value());
+
+                if (options.stats())
+                {
+                    std::cout << stats << std::flush;
+                }
+
+                if (options.rules())
+                {
+                    std::istringstream metrics(stats);
+                    Stats::write_rules(std::cout, metrics);
+                    std::cout << std::flush;
+                }
+            }
+
             if (options.run())
             {
                 Logger::level(options.loglevel());
+                Logger::async(true);
                 auto app = config->make_app();
                 app->run();
+                Logger::async(false);
             }
         }
     }
     catch (const std::exception &e)
     {
+        Logger::async(false);
         std::cerr << "error: " << e.what() << std::endl;
         return EXIT_FAILURE;
     }
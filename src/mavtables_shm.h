@@ -0,0 +1,442 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+/* Shared memory ring buffers for local mavtables clients.
+ *
+ * A `shm` interface creates a POSIX shared memory object containing two
+ * single producer, single consumer ring buffers: one carrying packets from
+ * mavtables to the client and one carrying packets from the client to
+ * mavtables.  Clients read packets in place, without copying them out of the
+ * ring.
+ *
+ * Each ring holds a sequence of records, a 32 bit length followed by that many
+ * bytes of MAVLink packet data, padded to a multiple of 4 bytes.  A record
+ * never wraps around the end of the ring, a length of MAVTABLES_SHM_WRAP marks
+ * that the next record starts at the beginning of the ring.
+ *
+ * The consumer of a ring can sleep until data arrives, the producer wakes it
+ * with a (process shared) futex on Linux.  On other systems waiting falls back
+ * to polling every millisecond.
+ *
+ * Usage by a client:
+ *
+ *     struct mavtables_shm *shm = mavtables_shm_attach("/mavtables");
+ *     struct mavtables_shm_ring *rx = mavtables_shm_to_client(shm);
+ *     struct timespec timeout = {1, 0};
+ *     uint32_t len;
+ *     const uint8_t *packet;
+ *
+ *     while (mavtables_shm_wait(rx, &timeout))
+ *     {
+ *         while ((packet = mavtables_shm_peek(rx, &len)) != NULL)
+ *         {
+ *             record(packet, len);
+ *             mavtables_shm_consume(rx, len);
+ *         }
+ *     }
+ *
+ *     mavtables_shm_detach(shm);
+ *
+ * This header only depends on the C library and works from both C and C++.
+ */
+
+
+#ifndef MAVTABLES_SHM_H_
+#define MAVTABLES_SHM_H_
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define MAVTABLES_SHM_MAGIC 0x4853544du
+#define MAVTABLES_SHM_VERSION 1u
+#define MAVTABLES_SHM_WRAP 0xffffffffu
+
+
+/* Control block of a ring, followed by `size` bytes of data.
+ *
+ * The head and tail are free running byte counters, the producer only writes
+ * the head and the consumer only writes the tail.  They are kept on separate
+ * cache lines so the two processes do not contend for them.
+ */
+struct mavtables_shm_ring
+{
+    uint32_t head;      /* Bytes written by the producer. */
+    uint8_t pad0_[60];
+    uint32_t tail;      /* Bytes consumed by the consumer. */
+    uint8_t pad1_[60];
+    uint32_t seq;       /* Futex word, incremented on every write. */
+    uint32_t waiting;   /* Set while the consumer is going to sleep. */
+    uint32_t size;      /* Size of the data in bytes (a power of 2). */
+    uint32_t dropped;   /* Records dropped because the ring was full. */
+    uint8_t pad2_[48];
+};
+
+
+/* Header of the shared memory object, followed by the ring from mavtables to
+ * the client and then the ring from the client to mavtables.
+ */
+struct mavtables_shm
+{
+    uint32_t magic;     /* MAVTABLES_SHM_MAGIC once initialized. */
+    uint32_t version;   /* MAVTABLES_SHM_VERSION. */
+    uint32_t ring_size; /* Size of the data of each ring in bytes. */
+    uint8_t pad_[52];
+};
+
+
+/* Size of a shared memory object with the given ring size. */
+static inline size_t mavtables_shm_size(uint32_t ring_size)
+{
+    return sizeof(struct mavtables_shm) +
+           2 * (sizeof(struct mavtables_shm_ring) + ring_size);
+}
+
+
+/* Ring carrying packets from mavtables to the client. */
+static inline struct mavtables_shm_ring *mavtables_shm_to_client(
+    struct mavtables_shm *shm)
+{
+    return (struct mavtables_shm_ring *)(shm + 1);
+}
+
+
+/* Ring carrying packets from the client to mavtables. */
+static inline struct mavtables_shm_ring *mavtables_shm_from_client(
+    struct mavtables_shm *shm)
+{
+    return (struct mavtables_shm_ring *)(
+               (uint8_t *)mavtables_shm_to_client(shm) +
+               sizeof(struct mavtables_shm_ring) + shm->ring_size);
+}
+
+
+/* Data of a ring. */
+static inline uint8_t *mavtables_shm_data(struct mavtables_shm_ring *ring)
+{
+    return (uint8_t *)(ring + 1);
+}
+
+
+/* Initialize a shared memory object (done by mavtables).  The ring size must
+ * be a power of 2 and the memory at least mavtables_shm_size(ring_size) bytes.
+ */
+static inline void mavtables_shm_init(
+    struct mavtables_shm *shm, uint32_t ring_size)
+{
+    memset(shm, 0, mavtables_shm_size(ring_size));
+    shm->version = MAVTABLES_SHM_VERSION;
+    shm->ring_size = ring_size;
+    mavtables_shm_to_client(shm)->size = ring_size;
+    mavtables_shm_from_client(shm)->size = ring_size;
+    __atomic_store_n(&shm->magic, MAVTABLES_SHM_MAGIC, __ATOMIC_RELEASE);
+}
+
+
+/* Wake the consumer of a ring if it is waiting. */
+static inline void mavtables_shm_wake_(struct mavtables_shm_ring *ring)
+{
+    __atomic_fetch_add(&ring->seq, 1, __ATOMIC_SEQ_CST);
+
+    if (__atomic_load_n(&ring->waiting, __ATOMIC_SEQ_CST))
+    {
+#ifdef __linux__
+        syscall(SYS_futex, &ring->seq, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+    }
+}
+
+
+/* Write a record to a ring of the given size (producer only).  Returns 0 on
+ * success or -1 if there is not enough free space, in which case the record is
+ * dropped.
+ *
+ * The size is passed in, instead of taken from the ring, so that mavtables
+ * never writes outside of the ring, whatever a client leaves in the shared
+ * control block.
+ */
+static inline int mavtables_shm_write_sized(
+    struct mavtables_shm_ring *ring, uint32_t size, const void *data,
+    uint32_t len)
+{
+    uint32_t head = ring->head;
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    uint32_t mask = size - 1;
+    uint32_t record;
+    uint32_t offset = head & mask & ~3u;
+    uint32_t skip = 0;
+    uint8_t *buffer = mavtables_shm_data(ring);
+
+    if (len > size / 2)
+    {
+        __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+        return -1;
+    }
+
+    record = 4 + ((len + 3) & ~3u);
+
+    /* Records do not wrap, skip to the start of the ring instead. */
+    if (size - offset < record)
+    {
+        skip = size - offset;
+    }
+
+    if (record > size / 2 || head - tail > size ||
+            size - (head - tail) < skip + record)
+    {
+        __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+        return -1;
+    }
+
+    if (skip != 0)
+    {
+        uint32_t wrap = MAVTABLES_SHM_WRAP;
+        memcpy(buffer + offset, &wrap, 4);
+        head += skip;
+        offset = 0;
+    }
+
+    memcpy(buffer + offset, &len, 4);
+    memcpy(buffer + offset + 4, data, len);
+    __atomic_store_n(&ring->head, head + record, __ATOMIC_RELEASE);
+    mavtables_shm_wake_(ring);
+    return 0;
+}
+
+
+/* Write a record to a ring (producer only).  Returns 0 on success or -1 if
+ * there is not enough free space, in which case the record is dropped.
+ */
+static inline int mavtables_shm_write(
+    struct mavtables_shm_ring *ring, const void *data, uint32_t len)
+{
+    return mavtables_shm_write_sized(ring, ring->size, data, len);
+}
+
+
+/* Drop everything in a ring after finding a corrupt record (consumer only). */
+static inline const uint8_t *mavtables_shm_reset_(
+    struct mavtables_shm_ring *ring, uint32_t head)
+{
+    __atomic_store_n(&ring->tail, head, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+
+/* Get the next record of a ring of the given size in place (consumer only).
+ * Returns a pointer to the record's data and stores its length in `len`, or
+ * returns NULL if the ring is empty.  The data is valid until
+ * mavtables_shm_consume is called.
+ *
+ * Every record is checked against the size and the amount of data in the ring
+ * before it is returned.  A corrupt record (such as one with a length running
+ * past the end of the ring) empties the ring and is counted as dropped.  As
+ * with mavtables_shm_write_sized, the size is passed in so the consumer does
+ * not trust the shared control block.
+ */
+static inline const uint8_t *mavtables_shm_peek_sized(
+    struct mavtables_shm_ring *ring, uint32_t size, uint32_t *len)
+{
+    uint32_t tail = ring->tail;
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint32_t mask = size - 1;
+    uint32_t offset = tail & mask;
+    uint8_t *buffer = mavtables_shm_data(ring);
+
+    if (head == tail)
+    {
+        return NULL;
+    }
+
+    if (head - tail > size || (offset & 3) != 0)
+    {
+        return mavtables_shm_reset_(ring, head);
+    }
+
+    memcpy(len, buffer + offset, 4);
+
+    /* Skip to the start of the ring. */
+    if (*len == MAVTABLES_SHM_WRAP)
+    {
+        if (head - tail < size - offset)
+        {
+            return mavtables_shm_reset_(ring, head);
+        }
+
+        tail += size - offset;
+        offset = 0;
+        __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+
+        if (head == tail)
+        {
+            return NULL;
+        }
+
+        memcpy(len, buffer, 4);
+    }
+
+    if (*len > size - offset - 4 || 4 + ((*len + 3) & ~3u) > head - tail)
+    {
+        return mavtables_shm_reset_(ring, head);
+    }
+
+    return buffer + offset + 4;
+}
+
+
+/* Get the next record of a ring in place (consumer only).  Returns a pointer
+ * to the record's data and stores its length in `len`, or returns NULL if the
+ * ring is empty.  The data is valid until mavtables_shm_consume is called.
+ */
+static inline const uint8_t *mavtables_shm_peek(
+    struct mavtables_shm_ring *ring, uint32_t *len)
+{
+    return mavtables_shm_peek_sized(ring, ring->size, len);
+}
+
+
+/* Release the record returned by mavtables_shm_peek (consumer only). */
+static inline void mavtables_shm_consume(
+    struct mavtables_shm_ring *ring, uint32_t len)
+{
+    __atomic_store_n(
+        &ring->tail, ring->tail + 4 + ((len + 3) & ~3u), __ATOMIC_RELEASE);
+}
+
+
+/* Wait until a ring is not empty (consumer only).  Waits forever if the
+ * timeout is NULL.  Returns 1 if there is data to read, otherwise 0.
+ */
+static inline int mavtables_shm_wait(
+    struct mavtables_shm_ring *ring, const struct timespec *timeout)
+{
+    uint32_t seq = __atomic_load_n(&ring->seq, __ATOMIC_SEQ_CST);
+    int ready;
+
+    if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) != ring->tail)
+    {
+        return 1;
+    }
+
+    if (timeout != NULL && timeout->tv_sec == 0 && timeout->tv_nsec == 0)
+    {
+        return 0;
+    }
+
+    __atomic_store_n(&ring->waiting, 1, __ATOMIC_SEQ_CST);
+
+    if (__atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) == ring->tail)
+    {
+#ifdef __linux__
+        syscall(SYS_futex, &ring->seq, FUTEX_WAIT, seq, timeout, NULL, 0);
+#else
+        struct timespec delay = {0, 1000000};
+
+        if (timeout != NULL && timeout->tv_sec == 0 &&
+                timeout->tv_nsec < delay.tv_nsec)
+        {
+            delay.tv_nsec = timeout->tv_nsec;
+        }
+
+        (void)seq;
+        nanosleep(&delay, NULL);
+#endif
+    }
+
+    __atomic_store_n(&ring->waiting, 0, __ATOMIC_SEQ_CST);
+    ready = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) != ring->tail;
+    return ready;
+}
+
+
+/* Map the shared memory object of a mavtables `shm` interface.  Returns NULL
+ * if the object does not exist or has not been initialized by mavtables.
+ */
+static inline struct mavtables_shm *mavtables_shm_attach(const char *name)
+{
+    struct stat info;
+    struct mavtables_shm *shm;
+    int fd = shm_open(name, O_RDWR, 0);
+
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    if (fstat(fd, &info) < 0 ||
+            (size_t)info.st_size < sizeof(struct mavtables_shm))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    shm = (struct mavtables_shm *)mmap(
+              NULL, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+              fd, 0);
+    close(fd);
+
+    if (shm == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    if (__atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) !=
+            MAVTABLES_SHM_MAGIC ||
+            shm->version != MAVTABLES_SHM_VERSION ||
+            mavtables_shm_size(shm->ring_size) > (size_t)info.st_size)
+    {
+        munmap(shm, (size_t)info.st_size);
+        return NULL;
+    }
+
+    return shm;
+}
+
+
+/* Unmap a shared memory object mapped with mavtables_shm_attach. */
+static inline void mavtables_shm_detach(struct mavtables_shm *shm)
+{
+    munmap(shm, mavtables_shm_size(shm->ring_size));
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* MAVTABLES_SHM_H_ */
@@ -0,0 +1,39 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "tracepoints.hpp"
+
+
+#ifdef HAVE_SYS_SDT_H
+
+// Semaphores of the tracepoints, set by tools while they are attached.
+extern "C"
+{
+    __attribute__((section(".probes")))
+    volatile unsigned short mavtables_packet_parsed_semaphore = 0;
+    __attribute__((section(".probes")))
+    volatile unsigned short mavtables_filter_decision_semaphore = 0;
+    __attribute__((section(".probes")))
+    volatile unsigned short mavtables_queue_push_semaphore = 0;
+    __attribute__((section(".probes")))
+    volatile unsigned short mavtables_queue_pop_semaphore = 0;
+    __attribute__((section(".probes")))
+    volatile unsigned short mavtables_packet_sent_semaphore = 0;
+}
+
+#endif
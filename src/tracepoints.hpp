@@ -0,0 +1,160 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef TRACEPOINTS_HPP_
+#define TRACEPOINTS_HPP_
+
+
+#include <chrono>
+
+#include "config.hpp"
+#include "MAVAddress.hpp"
+#include "Packet.hpp"
+
+
+/** \defgroup tracepoints Tracepoints
+ *
+ *  Static user space (USDT) tracepoints on the packet path.
+ *
+ *  When mavtables is built with `sys/sdt.h` (from SystemTap) each tracepoint
+ *  is a single `nop` instruction along with a note in the executable, which
+ *  tools such as `bpftrace` and `perf` can attach to on a running mavtables.
+ *  Each tracepoint has a semaphore which is set while a tool is attached and
+ *  the arguments are only computed while it is.  Without `sys/sdt.h` the
+ *  tracepoints are removed entirely.
+ *
+ *  The tracepoints (of provider `mavtables`) and their arguments are:
+ *  - `packet_parsed` - A packet was received and parsed, before it is routed.
+ *      - msgid, source, dest, connection, packet, received
+ *  - `filter_decision` - The filter decided whether to send a packet on a
+ *      connection.
+ *      - msgid, source, dest, from, connection, accept, priority, rule
+ *  - `queue_push` - A packet was added to a connection's queue.
+ *      - msgid, source, dest, connection, packet, priority, received, queued
+ *  - `queue_pop` - A packet was taken from a connection's queue.
+ *      - msgid, source, dest, connection, packet, priority, received, queued
+ *  - `packet_sent` - A packet was written by an interface.
+ *      - msgid, source, dest, connection, packet, bytes, received
+ *
+ *  Addresses are given as 16 bit integers (see \ref MAVAddress::address) and
+ *  dest is -1 for packets without a destination.  Connections and packets are
+ *  given as pointers, which identify them across tracepoints.  from is the
+ *  connection the packet was received on, or 0 if it is not known.  rule is
+ *  the line of the deciding rule in the configuration file, or 0 for the
+ *  default action.  Times are in nanoseconds of `CLOCK_MONOTONIC`, the same
+ *  clock as `nsecs` in `bpftrace`.
+ */
+
+
+#ifdef HAVE_SYS_SDT_H
+
+    #ifdef __clang__
+        #pragma clang diagnostic push
+        #pragma clang diagnostic ignored "-Wreserved-id-macro"
+    #endif
+
+    #define _SDT_HAS_SEMAPHORES 1
+
+    #ifdef __clang__
+        #pragma clang diagnostic pop
+    #endif
+
+    #include <sys/sdt.h>
+
+    extern "C"
+    {
+        extern volatile unsigned short mavtables_packet_parsed_semaphore;
+        extern volatile unsigned short mavtables_filter_decision_semaphore;
+        extern volatile unsigned short mavtables_queue_push_semaphore;
+        extern volatile unsigned short mavtables_queue_pop_semaphore;
+        extern volatile unsigned short mavtables_packet_sent_semaphore;
+    }
+
+    /** Determine whether a tool is attached to a tracepoint.
+     *
+     *  \ingroup tracepoints
+     *  \param name The name of the tracepoint.
+     */
+    #define TRACEPOINT_ENABLED(name) \
+        __builtin_expect(mavtables_##name##_semaphore != 0, 0)
+
+    /** Fire a tracepoint.
+     *
+     *  This should only be used after checking \ref TRACEPOINT_ENABLED.
+     *
+     *  \ingroup tracepoints
+     *  \param name The name of the tracepoint.
+     *  \param ... The arguments of the tracepoint, integers or pointers.
+     */
+    #define TRACEPOINT(name, ...) STAP_PROBEV(mavtables, name, __VA_ARGS__)
+
+#else
+
+    #define TRACEPOINT_ENABLED(name) false
+    #define TRACEPOINT(name, ...)
+
+#endif
+
+
+/** Helpers to convert tracepoint arguments to integers.
+ *
+ *  \ingroup tracepoints
+ */
+namespace tracepoints
+{
+
+    /** Get the source address of a packet.
+     *
+     *  \param packet The packet to get the source address of.
+     *  \returns The source address as a 16 bit integer.
+     */
+    inline unsigned int source(const Packet &packet)
+    {
+        return packet.source().address();
+    }
+
+
+    /** Get the destination address of a packet.
+     *
+     *  \param packet The packet to get the destination address of.
+     *  \returns The destination address as a 16 bit integer or -1 if the
+     *      packet does not have a destination.
+     */
+    inline int dest(const Packet &packet)
+    {
+        auto dest = packet.dest();
+        return dest ? static_cast<int>(dest->address()) : -1;
+    }
+
+
+    /** Get a time in nanoseconds.
+     *
+     *  \param time The time to convert.
+     *  \returns The time in nanoseconds since the epoch of the steady clock,
+     *      which is `CLOCK_MONOTONIC` on Linux.
+     */
+    inline long long nanoseconds(std::chrono::steady_clock::time_point time)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   time.time_since_epoch()).count();
+    }
+
+}
+
+
+#endif // TRACEPOINTS_HPP_
@@ -0,0 +1,100 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "unix_socket.hpp"
+#include "UnixSyscalls.hpp"
+
+
+/** \defgroup unix_socket Unix Domain Socket Functions
+ *
+ *  Functions shared by the unix domain sockets.
+ */
+
+
+/** Build a unix domain socket address from a path.
+ *
+ *  A path starting with a null character is a Linux abstract socket name
+ *  and is used as is, otherwise the path is null terminated.
+ *
+ *  \ingroup unix_socket
+ *  \param path The filesystem path (or abstract name) of the socket.
+ *  \param addr The socket address structure to fill in.
+ *  \returns The length of the socket address.
+ *  \throws std::invalid_argument if the \p path is empty or too long.
+ */
+socklen_t unix_address(const std::string &path, struct sockaddr_un &addr)
+{
+    if (path.empty())
+    {
+        throw std::invalid_argument("Socket path is empty.");
+    }
+
+    bool abstract = path[0] == '\0';
+
+    if (path.size() + (abstract ? 0 : 1) > sizeof(addr.sun_path))
+    {
+        throw std::invalid_argument(
+            "Socket path (" + path + ") is longer than " +
+            std::to_string(sizeof(addr.sun_path) - 1) + " characters.");
+    }
+
+    std::memset(&addr, '\0', sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.data(), path.size());
+    return static_cast<socklen_t>(
+               offsetof(struct sockaddr_un, sun_path) + path.size() +
+               (abstract ? 0 : 1));
+}
+
+
+/** Remove a unix domain socket from the filesystem.
+ *
+ *  Only sockets are removed, so a mistyped path can not delete some other
+ *  file.
+ *
+ *  \ingroup unix_socket
+ *  \param syscalls The object to use for unix system calls.
+ *  \param path The filesystem path of the socket.
+ *  \retval true %If there is no longer a file at \p path.
+ *  \retval false %If the file at \p path is not a socket.
+ */
+bool remove_socket(UnixSyscalls &syscalls, const std::string &path)
+{
+    struct stat status;
+
+    if (syscalls.lstat(path.c_str(), &status) < 0)
+    {
+        return true;
+    }
+
+    if (!S_ISSOCK(status.st_mode))
+    {
+        return false;
+    }
+
+    syscalls.unlink(path.c_str());
+    return true;
+}
@@ -0,0 +1,34 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef UNIX_SOCKET_HPP_
+#define UNIX_SOCKET_HPP_
+
+
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "UnixSyscalls.hpp"
+
+
+socklen_t unix_address(const std::string &path, struct sockaddr_un &addr);
+bool remove_socket(UnixSyscalls &syscalls, const std::string &path);
+
+
+#endif // UNIX_SOCKET_HPP_
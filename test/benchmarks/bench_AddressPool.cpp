@@ -0,0 +1,136 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <cstddef>
+#include <vector>
+
+#include "AddressPool.hpp"
+#include "MAVAddress.hpp"
+
+#include "benchmark.hpp"
+
+
+namespace
+{
+
+    // Number of components in the pool, a large network.
+    constexpr unsigned int COMPONENTS = 64;
+
+
+    /** Build the addresses of the components in the pool.
+     *
+     *  \returns \ref COMPONENTS addresses spread over several systems.
+     */
+    std::vector<MAVAddress> components()
+    {
+        std::vector<MAVAddress> addresses;
+
+        for (unsigned int i = 0; i < COMPONENTS; ++i)
+        {
+            addresses.emplace_back(i / 8 + 1, i % 8 + 1);
+        }
+
+        return addresses;
+    }
+
+
+    // Refresh components already in the pool, as each received packet does.
+    void add(benchmark::State &state)
+    {
+        AddressPool<> pool;
+        auto addresses = components();
+
+        for (const auto &address : addresses)
+        {
+            pool.add(address);
+        }
+
+        state.start();
+
+        for (std::size_t i = 0; i < state.iterations(); ++i)
+        {
+            pool.add(addresses[i % COMPONENTS]);
+        }
+
+        state.stop();
+    }
+
+
+    // Half of the lookups are for components not in the pool.
+    void contains(benchmark::State &state)
+    {
+        AddressPool<> pool;
+        auto addresses = components();
+
+        for (std::size_t i = 0; i < addresses.size(); i += 2)
+        {
+            pool.add(addresses[i]);
+        }
+
+        state.start();
+
+        for (std::size_t i = 0; i < state.iterations(); ++i)
+        {
+            benchmark::keep(pool.contains(addresses[i % COMPONENTS]));
+        }
+
+        state.stop();
+    }
+
+
+    // List every component in the pool.
+    void addresses(benchmark::State &state)
+    {
+        AddressPool<> pool;
+
+        for (const auto &address : components())
+        {
+            pool.add(address);
+        }
+
+        state.start();
+
+        for (std::size_t i = 0; i < state.iterations(); ++i)
+        {
+            benchmark::keep(pool.addresses());
+        }
+
+        state.stop();
+    }
+
+}
+
+
+namespace benchmark
+{
+
+    /** AddressPool benchmarks.
+     *
+     *  \returns Benchmarks of AddressPool add, contains and addresses with a
+     *      pool of 64 components.
+     */
+    std::vector<Benchmark> address_pool()
+    {
+        return
+        {
+            {"AddressPool/add", add},
+            {"AddressPool/contains", contains},
+            {"AddressPool/addresses", addresses}
+        };
+    }
+
+}
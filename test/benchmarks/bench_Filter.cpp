@@ -0,0 +1,115 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Accept.hpp"
+#include "Chain.hpp"
+#include "Filter.hpp"
+#include "If.hpp"
+#include "MAVAddress.hpp"
+#include "MAVSubnet.hpp"
+#include "PacketVersion2.hpp"
+#include "Reject.hpp"
+
+#include "benchmark.hpp"
+#include "common_Packet.hpp"
+
+
+namespace
+{
+
+    /** Run a packet through a filter with a synthetic ruleset.
+     *
+     *  The ruleset has \p rules - 1 rules that match the packet's type but not
+     *  its source, followed by an accept rule.  Every rule is therefore
+     *  evaluated for each packet, the worst case for the filter.
+     *
+     *  \param state The benchmark state.
+     *  \param rules The number of rules in the default chain.
+     */
+    void will_accept(benchmark::State &state, std::size_t rules)
+    {
+        Chain chain("bench");
+
+        for (std::size_t i = 1; i < rules; ++i)
+        {
+            auto system = static_cast<unsigned int>(i % 191 + 1);
+            chain.append(
+                std::make_unique<Reject>(
+                    If().type("PING").from(
+                        MAVSubnet(MAVAddress(system, 0), 0xFF, 0x00))));
+        }
+
+        chain.append(std::make_unique<Accept>());
+        Filter filter(std::move(chain));
+        auto ping = packet_v2::Packet(to_vector(PingV2()));
+        MAVAddress address("127.1");
+        state.start();
+
+        for (std::size_t i = 0; i < state.iterations(); ++i)
+        {
+            auto result = filter.will_accept(ping, address);
+            benchmark::keep(result);
+        }
+
+        state.stop();
+    }
+
+
+    void rules_1(benchmark::State &state)
+    {
+        will_accept(state, 1);
+    }
+
+
+    void rules_16(benchmark::State &state)
+    {
+        will_accept(state, 16);
+    }
+
+
+    void rules_256(benchmark::State &state)
+    {
+        will_accept(state, 256);
+    }
+
+}
+
+
+namespace benchmark
+{
+
+    /** Filter benchmarks.
+     *
+     *  \returns Benchmarks of Filter::will_accept over rulesets of different
+     *      sizes.
+     */
+    std::vector<Benchmark> filter()
+    {
+        return
+        {
+            {"Filter/will_accept/1", rules_1},
+            {"Filter/will_accept/16", rules_16},
+            {"Filter/will_accept/256", rules_256}
+        };
+    }
+
+}
@@ -0,0 +1,163 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "PacketParser.hpp"
+
+#include "benchmark.hpp"
+#include "common_Packet.hpp"
+
+
+namespace
+{
+
+    // Number of packets in each byte stream.
+    constexpr std::size_t PACKETS = 64;
+
+
+    /** Parse a byte stream, looping over it until enough packets are parsed.
+     *
+     *  One operation is one complete packet.
+     *
+     *  \param state The benchmark state.
+     *  \param stream The bytes to feed to the parser.
+     */
+    void parse(benchmark::State &state, const std::vector<uint8_t> &stream)
+    {
+        PacketParser parser;
+        std::size_t packets = 0;
+        std::size_t i = 0;
+        state.start();
+
+        while (packets < state.iterations())
+        {
+            auto packet = parser.parse_byte(stream[i]);
+
+            if (packet)
+            {
+                benchmark::keep(packet);
+                ++packets;
+            }
+
+            if (++i == stream.size())
+            {
+                i = 0;
+            }
+        }
+
+        state.stop();
+    }
+
+
+    /** Concatenate copies of a packet into a byte stream.
+     *
+     *  \param packet The bytes of a single packet.
+     *  \returns \ref PACKETS copies of the \p packet.
+     */
+    std::vector<uint8_t> repeat(const std::vector<uint8_t> &packet)
+    {
+        std::vector<uint8_t> stream;
+
+        for (std::size_t i = 0; i < PACKETS; ++i)
+        {
+            stream.insert(stream.end(), packet.begin(), packet.end());
+        }
+
+        return stream;
+    }
+
+
+    void v1(benchmark::State &state)
+    {
+        parse(state, repeat(to_vector(PingV1())));
+    }
+
+
+    void v2(benchmark::State &state)
+    {
+        parse(state, repeat(to_vector(PingV2())));
+    }
+
+
+    void v2_signed(benchmark::State &state)
+    {
+        parse(state, repeat(to_vector_with_sig(PingV2())));
+    }
+
+
+    // Mixed v1.0, v2.0 and signed packets, each followed by line noise that
+    // does not contain a start byte.
+    void noisy(benchmark::State &state)
+    {
+        std::vector<std::vector<uint8_t>> packets =
+        {
+            to_vector(PingV1()), to_vector(PingV2()),
+            to_vector_with_sig(PingV2()), to_vector(HeartbeatV1()),
+            to_vector(HeartbeatV2())
+        };
+        std::minstd_rand random(42);
+        std::uniform_int_distribution<unsigned int> noise(0, 255);
+        std::uniform_int_distribution<std::size_t> length(0, 16);
+        std::vector<uint8_t> stream;
+
+        for (std::size_t i = 0; i < PACKETS; ++i)
+        {
+            const auto &packet = packets[i % packets.size()];
+            stream.insert(stream.end(), packet.begin(), packet.end());
+
+            for (auto n = length(random); n > 0; --n)
+            {
+                auto byte = static_cast<uint8_t>(noise(random));
+
+                if (byte == 0xFE || byte == 0xFD)
+                {
+                    byte = 0x00;
+                }
+
+                stream.push_back(byte);
+            }
+        }
+
+        parse(state, stream);
+    }
+
+}
+
+
+namespace benchmark
+{
+
+    /** PacketParser benchmarks.
+     *
+     *  \returns Benchmarks of parsing byte streams into packets.
+     */
+    std::vector<Benchmark> packet_parser()
+    {
+        return
+        {
+            {"PacketParser/v1", v1},
+            {"PacketParser/v2", v2},
+            {"PacketParser/v2_signed", v2_signed},
+            {"PacketParser/noisy", noisy}
+        };
+    }
+
+}
@@ -0,0 +1,129 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Packet.hpp"
+#include "PacketQueue.hpp"
+#include "PacketVersion2.hpp"
+
+#include "benchmark.hpp"
+#include "common_Packet.hpp"
+
+
+namespace
+{
+
+    /** Push packets from multiple producer threads and pop them from one.
+     *
+     *  This is the pattern of a connection's queue, many interface threads
+     *  push while the interface that owns the connection pops.  One operation
+     *  is one packet pushed and popped.
+     *
+     *  \param state The benchmark state.
+     *  \param producers The number of threads pushing packets.
+     */
+    void push_pop(benchmark::State &state, std::size_t producers)
+    {
+        PacketQueue queue;
+        std::shared_ptr<const Packet> packet =
+            std::make_shared<packet_v2::Packet>(to_vector(PingV2()));
+        std::vector<std::thread> threads;
+        state.start();
+
+        for (std::size_t n = 0; n < producers; ++n)
+        {
+            // The first producer also pushes the remainder.
+            auto count = state.iterations() / producers;
+
+            if (n == 0)
+            {
+                count += state.iterations() % producers;
+            }
+
+            threads.emplace_back([&queue, packet, count]()
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    queue.push(packet, static_cast<int>(i % 3));
+                }
+            });
+        }
+
+        for (std::size_t i = 0; i < state.iterations(); ++i)
+        {
+            benchmark::keep(queue.pop());
+        }
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        state.stop();
+    }
+
+
+    void producers_1(benchmark::State &state)
+    {
+        push_pop(state, 1);
+    }
+
+
+    void producers_2(benchmark::State &state)
+    {
+        push_pop(state, 2);
+    }
+
+
+    void producers_4(benchmark::State &state)
+    {
+        push_pop(state, 4);
+    }
+
+
+    void producers_8(benchmark::State &state)
+    {
+        push_pop(state, 8);
+    }
+
+}
+
+
+namespace benchmark
+{
+
+    /** PacketQueue benchmarks.
+     *
+     *  \returns Benchmarks of PacketQueue push/pop contention with different
+     *      numbers of producer threads.
+     */
+    std::vector<Benchmark> packet_queue()
+    {
+        return
+        {
+            {"PacketQueue/push_pop/1", producers_1},
+            {"PacketQueue/push_pop/2", producers_2},
+            {"PacketQueue/push_pop/4", producers_4},
+            {"PacketQueue/push_pop/8", producers_8}
+        };
+    }
+
+}
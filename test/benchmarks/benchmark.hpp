@@ -0,0 +1,93 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef BENCHMARK_HPP_
+#define BENCHMARK_HPP_
+
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+/** A minimal microbenchmark harness.
+ *
+ *  Each benchmark is a function taking a \ref benchmark::State.  It performs
+ *  any setup, calls \ref benchmark::State::start, runs the operation under
+ *  test \ref benchmark::State::iterations times and then calls \ref
+ *  benchmark::State::stop.  The harness grows the number of iterations until
+ *  the timed section runs long enough to be measured and reports the time and
+ *  number of heap allocations per operation.
+ */
+namespace benchmark
+{
+
+    /** The timing state of a single benchmark run.
+     */
+    class State
+    {
+        public:
+            State(std::size_t iterations);
+            std::size_t iterations() const;
+            void start();
+            void stop();
+            std::chrono::nanoseconds elapsed() const;
+            unsigned long long allocations() const;
+
+        private:
+            std::size_t iterations_;
+            std::chrono::steady_clock::time_point start_time_;
+            std::chrono::nanoseconds elapsed_;
+            unsigned long long start_allocations_;
+            unsigned long long allocations_;
+    };
+
+
+    /** A named benchmark.
+     */
+    struct Benchmark
+    {
+        std::string name;           //!< Name printed in the report.
+        void (*function)(State &);  //!< The benchmark function.
+    };
+
+
+    unsigned long long allocations();
+
+
+    /** Prevent the compiler from optimizing away a value.
+     *
+     *  \param value The value to keep, it is treated as if it was read.
+     */
+    template <class T>
+    inline void keep(const T &value)
+    {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+
+    // Benchmark suites, one per bench_*.cpp file.
+    std::vector<Benchmark> address_pool();
+    std::vector<Benchmark> filter();
+    std::vector<Benchmark> packet_parser();
+    std::vector<Benchmark> packet_queue();
+
+}
+
+
+#endif // BENCHMARK_HPP_
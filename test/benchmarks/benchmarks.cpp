@@ -0,0 +1,279 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "benchmark.hpp"
+
+
+namespace
+{
+
+    // Total number of heap allocations made by the process.
+    std::atomic<unsigned long long> allocations_(0);
+
+    // Minimum duration of the timed section of a run.
+    constexpr std::chrono::milliseconds MIN_TIME(250);
+
+    // Upper limit on the number of iterations of a run.
+    constexpr std::size_t MAX_ITERATIONS = 1000000000;
+
+
+    /** Run a benchmark until the timed section takes at least \ref MIN_TIME.
+     *
+     *  \param benchmark The benchmark to run.
+     *  \returns The state of the final run.
+     */
+    benchmark::State measure(const benchmark::Benchmark &benchmark)
+    {
+        std::size_t iterations = 1;
+
+        while (true)
+        {
+            benchmark::State state(iterations);
+            benchmark.function(state);
+            auto elapsed = state.elapsed();
+
+            if (elapsed >= MIN_TIME || iterations >= MAX_ITERATIONS)
+            {
+                return state;
+            }
+
+            // Aim 40% past the minimum time, growing by at most 10x.
+            double scale = 10.0;
+
+            if (elapsed.count() > 0)
+            {
+                scale = 1.4 * static_cast<double>(
+                            std::chrono::nanoseconds(MIN_TIME).count()) /
+                        static_cast<double>(elapsed.count());
+            }
+
+            iterations = std::min(
+                             {iterations * 10, MAX_ITERATIONS,
+                              std::max(iterations + 1,
+                                       static_cast<std::size_t>(
+                                           static_cast<double>(iterations) *
+                                           scale))
+                             });
+        }
+    }
+
+
+    /** Determine if a benchmark was selected on the command line.
+     *
+     *  \param name The name of the benchmark.
+     *  \param filters Substrings given on the command line, if empty all
+     *      benchmarks are selected.
+     *  \retval true %If the benchmark should be run.
+     *  \retval false %If the benchmark should be skipped.
+     */
+    bool selected(
+        const std::string &name, const std::vector<std::string> &filters)
+    {
+        if (filters.empty())
+        {
+            return true;
+        }
+
+        return std::any_of(
+                   filters.begin(), filters.end(),
+                   [&](const auto & filter)
+        {
+            return name.find(filter) != std::string::npos;
+        });
+    }
+
+}
+
+
+/** Count every (non aligned) heap allocation.
+ *
+ *  The array and nothrow forms are implemented in terms of this one.
+ */
+void *operator new(std::size_t size)
+{
+    allocations_.fetch_add(1, std::memory_order_relaxed);
+
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+
+/** Free memory allocated by the counting operator new.
+ */
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+
+/** Free memory allocated by the counting operator new.
+ */
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+
+namespace benchmark
+{
+
+    /** Construct a benchmark state.
+     *
+     *  \param iterations The number of operations the benchmark must perform
+     *      between \ref start and \ref stop.
+     */
+    State::State(std::size_t iterations)
+        : iterations_(iterations), elapsed_(0),
+          start_allocations_(0), allocations_(0)
+    {
+    }
+
+
+    /** Return the number of operations to perform.
+     *
+     *  \returns The number of operations the benchmark must perform between
+     *      \ref start and \ref stop.
+     */
+    std::size_t State::iterations() const
+    {
+        return iterations_;
+    }
+
+
+    /** Start timing, call after any setup.
+     */
+    void State::start()
+    {
+        start_allocations_ = benchmark::allocations();
+        start_time_ = std::chrono::steady_clock::now();
+    }
+
+
+    /** Stop timing, call before any teardown.
+     */
+    void State::stop()
+    {
+        auto stop_time = std::chrono::steady_clock::now();
+        allocations_ = benchmark::allocations() - start_allocations_;
+        elapsed_ = stop_time - start_time_;
+    }
+
+
+    /** Return the duration of the timed section.
+     *
+     *  \returns The time between \ref start and \ref stop.
+     */
+    std::chrono::nanoseconds State::elapsed() const
+    {
+        return elapsed_;
+    }
+
+
+    /** Return the heap allocations made in the timed section.
+     *
+     *  \returns The number of allocations between \ref start and \ref stop,
+     *      from all threads.
+     */
+    unsigned long long State::allocations() const
+    {
+        return allocations_;
+    }
+
+
+    /** Return the number of heap allocations made so far.
+     *
+     *  \returns The number of calls to operator new since the program started.
+     */
+    unsigned long long allocations()
+    {
+        return allocations_.load(std::memory_order_relaxed);
+    }
+
+}
+
+
+/** Run the microbenchmarks.
+ *
+ *  Any command line arguments are treated as substrings, only benchmarks with
+ *  a name containing one of them are run.
+ */
+int main(int argc, const char *argv[])
+{
+    try
+    {
+        std::vector<std::string> filters(argv + 1, argv + argc);
+        std::vector<benchmark::Benchmark> benchmarks;
+
+        for (auto suite :
+                {
+                    benchmark::address_pool, benchmark::filter,
+                    benchmark::packet_parser, benchmark::packet_queue
+                })
+        {
+            auto more = suite();
+            benchmarks.insert(benchmarks.end(), more.begin(), more.end());
+        }
+
+        std::cout << std::left << std::setw(40) << "benchmark" << std::right
+                  << std::setw(12) << "iterations"
+                  << std::setw(12) << "ns/op"
+                  << std::setw(12) << "allocs/op" << std::endl;
+
+        for (const auto &benchmark : benchmarks)
+        {
+            if (!selected(benchmark.name, filters))
+            {
+                continue;
+            }
+
+            auto state = measure(benchmark);
+            auto iterations = static_cast<double>(state.iterations());
+            std::cout << std::left << std::setw(40) << benchmark.name
+                      << std::right << std::setw(12) << state.iterations()
+                      << std::fixed << std::setprecision(1)
+                      << std::setw(12)
+                      << static_cast<double>(state.elapsed().count()) /
+                      iterations
+                      << std::setprecision(2) << std::setw(12)
+                      << static_cast<double>(state.allocations()) / iterations
+                      << std::endl;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -15,13 +15,17 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
+#include <cstring>
 #include <iostream>
 #include <memory>
 #include <sstream>
 #include <string>
 #include <utility>
 
+#include <sys/stat.h>
+
 #include "fakeit.hpp"
+#include "UnixSyscalls.hpp"
 
 
 /** Construct a std::shared_ptr from a fakit::Mock object.
@@ -126,3 +130,21 @@ class MockCErr
         std::stringstream buffer_;
         std::streambuf *sbuf_;
 };
+
+
+/** Mock 'lstat' to report a file of the given type at every path.
+ *
+ *  \param mock_sys The mocked system calls.
+ *  \param type The file type, such as S_IFSOCK.
+ */
+inline void mock_lstat(fakeit::Mock<UnixSyscalls> &mock_sys, mode_t type)
+{
+    fakeit::When(Method(mock_sys, lstat)).AlwaysDo(
+        [type](auto pathname, auto statbuf)
+    {
+        (void)pathname;
+        std::memset(statbuf, '\0', sizeof(*statbuf));
+        statbuf->st_mode = type;
+        return 0;
+    });
+}
@@ -348,6 +348,29 @@ namespace
         return data;
     }
 
+    // Convert a MAVLink packet structure to a vector of bytes with a valid
+    // checksum (the structures above have a placeholder checksum).
+    template <class T>
+    static std::vector<uint8_t> to_vector_with_crc(T packet)
+    {
+        std::vector<uint8_t> data = to_vector(packet);
+        auto end = data.size() - 2;
+        uint16_t crc;
+        crc_init(&crc);
+
+        for (size_t i = 1; i < end; ++i)
+        {
+            crc_accumulate(data[i], &crc);
+        }
+
+        crc_accumulate(
+            mavlink_get_msg_entry(
+                static_cast<uint32_t>(packet.msgid))->crc_extra, &crc);
+        data[end] = static_cast<uint8_t>(crc & 0xFF);
+        data[end + 1] = static_cast<uint8_t>(crc >> 8);
+        return data;
+    }
+
 #ifdef __clang__
     #pragma clang diagnostic pop
 #endif
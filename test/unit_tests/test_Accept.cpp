@@ -142,6 +142,59 @@ TEST_CASE("Accept's 'action' method determines what to do with a "
 }
 
 
+TEST_CASE("Accept's count the packets their condition matches.", "[Accept]")
+{
+    auto ping = packet_v2::Packet(to_vector(PingV2()));
+    SECTION("Without a condition.")
+    {
+        Accept accept;
+        REQUIRE(accept.hits() == 0);
+        accept.action(ping, MAVAddress("192.168"));
+        accept.action(ping, MAVAddress("172.16"));
+        REQUIRE(accept.hits() == 2);
+    }
+    SECTION("With a condition.")
+    {
+        Accept accept(If().to("192.168"));
+        accept.action(ping, MAVAddress("192.168"));
+        accept.action(ping, MAVAddress("172.16"));
+        REQUIRE(accept.hits() == 1);
+        // Copies start without hits.
+        Accept copy(accept);
+        REQUIRE(copy.hits() == 0);
+        REQUIRE(accept.clone()->hits() == 0);
+    }
+    SECTION("Not from the 'may_accept' method.")
+    {
+        Accept accept;
+        accept.may_accept(4, MAVAddress("192.168"), false);
+        REQUIRE(accept.hits() == 0);
+    }
+}
+
+
+TEST_CASE("Accept's 'may_accept' method decides from only the packet ID and "
+          "source address.", "[Accept]")
+{
+    MAVAddress source("192.168");
+    SECTION("May accept if the conditional is or may be a match.")
+    {
+        REQUIRE(Accept().may_accept(4, source, false) == true);
+        REQUIRE(Accept(If().type("PING")).may_accept(4, source, false) == true);
+        REQUIRE(Accept(If().to("172.16")).may_accept(4, source, false) == true);
+    }
+    SECTION("Continues if the conditional does not match.")
+    {
+        REQUIRE_FALSE(
+            Accept(If().type("SET_MODE")).may_accept(
+                4, source, true).has_value());
+        REQUIRE_FALSE(
+            Accept(If().from("172.16")).may_accept(
+                4, source, true).has_value());
+    }
+}
+
+
 TEST_CASE("Accept's are printable (without a condition or a priority).",
           "[Accept]")
 {
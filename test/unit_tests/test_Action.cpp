@@ -102,6 +102,23 @@ TEST_CASE("Action's 'priority' method sets and gets the priority.",
 }
 
 
+
+
+TEST_CASE("Action's 'rule' method sets and gets the deciding rule.",
+          "[Action]")
+{
+    auto result = Action::make_accept();
+    REQUIRE(result.rule() == 0);
+    result.rule(12);
+    REQUIRE(result.rule() == 12);
+    // Only the first (innermost) rule is kept.
+    result.rule(3);
+    REQUIRE(result.rule() == 12);
+    // Not used for comparison.
+    REQUIRE(result == Action::make_accept());
+}
+
+
 TEST_CASE("Action's are comparable.", "[Action]")
 {
     SECTION("with ==")
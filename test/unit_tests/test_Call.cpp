@@ -18,6 +18,7 @@
 #include <catch.hpp>
 #include <fakeit.hpp>
 
+#include "Accept.hpp"
 #include "Action.hpp"
 #include "Call.hpp"
 #include "Chain.hpp"
@@ -26,6 +27,7 @@
 #include "Packet.hpp"
 #include "PacketVersion1.hpp"
 #include "PacketVersion2.hpp"
+#include "Reject.hpp"
 #include "Rule.hpp"
 #include "utility.hpp"
 
@@ -223,6 +225,66 @@ TEST_CASE("Call's 'action' method determines what to do with a "
 }
 
 
+TEST_CASE("Call's count the packets their condition matches.", "[Call]")
+{
+    fakeit::Mock<Chain> continue_mock;
+    fakeit::When(Method(continue_mock, action)).AlwaysReturn(
+        Action::make_continue());
+    std::shared_ptr<Chain> continue_chain = mock_shared(continue_mock);
+    auto ping = packet_v2::Packet(to_vector(PingV2()));
+    Call call(continue_chain, If().to("192.168"));
+    call.action(ping, MAVAddress("192.168"));
+    call.action(ping, MAVAddress("172.16"));
+    // Counted even though the called chain does not decide the packet.
+    REQUIRE(call.hits() == 1);
+}
+
+
+TEST_CASE("Call's 'chain' method returns the chain to delegate to.", "[Call]")
+{
+    auto chain = std::make_shared<Chain>("test_chain");
+    REQUIRE(Call(chain).chain() == chain.get());
+    REQUIRE(Accept().chain() == nullptr);
+}
+
+
+TEST_CASE("Call's 'may_accept' method decides from only the packet ID and "
+          "source address.", "[Call]")
+{
+    MAVAddress source("192.168");
+    auto accept_chain = std::make_shared<Chain>("accept_chain");
+    accept_chain->append(std::make_unique<Accept>());
+    auto reject_chain = std::make_shared<Chain>("reject_chain");
+    reject_chain->append(std::make_unique<Reject>());
+    auto empty = std::make_shared<Chain>("empty_chain");
+    SECTION("Returns the result of the chain if the conditional matches.")
+    {
+        REQUIRE(Call(accept_chain).may_accept(4, source, false) == true);
+        REQUIRE(Call(reject_chain).may_accept(4, source, true) == false);
+        REQUIRE(
+            Call(reject_chain, If().type("PING")).may_accept(
+                4, source, true) == false);
+        // Evaluation continues when the chain falls through.
+        REQUIRE_FALSE(Call(empty).may_accept(4, source, false).has_value());
+    }
+    SECTION("Continues if the conditional does not match.")
+    {
+        REQUIRE_FALSE(
+            Call(accept_chain, If().type("SET_MODE")).may_accept(
+                4, source, false).has_value());
+    }
+    SECTION("Only rejects if the conditional is certain to match.")
+    {
+        REQUIRE(
+            Call(accept_chain, If().to("172.16")).may_accept(
+                4, source, false) == true);
+        REQUIRE_FALSE(
+            Call(reject_chain, If().to("172.16")).may_accept(
+                4, source, true).has_value());
+    }
+}
+
+
 TEST_CASE("Call's are printable (without a condition or a priority).", "[Call]")
 {
     auto chain = std::make_shared<TestChain>();
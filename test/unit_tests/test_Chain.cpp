@@ -15,6 +15,7 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
+#include <chrono>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -253,6 +254,141 @@ TEST_CASE("Chain's 'action' method determines what to do with a packet with "
 }
 
 
+
+
+TEST_CASE("Chain's 'action' method sets the index of the deciding rule.",
+          "[Chain]")
+{
+    auto ping = packet_v1::Packet(to_vector(PingV1()));
+    auto chain = std::make_shared<Chain>("main_chain");
+    auto subchain = std::make_shared<Chain>("sub_chain");
+    chain->append(std::make_unique<Accept>(If().to("192.168")), 10);
+    chain->append(std::make_unique<Call>(subchain, If().to("172.0/8")), 11);
+    chain->append(std::make_unique<Reject>(If().to("10.10")));
+    subchain->append(std::make_unique<Accept>(If().to("172.16")), 20);
+    REQUIRE(chain->action(ping, MAVAddress("192.168")).rule() == 10);
+    // Innermost rule.
+    REQUIRE(chain->action(ping, MAVAddress("172.16")).rule() == 20);
+    // Without index.
+    REQUIRE(chain->action(ping, MAVAddress("10.10")).rule() == 0);
+    // Copies keep the indices.
+    Chain copy(*chain);
+    REQUIRE(copy.action(ping, MAVAddress("192.168")).rule() == 10);
+}
+
+
+TEST_CASE("Chain's count the packets they evaluate.", "[Chain]")
+{
+    auto ping = packet_v1::Packet(to_vector(PingV1()));
+    auto chain = std::make_shared<Chain>("main_chain");
+    auto subchain = std::make_shared<Chain>("sub_chain");
+    chain->append(std::make_unique<Accept>(If().to("192.168")), 10);
+    chain->append(std::make_unique<Call>(subchain, If().to("172.0/8")), 11);
+    chain->append(std::make_unique<Reject>(), 12);
+    subchain->append(std::make_unique<Accept>(If().to("172.16")), 20);
+    REQUIRE(chain->packets() == 0);
+    chain->action(ping, MAVAddress("192.168"));
+    chain->action(ping, MAVAddress("172.16"));
+    chain->action(ping, MAVAddress("172.17"));
+    chain->action(ping, MAVAddress("10.10"));
+    REQUIRE(chain->packets() == 4);
+    REQUIRE(subchain->packets() == 2);
+    // Rules.
+    REQUIRE(chain->rules().size() == 3);
+    REQUIRE(chain->rules()[0]->hits() == 1);
+    REQUIRE(chain->rules()[1]->hits() == 2);
+    REQUIRE(chain->rules()[2]->hits() == 2);
+    REQUIRE(subchain->rules()[0]->hits() == 1);
+    REQUIRE(chain->indices() == std::vector<unsigned int>({10, 11, 12}));
+    // Copies start without counts.
+    Chain copy(*chain);
+    REQUIRE(copy.packets() == 0);
+    REQUIRE(copy.rules()[0]->hits() == 0);
+}
+
+
+TEST_CASE("Chain's 'profile' method times a sample of the evaluations.",
+          "[Chain]")
+{
+    auto ping = packet_v1::Packet(to_vector(PingV1()));
+    Chain chain("test_chain");
+    chain.append(std::make_unique<Accept>(If().to("192.168")));
+    SECTION("Disabled by default.")
+    {
+        for (int i = 0; i < 10; ++i)
+        {
+            chain.action(ping, MAVAddress("192.168"));
+        }
+
+        REQUIRE(chain.packets() == 10);
+        REQUIRE(chain.samples() == 0);
+        REQUIRE(chain.sample_time() == std::chrono::nanoseconds(0));
+    }
+    SECTION("Times one in every 'period' evaluations.")
+    {
+        Chain::profile(1);
+        chain.action(ping, MAVAddress("192.168"));
+        REQUIRE(chain.samples() == 1);
+        Chain::profile(4);
+
+        for (int i = 0; i < 12; ++i)
+        {
+            chain.action(ping, MAVAddress("192.168"));
+        }
+
+        Chain::profile(0);
+        REQUIRE(chain.packets() == 13);
+        REQUIRE(chain.samples() == 4);
+        REQUIRE(chain.sample_time() >= std::chrono::nanoseconds(0));
+    }
+    SECTION("Samples each chain from its own evaluations.")
+    {
+        auto subchain = std::make_shared<Chain>("test_subchain");
+        Chain outer("test_outer");
+        outer.append(std::make_unique<Call>(subchain));
+        Chain::profile(2);
+
+        for (int i = 0; i < 10; ++i)
+        {
+            outer.action(ping, MAVAddress("192.168"));
+        }
+
+        Chain::profile(0);
+        REQUIRE(outer.samples() == 5);
+        REQUIRE(subchain->samples() == 5);
+    }
+}
+
+
+TEST_CASE("Chain's 'may_accept' method decides from only the packet ID and "
+          "source address.", "[Chain]")
+{
+    MAVAddress source("192.168");
+    SECTION("When the chain is well formed.")
+    {
+        auto chain = std::make_shared<Chain>("main_chain");
+        auto subchain = std::make_shared<Chain>("sub_chain");
+        chain->append(std::make_unique<Reject>(If().type("HEARTBEAT")));
+        chain->append(std::make_unique<Accept>(If().from("10.10")));
+        chain->append(std::make_unique<Call>(subchain, If().type("PING")));
+        chain->append(std::make_unique<Reject>(If().to("172.16")));
+        subchain->append(std::make_unique<Reject>(If().from("192.0/8")));
+        REQUIRE(chain->may_accept(0, MAVAddress("10.10"), true) == false);
+        REQUIRE(chain->may_accept(4, MAVAddress("10.10"), false) == true);
+        REQUIRE(chain->may_accept(4, source, true) == false);
+        REQUIRE_FALSE(chain->may_accept(11, source, true).has_value());
+    }
+    SECTION("And throws an error when chain recursion is detected.")
+    {
+        auto chain = std::make_shared<Chain>("main_chain");
+        auto subchain = std::make_shared<Chain>("sub_chain");
+        chain->append(std::make_unique<Call>(subchain));
+        subchain->append(std::make_unique<Call>(chain));
+        REQUIRE_THROWS_AS(chain->may_accept(4, source, true), RecursionError);
+    }
+}
+
+
 TEST_CASE("Chain's are printable.", "[Chain]")
 {
     auto chain = std::make_shared<Chain>("default");
@@ -15,7 +15,10 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
+#include <cstdio>
 #include <memory>
+#include <stdexcept>
+#include <tuple>
 
 #include <catch.hpp>
 #include <fakeit.hpp>
@@ -23,7 +26,9 @@
 
 #include "config_grammar.hpp"
 #include "ConfigParser.hpp"
+#include "Deduplicator.hpp"
 #include "MAVAddress.hpp"
+#include "PacketVersion1.hpp"
 #include "PacketVersion2.hpp"
 #include "parse_tree.hpp"
 #include "utility.hpp"
@@ -686,15 +691,15 @@ TEST_CASE("'parse_filter' parses the filter from the given AST root node.",
         auto filter = parse_filter(*root);
         REQUIRE(filter != nullptr);
         auto ping_result = filter->will_accept(ping, MAVAddress("127.1"));
-        REQUIRE(ping_result.first == true);
-        REQUIRE(ping_result.second == 1);
+        REQUIRE(std::get<0>(ping_result) == true);
+        REQUIRE(std::get<1>(ping_result) == 1);
         auto heartbeat_result =
             filter->will_accept(heartbeat, MAVAddress("127.1"));
-        REQUIRE(heartbeat_result.first == true);
-        REQUIRE(heartbeat_result.second == 2);
+        REQUIRE(std::get<0>(heartbeat_result) == true);
+        REQUIRE(std::get<1>(heartbeat_result) == 2);
         auto encapsulated_result =
             filter->will_accept(encapsulated_data, MAVAddress("127.1"));
-        REQUIRE(encapsulated_result.first == false);
+        REQUIRE(std::get<0>(encapsulated_result) == false);
     }
     SECTION("Default filter action is 'accept'")
     {
@@ -707,8 +712,8 @@ TEST_CASE("'parse_filter' parses the filter from the given AST root node.",
         auto filter = parse_filter(*root);
         REQUIRE(filter != nullptr);
         auto result = filter->will_accept(ping, MAVAddress("127.1"));
-        REQUIRE(result.first == true);
-        REQUIRE(result.second == 0);
+        REQUIRE(std::get<0>(result) == true);
+        REQUIRE(std::get<1>(result) == 0);
     }
     SECTION("Default filter action is 'reject'")
     {
@@ -721,7 +726,7 @@ TEST_CASE("'parse_filter' parses the filter from the given AST root node.",
         auto filter = parse_filter(*root);
         REQUIRE(filter != nullptr);
         auto result = filter->will_accept(ping, MAVAddress("127.1"));
-        REQUIRE(result.first == false);
+        REQUIRE(std::get<0>(result) == false);
     }
     SECTION("The default, default filter action is 'reject'")
     {
@@ -733,7 +738,145 @@ TEST_CASE("'parse_filter' parses the filter from the given AST root node.",
         auto filter = parse_filter(*root);
         REQUIRE(filter != nullptr);
         auto result = filter->will_accept(ping, MAVAddress("127.1"));
-        REQUIRE(result.first == false);
+        REQUIRE(std::get<0>(result) == false);
+    }
+    SECTION("Chains are profiled.")
+    {
+        tao::pegtl::string_input<> in(
+            "profile 1;\n"
+            "chain default {\n"
+            "    accept;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        auto filter = parse_filter(*root);
+        REQUIRE(filter != nullptr);
+        filter->will_accept(ping, MAVAddress("127.1"));
+        REQUIRE(filter->default_chain().samples() == 1);
+        // Profiling is disabled by parsing a filter without it.
+        tao::pegtl::string_input<> in_without("chain default {\n}\n", "");
+        root = config::parse(in_without);
+        REQUIRE(root != nullptr);
+        filter = parse_filter(*root);
+        REQUIRE(filter != nullptr);
+        filter->will_accept(ping, MAVAddress("127.1"));
+        REQUIRE(filter->default_chain().samples() == 0);
+    }
+}
+
+
+TEST_CASE("'parse_deduplicator' parses the duplicate packet detector from the "
+          "given AST root node.", "[ConfigParser]")
+{
+    auto ping = packet_v2::Packet(to_vector(PingV2()));
+    SECTION("Duplicate packets are suppressed.")
+    {
+        tao::pegtl::string_input<> in("deduplicate 250;\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        auto deduplicator = parse_deduplicator(*root);
+        REQUIRE(deduplicator != nullptr);
+        REQUIRE_FALSE(deduplicator->duplicate(ping));
+        REQUIRE(deduplicator->duplicate(ping));
+    }
+    SECTION("Duplicate packets are not suppressed by default.")
+    {
+        tao::pegtl::string_input<> in("default_action accept;\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(parse_deduplicator(*root) == nullptr);
+    }
+    SECTION("The deduplication window must not be 0.")
+    {
+        tao::pegtl::string_input<> in("deduplicate 0;\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_THROWS_AS(parse_deduplicator(*root), std::invalid_argument);
+        REQUIRE_THROWS_WITH(
+            parse_deduplicator(*root),
+            "Deduplication window (0 ms) must be between 1 and 1000000 ms.");
+    }
+}
+
+
+
+
+TEST_CASE("'parse_decision_log' parses the decision log from the given AST "
+          "root node.", "[ConfigParser]")
+{
+    SECTION("Decisions are recorded.")
+    {
+        tao::pegtl::string_input<> in(
+            "decision_log {\n"
+            "    path parse_decision_log_test.log;\n"
+            "    records 16;\n"
+            "    files 1;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(parse_decision_log(*root) != nullptr);
+        std::remove("parse_decision_log_test.log");
+    }
+    SECTION("Decisions are not recorded by default.")
+    {
+        tao::pegtl::string_input<> in("default_action accept;\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(parse_decision_log(*root) == nullptr);
+    }
+    SECTION("The path is required.")
+    {
+        tao::pegtl::string_input<> in(
+            "decision_log {\n"
+            "    records 16;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_THROWS_AS(parse_decision_log(*root), std::invalid_argument);
+        REQUIRE_THROWS_WITH(
+            parse_decision_log(*root), "missing decision log path");
+    }
+}
+
+
+TEST_CASE("'parse_flight_recorder' parses the flight recorder from the given "
+          "AST root node.", "[ConfigParser]")
+{
+    SECTION("The flight recorder can be configured.")
+    {
+        tao::pegtl::string_input<> in(
+            "flight_recorder {\n"
+            "    path parse_flight_recorder_test.log;\n"
+            "    records 16;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        auto recorder = parse_flight_recorder(*root);
+        REQUIRE(recorder != nullptr);
+        REQUIRE(recorder->path() == "parse_flight_recorder_test.log");
+    }
+    SECTION("The flight recorder is always on.")
+    {
+        tao::pegtl::string_input<> in("default_action accept;\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        auto recorder = parse_flight_recorder(*root);
+        REQUIRE(recorder != nullptr);
+        REQUIRE(recorder->path() == FlightRecorder::DEFAULT_PATH);
+    }
+    SECTION("The number of records must be a power of 2.")
+    {
+        tao::pegtl::string_input<> in(
+            "flight_recorder {\n"
+            "    records 1000;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_THROWS_AS(
+            parse_flight_recorder(*root), std::invalid_argument);
+        REQUIRE_THROWS_WITH(
+            parse_flight_recorder(*root),
+            "Flight recorder size (1000) is not a power of 2.");
     }
 }
 
@@ -789,6 +932,35 @@ TEST_CASE("'parse_serial' parses a serial interface from a serial interface "
             "    flow_control no;\n"
             "}");
     }
+    SECTION("With receive tuning.")
+    {
+        tao::pegtl::string_input<> in(
+            "serial {\n"
+            "    device ./ttyS0;\n"
+            "    baudrate 115200;\n"
+            "    read_min_bytes 32;\n"
+            "    read_timeout 100;\n"
+            "    read_buffer_size 2048;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_FALSE(root->children.empty());
+        REQUIRE(root->children[0] != nullptr);
+        auto filter = std::make_shared<Filter>(Chain("default"));
+        auto connection_pool = std::make_shared<ConnectionPool>();
+        auto serial_port =
+            parse_serial(*root->children[0], filter, connection_pool);
+        REQUIRE(
+            str(*serial_port) ==
+            "serial {\n"
+            "    device ./ttyS0;\n"
+            "    baudrate 115200;\n"
+            "    flow_control no;\n"
+            "    read_min_bytes 32;\n"
+            "    read_timeout 100;\n"
+            "    read_buffer_size 2048;\n"
+            "}");
+    }
     SECTION("Default flow control is off.")
     {
         tao::pegtl::string_input<> in(
@@ -900,6 +1072,43 @@ TEST_CASE("'parse_serial' parses a serial interface from a serial interface "
 }
 
 
+TEST_CASE("'parse_tracer' parses the packet tracer from the given AST root "
+          "node.", "[ConfigParser]")
+{
+    auto ping = packet_v2::Packet(to_vector(PingV2()));
+    auto heartbeat = packet_v1::Packet(to_vector(HeartbeatV1()));
+    SECTION("Packets are traced.")
+    {
+        tao::pegtl::string_input<> in(
+            "trace 1 if PING;\n"
+            "trace 65536 if HEARTBEAT;\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        auto tracer = parse_tracer(*root);
+        REQUIRE(tracer != nullptr);
+        REQUIRE(tracer->check(ping));
+        REQUIRE_FALSE(tracer->check(heartbeat));
+    }
+    SECTION("Packets are not traced by default.")
+    {
+        tao::pegtl::string_input<> in("default_action accept;\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(parse_tracer(*root) == nullptr);
+    }
+    SECTION("The trace period must be in range.")
+    {
+        tao::pegtl::string_input<> in("trace 0;\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_THROWS_AS(parse_tracer(*root), std::invalid_argument);
+        REQUIRE_THROWS_WITH(
+            parse_tracer(*root),
+            "Trace period (0) must be between 1 and 65536.");
+    }
+}
+
+
 TEST_CASE("'parse_udp' parses a UDP interface from a UDP interface AST node.",
           "[ConfigParser]")
 {
@@ -915,10 +1124,11 @@ TEST_CASE("'parse_udp' parses a UDP interface from a UDP interface AST node.",
         REQUIRE(root->children[0] != nullptr);
         auto filter = std::make_shared<Filter>(Chain("default"));
         auto connection_pool = std::make_shared<ConnectionPool>();
-        auto udp_socket =
+        auto udp_sockets =
             parse_udp(*root->children[0], filter, connection_pool);
+        REQUIRE(udp_sockets.size() == 1);
         REQUIRE(
-            str(*udp_socket) ==
+            str(*udp_sockets[0]) ==
             "udp {\n"
             "    port 14500;\n"
             "}");
@@ -936,10 +1146,11 @@ TEST_CASE("'parse_udp' parses a UDP interface from a UDP interface AST node.",
         REQUIRE(root->children[0] != nullptr);
         auto filter = std::make_shared<Filter>(Chain("default"));
         auto connection_pool = std::make_shared<ConnectionPool>();
-        auto udp_socket =
+        auto udp_sockets =
             parse_udp(*root->children[0], filter, connection_pool);
+        REQUIRE(udp_sockets.size() == 1);
         REQUIRE(
-            str(*udp_socket) ==
+            str(*udp_sockets[0]) ==
             "udp {\n"
             "    port 14500;\n"
             "    address 127.0.0.1;\n"
@@ -958,10 +1169,11 @@ TEST_CASE("'parse_udp' parses a UDP interface from a UDP interface AST node.",
         REQUIRE(root->children[0] != nullptr);
         auto filter = std::make_shared<Filter>(Chain("default"));
         auto connection_pool = std::make_shared<ConnectionPool>();
-        auto udp_socket =
+        auto udp_sockets =
             parse_udp(*root->children[0], filter, connection_pool);
+        REQUIRE(udp_sockets.size() == 1);
         REQUIRE(
-            str(*udp_socket) ==
+            str(*udp_sockets[0]) ==
             "udp {\n"
             "    port 14500;\n"
             "    max_bitrate 8192;\n"
@@ -981,16 +1193,390 @@ TEST_CASE("'parse_udp' parses a UDP interface from a UDP interface AST node.",
         REQUIRE(root->children[0] != nullptr);
         auto filter = std::make_shared<Filter>(Chain("default"));
         auto connection_pool = std::make_shared<ConnectionPool>();
-        auto udp_socket =
+        auto udp_sockets =
             parse_udp(*root->children[0], filter, connection_pool);
+        REQUIRE(udp_sockets.size() == 1);
         REQUIRE(
-            str(*udp_socket) ==
+            str(*udp_sockets[0]) ==
             "udp {\n"
             "    port 14500;\n"
             "    address 127.0.0.1;\n"
             "    max_bitrate 8192;\n"
             "}");
     }
+    SECTION("With per destination bitrate limit.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    port 14500;\n"
+            "    peer_max_bitrate 4096;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_FALSE(root->children.empty());
+        REQUIRE(root->children[0] != nullptr);
+        auto filter = std::make_shared<Filter>(Chain("default"));
+        auto connection_pool = std::make_shared<ConnectionPool>();
+        auto udp_sockets =
+            parse_udp(*root->children[0], filter, connection_pool);
+        REQUIRE(udp_sockets.size() == 1);
+        REQUIRE(
+            str(*udp_sockets[0]) ==
+            "udp {\n"
+            "    port 14500;\n"
+            "    peer_max_bitrate 4096;\n"
+            "}");
+    }
+    SECTION("With multiple threads.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    port 14500;\n"
+            "    threads 3;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_FALSE(root->children.empty());
+        REQUIRE(root->children[0] != nullptr);
+        auto filter = std::make_shared<Filter>(Chain("default"));
+        auto connection_pool = std::make_shared<ConnectionPool>();
+        auto udp_sockets =
+            parse_udp(*root->children[0], filter, connection_pool);
+        REQUIRE(udp_sockets.size() == 3);
+
+        for (const auto &udp_socket : udp_sockets)
+        {
+            REQUIRE(udp_socket != nullptr);
+            REQUIRE(
+                str(*udp_socket) ==
+                "udp {\n"
+                "    port 14500;\n"
+                "}");
+        }
+    }
+    SECTION("Zero threads is an error.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    port 14500;\n"
+            "    threads 0;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_FALSE(root->children.empty());
+        REQUIRE(root->children[0] != nullptr);
+        auto filter = std::make_shared<Filter>(Chain("default"));
+        auto connection_pool = std::make_shared<ConnectionPool>();
+        REQUIRE_THROWS_AS(
+            parse_udp(*root->children[0], filter, connection_pool),
+            std::invalid_argument);
+        REQUIRE_THROWS_WITH(
+            parse_udp(*root->children[0], filter, connection_pool),
+            "number of threads must be at least 1");
+    }
+    SECTION("With peer weights.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    port 14500;\n"
+            "    weight 192.168.0.0/16 4;\n"
+            "    weight 10.0.0.7 2;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_FALSE(root->children.empty());
+        REQUIRE(root->children[0] != nullptr);
+        auto filter = std::make_shared<Filter>(Chain("default"));
+        auto connection_pool = std::make_shared<ConnectionPool>();
+        auto udp_sockets =
+            parse_udp(*root->children[0], filter, connection_pool);
+        REQUIRE(udp_sockets.size() == 1);
+        REQUIRE(udp_sockets[0] != nullptr);
+    }
+    SECTION("With an idle timeout.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    port 14500;\n"
+            "    idle_timeout 30000;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_FALSE(root->children.empty());
+        REQUIRE(root->children[0] != nullptr);
+        auto filter = std::make_shared<Filter>(Chain("default"));
+        auto connection_pool = std::make_shared<ConnectionPool>();
+        auto udp_sockets =
+            parse_udp(*root->children[0], filter, connection_pool);
+        REQUIRE(udp_sockets.size() == 1);
+        REQUIRE(udp_sockets[0] != nullptr);
+    }
+    SECTION("With connected peer sockets.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    port 14500;\n"
+            "    connect_peers yes;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_FALSE(root->children.empty());
+        REQUIRE(root->children[0] != nullptr);
+        auto filter = std::make_shared<Filter>(Chain("default"));
+        auto connection_pool = std::make_shared<ConnectionPool>();
+        auto udp_sockets =
+            parse_udp(*root->children[0], filter, connection_pool);
+        REQUIRE(udp_sockets.size() == 1);
+        REQUIRE(udp_sockets[0] != nullptr);
+    }
+    SECTION("With kernel timestamps.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    port 14500;\n"
+            "    kernel_timestamps yes;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_FALSE(root->children.empty());
+        REQUIRE(root->children[0] != nullptr);
+        auto filter = std::make_shared<Filter>(Chain("default"));
+        auto connection_pool = std::make_shared<ConnectionPool>();
+        auto udp_sockets =
+            parse_udp(*root->children[0], filter, connection_pool);
+        REQUIRE(udp_sockets.size() == 1);
+        REQUIRE(udp_sockets[0] != nullptr);
+    }
+    SECTION("With a multicast group.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    port 14500;\n"
+            "    multicast 239.1.2.3;\n"
+            "    preload 255.1;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_FALSE(root->children.empty());
+        REQUIRE(root->children[0] != nullptr);
+        auto filter = std::make_shared<Filter>(Chain("default"));
+        auto connection_pool = std::make_shared<ConnectionPool>();
+        auto udp_sockets =
+            parse_udp(*root->children[0], filter, connection_pool);
+        REQUIRE(udp_sockets.size() == 1);
+        REQUIRE(udp_sockets[0] != nullptr);
+    }
+    SECTION("With packet aggregation.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    port 14500;\n"
+            "    aggregate 1400;\n"
+            "    aggregate_delay 10;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_FALSE(root->children.empty());
+        REQUIRE(root->children[0] != nullptr);
+        auto filter = std::make_shared<Filter>(Chain("default"));
+        auto connection_pool = std::make_shared<ConnectionPool>();
+        auto udp_sockets =
+            parse_udp(*root->children[0], filter, connection_pool);
+        REQUIRE(udp_sockets.size() == 1);
+        REQUIRE(udp_sockets[0] != nullptr);
+    }
+    SECTION("Too small aggregation MTU is an error.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    port 14500;\n"
+            "    aggregate 100;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_FALSE(root->children.empty());
+        REQUIRE(root->children[0] != nullptr);
+        auto filter = std::make_shared<Filter>(Chain("default"));
+        auto connection_pool = std::make_shared<ConnectionPool>();
+        REQUIRE_THROWS_WITH(
+            parse_udp(*root->children[0], filter, connection_pool),
+            "MTU (100) must be at least 280 bytes.");
+    }
+    SECTION("Multicast with multiple threads is an error.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    port 14500;\n"
+            "    threads 2;\n"
+            "    multicast 239.1.2.3:14550;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_FALSE(root->children.empty());
+        REQUIRE(root->children[0] != nullptr);
+        auto filter = std::make_shared<Filter>(Chain("default"));
+        auto connection_pool = std::make_shared<ConnectionPool>();
+        REQUIRE_THROWS_AS(
+            parse_udp(*root->children[0], filter, connection_pool),
+            std::invalid_argument);
+        REQUIRE_THROWS_WITH(
+            parse_udp(*root->children[0], filter, connection_pool),
+            "multicast can not be used with multiple threads");
+    }
+    SECTION("Zero peer weight is an error.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    port 14500;\n"
+            "    weight 192.168.0.0/16 0;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_FALSE(root->children.empty());
+        REQUIRE(root->children[0] != nullptr);
+        auto filter = std::make_shared<Filter>(Chain("default"));
+        auto connection_pool = std::make_shared<ConnectionPool>();
+        REQUIRE_THROWS_AS(
+            parse_udp(*root->children[0], filter, connection_pool),
+            std::invalid_argument);
+        REQUIRE_THROWS_WITH(
+            parse_udp(*root->children[0], filter, connection_pool),
+            "Peer weight must be non-zero.");
+    }
+}
+
+
+TEST_CASE("'parse_unix' parses a unix domain socket interface from a unix "
+          "domain socket interface AST node.", "[ConfigParser]")
+{
+    SECTION("With a path.")
+    {
+        tao::pegtl::string_input<> in(
+            "unix {\n"
+            "    path ./mavtables_test.sock;\n"
+            "    idle_timeout 30000;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_FALSE(root->children.empty());
+        REQUIRE(root->children[0] != nullptr);
+        auto filter = std::make_shared<Filter>(Chain("default"));
+        auto connection_pool = std::make_shared<ConnectionPool>();
+        auto unix_socket =
+            parse_unix(*root->children[0], filter, connection_pool);
+        REQUIRE(unix_socket != nullptr);
+        REQUIRE(
+            str(*unix_socket) ==
+            "unix {\n"
+            "    path ./mavtables_test.sock;\n"
+            "}");
+    }
+    SECTION("Throw error if path is missing.")
+    {
+        tao::pegtl::string_input<> in(
+            "unix {\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_FALSE(root->children.empty());
+        REQUIRE(root->children[0] != nullptr);
+        auto filter = std::make_shared<Filter>(Chain("default"));
+        auto connection_pool = std::make_shared<ConnectionPool>();
+        REQUIRE_THROWS_AS(
+            parse_unix(*root->children[0], filter, connection_pool),
+            std::invalid_argument);
+        REQUIRE_THROWS_WITH(
+            parse_unix(*root->children[0], filter, connection_pool),
+            "missing socket path");
+    }
+}
+
+
+TEST_CASE("'parse_shm' parses a shared memory interface from a shared memory "
+          "interface AST node.", "[ConfigParser]")
+{
+    SECTION("With a name and ring size.")
+    {
+        tao::pegtl::string_input<> in(
+            "shm {\n"
+            "    name /mavtables_test_shm;\n"
+            "    ring_size 4096;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_FALSE(root->children.empty());
+        REQUIRE(root->children[0] != nullptr);
+        auto filter = std::make_shared<Filter>(Chain("default"));
+        auto connection_pool = std::make_shared<ConnectionPool>();
+        auto shm = parse_shm(*root->children[0], filter, connection_pool);
+        REQUIRE(shm != nullptr);
+        REQUIRE(
+            str(*shm) ==
+            "shm {\n"
+            "    name /mavtables_test_shm;\n"
+            "    ring_size 4096;\n"
+            "}");
+    }
+    SECTION("With the default ring size.")
+    {
+        tao::pegtl::string_input<> in(
+            "shm {\n"
+            "    name /mavtables_test_shm;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_FALSE(root->children.empty());
+        REQUIRE(root->children[0] != nullptr);
+        auto filter = std::make_shared<Filter>(Chain("default"));
+        auto connection_pool = std::make_shared<ConnectionPool>();
+        auto shm = parse_shm(*root->children[0], filter, connection_pool);
+        REQUIRE(shm != nullptr);
+        REQUIRE(
+            str(*shm) ==
+            "shm {\n"
+            "    name /mavtables_test_shm;\n"
+            "    ring_size 1048576;\n"
+            "}");
+    }
+    SECTION("Throw error if name is missing.")
+    {
+        tao::pegtl::string_input<> in(
+            "shm {\n"
+            "    ring_size 4096;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_FALSE(root->children.empty());
+        REQUIRE(root->children[0] != nullptr);
+        auto filter = std::make_shared<Filter>(Chain("default"));
+        auto connection_pool = std::make_shared<ConnectionPool>();
+        REQUIRE_THROWS_AS(
+            parse_shm(*root->children[0], filter, connection_pool),
+            std::invalid_argument);
+        REQUIRE_THROWS_WITH(
+            parse_shm(*root->children[0], filter, connection_pool),
+            "missing shared memory name");
+    }
+    SECTION("Throw error if ring size is not a power of 2.")
+    {
+        tao::pegtl::string_input<> in(
+            "shm {\n"
+            "    name /mavtables_test_shm;\n"
+            "    ring_size 5000;\n"
+            "}\n", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE_FALSE(root->children.empty());
+        REQUIRE(root->children[0] != nullptr);
+        auto filter = std::make_shared<Filter>(Chain("default"));
+        auto connection_pool = std::make_shared<ConnectionPool>();
+        REQUIRE_THROWS_AS(
+            parse_shm(*root->children[0], filter, connection_pool),
+            std::invalid_argument);
+        REQUIRE_THROWS_WITH(
+            parse_shm(*root->children[0], filter, connection_pool),
+            "Ring size (5000) must be a power of 2 of at least 1024 bytes.");
+    }
 }
 
 
@@ -16,23 +16,34 @@
 
 
 #include <chrono>
+#include <cstdio>
+#include <fstream>
 #include <memory>
+#include <optional>
 #include <set>
+#include <sstream>
 #include <stdexcept>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 #include <catch.hpp>
 #include <fakeit.hpp>
 
+#include "Accept.hpp"
 #include "AddressPool.hpp"
+#include "Chain.hpp"
 #include "Connection.hpp"
+#include "DecisionLog.hpp"
 #include "Filter.hpp"
+#include "If.hpp"
 #include "Logger.hpp"
 #include "MAVAddress.hpp"
 #include "Packet.hpp"
 #include "PacketQueue.hpp"
 #include "PacketVersion2.hpp"
+#include "QueuedPacket.hpp"
+#include "Stats.hpp"
 #include "utility.hpp"
 
 #include "common.hpp"
@@ -180,6 +191,74 @@ TEST_CASE("Connection's 'add_address' method adds/updates addresses.",
 }
 
 
+TEST_CASE("Connection's 'has_addresses' method determines if any addresses "
+          "are reachable.", "[Connection]")
+{
+    fakeit::Mock<Filter> mock_filter;
+    fakeit::Mock<AddressPool<>> mock_pool;
+    fakeit::Mock<PacketQueue> mock_queue;
+    auto filter = mock_shared(mock_filter);
+    auto pool = mock_unique(mock_pool);
+    auto queue = mock_unique(mock_queue);
+    Connection conn("DEVICE", filter, false, std::move(pool), std::move(queue));
+    SECTION("No addresses.")
+    {
+        fakeit::When(Method(mock_pool, addresses)).AlwaysReturn(
+            std::vector<MAVAddress>());
+        REQUIRE_FALSE(conn.has_addresses());
+    }
+    SECTION("Some addresses.")
+    {
+        fakeit::When(Method(mock_pool, addresses)).AlwaysReturn(
+            std::vector<MAVAddress>({MAVAddress("192.168")}));
+        REQUIRE(conn.has_addresses());
+    }
+}
+
+
+TEST_CASE("Connection's count the duplicate packets received on them.",
+          "[Connection]")
+{
+    fakeit::Mock<Filter> mock_filter;
+    auto filter = mock_shared(mock_filter);
+    Connection conn("DEVICE", filter);
+    REQUIRE(conn.duplicates() == 0);
+    REQUIRE(conn.add_duplicate() == 1);
+    REQUIRE(conn.add_duplicate() == 2);
+    REQUIRE(conn.duplicates() == 2);
+}
+
+
+TEST_CASE("Connection's 'may_accept' method decides from only the packet ID "
+          "and source address.", "[Connection]")
+{
+    fakeit::Mock<Filter> mock_filter;
+    fakeit::Mock<AddressPool<>> mock_pool;
+    fakeit::Mock<PacketQueue> mock_queue;
+    auto filter = mock_shared(mock_filter);
+    auto pool = mock_unique(mock_pool);
+    auto queue = mock_unique(mock_queue);
+    Connection conn("DEVICE", filter, false, std::move(pool), std::move(queue));
+    SECTION("Never accepts packets from its own addresses.")
+    {
+        fakeit::When(Method(mock_pool, contains)).AlwaysReturn(true);
+        fakeit::When(Method(mock_filter, may_accept)).AlwaysReturn(true);
+        REQUIRE_FALSE(conn.may_accept(4, MAVAddress("192.168")));
+        fakeit::Verify(Method(mock_filter, may_accept)).Exactly(0);
+    }
+    SECTION("Otherwise defers to the filter.")
+    {
+        fakeit::When(Method(mock_pool, contains)).AlwaysReturn(false);
+        fakeit::When(Method(mock_filter, may_accept)).Return(true, false);
+        REQUIRE(conn.may_accept(4, MAVAddress("192.168")));
+        REQUIRE_FALSE(conn.may_accept(4, MAVAddress("192.168")));
+        fakeit::Verify(
+            Method(mock_filter, may_accept).Using(4, MAVAddress("192.168"))
+        ).Exactly(2);
+    }
+}
+
+
 TEST_CASE("Connection's 'next_packet' method.", "[Connection]")
 {
     auto ping = std::make_shared<packet_v2::Packet>(to_vector(PingV2()));
@@ -192,42 +271,43 @@ TEST_CASE("Connection's 'next_packet' method.", "[Connection]")
     Connection conn("name", filter, false, std::move(pool), std::move(queue));
     SECTION("Returns the next packet.")
     {
-        fakeit::When(
-            OverloadedMethod(
-                mock_queue, pop,
-                std::shared_ptr<const Packet>(
-                    const std::chrono::nanoseconds &))).Return(ping);
+        fakeit::When(Method(mock_queue, pop_queued)).Return(
+            QueuedPacket(ping, 0, 0));
         std::chrono::nanoseconds timeout = 1ms;
         auto packet = conn.next_packet(timeout);
         REQUIRE(packet != nullptr);
         REQUIRE(*packet == *ping);
-        fakeit::Verify(
-            OverloadedMethod(
-                mock_queue, pop,
-                std::shared_ptr<const Packet>(
-                    const std::chrono::nanoseconds &)).Matching([](auto a)
+        fakeit::Verify(Method(mock_queue, pop_queued).Matching([](auto a)
         {
             return a == 1ms;
         })).Once();
     }
     SECTION("Or times out and returns nullptr.")
     {
-        fakeit::When(
-            OverloadedMethod(
-                mock_queue, pop,
-                std::shared_ptr<const Packet>(
-                    const std::chrono::nanoseconds &))).Return(nullptr);
+        fakeit::When(Method(mock_queue, pop_queued)).Return(std::nullopt);
         std::chrono::nanoseconds timeout = 0ms;
         REQUIRE(conn.next_packet(timeout) == nullptr);
-        fakeit::Verify(
-            OverloadedMethod(
-                mock_queue, pop,
-                std::shared_ptr<const Packet>(
-                    const std::chrono::nanoseconds &)).Matching([](auto a)
+        fakeit::Verify(Method(mock_queue, pop_queued).Matching([](auto a)
         {
             return a == 0ms;
         })).Once();
     }
+    SECTION("Records the latency and sojourn time of the packet.")
+    {
+        auto packet = std::make_shared<packet_v2::Packet>(to_vector(PingV2()));
+        packet->timestamp(std::chrono::steady_clock::now() - 50ms);
+        fakeit::When(Method(mock_queue, pop_queued)).Return(
+            QueuedPacket(packet, 2, 0), std::nullopt);
+        REQUIRE(conn.latency().priorities().empty());
+        REQUIRE(conn.next_packet(0ms) != nullptr);
+        REQUIRE(conn.next_packet(0ms) == nullptr);
+        REQUIRE(conn.latency().priorities() == std::vector<int> {2});
+        REQUIRE(conn.latency().latency(2).count() == 1);
+        REQUIRE(conn.latency().latency(2).max() >= 50ms);
+        REQUIRE(conn.latency().sojourn(2).count() == 1);
+        REQUIRE(conn.latency().sojourn(2).max() < 50ms);
+        REQUIRE(conn.traffic().packets(Traffic::sent) == 1);
+    }
 }
 
 
@@ -279,7 +359,7 @@ TEST_CASE("Connection's 'send' method (with destination address).",
         {
             (void)a;
             (void)b;
-            return std::pair<bool, int>(true, 2);
+            return std::tuple<bool, int, unsigned int>(true, 2, 0);
         });
         fakeit::When(Method(mock_pool, contains)).AlwaysDo([&](auto & a)
         {
@@ -306,7 +386,7 @@ TEST_CASE("Connection's 'send' method (with destination address).",
         {
             (void)a;
             (void)b;
-            return std::pair<bool, int>(true, 2);
+            return std::tuple<bool, int, unsigned int>(true, 2, 0);
         });
         fakeit::When(Method(mock_pool, contains)).AlwaysDo([&](auto & a)
         {
@@ -330,7 +410,7 @@ TEST_CASE("Connection's 'send' method (with destination address).",
         {
             (void)a;
             (void)b;
-            return std::pair<bool, int>(false, 0);
+            return std::tuple<bool, int, unsigned int>(false, 0, 0);
         });
         fakeit::When(Method(mock_pool, contains)).AlwaysDo([&](auto & a)
         {
@@ -352,7 +432,7 @@ TEST_CASE("Connection's 'send' method (with destination address).",
         {
             (void)a;
             (void)b;
-            return std::pair<bool, int>(false, 0);
+            return std::tuple<bool, int, unsigned int>(false, 0, 0);
         });
         fakeit::When(Method(mock_pool, contains)).AlwaysDo([&](auto & a)
         {
@@ -372,7 +452,7 @@ TEST_CASE("Connection's 'send' method (with destination address).",
         {
             (void)a;
             (void)b;
-            return std::pair<bool, int>(true, 0);
+            return std::tuple<bool, int, unsigned int>(true, 0, 0);
         });
         fakeit::When(Method(mock_pool, addresses)).AlwaysReturn(
             std::vector<MAVAddress>());
@@ -394,7 +474,7 @@ TEST_CASE("Connection's 'send' method (with destination address).",
         {
             (void)a;
             (void)b;
-            return std::pair<bool, int>(true, 0);
+            return std::tuple<bool, int, unsigned int>(true, 0, 0);
         });
         fakeit::When(Method(mock_pool, addresses)).AlwaysReturn(
             std::vector<MAVAddress>());
@@ -424,15 +504,15 @@ TEST_CASE("Connection's 'send' method (without destination address).",
 
         if (b == MAVAddress("192.168"))
         {
-            return std::pair<bool, int>(true, 2);
+            return std::tuple<bool, int, unsigned int>(true, 2, 0);
         }
 
         if (b == MAVAddress("172.16"))
         {
-            return std::pair<bool, int>(true, -3);
+            return std::tuple<bool, int, unsigned int>(true, -3, 0);
         }
 
-        return std::pair<bool, int>(false, 0);
+        return std::tuple<bool, int, unsigned int>(false, 0, 0);
     });
     fakeit::Mock<AddressPool<>> mock_pool;
     fakeit::When(Method(mock_pool, contains)).AlwaysDo([](MAVAddress addr)
@@ -576,7 +656,7 @@ TEST_CASE("Connection's 'send' method (without destination address).",
         {
             (void)a;
             (void)b;
-            return std::pair<bool, int>(false, 0);
+            return std::tuple<bool, int, unsigned int>(false, 0, 0);
         });
         fakeit::When(Method(mock_pool, addresses)).AlwaysDo([]()
         {
@@ -604,7 +684,7 @@ TEST_CASE("Connection's 'send' method (without destination address).",
         {
             (void)a;
             (void)b;
-            return std::pair<bool, int>(false, 0);
+            return std::tuple<bool, int, unsigned int>(false, 0, 0);
         });
         fakeit::When(Method(mock_pool, addresses)).AlwaysDo([]()
         {
@@ -637,15 +717,15 @@ TEST_CASE("Connection's 'send' method (with broadcast address 0.0).",
 
         if (b == MAVAddress("192.168"))
         {
-            return std::pair<bool, int>(true, 2);
+            return std::tuple<bool, int, unsigned int>(true, 2, 0);
         }
 
         if (b == MAVAddress("172.16"))
         {
-            return std::pair<bool, int>(true, -3);
+            return std::tuple<bool, int, unsigned int>(true, -3, 0);
         }
 
-        return std::pair<bool, int>(false, 0);
+        return std::tuple<bool, int, unsigned int>(false, 0, 0);
     });
     fakeit::Mock<AddressPool<>> mock_pool;
     fakeit::When(Method(mock_pool, contains)).AlwaysDo([](MAVAddress addr)
@@ -789,7 +869,7 @@ TEST_CASE("Connection's 'send' method (with broadcast address 0.0).",
         {
             (void)a;
             (void)b;
-            return std::pair<bool, int>(false, 0);
+            return std::tuple<bool, int, unsigned int>(false, 0, 0);
         });
         fakeit::When(Method(mock_pool, addresses)).AlwaysDo([]()
         {
@@ -817,7 +897,7 @@ TEST_CASE("Connection's 'send' method (with broadcast address 0.0).",
         {
             (void)a;
             (void)b;
-            return std::pair<bool, int>(false, 0);
+            return std::tuple<bool, int, unsigned int>(false, 0, 0);
         });
         fakeit::When(Method(mock_pool, addresses)).AlwaysDo([]()
         {
@@ -875,15 +955,15 @@ TEST_CASE("Connection's 'send' method (with component broadcast address x.0).",
 
         if (b == MAVAddress("123.168"))
         {
-            return std::pair<bool, int>(true, 2);
+            return std::tuple<bool, int, unsigned int>(true, 2, 0);
         }
 
         if (b == MAVAddress("123.16"))
         {
-            return std::pair<bool, int>(true, -3);
+            return std::tuple<bool, int, unsigned int>(true, -3, 0);
         }
 
-        return std::pair<bool, int>(false, 0);
+        return std::tuple<bool, int, unsigned int>(false, 0, 0);
     });
     fakeit::Mock<PacketQueue> mock_queue;
     fakeit::Fake(Method(mock_queue, push));
@@ -1012,7 +1092,7 @@ TEST_CASE("Connection's 'send' method (with component broadcast address x.0).",
         {
             (void)a;
             (void)b;
-            return std::pair<bool, int>(false, 0);
+            return std::tuple<bool, int, unsigned int>(false, 0, 0);
         });
         fakeit::When(Method(mock_pool, addresses)).AlwaysDo([]()
         {
@@ -1041,7 +1121,7 @@ TEST_CASE("Connection's 'send' method (with component broadcast address x.0).",
         {
             (void)a;
             (void)b;
-            return std::pair<bool, int>(false, 0);
+            return std::tuple<bool, int, unsigned int>(false, 0, 0);
         });
         fakeit::When(Method(mock_pool, addresses)).AlwaysDo([]()
         {
@@ -1068,7 +1148,7 @@ TEST_CASE("Connection's 'send' method (with component broadcast address x.0).",
         {
             (void)a;
             (void)b;
-            return std::pair<bool, int>(true, 0);
+            return std::tuple<bool, int, unsigned int>(true, 0, 0);
         });
         fakeit::When(Method(mock_pool, addresses)).AlwaysReturn(
             std::vector<MAVAddress>());
@@ -1090,7 +1170,7 @@ TEST_CASE("Connection's 'send' method (with component broadcast address x.0).",
         {
             (void)a;
             (void)b;
-            return std::pair<bool, int>(true, 0);
+            return std::tuple<bool, int, unsigned int>(true, 0, 0);
         });
         fakeit::When(Method(mock_pool, addresses)).AlwaysReturn(
             std::vector<MAVAddress>());
@@ -1172,10 +1252,10 @@ TEST_CASE("Connection's 'send' method (destination address, system reachable, "
 
             if (b == MAVAddress("127.1"))
             {
-                return std::pair<bool, int>(true, 2);
+                return std::tuple<bool, int, unsigned int>(true, 2, 0);
             }
 
-            return std::pair<bool, int>(false, 0);
+            return std::tuple<bool, int, unsigned int>(false, 0, 0);
         });
         fakeit::Fake(Method(mock_queue, push));
         conn.send(ping);
@@ -1201,10 +1281,10 @@ TEST_CASE("Connection's 'send' method (destination address, system reachable, "
 
             if (b == MAVAddress("127.1"))
             {
-                return std::pair<bool, int>(true, 2);
+                return std::tuple<bool, int, unsigned int>(true, 2, 0);
             }
 
-            return std::pair<bool, int>(false, 0);
+            return std::tuple<bool, int, unsigned int>(false, 0, 0);
         });
         fakeit::Fake(Method(mock_queue, push));
         conn.send(ping);
@@ -1227,10 +1307,10 @@ TEST_CASE("Connection's 'send' method (destination address, system reachable, "
 
             if (b == MAVAddress("127.1"))
             {
-                return std::pair<bool, int>(false, 0);
+                return std::tuple<bool, int, unsigned int>(false, 0, 0);
             }
 
-            return std::pair<bool, int>(true, 2);
+            return std::tuple<bool, int, unsigned int>(true, 2, 0);
         });
         fakeit::Fake(Method(mock_queue, push));
         conn.send(ping);
@@ -1251,10 +1331,10 @@ TEST_CASE("Connection's 'send' method (destination address, system reachable, "
 
             if (b == MAVAddress("127.1"))
             {
-                return std::pair<bool, int>(false, 0);
+                return std::tuple<bool, int, unsigned int>(false, 0, 0);
             }
 
-            return std::pair<bool, int>(true, 2);
+            return std::tuple<bool, int, unsigned int>(true, 2, 0);
         });
         fakeit::Fake(Method(mock_queue, push));
         conn.send(ping);
@@ -1263,3 +1343,32 @@ TEST_CASE("Connection's 'send' method (destination address, system reachable, "
     }
     Logger::level(0);
 }
+
+
+
+
+TEST_CASE("Connection's record filter decisions in the installed "
+          "DecisionLog.", "[Connection]")
+{
+    Chain chain("default");
+    chain.append(std::make_unique<Accept>(2, If().to("127.1")), 7);
+    auto filter = std::make_shared<Filter>(chain);
+    auto source_connection = std::make_shared<Connection>("SOURCE", filter);
+    auto ping = std::make_shared<packet_v2::Packet>(to_vector(PingV2()));
+    ping->connection(source_connection);
+    Connection conn("DEST", filter);
+    conn.add_address(MAVAddress("127.1"));
+    {
+        DecisionLog log("connection_decision_test.log", 16, 1);
+        DecisionLog::install(&log);
+        conn.send(ping);
+        DecisionLog::install(nullptr);
+    }
+    std::ifstream file("connection_decision_test.log", std::ios::binary);
+    std::stringstream ss;
+    DecisionLog::dump(file, ss);
+    REQUIRE(ss.str().substr(26) ==
+            "  accept PING (#4) from 192.168 to 127.1 source SOURCE "
+            "dest DEST priority 2 rule 7\n");
+    std::remove("connection_decision_test.log");
+}
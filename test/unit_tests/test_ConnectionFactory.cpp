@@ -19,6 +19,7 @@
 #include <future>
 #include <memory>
 #include <stdexcept>
+#include <tuple>
 
 #include <catch.hpp>
 
@@ -62,7 +63,7 @@ TEST_CASE("ConnectionFactory's 'get' method returns a new connection.",
     {
         (void)a;
         (void)b;
-        return std::pair<bool, int>(true, 0);
+        return std::tuple<bool, int, unsigned int>(true, 0, 0);
     });
     auto filter = mock_shared(mock_filter);
     REQUIRE(filter != nullptr);
@@ -92,6 +93,40 @@ TEST_CASE("ConnectionFactory's 'get' method returns a new connection.",
 }
 
 
+TEST_CASE("ConnectionFactory's 'get' method accepts a ready callback.",
+          "[ConnectionFactory]")
+{
+    auto heartbeat =
+        std::make_shared<packet_v2::Packet>(to_vector(HeartbeatV2()));
+    fakeit::Mock<Filter> mock_filter;
+    fakeit::When(Method(mock_filter, will_accept)
+                ).AlwaysDo([](auto & a, auto & b)
+    {
+        (void)a;
+        (void)b;
+        return std::tuple<bool, int, unsigned int>(true, 0, 0);
+    });
+    auto filter = mock_shared(mock_filter);
+    ConnectionFactory<> connection_factory(filter);
+    int ready = 0;
+    std::unique_ptr<Connection> conn = connection_factory.get(
+        "CONNECTION", [&]()
+    {
+        ++ready;
+    });
+    conn->add_address(MAVAddress("192.168"));
+    conn->send(heartbeat);
+    REQUIRE(ready == 1);
+    conn->send(heartbeat);
+    REQUIRE(ready == 1);
+    REQUIRE(conn->next_packet(0s) != nullptr);
+    REQUIRE(conn->next_packet(0s) != nullptr);
+    conn->send(heartbeat);
+    REQUIRE(ready == 2);
+    REQUIRE(connection_factory.wait_for_packet(0s));
+}
+
+
 TEST_CASE("ConnectionFactory's 'wait_for_packet' method waits for a packet "
           "on any of the connections created by the factory.",
           "[ConnectionFactory]")
@@ -104,7 +139,7 @@ TEST_CASE("ConnectionFactory's 'wait_for_packet' method waits for a packet "
     {
         (void)a;
         (void)b;
-        return std::pair<bool, int>(true, 0);
+        return std::tuple<bool, int, unsigned int>(true, 0, 0);
     });
     auto filter = mock_shared(mock_filter);
     REQUIRE(filter != nullptr);
@@ -16,13 +16,17 @@
 
 
 #include <memory>
+#include <string>
 
 #include <catch.hpp>
 #include <fakeit.hpp>
 
 #include "Connection.hpp"
 #include "ConnectionPool.hpp"
+#include "Deduplicator.hpp"
+#include "Filter.hpp"
 #include "Logger.hpp"
+#include "MAVAddress.hpp"
 #include "PacketVersion2.hpp"
 #include "utility.hpp"
 
@@ -164,6 +168,84 @@ TEST_CASE("ConnectionPool's 'remove' method removes a connection.",
 }
 
 
+TEST_CASE("ConnectionPool's 'may_accept' method determines if any connection "
+          "may accept a packet.", "[ConnectionPool]")
+{
+    fakeit::Mock<Connection> mock1;
+    fakeit::Mock<Connection> mock2;
+    std::shared_ptr<Connection> connection1 = mock_shared(mock1);
+    std::shared_ptr<Connection> connection2 = mock_shared(mock2);
+    ConnectionPool pool;
+    SECTION("Without any connections.")
+    {
+        REQUIRE_FALSE(pool.may_accept(4, MAVAddress("192.168")));
+    }
+    SECTION("When no connection may accept the packet.")
+    {
+        fakeit::When(Method(mock1, may_accept)).AlwaysReturn(false);
+        fakeit::When(Method(mock2, may_accept)).AlwaysReturn(false);
+        pool.add(connection1);
+        pool.add(connection2);
+        REQUIRE_FALSE(pool.may_accept(4, MAVAddress("192.168")));
+        fakeit::Verify(
+            Method(mock1, may_accept).Using(4, MAVAddress("192.168"))).Once();
+        fakeit::Verify(
+            Method(mock2, may_accept).Using(4, MAVAddress("192.168"))).Once();
+    }
+    SECTION("When a connection may accept the packet.")
+    {
+        fakeit::When(Method(mock1, may_accept)).AlwaysReturn(true);
+        fakeit::When(Method(mock2, may_accept)).AlwaysReturn(true);
+        pool.add(connection1);
+        pool.add(connection2);
+        REQUIRE(pool.may_accept(4, MAVAddress("192.168")));
+    }
+}
+
+
+TEST_CASE("ConnectionPool's can suppress duplicate packets.",
+          "[ConnectionPool]")
+{
+    fakeit::Mock<Connection> mock;
+    fakeit::Fake(Method(mock, send));
+    std::shared_ptr<Connection> connection = mock_shared(mock);
+    fakeit::Mock<Filter> mock_filter;
+    auto filter = mock_shared(mock_filter);
+    auto link1 = std::make_shared<Connection>("LINK1", filter);
+    auto link2 = std::make_shared<Connection>("LINK2", filter);
+    auto ping1 = std::make_unique<packet_v2::Packet>(to_vector(PingV2()));
+    ping1->connection(link1);
+    auto ping2 = std::make_unique<packet_v2::Packet>(to_vector(PingV2()));
+    ping2->connection(link2);
+    SECTION("When enabled.")
+    {
+        Logger::level(2);
+        MockCOut mock_cout;
+        ConnectionPool pool(std::make_unique<Deduplicator<>>());
+        pool.add(connection);
+        pool.send(std::move(ping1));
+        pool.send(std::move(ping2));
+        fakeit::Verify(Method(mock, send)).Once();
+        REQUIRE(link1->duplicates() == 0);
+        REQUIRE(link2->duplicates() == 1);
+        REQUIRE(
+            mock_cout.buffer().find(
+                "suppressed duplicate PING (#4) from 192.168 to 127.1 (v2.0) "
+                "source LINK2 (1 duplicates)\n") != std::string::npos);
+        Logger::level(0);
+    }
+    SECTION("When disabled (the default).")
+    {
+        ConnectionPool pool;
+        pool.add(connection);
+        pool.send(std::move(ping1));
+        pool.send(std::move(ping2));
+        fakeit::Verify(Method(mock, send)).Exactly(2);
+        REQUIRE(link2->duplicates() == 0);
+    }
+}
+
+
 TEST_CASE("ConnectionPool's 'send' method removes connections that have "
           "expired.", "[ConnectionPool]")
 {
@@ -0,0 +1,79 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <thread>
+#include <vector>
+
+#include <catch.hpp>
+
+#include "Counters.hpp"
+
+
+TEST_CASE("Counters start at 0.", "[Counters]")
+{
+    Counters<3> counters;
+    REQUIRE(counters.value(0) == 0);
+    REQUIRE(counters.value(1) == 0);
+    REQUIRE(counters.value(2) == 0);
+}
+
+
+TEST_CASE("Counters can be added to.", "[Counters]")
+{
+    Counters<2> counters;
+    REQUIRE(counters.add(0) == 1);
+    REQUIRE(counters.add(0) == 2);
+    REQUIRE(counters.add(1, 100) == 100);
+    REQUIRE(counters.value(0) == 2);
+    REQUIRE(counters.value(1) == 100);
+}
+
+
+TEST_CASE("Counters sum the counts of every thread.", "[Counters]")
+{
+    Counters<2> counters;
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < 2 * static_cast<int>(COUNTER_SHARDS); ++i)
+    {
+        threads.emplace_back([&counters]()
+        {
+            for (int j = 0; j < 1000; ++j)
+            {
+                counters.add(0);
+                counters.add(1, 2);
+            }
+        });
+    }
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    REQUIRE(counters.value(0) == 2 * COUNTER_SHARDS * 1000);
+    REQUIRE(counters.value(1) == 2 * COUNTER_SHARDS * 2000);
+}
+
+
+TEST_CASE("Threads are assigned a fixed counter shard.", "[Counters]")
+{
+    auto shard = counter_shard();
+    REQUIRE(shard < COUNTER_SHARDS);
+    REQUIRE(counter_shard() == shard);
+}
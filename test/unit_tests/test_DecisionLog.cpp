@@ -0,0 +1,234 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <catch.hpp>
+
+#include "DecisionLog.hpp"
+#include "Logger.hpp"
+#include "MAVAddress.hpp"
+#include "PacketVersion2.hpp"
+
+#include "common_Packet.hpp"
+
+
+namespace
+{
+
+#ifdef __clang__
+    #pragma clang diagnostic push
+    #pragma clang diagnostic ignored "-Wunused-function"
+#endif
+
+    DecisionRecord make_record(
+        DecisionRecord::Action action, uint32_t rule = 0)
+    {
+        DecisionRecord record;
+        record.time = 1500000000123456789;
+        record.id = 4;
+        record.source = static_cast<uint16_t>(MAVAddress("192.168").address());
+        record.dest = static_cast<uint16_t>(MAVAddress("127.1").address());
+        record.from = Logger::register_name("SOURCE");
+        record.to = Logger::register_name("DEST");
+        record.rule = rule;
+        record.priority = 3;
+        record.action = action;
+        record.flags = DecisionRecord::HAS_DEST;
+        return record;
+    }
+
+    std::string dump(const std::string &path, bool csv = false)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream ss;
+        DecisionLog::dump(file, ss, csv);
+        return ss.str();
+    }
+
+#ifdef __clang__
+    #pragma clang diagnostic pop
+#endif
+
+}
+
+
+TEST_CASE("DecisionRecord's can be made from a packet.", "[DecisionLog]")
+{
+    packet_v2::Packet packet(to_vector(PingV2()));
+    auto record = DecisionRecord::make(
+                      DecisionRecord::ACCEPT, packet, 1, 2, 100000, 12);
+    REQUIRE(record.id == 4);
+    REQUIRE(record.source == MAVAddress("192.168").address());
+    REQUIRE(record.dest == MAVAddress("127.1").address());
+    REQUIRE(record.flags == DecisionRecord::HAS_DEST);
+    REQUIRE(record.from == 1);
+    REQUIRE(record.to == 2);
+    REQUIRE(record.priority == 32767);
+    REQUIRE(record.rule == 12);
+    REQUIRE(record.action == DecisionRecord::ACCEPT);
+    auto received = DecisionRecord::make(
+                        DecisionRecord::RECEIVED, packet, 1);
+    REQUIRE(received.to == 0);
+    REQUIRE(received.priority == 0);
+    REQUIRE(received.rule == 0);
+    REQUIRE(received.action == DecisionRecord::RECEIVED);
+}
+
+
+TEST_CASE("DecisionLog's ensure at least 1 record and file.",
+          "[DecisionLog]")
+{
+    REQUIRE_THROWS_AS(
+        DecisionLog("decision_log_test.log", 0), std::invalid_argument);
+    REQUIRE_THROWS_WITH(
+        DecisionLog("decision_log_test.log", 0),
+        "Decision log files must hold at least 1 record.");
+    REQUIRE_THROWS_AS(
+        DecisionLog("decision_log_test.log", 16, 0), std::invalid_argument);
+    REQUIRE_THROWS_WITH(
+        DecisionLog("decision_log_test.log", 16, 0),
+        "Decision log must keep at least 1 file.");
+}
+
+
+TEST_CASE("DecisionLog's throw an error if the file can not be created.",
+          "[DecisionLog]")
+{
+    REQUIRE_THROWS_AS(
+        DecisionLog("no_such_directory/decision_log_test.log"),
+        std::system_error);
+}
+
+
+TEST_CASE("DecisionLog's record decisions that can be dumped as text.",
+          "[DecisionLog]")
+{
+    {
+        DecisionLog log("decision_log_test.log", 16, 1);
+        log.record(make_record(DecisionRecord::ACCEPT, 12));
+        auto reject = make_record(DecisionRecord::REJECT);
+        reject.flags = 0;
+        reject.from = 0;
+        reject.priority = 0;
+        log.record(reject);
+    }
+    std::stringstream ss(dump("decision_log_test.log"));
+    std::string line;
+    REQUIRE(std::getline(ss, line));
+    REQUIRE(line.substr(26) ==
+            "  accept PING (#4) from 192.168 to 127.1 source SOURCE "
+            "dest DEST priority 3 rule 12");
+    REQUIRE(line.substr(19, 7) == ".123456");
+    REQUIRE(std::getline(ss, line));
+    REQUIRE(line.substr(26) ==
+            "  reject PING (#4) from 192.168 source unknown "
+            "dest DEST priority 0 rule default");
+    REQUIRE_FALSE(std::getline(ss, line));
+    std::remove("decision_log_test.log");
+}
+
+
+TEST_CASE("DecisionLog's can be dumped as CSV.", "[DecisionLog]")
+{
+    {
+        DecisionLog log("decision_log_test.log", 16, 1);
+        log.record(make_record(DecisionRecord::ACCEPT, 12));
+    }
+    auto csv = dump("decision_log_test.log", true);
+    REQUIRE(csv.substr(26) ==
+            ",accept,4,PING,192.168,127.1,SOURCE,DEST,3,12\n");
+    REQUIRE(std::string(DecisionLog::CSV_HEADER) ==
+            "time,action,id,name,source,dest,from,to,priority,rule");
+    std::remove("decision_log_test.log");
+}
+
+
+TEST_CASE("DecisionLog's rotate full files.", "[DecisionLog]")
+{
+    {
+        DecisionLog log("decision_log_test.log", 2, 3);
+
+        for (uint32_t i = 1; i <= 7; ++i)
+        {
+            log.record(make_record(DecisionRecord::ACCEPT, i));
+        }
+    }
+    auto count = [](const std::string & text)
+    {
+        std::stringstream ss(text);
+        std::string line;
+        int lines = 0;
+
+        while (std::getline(ss, line))
+        {
+            ++lines;
+        }
+
+        return lines;
+    };
+    auto current = dump("decision_log_test.log");
+    REQUIRE(count(current) == 1);
+    REQUIRE(current.find("rule 7") != std::string::npos);
+    auto previous = dump("decision_log_test.log.1");
+    REQUIRE(count(previous) == 2);
+    REQUIRE(previous.find("rule 5") != std::string::npos);
+    REQUIRE(previous.find("rule 6") != std::string::npos);
+    auto oldest = dump("decision_log_test.log.2");
+    REQUIRE(count(oldest) == 2);
+    REQUIRE(oldest.find("rule 3") != std::string::npos);
+    REQUIRE_FALSE(std::ifstream("decision_log_test.log.3"));
+    std::remove("decision_log_test.log");
+    std::remove("decision_log_test.log.1");
+    std::remove("decision_log_test.log.2");
+}
+
+
+TEST_CASE("DecisionLog's can be installed for use by all connections.",
+          "[DecisionLog]")
+{
+    REQUIRE(DecisionLog::installed() == nullptr);
+    {
+        DecisionLog log("decision_log_test.log", 16, 1);
+        DecisionLog::install(&log);
+        REQUIRE(DecisionLog::installed() == &log);
+        DecisionLog::install(nullptr);
+        REQUIRE(DecisionLog::installed() == nullptr);
+        // Uninstalled on destruction.
+        DecisionLog::install(&log);
+    }
+    REQUIRE(DecisionLog::installed() == nullptr);
+    std::remove("decision_log_test.log");
+}
+
+
+TEST_CASE("DecisionLog's 'dump' method rejects other files.",
+          "[DecisionLog]")
+{
+    std::stringstream in(
+        "not a decision log, but long enough to read a header");
+    std::stringstream out;
+    REQUIRE_THROWS_AS(DecisionLog::dump(in, out), std::invalid_argument);
+    REQUIRE_THROWS_WITH(
+        DecisionLog::dump(in, out), "Not a mavtables decision log.");
+}
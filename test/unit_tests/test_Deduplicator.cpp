@@ -0,0 +1,142 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <catch.hpp>
+#include <fake_clock.hh>
+
+#include "Deduplicator.hpp"
+#include "PacketVersion2.hpp"
+
+#include "common_Packet.hpp"
+
+
+using namespace std::chrono_literals;
+using namespace testing;
+
+
+TEST_CASE("Deduplicator's can be constructed.", "[Deduplicator]")
+{
+    REQUIRE_NOTHROW(Deduplicator<>());
+    REQUIRE_NOTHROW(Deduplicator<>(1ms));
+    REQUIRE_NOTHROW(Deduplicator<>(1000000ms));
+}
+
+
+TEST_CASE("Deduplicator's ensure the window is valid.", "[Deduplicator]")
+{
+    REQUIRE_THROWS_AS(Deduplicator<>(0ms), std::invalid_argument);
+    REQUIRE_THROWS_WITH(
+        Deduplicator<>(0ms),
+        "Deduplication window (0 ms) must be between 1 and 1000000 ms.");
+    REQUIRE_THROWS_AS(Deduplicator<>(1000001ms), std::invalid_argument);
+    REQUIRE_THROWS_WITH(
+        Deduplicator<>(1000001ms),
+        "Deduplication window (1000001 ms) must be between 1 and 1000000 ms.");
+}
+
+
+TEST_CASE("Deduplicator's detect copies of a packet within the window.",
+          "[Deduplicator]")
+{
+    Deduplicator<fake_clock> deduplicator(100ms);
+    auto ping = packet_v2::Packet(to_vector(PingV2()));
+    REQUIRE_FALSE(deduplicator.duplicate(ping));
+    REQUIRE(deduplicator.duplicate(ping));
+    fake_clock::advance(99ms);
+    REQUIRE(deduplicator.duplicate(ping));
+    // The window is measured from the first copy.
+    fake_clock::advance(1ms);
+    REQUIRE_FALSE(deduplicator.duplicate(ping));
+    REQUIRE(deduplicator.duplicate(ping));
+    fake_clock::advance(1s);
+}
+
+
+TEST_CASE("Deduplicator's key packets on source address, sequence number, "
+          "message ID and checksum.", "[Deduplicator]")
+{
+    Deduplicator<fake_clock> deduplicator(100ms);
+    auto ping = PingV2();
+    REQUIRE_FALSE(deduplicator.duplicate(packet_v2::Packet(to_vector(ping))));
+    SECTION("Packets are the same.")
+    {
+        // The signature is not part of the key.
+        REQUIRE(deduplicator.duplicate(
+                    packet_v2::Packet(to_vector_with_sig(ping))));
+    }
+    SECTION("Source address differs.")
+    {
+        ping.compid = 1;
+        REQUIRE_FALSE(
+            deduplicator.duplicate(packet_v2::Packet(to_vector(ping))));
+    }
+    SECTION("Sequence number differs.")
+    {
+        ping.seq = 1;
+        REQUIRE_FALSE(
+            deduplicator.duplicate(packet_v2::Packet(to_vector(ping))));
+    }
+    SECTION("Message ID differs.")
+    {
+        auto heartbeat = HeartbeatV2();
+        heartbeat.sysid = ping.sysid;
+        heartbeat.compid = ping.compid;
+        REQUIRE_FALSE(
+            deduplicator.duplicate(packet_v2::Packet(to_vector(heartbeat))));
+    }
+    SECTION("Checksum differs.")
+    {
+        ping.checksum = 0x1234;
+        REQUIRE_FALSE(
+            deduplicator.duplicate(packet_v2::Packet(to_vector(ping))));
+    }
+    fake_clock::advance(1s);
+}
+
+
+TEST_CASE("Deduplicator's are threadsafe.", "[Deduplicator]")
+{
+    Deduplicator<> deduplicator(10s);
+    auto ping = packet_v2::Packet(to_vector(PingV2()));
+    std::atomic<int> originals(0);
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        threads.emplace_back([&]()
+        {
+            if (!deduplicator.duplicate(ping))
+            {
+                ++originals;
+            }
+        });
+    }
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    REQUIRE(originals == 1);
+}
@@ -15,6 +15,8 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
+#include <memory>
+#include <tuple>
 #include <utility>
 
 #include <catch.hpp>
@@ -25,6 +27,8 @@
 #include "Chain.hpp"
 #include "Filter.hpp"
 #include "GoTo.hpp"
+#include "If.hpp"
+#include "MAVAddress.hpp"
 #include "PacketVersion2.hpp"
 #include "Reject.hpp"
 
@@ -74,6 +78,16 @@ TEST_CASE("Filter's are comparable.", "[Filter]")
 }
 
 
+TEST_CASE("Filter's 'default_chain' method returns the chain filtering begins "
+          "with.", "[Filter]")
+{
+    Chain chain("test_chain");
+    chain.append(std::make_unique<Accept>());
+    Filter filter(chain);
+    REQUIRE(filter.default_chain() == chain);
+}
+
+
 TEST_CASE("Filter's are copyable.", "[Filter]")
 {
     auto original = Filter(Chain("test_chain"));
@@ -120,7 +134,7 @@ TEST_CASE("Filter's 'will_accept' method determines whether to accept or "
         chain.append(std::make_unique<Accept>());
         REQUIRE(
             Filter(chain).will_accept(ping, MAVAddress("192.168")) ==
-            std::make_pair(true, 0));
+            std::make_tuple(true, 0, 0u));
     }
     SECTION("Accept packet, with priority.")
     {
@@ -128,14 +142,15 @@ TEST_CASE("Filter's 'will_accept' method determines whether to accept or "
         chain.append(std::make_unique<Accept>(3));
         REQUIRE(
             Filter(chain).will_accept(ping, MAVAddress("192.168")) ==
-            std::make_pair(true, 3));
+            std::make_tuple(true, 3, 0u));
     }
     SECTION("Reject packet.")
     {
         Chain chain("test_chain");
         chain.append(std::make_unique<Reject>());
         REQUIRE_FALSE(
-            Filter(chain).will_accept(ping, MAVAddress("192.168")).first);
+            std::get<0>(
+                Filter(chain).will_accept(ping, MAVAddress("192.168"))));
     }
     SECTION("Default action.")
     {
@@ -143,10 +158,11 @@ TEST_CASE("Filter's 'will_accept' method determines whether to accept or "
         Chain chain("test_chain");
         chain.append(std::make_unique<GoTo>(subchain));
         REQUIRE_FALSE(
-            Filter(chain).will_accept(ping, MAVAddress("192.168")).first);
+            std::get<0>(
+                Filter(chain).will_accept(ping, MAVAddress("192.168"))));
         REQUIRE(
             Filter(chain, true).will_accept(ping, MAVAddress("192.168")) ==
-            std::make_pair(true, 0));
+            std::make_tuple(true, 0, 0u));
     }
     SECTION("Undecided action.")
     {
@@ -154,9 +170,59 @@ TEST_CASE("Filter's 'will_accept' method determines whether to accept or "
         Chain chain("test_chain");
         chain.append(std::make_unique<Call>(subchain));
         REQUIRE_FALSE(
-            Filter(chain).will_accept(ping, MAVAddress("192.168")).first);
+            std::get<0>(
+                Filter(chain).will_accept(ping, MAVAddress("192.168"))));
         REQUIRE(
             Filter(chain, true).will_accept(ping, MAVAddress("192.168")) ==
-            std::make_pair(true, 0));
+            std::make_tuple(true, 0, 0u));
+    }
+}
+
+
+TEST_CASE("Filter's 'will_accept' method returns the rule that decided the "
+          "packet.", "[Filter]")
+{
+    auto ping = packet_v2::Packet(to_vector(PingV2()));
+    Chain chain("test_chain");
+    chain.append(std::make_unique<Accept>(If().to("192.168")), 5);
+    chain.append(std::make_unique<Reject>(If().to("10.10")), 6);
+    Filter filter(chain);
+    REQUIRE(
+        filter.will_accept(ping, MAVAddress("192.168")) ==
+        std::make_tuple(true, 0, 5u));
+    REQUIRE(
+        std::get<2>(filter.will_accept(ping, MAVAddress("10.10"))) == 6);
+    // Default action.
+    REQUIRE(
+        std::get<2>(filter.will_accept(ping, MAVAddress("172.16"))) == 0);
+}
+
+
+TEST_CASE("Filter's 'may_accept' method decides from only the packet ID and "
+          "source address.", "[Filter]")
+{
+    MAVAddress source("192.168");
+    SECTION("Rejected packets.")
+    {
+        Chain chain("test_chain");
+        chain.append(std::make_unique<Reject>(If().type("PING")));
+        chain.append(std::make_unique<Accept>());
+        REQUIRE_FALSE(Filter(chain).may_accept(4, source));
+        REQUIRE(Filter(chain).may_accept(0, source));
+    }
+    SECTION("Packets that depend on the destination may be accepted.")
+    {
+        Chain chain("test_chain");
+        chain.append(std::make_unique<Reject>(If().to("172.16")));
+        REQUIRE(Filter(chain, true).may_accept(4, source));
+        REQUIRE_FALSE(Filter(chain, false).may_accept(4, source));
+        chain.append(std::make_unique<Accept>(If().to("10.10")));
+        REQUIRE(Filter(chain, false).may_accept(4, source));
+    }
+    SECTION("Default action.")
+    {
+        Chain chain("test_chain");
+        REQUIRE_FALSE(Filter(chain).may_accept(4, source));
+        REQUIRE(Filter(chain, true).may_accept(4, source));
     }
 }
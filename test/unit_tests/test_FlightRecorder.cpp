@@ -0,0 +1,241 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <catch.hpp>
+
+#include "DecisionLog.hpp"
+#include "FlightRecorder.hpp"
+#include "Logger.hpp"
+#include "MAVAddress.hpp"
+
+
+namespace
+{
+
+#ifdef __clang__
+    #pragma clang diagnostic push
+    #pragma clang diagnostic ignored "-Wunused-function"
+#endif
+
+    DecisionRecord make_record(
+        DecisionRecord::Action action, uint32_t rule = 0)
+    {
+        DecisionRecord record;
+        record.time = 1500000000123456789;
+        record.id = 4;
+        record.source = static_cast<uint16_t>(MAVAddress("192.168").address());
+        record.dest = static_cast<uint16_t>(MAVAddress("127.1").address());
+        record.from = Logger::register_name("SOURCE");
+        record.to = Logger::register_name("DEST");
+        record.rule = rule;
+        record.priority = 3;
+        record.action = action;
+        record.flags = DecisionRecord::HAS_DEST;
+        return record;
+    }
+
+    std::string dump(FlightRecorder &recorder)
+    {
+        std::stringstream records;
+        recorder.dump(records);
+        std::stringstream ss;
+        DecisionLog::dump(records, ss);
+        return ss.str();
+    }
+
+#ifdef __clang__
+    #pragma clang diagnostic pop
+#endif
+
+}
+
+
+TEST_CASE("FlightRecorder's must hold a power of 2 records.",
+          "[FlightRecorder]")
+{
+    REQUIRE_NOTHROW(FlightRecorder());
+    REQUIRE_NOTHROW(FlightRecorder("flight_recorder_test.log", 16));
+    REQUIRE_THROWS_AS(
+        FlightRecorder("flight_recorder_test.log", 0), std::invalid_argument);
+    REQUIRE_THROWS_AS(
+        FlightRecorder("flight_recorder_test.log", 10), std::invalid_argument);
+    REQUIRE_THROWS_WITH(
+        FlightRecorder("flight_recorder_test.log", 10),
+        "Flight recorder size (10) is not a power of 2.");
+}
+
+
+TEST_CASE("FlightRecorder's have a path to be dumped to.", "[FlightRecorder]")
+{
+    REQUIRE(FlightRecorder().path() == FlightRecorder::DEFAULT_PATH);
+    REQUIRE(FlightRecorder("flight_recorder_test.log").path() ==
+            "flight_recorder_test.log");
+}
+
+
+TEST_CASE("FlightRecorder's dump records in the decision log format.",
+          "[FlightRecorder]")
+{
+    FlightRecorder recorder("flight_recorder_test.log", 16);
+    REQUIRE(dump(recorder).empty());
+    recorder.record(make_record(DecisionRecord::RECEIVED));
+    recorder.record(make_record(DecisionRecord::ACCEPT, 12));
+    std::stringstream ss(dump(recorder));
+    std::string line;
+    REQUIRE(std::getline(ss, line));
+    REQUIRE(line.substr(26) ==
+            "  receive PING (#4) from 192.168 to 127.1 source SOURCE");
+    REQUIRE(std::getline(ss, line));
+    REQUIRE(line.substr(26) ==
+            "  accept PING (#4) from 192.168 to 127.1 source SOURCE "
+            "dest DEST priority 3 rule 12");
+    REQUIRE_FALSE(std::getline(ss, line));
+}
+
+
+TEST_CASE("FlightRecorder's keep only the most recent records.",
+          "[FlightRecorder]")
+{
+    FlightRecorder recorder("flight_recorder_test.log", 4);
+
+    for (uint32_t i = 1; i <= 6; ++i)
+    {
+        recorder.record(make_record(DecisionRecord::ACCEPT, i));
+    }
+
+    std::stringstream ss(dump(recorder));
+    std::string line;
+
+    for (uint32_t i = 3; i <= 6; ++i)
+    {
+        REQUIRE(std::getline(ss, line));
+        REQUIRE(line.substr(line.rfind(' ') + 1) == std::to_string(i));
+    }
+
+    REQUIRE_FALSE(std::getline(ss, line));
+}
+
+
+TEST_CASE("FlightRecorder's only dump whole records while recording.",
+          "[FlightRecorder]")
+{
+    FlightRecorder recorder("flight_recorder_test.log", 4);
+    std::atomic<bool> running(true);
+    std::vector<std::thread> writers;
+
+    for (uint32_t n = 1; n <= 4; ++n)
+    {
+        writers.emplace_back([&, n]()
+        {
+            // Every field of a record is derived from the same value, so a
+            // torn record can be detected.
+            for (uint32_t i = n; running.load(); i += 4)
+            {
+                DecisionRecord record;
+                std::memset(&record, static_cast<int>(i & 0xFF),
+                            sizeof(record));
+                record.action = DecisionRecord::ACCEPT;
+                record.flags = static_cast<uint8_t>(i & 0xFF);
+                recorder.record(record);
+            }
+        });
+    }
+
+    std::vector<std::string> dumps;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        std::stringstream ss;
+        recorder.dump(ss);
+        dumps.push_back(ss.str().substr(DecisionLog::HEADER_SIZE));
+    }
+
+    running.store(false);
+
+    for (auto &writer : writers)
+    {
+        writer.join();
+    }
+
+    for (const auto &records : dumps)
+    {
+        REQUIRE(records.size() % sizeof(DecisionRecord) == 0);
+
+        for (std::size_t i = 0; i < records.size();
+                i += sizeof(DecisionRecord))
+        {
+            DecisionRecord record;
+            std::memcpy(&record, records.data() + i, sizeof(record));
+            REQUIRE(record.action == DecisionRecord::ACCEPT);
+            REQUIRE(record.time == 0x0101010101010101ull * record.flags);
+            REQUIRE(record.rule == 0x01010101u * record.flags);
+        }
+    }
+}
+
+
+TEST_CASE("FlightRecorder's can be dumped to a file.", "[FlightRecorder]")
+{
+    SECTION("The file is replaced on each dump.")
+    {
+        FlightRecorder recorder("flight_recorder_test.log", 16);
+        recorder.record(make_record(DecisionRecord::ACCEPT, 1));
+        recorder.dump();
+        recorder.record(make_record(DecisionRecord::ACCEPT, 2));
+        recorder.dump();
+        std::ifstream file("flight_recorder_test.log", std::ios::binary);
+        std::stringstream ss;
+        DecisionLog::dump(file, ss);
+        REQUIRE(ss.str().find("rule 1\n") != std::string::npos);
+        REQUIRE(ss.str().find("rule 2\n") != std::string::npos);
+        std::remove("flight_recorder_test.log");
+    }
+    SECTION("Errors are thrown if the file can not be written.")
+    {
+        FlightRecorder recorder("no_such_directory/flight_recorder_test.log");
+        REQUIRE_THROWS_AS(recorder.dump(), std::system_error);
+    }
+}
+
+
+TEST_CASE("FlightRecorder's can be installed for use by all connections.",
+          "[FlightRecorder]")
+{
+    REQUIRE(FlightRecorder::installed() == nullptr);
+    {
+        FlightRecorder recorder("flight_recorder_test.log", 16);
+        FlightRecorder::install(&recorder);
+        REQUIRE(FlightRecorder::installed() == &recorder);
+        FlightRecorder::install(nullptr);
+        REQUIRE(FlightRecorder::installed() == nullptr);
+        // Uninstalled on destruction.
+        FlightRecorder::install(&recorder);
+    }
+    REQUIRE(FlightRecorder::installed() == nullptr);
+}
@@ -18,6 +18,7 @@
 #include <catch.hpp>
 #include <fakeit.hpp>
 
+#include "Accept.hpp"
 #include "Action.hpp"
 #include "Chain.hpp"
 #include "GoTo.hpp"
@@ -26,6 +27,7 @@
 #include "Packet.hpp"
 #include "PacketVersion1.hpp"
 #include "PacketVersion2.hpp"
+#include "Reject.hpp"
 #include "Rule.hpp"
 #include "utility.hpp"
 
@@ -223,6 +225,52 @@ TEST_CASE("GoTo's 'action' method determines what to do with a "
 }
 
 
+TEST_CASE("GoTo's 'chain' method returns the chain to delegate to.", "[GoTo]")
+{
+    auto chain = std::make_shared<Chain>("test_chain");
+    REQUIRE(GoTo(chain).chain() == chain.get());
+    REQUIRE(GoTo(chain, 3, If().to("192.168")).chain() == chain.get());
+}
+
+
+TEST_CASE("GoTo's 'may_accept' method decides from only the packet ID and "
+          "source address.", "[GoTo]")
+{
+    MAVAddress source("192.168");
+    auto accept_chain = std::make_shared<Chain>("accept_chain");
+    accept_chain->append(std::make_unique<Accept>());
+    auto reject_chain = std::make_shared<Chain>("reject_chain");
+    reject_chain->append(std::make_unique<Reject>());
+    auto empty = std::make_shared<Chain>("empty_chain");
+    SECTION("Returns the result of the chain if the conditional matches.")
+    {
+        REQUIRE(GoTo(accept_chain).may_accept(4, source, false) == true);
+        REQUIRE(GoTo(reject_chain).may_accept(4, source, true) == false);
+        REQUIRE(
+            GoTo(reject_chain, If().type("PING")).may_accept(
+                4, source, true) == false);
+        // The default action is taken when the chain falls through.
+        REQUIRE(GoTo(empty).may_accept(4, source, true) == true);
+        REQUIRE(GoTo(empty).may_accept(4, source, false) == false);
+    }
+    SECTION("Continues if the conditional does not match.")
+    {
+        REQUIRE_FALSE(
+            GoTo(accept_chain, If().type("SET_MODE")).may_accept(
+                4, source, false).has_value());
+    }
+    SECTION("Only rejects if the conditional is certain to match.")
+    {
+        REQUIRE(
+            GoTo(accept_chain, If().to("172.16")).may_accept(
+                4, source, false) == true);
+        REQUIRE_FALSE(
+            GoTo(reject_chain, If().to("172.16")).may_accept(
+                4, source, true).has_value());
+    }
+}
+
+
 TEST_CASE("GoTo's are printable (without a condition or a priority).", "[GoTo]")
 {
     auto chain = std::make_shared<TestChain>();
@@ -0,0 +1,131 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <catch.hpp>
+
+#include "Histogram.hpp"
+
+
+using namespace std::chrono_literals;
+
+
+TEST_CASE("Histograms start empty.", "[Histogram]")
+{
+    Histogram histogram;
+    REQUIRE(histogram.count() == 0);
+    REQUIRE(histogram.sum() == 0ns);
+    REQUIRE(histogram.max() == 0ns);
+    REQUIRE(histogram.quantile(0.5) == 0ns);
+    REQUIRE(histogram.quantile(1.0) == 0ns);
+}
+
+
+TEST_CASE("Histogram's 'record' method records a duration.", "[Histogram]")
+{
+    Histogram histogram;
+    histogram.record(3ms);
+    histogram.record(1ms);
+    REQUIRE(histogram.count() == 2);
+    REQUIRE(histogram.sum() == 4ms);
+    REQUIRE(histogram.max() == 3ms);
+    SECTION("Negative durations are recorded as 0.")
+    {
+        histogram.record(-5ns);
+        REQUIRE(histogram.count() == 3);
+        REQUIRE(histogram.sum() == 4ms);
+        REQUIRE(histogram.quantile(0.0) == 0ns);
+    }
+}
+
+
+TEST_CASE("Histogram's 'quantile' method returns the duration that the given "
+          "fraction of recorded durations are less than or equal to.",
+          "[Histogram]")
+{
+    Histogram histogram;
+    SECTION("Short durations are exact.")
+    {
+        for (int i = 1; i <= 10; ++i)
+        {
+            histogram.record(std::chrono::nanoseconds(i));
+        }
+
+        REQUIRE(histogram.quantile(0.0) == 1ns);
+        REQUIRE(histogram.quantile(0.5) == 5ns);
+        REQUIRE(histogram.quantile(0.9) == 9ns);
+        REQUIRE(histogram.quantile(1.0) == 10ns);
+    }
+    SECTION("Longer durations are within 6.25%, but never low.")
+    {
+        for (int i = 1; i <= 1000; ++i)
+        {
+            histogram.record(std::chrono::microseconds(i));
+        }
+
+        for (auto [quantile, expected] : std::vector<std::pair<double, long>>
+                {{0.5, 500000}, {0.9, 900000}, {0.99, 990000}})
+        {
+            auto value = histogram.quantile(quantile).count();
+            REQUIRE(value >= expected);
+            REQUIRE(value <= expected + expected / 16);
+        }
+
+        // The maximum is exact.
+        REQUIRE(histogram.quantile(1.0) == 1ms);
+    }
+    SECTION("Durations longer than 2^36 ns are counted in the last bucket.")
+    {
+        histogram.record(1ms);
+        histogram.record(100s);
+        REQUIRE(histogram.max() == 100s);
+        REQUIRE(histogram.quantile(1.0) ==
+                std::chrono::nanoseconds((1LL << 36) - 1));
+    }
+}
+
+
+TEST_CASE("Histograms can be recorded to from many threads.", "[Histogram]")
+{
+    Histogram histogram;
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        threads.emplace_back([&histogram, i]()
+        {
+            for (int j = 0; j < 1000; ++j)
+            {
+                histogram.record(std::chrono::microseconds(i + 1));
+            }
+        });
+    }
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    REQUIRE(histogram.count() == 8000);
+    REQUIRE(histogram.sum() == 36000us);
+    REQUIRE(histogram.max() == 8us);
+}
@@ -0,0 +1,115 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <stdexcept>
+
+#include <catch.hpp>
+
+#include "IPAddress.hpp"
+#include "IPSubnet.hpp"
+#include "utility.hpp"
+
+
+TEST_CASE("IPSubnet's are comparable.", "[IPSubnet]")
+{
+    SECTION("with ==")
+    {
+        REQUIRE(IPSubnet(IPAddress("192.168.0.0"), 16) ==
+                IPSubnet(IPAddress("192.168.0.0"), 16));
+        REQUIRE(IPSubnet(IPAddress("192.168.1.2"), 16) ==
+                IPSubnet(IPAddress("192.168.0.0"), 16));
+        REQUIRE(IPSubnet(IPAddress("10.0.0.1"), 0) ==
+                IPSubnet(IPAddress("192.168.0.0"), 0));
+        REQUIRE_FALSE(IPSubnet(IPAddress("192.168.0.0"), 16) ==
+                      IPSubnet(IPAddress("192.168.0.0"), 24));
+        REQUIRE_FALSE(IPSubnet(IPAddress("192.168.0.0"), 16) ==
+                      IPSubnet(IPAddress("192.169.0.0"), 16));
+    }
+    SECTION("with !=")
+    {
+        REQUIRE(IPSubnet(IPAddress("192.168.0.0"), 16) !=
+                IPSubnet(IPAddress("192.168.0.0"), 24));
+        REQUIRE(IPSubnet(IPAddress("192.168.0.0"), 16) !=
+                IPSubnet(IPAddress("192.169.0.0"), 16));
+        REQUIRE_FALSE(IPSubnet(IPAddress("192.168.0.0"), 16) !=
+                      IPSubnet(IPAddress("192.168.0.0"), 16));
+    }
+}
+
+
+TEST_CASE("IPSubnet's can be constructed from an IP address and a prefix "
+          "length.", "[IPSubnet]")
+{
+    REQUIRE(IPSubnet(IPAddress("10.1.2.3")).prefix_length() == 32);
+    REQUIRE(IPSubnet(IPAddress("10.1.2.3"), 8).prefix_length() == 8);
+    REQUIRE(IPSubnet(IPAddress("10.1.2.3"), 0).prefix_length() == 0);
+    SECTION("And ensures the prefix length is within range.")
+    {
+        REQUIRE_THROWS_AS(
+            IPSubnet(IPAddress("10.1.2.3"), 33), std::out_of_range);
+        REQUIRE_THROWS_WITH(
+            IPSubnet(IPAddress("10.1.2.3"), 33),
+            "Prefix length (33) is outside of the allowed range (0 - 32).");
+    }
+}
+
+
+TEST_CASE("IPSubnet's can be constructed from strings.", "[IPSubnet]")
+{
+    REQUIRE(IPSubnet("192.168.0.0/16") ==
+            IPSubnet(IPAddress("192.168.0.0"), 16));
+    REQUIRE(IPSubnet("10.1.2.3") == IPSubnet(IPAddress("10.1.2.3"), 32));
+    REQUIRE(IPSubnet("0.0.0.0/0") == IPSubnet(IPAddress("0.0.0.0"), 0));
+    SECTION("And ensures the string is a valid subnet.")
+    {
+        REQUIRE_THROWS_AS(IPSubnet("192.168.0.0/"), std::invalid_argument);
+        REQUIRE_THROWS_AS(IPSubnet("192.168.0.0/a"), std::invalid_argument);
+        REQUIRE_THROWS_AS(IPSubnet("192.168.0.0/123"), std::invalid_argument);
+        REQUIRE_THROWS_AS(
+            IPSubnet("192.168.0.0:80/16"), std::invalid_argument);
+        REQUIRE_THROWS_AS(IPSubnet("192.168/16"), std::invalid_argument);
+        REQUIRE_THROWS_WITH(
+            IPSubnet("192.168.0.0/a"), "Invalid IP subnet string.");
+    }
+    SECTION("And ensures the prefix length is within range.")
+    {
+        REQUIRE_THROWS_AS(IPSubnet("192.168.0.0/33"), std::out_of_range);
+    }
+}
+
+
+TEST_CASE("IPSubnet's 'contains' method determines if an IP address is "
+          "part of the subnet.", "[IPSubnet]")
+{
+    IPSubnet subnet("192.168.0.0/16");
+    REQUIRE(subnet.contains(IPAddress("192.168.0.0")));
+    REQUIRE(subnet.contains(IPAddress("192.168.255.255")));
+    REQUIRE(subnet.contains(IPAddress("192.168.1.2:14550")));
+    REQUIRE_FALSE(subnet.contains(IPAddress("192.169.0.0")));
+    REQUIRE_FALSE(subnet.contains(IPAddress("10.0.0.1")));
+    REQUIRE(IPSubnet("10.0.0.1").contains(IPAddress("10.0.0.1:4000")));
+    REQUIRE_FALSE(IPSubnet("10.0.0.1").contains(IPAddress("10.0.0.2")));
+    REQUIRE(IPSubnet("0.0.0.0/0").contains(IPAddress("255.255.255.255")));
+}
+
+
+TEST_CASE("IPSubnet's are printable.", "[IPSubnet]")
+{
+    REQUIRE(str(IPSubnet("192.168.0.0/16")) == "192.168.0.0/16");
+    REQUIRE(str(IPSubnet("10.1.2.3")) == "10.1.2.3/32");
+    REQUIRE(str(IPSubnet("0.0.0.0/0")) == "0.0.0.0/0");
+}
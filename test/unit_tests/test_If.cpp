@@ -256,6 +256,34 @@ TEST_CASE("If's 'check' method determines if a packet and destination"
 }
 
 
+TEST_CASE("If's 'check' method can decide from only the packet ID and source "
+          "address.", "[If]")
+{
+    MAVAddress source("192.168");
+    SECTION("Matches if there is no destination subnet.")
+    {
+        REQUIRE(If().check(4, source) == true);
+        REQUIRE(If(4).check(4, source) == true);
+        REQUIRE(If(4, MAVSubnet("192.0/8")).check(4, source) == true);
+    }
+    SECTION("Does not match if the packet ID or source address differ.")
+    {
+        REQUIRE(If(11).check(4, source) == false);
+        REQUIRE(If({}, MAVSubnet("193.168")).check(4, source) == false);
+        REQUIRE(
+            If(11, {}, MAVSubnet("172.16")).check(4, source) == false);
+    }
+    SECTION("Is undecided if there is a destination subnet.")
+    {
+        REQUIRE_FALSE(
+            If({}, {}, MAVSubnet("172.16")).check(4, source).has_value());
+        REQUIRE_FALSE(
+            If(4, MAVSubnet("192.168"), MAVSubnet("172.16")).check(
+                4, source).has_value());
+    }
+}
+
+
 TEST_CASE("If's 'type' method sets the packet ID for matching.",
           "[If]")
 {
@@ -0,0 +1,146 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <ctime>
+#include <stdexcept>
+#include <string>
+
+#include <catch.hpp>
+
+#include "LogRing.hpp"
+
+
+TEST_CASE("LogRing's can be constructed.", "[LogRing]")
+{
+    REQUIRE_NOTHROW(LogRing());
+    REQUIRE_NOTHROW(LogRing(1));
+    REQUIRE_NOTHROW(LogRing(64));
+}
+
+
+TEST_CASE("LogRing's ensure the size is a power of 2.", "[LogRing]")
+{
+    REQUIRE_THROWS_AS(LogRing(0), std::invalid_argument);
+    REQUIRE_THROWS_AS(LogRing(3), std::invalid_argument);
+    REQUIRE_THROWS_AS(LogRing(1000), std::invalid_argument);
+    REQUIRE_THROWS_WITH(LogRing(3), "Log ring size (3) must be a power of 2.");
+}
+
+
+TEST_CASE("LogRing's return records in the order they were pushed.",
+          "[LogRing]")
+{
+    LogRing ring(4);
+    REQUIRE(ring.peek() == nullptr);
+    REQUIRE(ring.push(100, "first"));
+    REQUIRE(ring.push(200, "second"));
+    REQUIRE(ring.peek() != nullptr);
+    REQUIRE(ring.peek()->time == 100);
+    REQUIRE(std::string(ring.peek()->message, ring.peek()->length) ==
+            "first");
+    REQUIRE(ring.peek(1)->time == 200);
+    REQUIRE(std::string(ring.peek(1)->message, ring.peek(1)->length) ==
+            "second");
+    REQUIRE(ring.peek(2) == nullptr);
+    ring.pop();
+    REQUIRE(ring.peek()->time == 200);
+    REQUIRE(ring.peek(1) == nullptr);
+    ring.pop();
+    REQUIRE(ring.peek() == nullptr);
+    // Wraps around.
+    for (std::time_t i = 0; i < 10; ++i)
+    {
+        REQUIRE(ring.push(i, std::to_string(i)));
+        REQUIRE(ring.peek()->time == i);
+        ring.pop();
+    }
+}
+
+
+TEST_CASE("LogRing's truncate long messages.", "[LogRing]")
+{
+    LogRing ring(1);
+    std::string message(1000, 'x');
+    REQUIRE(ring.push(0, message));
+    REQUIRE(ring.peek()->length == sizeof(LogRecord::message));
+    REQUIRE(std::string(ring.peek()->message, ring.peek()->length) ==
+            message.substr(0, sizeof(LogRecord::message)));
+}
+
+
+TEST_CASE("LogRing's drop and count messages when full.", "[LogRing]")
+{
+    LogRing ring(2);
+    REQUIRE(ring.dropped() == 0);
+    REQUIRE(ring.push(1, "a"));
+    REQUIRE(ring.push(2, "b"));
+    REQUIRE_FALSE(ring.push(3, "c"));
+    REQUIRE_FALSE(ring.push(4, "d"));
+    REQUIRE(ring.dropped() == 2);
+    REQUIRE(ring.dropped() == 0);
+    ring.pop(2);
+    REQUIRE(ring.push(5, "e"));
+    REQUIRE(ring.peek()->time == 5);
+    REQUIRE(ring.dropped() == 0);
+}
+
+
+TEST_CASE("LogRing's can store packet event records.", "[LogRing]")
+{
+    LogRing ring(2);
+    LogRecord record;
+    record.time = 10;
+    record.event = LogEvent::accepted;
+    record.has_dest = true;
+    record.version = 0x0200;
+    record.id = 4;
+    record.source = 0x0101;
+    record.dest = 0x0202;
+    record.from = 1;
+    record.to = 2;
+    record.count = 3;
+    record.length = 0;
+    REQUIRE(ring.push(record));
+    REQUIRE(ring.push(20, "message"));
+    auto first = ring.peek();
+    REQUIRE(first->time == 10);
+    REQUIRE(first->event == LogEvent::accepted);
+    REQUIRE(first->has_dest);
+    REQUIRE(first->version == 0x0200);
+    REQUIRE(first->id == 4);
+    REQUIRE(first->source == 0x0101);
+    REQUIRE(first->dest == 0x0202);
+    REQUIRE(first->from == 1);
+    REQUIRE(first->to == 2);
+    REQUIRE(first->count == 3);
+    REQUIRE(first->length == 0);
+    REQUIRE(ring.peek(1)->event == LogEvent::message);
+    REQUIRE_FALSE(ring.push(record));
+    REQUIRE(ring.dropped() == 1);
+}
+
+
+TEST_CASE("LogRing's flag whether their thread is pushing.", "[LogRing]")
+{
+    LogRing ring(4);
+    REQUIRE_FALSE(ring.pushing());
+    ring.pushing(true);
+    REQUIRE(ring.pushing());
+    ring.pushing(false);
+    REQUIRE_FALSE(ring.pushing());
+}
@@ -18,13 +18,19 @@
 #include <ctime>
 #include <iomanip>
 #include <sstream>
+#include <string>
+#include <thread>
 
 #include <catch.hpp>
 
 #include "Logger.hpp"
+#include "LogRing.hpp"
+#include "PacketVersion1.hpp"
+#include "PacketVersion2.hpp"
 #include "utility.hpp"
 
 #include "common.hpp"
+#include "common_Packet.hpp"
 
 
 TEST_CASE("The Logger level can be set and retrieved with the static 'level' "
@@ -110,3 +116,166 @@ TEST_CASE("All logged messages have a timestamp (this can sometimes fail if "
         "  timestamped log message\n");
     Logger::level(0);
 }
+
+
+TEST_CASE("The Logger can write messages from a separate thread when "
+          "asynchronous logging is enabled.", "[Logger]")
+{
+    Logger::level(1);
+    MockCOut mock_cout;
+    Logger::async(true);
+    Logger::log("first async message");
+    Logger::log(2, "not logged");
+    std::thread thread([]()
+    {
+        Logger::log("second async message");
+    });
+    thread.join();
+    Logger::flush();
+    Logger::async(false);
+    auto buffer = mock_cout.buffer();
+    REQUIRE(buffer.find("  first async message\n") != std::string::npos);
+    REQUIRE(buffer.find("  second async message\n") != std::string::npos);
+    REQUIRE(buffer.find("not logged") == std::string::npos);
+    mock_cout.reset();
+    // Back to synchronous logging.
+    Logger::log("sync message");
+    REQUIRE(mock_cout.buffer().substr(21) == "sync message\n");
+    Logger::level(0);
+}
+
+
+TEST_CASE("The Logger assigns ids to names with the static 'register_name' "
+          "method.", "[Logger]")
+{
+    auto id1 = Logger::register_name("Logger test name 1");
+    auto id2 = Logger::register_name("Logger test name 2");
+    REQUIRE(id1 != 0);
+    REQUIRE(id2 != 0);
+    REQUIRE(id1 != id2);
+    REQUIRE(Logger::register_name("Logger test name 1") == id1);
+    REQUIRE(Logger::register_name("Logger test name 2") == id2);
+    REQUIRE(Logger::register_name("unknown") == 0);
+}
+
+
+TEST_CASE("The Logger can render log records with the static 'render' "
+          "method.", "[Logger]")
+{
+    auto source = Logger::register_name("SOURCE");
+    auto dest = Logger::register_name("DEST");
+    LogRecord record;
+    record.time = 0;
+    record.event = LogEvent::received;
+    record.version = 0x0200;
+    record.id = 4;
+    record.source = static_cast<uint16_t>(MAVAddress("192.168").address());
+    record.has_dest = true;
+    record.dest = static_cast<uint16_t>(MAVAddress("127.1").address());
+    record.from = source;
+    record.to = dest;
+    record.count = 3;
+    record.length = 0;
+    SECTION("Text messages.")
+    {
+        record.event = LogEvent::message;
+        record.message[0] = 'h';
+        record.message[1] = 'i';
+        record.length = 2;
+        REQUIRE(Logger::render(record) == "hi");
+    }
+    SECTION("Received packets.")
+    {
+        REQUIRE(Logger::render(record) ==
+                "received PING (#4) from 192.168 to 127.1 (v2.0) "
+                "source SOURCE");
+    }
+    SECTION("Accepted packets.")
+    {
+        record.event = LogEvent::accepted;
+        REQUIRE(Logger::render(record) ==
+                "accepted PING (#4) from 192.168 to 127.1 (v2.0) "
+                "source SOURCE dest DEST");
+    }
+    SECTION("Rejected packets, without destination or known source.")
+    {
+        record.event = LogEvent::rejected;
+        record.version = 0x0100;
+        record.id = 0;
+        record.has_dest = false;
+        record.from = 0;
+        REQUIRE(Logger::render(record) ==
+                "rejected HEARTBEAT (#0) from 192.168 (v1.0) "
+                "source unknown dest DEST");
+    }
+    SECTION("Suppressed duplicates.")
+    {
+        record.event = LogEvent::duplicate;
+        REQUIRE(Logger::render(record) ==
+                "suppressed duplicate PING (#4) from 192.168 to 127.1 (v2.0) "
+                "source SOURCE (3 duplicates)");
+    }
+    SECTION("Queued packets.")
+    {
+        record.event = LogEvent::queued;
+        REQUIRE(Logger::render(record) ==
+                "queued PING (#4) from 192.168 to 127.1 (v2.0) "
+                "source SOURCE dest DEST");
+    }
+    SECTION("Packets taken to be sent.")
+    {
+        record.event = LogEvent::sending;
+        REQUIRE(Logger::render(record) ==
+                "sending PING (#4) from 192.168 to 127.1 (v2.0) "
+                "source SOURCE dest DEST (queued 3 us)");
+    }
+}
+
+
+TEST_CASE("The Logger can log packet events.", "[Logger]")
+{
+    auto source = Logger::register_name("SOURCE");
+    auto dest = Logger::register_name("DEST");
+    auto ping = packet_v2::Packet(to_vector(PingV2()));
+    auto heartbeat = packet_v1::Packet(to_vector(HeartbeatV1()));
+    MockCOut mock_cout;
+    SECTION("Only when the logger's level is high enough.")
+    {
+        Logger::level(2);
+        Logger::log(3, LogEvent::accepted, ping, source, dest);
+        REQUIRE(mock_cout.buffer().empty());
+    }
+    SECTION("Synchronously.")
+    {
+        Logger::level(3);
+        Logger::log(3, LogEvent::accepted, ping, source, dest);
+        REQUIRE(mock_cout.buffer().substr(21) ==
+                "accepted PING (#4) from 192.168 to 127.1 (v2.0) "
+                "source SOURCE dest DEST\n");
+        mock_cout.reset();
+        Logger::log(2, LogEvent::received, heartbeat);
+        REQUIRE(mock_cout.buffer().substr(21) ==
+                "received HEARTBEAT (#0) from 127.1 (v1.0) "
+                "source unknown\n");
+    }
+    SECTION("Asynchronously.")
+    {
+        Logger::level(3);
+        Logger::async(true);
+        Logger::log(3, LogEvent::rejected, ping, source, dest);
+        Logger::flush();
+        Logger::async(false);
+        REQUIRE(mock_cout.buffer().substr(21) ==
+                "rejected PING (#4) from 192.168 to 127.1 (v2.0) "
+                "source SOURCE dest DEST\n");
+    }
+    SECTION("At any level when traced.")
+    {
+        Logger::level(0);
+        Logger::trace(LogEvent::queued, ping, source, dest);
+        REQUIRE(mock_cout.buffer().substr(21) ==
+                "queued PING (#4) from 192.168 to 127.1 (v2.0) "
+                "source SOURCE dest DEST\n");
+    }
+    Logger::level(0);
+}
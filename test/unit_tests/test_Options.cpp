@@ -138,6 +138,9 @@ TEST_CASE("Options's class prints the help message.", "[Options]")
         "  -h [ --help ]         print this message\n"
         "  --config arg          specify configuration file\n"
         "  --ast                 print AST of configuration file (do not run)\n"
+        "  --stats               print statistics of the running mavtables\n"
+        "  --rules               print rule hit counts of the running "
+        "mavtables\n"
         "  --version             print version and license information\n"
         "  --loglevel arg        level of logging, between 0 and 3\n\n";
     SECTION("When given the '-h' flag.")
@@ -424,6 +427,57 @@ TEST_CASE("Options's class sets run to false and ast to true when the --ast "
 }
 
 
+TEST_CASE("Options's class sets run to false and stats to true when the "
+          "--stats flag is given.", "[Options]")
+{
+    MockCOut mock_cout;
+    // Setup mocks.
+    fakeit::Mock<Filesystem> fs_mock;
+    fakeit::When(Method(fs_mock, exists)).AlwaysReturn(true);
+    // Construct Options object.
+    int argc = 4;
+    const char *argv[4] =
+    {
+        "mavtables", "--stats", "--config", "test/mavtables.conf"
+    };
+    Options options(argc, argv);
+    // Verify Options object.
+    REQUIRE(options.config_file() == "test/mavtables.conf");
+    REQUIRE(options);
+    REQUIRE(options.stats());
+    REQUIRE_FALSE(options.ast());
+    REQUIRE_FALSE(options.run());
+    // Verify printing.
+    REQUIRE(mock_cout.buffer().empty());
+}
+
+
+TEST_CASE("Options's class sets run to false and rules to true when the "
+          "--rules flag is given.", "[Options]")
+{
+    MockCOut mock_cout;
+    // Setup mocks.
+    fakeit::Mock<Filesystem> fs_mock;
+    fakeit::When(Method(fs_mock, exists)).AlwaysReturn(true);
+    // Construct Options object.
+    int argc = 4;
+    const char *argv[4] =
+    {
+        "mavtables", "--rules", "--config", "test/mavtables.conf"
+    };
+    Options options(argc, argv);
+    // Verify Options object.
+    REQUIRE(options.config_file() == "test/mavtables.conf");
+    REQUIRE(options);
+    REQUIRE(options.rules());
+    REQUIRE_FALSE(options.stats());
+    REQUIRE_FALSE(options.ast());
+    REQUIRE_FALSE(options.run());
+    // Verify printing.
+    REQUIRE(mock_cout.buffer().empty());
+}
+
+
 TEST_CASE("Option's class has a loglevel option", "[Options]")
 {
     MockCOut mock_cout;
@@ -15,6 +15,7 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -76,6 +77,14 @@ namespace
             {
                 return MAVAddress("2.71");
             }
+            virtual unsigned int sequence() const
+            {
+                return 7;
+            }
+            virtual uint16_t checksum() const
+            {
+                return 0xBEEF;
+            }
             PacketTestClass &operator=(const PacketTestClass &other) = default;
             PacketTestClass &operator=(PacketTestClass &&other) = default;
     };
@@ -212,6 +221,27 @@ TEST_CASE("Packet's optionally have a source connection.", "[Packet]")
 }
 
 
+TEST_CASE("Packet's have a receive timestamp.", "[Packet]")
+{
+    SECTION("Defaults to the time the packet was constructed.")
+    {
+        auto before = std::chrono::steady_clock::now();
+        PacketTestClass packet({});
+        auto after = std::chrono::steady_clock::now();
+        REQUIRE(packet.timestamp() >= before);
+        REQUIRE(packet.timestamp() <= after);
+    }
+    SECTION("Can be set with the 'timestamp' method.")
+    {
+        PacketTestClass packet({});
+        auto time = std::chrono::steady_clock::time_point(
+                        std::chrono::seconds(42));
+        packet.timestamp(time);
+        REQUIRE(packet.timestamp() == time);
+    }
+}
+
+
 TEST_CASE("Packet's are printable.", "[Packet]")
 {
     REQUIRE(
@@ -26,6 +26,7 @@
 #include <catch.hpp>
 
 #include "config.hpp"
+#include "MAVAddress.hpp"
 #include "Packet.hpp"
 #include "PacketParser.hpp"
 #include "PacketVersion1.hpp"
@@ -203,6 +204,141 @@ TEST_CASE("PacketParser's can be cleared with 'clear'.", "[PacketParser]")
 }
 
 
+TEST_CASE("PacketParser's skip packets rejected by the prefilter.",
+          "[PacketParser]")
+{
+    PacketParser parser;
+    std::vector<std::pair<unsigned long, MAVAddress>> headers;
+    parser.prefilter([&](auto id, const auto & source)
+    {
+        headers.emplace_back(id, source);
+        return id != 4;
+    });
+    SECTION("Rejected v1.0 packets are skipped.")
+    {
+        for (auto byte : to_vector(PingV1()))
+        {
+            REQUIRE(parser.parse_byte(byte) == nullptr);
+        }
+
+        REQUIRE(headers.size() == 1);
+        REQUIRE(headers[0].first == 4);
+        REQUIRE(headers[0].second == MAVAddress("192.168"));
+        REQUIRE(parser.bytes_parsed() == 0);
+    }
+    SECTION("Rejected v2.0 packets (with signature) are skipped.")
+    {
+        for (auto byte : to_vector_with_sig(PingV2()))
+        {
+            REQUIRE(parser.parse_byte(byte) == nullptr);
+        }
+
+        REQUIRE(headers.size() == 1);
+        REQUIRE(headers[0].first == 4);
+        REQUIRE(headers[0].second == MAVAddress("192.168"));
+        REQUIRE(parser.bytes_parsed() == 0);
+    }
+    SECTION("Accepted packets are parsed.")
+    {
+        auto data = to_vector(HeartbeatV2());
+        auto packet = test_packet_parser(parser, data, sizeof(HeartbeatV2));
+        REQUIRE(*packet == packet_v2::Packet(to_vector(HeartbeatV2())));
+        REQUIRE(headers.size() == 1);
+        REQUIRE(headers[0].first == 0);
+        REQUIRE(headers[0].second == MAVAddress("127.1"));
+    }
+    SECTION("Parsing continues after a rejected packet.")
+    {
+        auto data = to_vector(PingV2());
+        auto heartbeat = to_vector(HeartbeatV2());
+        data.insert(data.end(), heartbeat.begin(), heartbeat.end());
+        auto packet = test_packet_parser(parser, data, data.size());
+        REQUIRE(*packet == packet_v2::Packet(to_vector(HeartbeatV2())));
+        REQUIRE(headers.size() == 2);
+    }
+    SECTION("An empty prefilter parses every packet.")
+    {
+        parser.prefilter({});
+        auto data = to_vector(PingV2());
+        auto packet = test_packet_parser(parser, data, sizeof(PingV2));
+        REQUIRE(*packet == packet_v2::Packet(to_vector(PingV2())));
+        REQUIRE(headers.empty());
+    }
+}
+
+
+TEST_CASE("PacketParser's report the source address of skipped packets "
+          "with a valid checksum.", "[PacketParser]")
+{
+    PacketParser parser;
+    std::vector<MAVAddress> skipped;
+    parser.prefilter([](auto id, const auto & source)
+    {
+        (void)source;
+        return id != 4;
+    },
+    [&](const auto & source)
+    {
+        skipped.push_back(source);
+    });
+    auto parse = [&](const std::vector<uint8_t> &data)
+    {
+        for (auto byte : data)
+        {
+            REQUIRE(parser.parse_byte(byte) == nullptr);
+        }
+
+        REQUIRE(parser.bytes_parsed() == 0);
+    };
+    SECTION("v1.0 packets.")
+    {
+        parse(to_vector_with_crc(PingV1()));
+        REQUIRE(skipped == std::vector<MAVAddress>({MAVAddress("192.168")}));
+    }
+    SECTION("v2.0 packets.")
+    {
+        parse(to_vector_with_crc(PingV2()));
+        REQUIRE(skipped == std::vector<MAVAddress>({MAVAddress("192.168")}));
+    }
+    SECTION("v2.0 packets with signature.")
+    {
+        auto ping = PingV2();
+        ping.incompat_flags |= MAVLINK_IFLAG_SIGNED;
+        auto data = to_vector_with_crc(ping);
+        data.insert(data.end(), 13, 0xFD);
+        parse(data);
+        REQUIRE(skipped == std::vector<MAVAddress>({MAVAddress("192.168")}));
+    }
+    SECTION("Not when the checksum is invalid.")
+    {
+        parse(to_vector(PingV1()));
+        parse(to_vector(PingV2()));
+        parse(to_vector_with_sig(PingV2()));
+        auto data = to_vector_with_crc(PingV2());
+        data[12] ^= 0x01;
+        parse(data);
+        REQUIRE(skipped.empty());
+    }
+    SECTION("Not when the packet ID is unknown.")
+    {
+        auto ping = PingV2();
+        ping.msgid = 0xFFFFFF;
+        parser.prefilter([](auto id, const auto & source)
+        {
+            (void)id;
+            (void)source;
+            return false;
+        },
+        [&](const auto & source)
+        {
+            skipped.push_back(source);
+        });
+        parse(to_vector(ping));
+        REQUIRE(skipped.empty());
+    }
+}
+
+
 TEST_CASE("PacketParser's keep track of how many bytes they have parsed of "
           "the current packet.", "[PacketParser]")
 {
@@ -69,6 +69,32 @@ TEST_CASE("PacketQueue's 'push' adds a packet to the queue.", "[PacketQueue]")
         queue.push(ping);
         REQUIRE(called);
     }
+    SECTION("Calls the ready callback when the queue was empty.")
+    {
+        auto ping = std::make_shared<packet_v2::Packet>(to_vector(PingV2()));
+        int calls = 0;
+        int ready_calls = 0;
+        bool ready_first = false;
+        PacketQueue queue([&]()
+        {
+            ++calls;
+        }, [&]()
+        {
+            ready_first = ready_calls == calls;
+            ++ready_calls;
+        });
+        queue.push(ping);
+        REQUIRE(ready_calls == 1);
+        REQUIRE(ready_first);
+        queue.push(ping);
+        REQUIRE(ready_calls == 1);
+        REQUIRE(calls == 2);
+        queue.pop();
+        queue.pop();
+        queue.push(ping);
+        REQUIRE(ready_calls == 2);
+        REQUIRE(calls == 3);
+    }
 }
 
 
@@ -83,6 +109,27 @@ TEST_CASE("PacketQueue's 'empty' method determines if the queue is empty or "
 }
 
 
+TEST_CASE("PacketQueue's 'size' and 'high_water' methods track the number of "
+          "queued packets.", "[PacketQueue]")
+{
+    auto ping = std::make_shared<packet_v2::Packet>(to_vector(PingV2()));
+    PacketQueue queue;
+    REQUIRE(queue.size() == 0);
+    REQUIRE(queue.high_water() == 0);
+    queue.push(ping);
+    queue.push(ping);
+    REQUIRE(queue.size() == 2);
+    REQUIRE(queue.high_water() == 2);
+    queue.pop(0s);
+    REQUIRE(queue.size() == 1);
+    REQUIRE(queue.high_water() == 2);
+    queue.push(ping);
+    queue.push(ping);
+    REQUIRE(queue.size() == 3);
+    REQUIRE(queue.high_water() == 3);
+}
+
+
 TEST_CASE("PacketQueue's can be managed with 'push' and 'pop' methods.",
           "[PacketQueue]")
 {
@@ -302,3 +349,40 @@ TEST_CASE("PacketQueue's 'pop' method is non blocking when given a 0 second "
         REQUIRE(queue.pop(0s) == nullptr);
     }
 }
+
+
+TEST_CASE("PacketQueue's 'pop_queued' method returns the packet along with its "
+          "priority and the time it was queued.", "[PacketQueue]")
+{
+    auto ping = std::make_shared<packet_v2::Packet>(to_vector(PingV2()));
+    auto heartbeat =
+        std::make_shared<packet_v2::Packet>(to_vector(HeartbeatV2()));
+    PacketQueue queue;
+    SECTION("Returns the highest priority packet when one is available.")
+    {
+        auto before = std::chrono::steady_clock::now();
+        queue.push(ping, 1);
+        queue.push(heartbeat, 3);
+        auto after = std::chrono::steady_clock::now();
+        auto queued = queue.pop_queued(0s);
+        REQUIRE(queued.has_value());
+        REQUIRE(*queued->packet() == *heartbeat);
+        REQUIRE(queued->priority() == 3);
+        REQUIRE(queued->timestamp() >= before);
+        REQUIRE(queued->timestamp() <= after);
+        queued = queue.pop_queued(0s);
+        REQUIRE(queued.has_value());
+        REQUIRE(*queued->packet() == *ping);
+        REQUIRE(queued->priority() == 1);
+    }
+    SECTION("Returns {} when the timeout expires.")
+    {
+        REQUIRE_FALSE(queue.pop_queued(1ms).has_value());
+    }
+    SECTION("Returns {} when the queue is closed.")
+    {
+        queue.push(ping);
+        queue.close();
+        REQUIRE_FALSE(queue.pop_queued(0s).has_value());
+    }
+}
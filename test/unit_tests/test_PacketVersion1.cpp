@@ -409,6 +409,20 @@ TEST_CASE("packet_v1::Packet's have a source address.", "[packet_v1::Packet]")
 }
 
 
+TEST_CASE("packet_v1::Packet's have a sequence number and checksum.",
+          "[packet_v1::Packet]")
+{
+    auto ping = PingV1();
+    ping.seq = 42;
+    ping.checksum = 0x1234;
+    REQUIRE(packet_v1::Packet(to_vector(ping)).sequence() == 42);
+    REQUIRE(packet_v1::Packet(to_vector(ping)).checksum() == 0x1234);
+    auto encapsulated_data = to_vector(EncapsulatedDataV1());
+    REQUIRE(packet_v1::Packet(encapsulated_data).sequence() == 0xFE);
+    REQUIRE(packet_v1::Packet(encapsulated_data).checksum() == 0xFACE);
+}
+
+
 TEST_CASE("packet_v1::Packet's optionally have a destination address.",
           "[packet_v1::Packet]")
 {
@@ -675,6 +675,22 @@ TEST_CASE("packet_v2::Packet's have a source address.", "[packet_v2::Packet]")
 }
 
 
+TEST_CASE("packet_v2::Packet's have a sequence number and checksum.",
+          "[packet_v2::Packet]")
+{
+    auto ping = PingV2();
+    ping.seq = 42;
+    ping.checksum = 0x1234;
+    REQUIRE(packet_v2::Packet(to_vector(ping)).sequence() == 42);
+    REQUIRE(packet_v2::Packet(to_vector(ping)).checksum() == 0x1234);
+    // The signature does not change the checksum.
+    REQUIRE(packet_v2::Packet(to_vector_with_sig(ping)).checksum() == 0x1234);
+    auto encapsulated_data = to_vector_with_sig(EncapsulatedDataV2());
+    REQUIRE(packet_v2::Packet(encapsulated_data).sequence() == 0xFD);
+    REQUIRE(packet_v2::Packet(encapsulated_data).checksum() == 0xFACE);
+}
+
+
 TEST_CASE("packet_v2::Packet's optionally have a destination address.",
           "[packet_v2::Packet]")
 {
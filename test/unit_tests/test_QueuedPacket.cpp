@@ -15,6 +15,7 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
+#include <chrono>
 #include <limits>
 #include <utility>
 
@@ -213,6 +214,27 @@ TEST_CASE("QueuedPacket's 'packet' method returns the contained MAVLink packet",
 }
 
 
+TEST_CASE("QueuedPacket's 'priority' method returns the priority of the "
+          "packet.", "[QueuedPacket]")
+{
+    auto packet = std::make_shared<packet_v2::Packet>(to_vector(PingV2()));
+    REQUIRE(QueuedPacket(packet, 3, 10).priority() == 3);
+    REQUIRE(QueuedPacket(packet, -2, 10).priority() == -2);
+}
+
+
+TEST_CASE("QueuedPacket's 'timestamp' method returns the time the packet was "
+          "queued.", "[QueuedPacket]")
+{
+    auto packet = std::make_shared<packet_v2::Packet>(to_vector(PingV2()));
+    auto before = std::chrono::steady_clock::now();
+    QueuedPacket queued(packet, 3, 10);
+    auto after = std::chrono::steady_clock::now();
+    REQUIRE(queued.timestamp() >= before);
+    REQUIRE(queued.timestamp() <= after);
+}
+
+
 TEST_CASE("QueuedPacket's are printable.", "[QueuedPacket]")
 {
     auto packet = std::make_shared<packet_v2::Packet>(to_vector(PingV2()));
@@ -99,6 +99,27 @@ TEST_CASE("Reject's 'action' method determines what to do with a "
 }
 
 
+TEST_CASE("Reject's 'may_accept' method decides from only the packet ID and "
+          "source address.", "[Reject]")
+{
+    MAVAddress source("192.168");
+    SECTION("Rejects if the conditional is a match.")
+    {
+        REQUIRE(Reject().may_accept(4, source, true) == false);
+        REQUIRE(Reject(If().type("PING")).may_accept(4, source, true) == false);
+    }
+    SECTION("Continues if the conditional does not or may not match.")
+    {
+        REQUIRE_FALSE(
+            Reject(If().type("SET_MODE")).may_accept(
+                4, source, false).has_value());
+        REQUIRE_FALSE(
+            Reject(If().to("172.16")).may_accept(
+                4, source, false).has_value());
+    }
+}
+
+
 TEST_CASE("Reject's are printable (without a condition).", "[Reject]")
 {
     auto ping = packet_v2::Packet(to_vector(PingV2()));
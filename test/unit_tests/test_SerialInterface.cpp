@@ -17,7 +17,9 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <set>
 #include <stdexcept>
 #include <vector>
@@ -113,6 +115,7 @@ TEST_CASE("SerialInterface's 'receive_packet' method.", "[SerialInterface]")
     fakeit::Mock<ConnectionPool> mock_pool;
     auto pool = mock_shared(mock_pool);
     fakeit::Fake(Method(mock_pool, add));
+    fakeit::When(Method(mock_pool, may_accept)).AlwaysReturn(true);
     std::multiset<packet_v2::Packet,
         bool(*)(const packet_v2::Packet &, const packet_v2::Packet &)>
         send_packets([](const auto & a, const auto & b)
@@ -306,6 +309,45 @@ TEST_CASE("SerialInterface's 'receive_packet' method.", "[SerialInterface]")
         REQUIRE(it != send_packets.end());
         REQUIRE(it->connection() != nullptr);
     }
+    SECTION("Packets no connection may accept are skipped.")
+    {
+        // Mocks
+        fakeit::When(Method(mock_pool, may_accept)).AlwaysReturn(false);
+        fakeit::When(OverloadedMethod(mock_port, read, read_type)
+                    ).AlwaysDo([](auto a, auto b)
+        {
+            (void)b;
+            auto vec = to_vector_with_crc(HeartbeatV2());
+            std::copy(vec.begin(), vec.end(), a);
+        });
+        // Test
+        serial.receive_packet(timeout);
+        // Verification
+        fakeit::Verify(Method(mock_pool, may_accept).Using(
+                           0, MAVAddress("127.1"))).Once();
+        fakeit::Verify(Method(mock_connection, add_address
+                             ).Using(MAVAddress("127.1"))).Exactly(1);
+        fakeit::Verify(Method(mock_pool, send)).Exactly(0);
+    }
+    SECTION("Skipped packets with an invalid checksum are not learned.")
+    {
+        // Mocks
+        fakeit::When(Method(mock_pool, may_accept)).AlwaysReturn(false);
+        fakeit::When(OverloadedMethod(mock_port, read, read_type)
+                    ).AlwaysDo([](auto a, auto b)
+        {
+            (void)b;
+            auto vec = to_vector(HeartbeatV2());
+            std::copy(vec.begin(), vec.end(), a);
+        });
+        // Test
+        serial.receive_packet(timeout);
+        // Verification
+        fakeit::Verify(Method(mock_pool, may_accept).Using(
+                           0, MAVAddress("127.1"))).Once();
+        fakeit::Verify(Method(mock_connection, add_address)).Exactly(0);
+        fakeit::Verify(Method(mock_pool, send)).Exactly(0);
+    }
 }
 
 
@@ -341,6 +383,11 @@ TEST_CASE("SerialInterface's 'send_packet' method.", "[SerialInterface]")
     // Interface
     SerialInterface serial(std::move(port), pool, std::move(connection));
     std::chrono::nanoseconds timeout = 250ms;
+    // The packet wait gets what is left of the timeout.
+    auto in_time = [](const std::chrono::nanoseconds & t)
+    {
+        return t > 200ms && t <= 250ms;
+    };
     SECTION("No packets, timeout.")
     {
         // Mocks
@@ -349,45 +396,117 @@ TEST_CASE("SerialInterface's 'send_packet' method.", "[SerialInterface]")
         serial.send_packet(timeout);
         // Verification
         fakeit::Verify(
-            Method(mock_connection, next_packet).Using(250ms)).Once();
+            Method(mock_connection, next_packet).Matching(in_time)).Once();
         fakeit::Verify(
             OverloadedMethod(mock_port, write, write_type)).Exactly(0);
     }
     SECTION("Single packet.")
     {
         // Mocks
-        fakeit::When(Method(mock_connection, next_packet)).Return(heartbeat);
+        fakeit::When(Method(mock_connection, next_packet)
+                    ).Return(heartbeat).AlwaysReturn(nullptr);
         // Test
         serial.send_packet(timeout);
         // Verification
         fakeit::Verify(
-            Method(mock_connection, next_packet).Using(250ms)).Once();
+            Method(mock_connection, next_packet).Matching(in_time)).Once();
+        fakeit::Verify(
+            Method(mock_connection, next_packet).Using(0s)).Once();
         fakeit::Verify(
             OverloadedMethod(mock_port, write, write_type)).Exactly(1);
         REQUIRE(write_bytes.count(heartbeat->data()) == 1);
     }
-    SECTION("Multiple packets.")
+    SECTION("Multiple packets are combined into a single write.")
     {
         // Mocks
         fakeit::When(Method(mock_connection, next_packet)
-                    ).Return(heartbeat).Return(encapsulated_data);
+                    ).Return(heartbeat).Return(encapsulated_data)
+        .AlwaysReturn(nullptr);
         // Test
         serial.send_packet(timeout);
         // Verification
         fakeit::Verify(
-            Method(mock_connection, next_packet).Using(250ms)).Once();
+            Method(mock_connection, next_packet).Matching(in_time)).Once();
+        fakeit::Verify(
+            Method(mock_connection, next_packet).Using(0s)).Once();
         fakeit::Verify(
             OverloadedMethod(mock_port, write, write_type)).Exactly(1);
-        REQUIRE(write_bytes.count(heartbeat->data()) == 1);
+        auto combined = heartbeat->data();
+        combined.insert(
+            combined.end(), encapsulated_data->data().begin(),
+            encapsulated_data->data().end());
+        REQUIRE(write_bytes.count(combined) == 1);
         // Test
         serial.send_packet(timeout);
         // Verification
         fakeit::Verify(
-            Method(mock_connection, next_packet).Using(250ms)).Exactly(2);
+            Method(mock_connection, next_packet).Matching(in_time)).Exactly(2);
+        fakeit::Verify(
+            OverloadedMethod(mock_port, write, write_type)).Exactly(1);
+    }
+    SECTION("Stops combining packets when the write is large enough.")
+    {
+        // Mocks
+        fakeit::When(Method(mock_connection, next_packet)
+                    ).Return(encapsulated_data).Return(heartbeat)
+        .AlwaysReturn(nullptr);
+        // Test
+        serial.send_packet(timeout);
+        // Verification
+        fakeit::Verify(
+            Method(mock_connection, next_packet).Matching(in_time)).Once();
+        fakeit::Verify(
+            Method(mock_connection, next_packet).Using(0s)).Exactly(0);
+        fakeit::Verify(
+            OverloadedMethod(mock_port, write, write_type)).Exactly(1);
+        REQUIRE(write_bytes.count(encapsulated_data->data()) == 1);
+        // Test
+        serial.send_packet(timeout);
+        // Verification
+        fakeit::Verify(
+            Method(mock_connection, next_packet).Matching(in_time)).Exactly(2);
         fakeit::Verify(
             OverloadedMethod(mock_port, write, write_type)).Exactly(2);
         REQUIRE(write_bytes.count(heartbeat->data()) == 1);
-        REQUIRE(write_bytes.count(encapsulated_data->data()) == 1);
+    }
+    SECTION("Partial writes are resumed.")
+    {
+        // Mocks
+        fakeit::When(Method(mock_connection, next_packet)
+                    ).Return(heartbeat).AlwaysReturn(nullptr);
+        std::vector<std::size_t> offsets;
+        fakeit::When(Method(mock_port, write_some)).AlwaysDo(
+            [&](auto buffers, auto offset)
+        {
+            REQUIRE(buffers.size() == 1);
+            const std::vector<uint8_t> &data = buffers[0];
+            REQUIRE(data == heartbeat->data());
+            offsets.push_back(offset);
+            return std::min<std::size_t>(10, data.size() - offset);
+        });
+        // Test
+        serial.send_packet(timeout);
+        serial.send_packet(timeout);
+        serial.send_packet(timeout);
+        serial.send_packet(timeout);
+        // Verification (heartbeat packets are 21 bytes long).
+        REQUIRE(offsets == std::vector<std::size_t>({0, 10, 20}));
+        fakeit::Verify(
+            Method(mock_connection, next_packet).Matching(in_time)).Exactly(2);
+    }
+    SECTION("Waits for the serial port's output buffer to drain.")
+    {
+        // Mocks
+        fakeit::When(Method(mock_port, wait_for_output)).Return(false);
+        fakeit::When(Method(mock_connection, next_packet)).Return(heartbeat);
+        // Test
+        serial.send_packet(timeout);
+        // Verification
+        fakeit::Verify(
+            Method(mock_port, wait_for_output).Using(256, 250ms)).Once();
+        fakeit::Verify(Method(mock_connection, next_packet)).Exactly(0);
+        fakeit::Verify(
+            OverloadedMethod(mock_port, write, write_type)).Exactly(0);
     }
 }
 
@@ -17,6 +17,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <functional>
 #include <iterator>
 #include <optional>
 #include <utility>
@@ -149,6 +150,48 @@ TEST_CASE("SerialPort's 'write' method accepts two vector iterators",
 }
 
 
+TEST_CASE("SerialPort's 'write_some' method writes multiple buffers with "
+          "the 'write' method.", "[SerialPort]")
+{
+    SerialPort serial;
+    fakeit::Mock<SerialPort> mock_port(serial);
+    std::vector<std::vector<uint8_t>> written;
+    fakeit::When(
+        OverloadedMethod(
+            mock_port, write,
+            void(const std::vector<uint8_t> &))).AlwaysDo([&](auto a)
+    {
+        written.push_back(a);
+    });
+    SerialPort &port = mock_port.get();
+    std::vector<uint8_t> first = {0, 1, 2, 3};
+    std::vector<uint8_t> second = {4, 5, 6, 7, 8, 9};
+    SECTION("Without an offset.")
+    {
+        REQUIRE(port.write_some({std::cref(first), std::cref(second)}) == 10);
+        REQUIRE(written.size() == 1);
+        REQUIRE(
+            written[0] == std::vector<uint8_t>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+    }
+    SECTION("With an offset.")
+    {
+        REQUIRE(
+            port.write_some({std::cref(first), std::cref(second)}, 5) == 5);
+        REQUIRE(written.size() == 1);
+        REQUIRE(written[0] == std::vector<uint8_t>({5, 6, 7, 8, 9}));
+    }
+}
+
+
+TEST_CASE("SerialPort's do not have an output buffer by default.",
+          "[SerialPort]")
+{
+    SerialPort port;
+    REQUIRE(port.output_queue_size() == 0);
+    REQUIRE(port.wait_for_output(0, 1ms));
+}
+
+
 TEST_CASE("SerialPort's are printable.", "SerialPort")
 {
     REQUIRE(str(SerialPort()) == "unknown serial port");
@@ -0,0 +1,158 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <catch.hpp>
+#include <errno.h>
+#include <fakeit.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "SharedMemory.hpp"
+#include "UnixSyscalls.hpp"
+
+#include "common.hpp"
+
+
+TEST_CASE("SharedMemory's create and map a shared memory object on "
+          "construction and unmap and remove it on destruction.",
+          "[SharedMemory]")
+{
+    char buffer[64];
+    fakeit::Mock<UnixSyscalls> mock_sys;
+    fakeit::When(Method(mock_sys, shm_unlink)).AlwaysReturn(0);
+    fakeit::When(Method(mock_sys, shm_open)).Return(3);
+    fakeit::When(Method(mock_sys, ftruncate)).Return(0);
+    fakeit::When(Method(mock_sys, close)).Return(0);
+    SECTION("Without errors.")
+    {
+        fakeit::When(Method(mock_sys, mmap)).Return(buffer);
+        fakeit::When(Method(mock_sys, munmap)).Return(0);
+        {
+            SharedMemory memory("/mavtables", 64, mock_unique(mock_sys));
+            // The object of a previous run is removed before creation.
+            fakeit::Verify(
+                Method(mock_sys, shm_unlink), Method(mock_sys, shm_open),
+                Method(mock_sys, ftruncate), Method(mock_sys, mmap),
+                Method(mock_sys, close)).Once();
+            fakeit::Verify(Method(mock_sys, shm_open).Matching(
+                               [](auto name, auto oflag, auto mode)
+            {
+                return std::string(name) == "/mavtables" &&
+                       oflag == (O_CREAT | O_EXCL | O_RDWR) && mode == 0660;
+            })).Once();
+            fakeit::Verify(Method(mock_sys, ftruncate).Using(3, 64)).Once();
+            fakeit::Verify(Method(mock_sys, mmap).Matching(
+                               [](auto addr, auto len, auto prot, auto flags,
+                                  auto fd, auto offset)
+            {
+                return addr == nullptr && len == 64 &&
+                       prot == (PROT_READ | PROT_WRITE) &&
+                       flags == MAP_SHARED && fd == 3 && offset == 0;
+            })).Once();
+            fakeit::Verify(Method(mock_sys, close).Using(3)).Once();
+            REQUIRE(memory.data() == buffer);
+            REQUIRE(memory.name() == "/mavtables");
+            REQUIRE(memory.size() == 64);
+            fakeit::Verify(Method(mock_sys, munmap)).Exactly(0);
+        }
+        fakeit::Verify(Method(mock_sys, munmap).Using(buffer, 64)).Once();
+        fakeit::Verify(Method(mock_sys, shm_unlink)).Exactly(2);
+    }
+    SECTION("Emits errors from 'shm_open' system call.")
+    {
+        fakeit::When(Method(mock_sys, shm_open)).AlwaysDo(
+            [](auto name, auto oflag, auto mode)
+        {
+            (void)name;
+            (void)oflag;
+            (void)mode;
+            errno = EACCES;
+            return -1;
+        });
+        std::error_code ec(EACCES, std::system_category());
+        REQUIRE_THROWS_AS(
+            SharedMemory("/mavtables", 64, mock_unique(mock_sys)),
+            std::system_error);
+        REQUIRE_THROWS_WITH(
+            SharedMemory("/mavtables", 64, mock_unique(mock_sys)),
+            ec.message());
+    }
+    SECTION("Emits errors from 'ftruncate' system call.")
+    {
+        fakeit::When(Method(mock_sys, ftruncate)).AlwaysDo(
+            [](auto fd, auto length)
+        {
+            (void)fd;
+            (void)length;
+            errno = ENOSPC;
+            return -1;
+        });
+        std::error_code ec(ENOSPC, std::system_category());
+        REQUIRE_THROWS_WITH(
+            SharedMemory("/mavtables", 64, mock_unique(mock_sys)),
+            ec.message());
+        fakeit::Verify(Method(mock_sys, close).Using(3)).Once();
+        fakeit::Verify(Method(mock_sys, shm_unlink)).Exactly(2);
+        fakeit::Verify(Method(mock_sys, mmap)).Exactly(0);
+    }
+    SECTION("Emits errors from 'mmap' system call.")
+    {
+        fakeit::When(Method(mock_sys, mmap)).AlwaysDo(
+            [](auto addr, auto len, auto prot, auto flags, auto fd,
+               auto offset)
+        {
+            (void)addr;
+            (void)len;
+            (void)prot;
+            (void)flags;
+            (void)fd;
+            (void)offset;
+            errno = ENOMEM;
+            return MAP_FAILED;
+        });
+        std::error_code ec(ENOMEM, std::system_category());
+        REQUIRE_THROWS_WITH(
+            SharedMemory("/mavtables", 64, mock_unique(mock_sys)),
+            ec.message());
+        fakeit::Verify(Method(mock_sys, close).Using(3)).Once();
+        fakeit::Verify(Method(mock_sys, shm_unlink)).Exactly(2);
+        fakeit::Verify(Method(mock_sys, munmap)).Exactly(0);
+    }
+}
+
+
+TEST_CASE("SharedMemory's can be mapped by other processes.",
+          "[SharedMemory]")
+{
+    SharedMemory memory("/mavtables_test_shm", 4096);
+    std::memcpy(memory.data(), "mavtables", 10);
+    int fd = shm_open("/mavtables_test_shm", O_RDWR, 0);
+    REQUIRE(fd >= 0);
+    auto data = mmap(
+                    nullptr, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    REQUIRE(data != MAP_FAILED);
+    REQUIRE(std::string(static_cast<char *>(data)) == "mavtables");
+    munmap(data, 4096);
+}
@@ -0,0 +1,308 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include <catch.hpp>
+#include <fakeit.hpp>
+
+#include "Connection.hpp"
+#include "ConnectionPool.hpp"
+#include "mavtables_shm.h"
+#include "Packet.hpp"
+#include "PacketVersion2.hpp"
+#include "SharedMemory.hpp"
+#include "ShmInterface.hpp"
+#include "utility.hpp"
+
+#include "common.hpp"
+#include "common_Packet.hpp"
+
+
+using namespace std::chrono_literals;
+
+
+TEST_CASE("ShmInterface's can be constructed.", "[ShmInterface]")
+{
+    fakeit::Mock<ConnectionPool> mock_pool;
+    fakeit::Mock<Connection> mock_connection;
+    fakeit::Fake(Method(mock_pool, add));
+    auto memory = std::make_unique<SharedMemory>(
+                      "/mavtables_test_shm", mavtables_shm_size(1024));
+    auto pool = mock_shared(mock_pool);
+    auto connection = mock_unique(mock_connection);
+    SECTION("When all inputs are valid, registers connection with pool.")
+    {
+        Connection *conn = nullptr;
+        fakeit::When(Method(mock_pool, add)).AlwaysDo([&](auto a)
+        {
+            conn = a.lock().get();
+        });
+        auto shm = static_cast<mavtables_shm *>(memory->data());
+        REQUIRE_NOTHROW(
+            ShmInterface(std::move(memory), 1024, pool, std::move(connection)));
+        fakeit::Verify(Method(mock_pool, add)).Once();
+        REQUIRE(conn == &mock_connection.get());
+        REQUIRE(shm->magic == MAVTABLES_SHM_MAGIC);
+        REQUIRE(shm->version == MAVTABLES_SHM_VERSION);
+        REQUIRE(shm->ring_size == 1024);
+    }
+    SECTION("Ensures the shared memory pointer is not null.")
+    {
+        REQUIRE_THROWS_AS(
+            ShmInterface(nullptr, 1024, pool, std::move(connection)),
+            std::invalid_argument);
+        connection = mock_unique(mock_connection);
+        REQUIRE_THROWS_WITH(
+            ShmInterface(nullptr, 1024, pool, std::move(connection)),
+            "Given shared memory pointer is null.");
+    }
+    SECTION("Ensures the connection pool pointer is not null.")
+    {
+        REQUIRE_THROWS_WITH(
+            ShmInterface(
+                std::move(memory), 1024, nullptr, std::move(connection)),
+            "Given connection pool pointer is null.");
+    }
+    SECTION("Ensures the connection pointer is not null.")
+    {
+        REQUIRE_THROWS_WITH(
+            ShmInterface(std::move(memory), 1024, pool, nullptr),
+            "Given connection pointer is null.");
+    }
+    SECTION("Ensures the ring size is a power of 2 of at least 1024 bytes.")
+    {
+        REQUIRE_THROWS_AS(
+            ShmInterface(std::move(memory), 1000, pool, std::move(connection)),
+            std::invalid_argument);
+        memory = std::make_unique<SharedMemory>(
+                     "/mavtables_test_shm", mavtables_shm_size(1024));
+        connection = mock_unique(mock_connection);
+        REQUIRE_THROWS_WITH(
+            ShmInterface(std::move(memory), 512, pool, std::move(connection)),
+            "Ring size (512) must be a power of 2 of at least 1024 bytes.");
+    }
+    SECTION("Ensures the shared memory is large enough.")
+    {
+        REQUIRE_THROWS_WITH(
+            ShmInterface(std::move(memory), 2048, pool, std::move(connection)),
+            "Shared memory is too small for the ring size.");
+    }
+}
+
+
+TEST_CASE("ShmInterface's 'send_packet' method.", "[ShmInterface]")
+{
+    // MAVLink packets.
+    auto heartbeat =
+        std::make_shared<packet_v2::Packet>(to_vector(HeartbeatV2()));
+    auto encapsulated_data =
+        std::make_shared<packet_v2::Packet>(to_vector(EncapsulatedDataV2()));
+    // Pool
+    fakeit::Mock<ConnectionPool> mock_pool;
+    fakeit::Fake(Method(mock_pool, add));
+    // Connection
+    fakeit::Mock<Connection> mock_connection;
+    // Interface
+    auto memory = std::make_unique<SharedMemory>(
+                      "/mavtables_test_shm", mavtables_shm_size(1024));
+    auto shm = static_cast<mavtables_shm *>(memory->data());
+    auto ring = mavtables_shm_to_client(shm);
+    ShmInterface interface(
+        std::move(memory), 1024, mock_shared(mock_pool),
+        mock_unique(mock_connection));
+    SECTION("No packet to send.")
+    {
+        fakeit::When(Method(mock_connection, next_packet)).Return(nullptr);
+        interface.send_packet(250ms);
+        fakeit::Verify(Method(mock_connection, next_packet).Using(250ms))
+        .Once();
+        std::uint32_t length;
+        REQUIRE(mavtables_shm_peek(ring, &length) == nullptr);
+    }
+    SECTION("All queued packets are written to the ring.")
+    {
+        fakeit::When(Method(mock_connection, next_packet))
+        .Return(heartbeat).Return(encapsulated_data).AlwaysReturn(nullptr);
+        interface.send_packet(250ms);
+        fakeit::Verify(Method(mock_connection, next_packet).Using(250ms))
+        .Once();
+        fakeit::Verify(Method(mock_connection, next_packet).Using(0s))
+        .Exactly(2);
+        // Read in place.
+        std::uint32_t length;
+        auto data = mavtables_shm_peek(ring, &length);
+        REQUIRE(data != nullptr);
+        REQUIRE(std::vector<uint8_t>(data, data + length) ==
+                heartbeat->data());
+        mavtables_shm_consume(ring, length);
+        data = mavtables_shm_peek(ring, &length);
+        REQUIRE(data != nullptr);
+        REQUIRE(std::vector<uint8_t>(data, data + length) ==
+                encapsulated_data->data());
+        mavtables_shm_consume(ring, length);
+        REQUIRE(mavtables_shm_peek(ring, &length) == nullptr);
+        REQUIRE(ring->dropped == 0);
+    }
+    SECTION("Packets that do not fit in the ring are dropped.")
+    {
+        fakeit::When(Method(mock_connection, next_packet))
+        .Return(encapsulated_data, encapsulated_data, encapsulated_data,
+                encapsulated_data).AlwaysReturn(nullptr);
+        interface.send_packet(250ms);
+        REQUIRE(ring->dropped > 0);
+        std::uint32_t length;
+        auto data = mavtables_shm_peek(ring, &length);
+        REQUIRE(data != nullptr);
+        REQUIRE(std::vector<uint8_t>(data, data + length) ==
+                encapsulated_data->data());
+    }
+    SECTION("The ring size in shared memory is not trusted.")
+    {
+        ring->size = 0x80000000;
+        fakeit::When(Method(mock_connection, next_packet))
+        .Return(encapsulated_data, encapsulated_data, encapsulated_data,
+                encapsulated_data).AlwaysReturn(nullptr);
+        interface.send_packet(250ms);
+        REQUIRE(ring->dropped > 0);
+        REQUIRE(ring->head - ring->tail <= 1024);
+    }
+}
+
+
+TEST_CASE("ShmInterface's 'receive_packet' method.", "[ShmInterface]")
+{
+    // MAVLink packets.
+    auto heartbeat =
+        std::make_shared<packet_v2::Packet>(to_vector(HeartbeatV2()));
+    auto encapsulated_data =
+        std::make_shared<packet_v2::Packet>(to_vector(EncapsulatedDataV2()));
+    // Pool
+    fakeit::Mock<ConnectionPool> mock_pool;
+    fakeit::Fake(Method(mock_pool, add));
+    fakeit::When(Method(mock_pool, may_accept)).AlwaysReturn(true);
+    std::vector<packet_v2::Packet> send_packets;
+    fakeit::When(Method(mock_pool, send)).AlwaysDo([&](auto & a)
+    {
+        send_packets.push_back(
+            *dynamic_cast<const packet_v2::Packet *>(a.get()));
+    });
+    // Connection
+    fakeit::Mock<Connection> mock_connection;
+    fakeit::Fake(Method(mock_connection, add_address));
+    // Interface
+    auto memory = std::make_unique<SharedMemory>(
+                      "/mavtables_test_shm", mavtables_shm_size(1024));
+    auto shm = static_cast<mavtables_shm *>(memory->data());
+    auto ring = mavtables_shm_from_client(shm);
+    ShmInterface interface(
+        std::move(memory), 1024, mock_shared(mock_pool),
+        mock_unique(mock_connection));
+    SECTION("No packet received.")
+    {
+        interface.receive_packet(1ms);
+        fakeit::Verify(Method(mock_pool, send)).Exactly(0);
+    }
+    SECTION("Packets written by the client are parsed and sent.")
+    {
+        auto vec = heartbeat->data();
+        REQUIRE(mavtables_shm_write(
+                    ring, vec.data(), static_cast<uint32_t>(vec.size())) == 0);
+        vec = encapsulated_data->data();
+        REQUIRE(mavtables_shm_write(
+                    ring, vec.data(), static_cast<uint32_t>(vec.size())) == 0);
+        interface.receive_packet(250ms);
+        REQUIRE(send_packets.size() == 2);
+        REQUIRE(send_packets[0] == *heartbeat);
+        REQUIRE(send_packets[1] == *encapsulated_data);
+        fakeit::Verify(Method(mock_connection, add_address)).Exactly(2);
+        // The ring has been consumed.
+        std::uint32_t length;
+        REQUIRE(mavtables_shm_peek(ring, &length) == nullptr);
+    }
+    SECTION("Packets no connection may accept are skipped.")
+    {
+        fakeit::When(Method(mock_pool, may_accept)).AlwaysReturn(false);
+        // Only the address of the packet with a valid checksum is learned.
+        auto vec = to_vector_with_crc(HeartbeatV2());
+        REQUIRE(mavtables_shm_write(
+                    ring, vec.data(), static_cast<uint32_t>(vec.size())) == 0);
+        vec = heartbeat->data();
+        REQUIRE(mavtables_shm_write(
+                    ring, vec.data(), static_cast<uint32_t>(vec.size())) == 0);
+        interface.receive_packet(250ms);
+        REQUIRE(send_packets.empty());
+        fakeit::Verify(Method(mock_pool, may_accept).Using(
+                           0, MAVAddress("127.1"))).Exactly(2);
+        fakeit::Verify(Method(mock_connection, add_address)).Exactly(1);
+    }
+    SECTION("Records past the end of the ring empty the ring.")
+    {
+        // The client claims a huge ring and a record longer than it.
+        std::uint32_t length = 0x7FFFFFF0;
+        std::memcpy(mavtables_shm_data(ring), &length, 4);
+        ring->size = 0x80000000;
+        ring->head = 8;
+        interface.receive_packet(250ms);
+        REQUIRE(send_packets.empty());
+        REQUIRE(ring->tail == ring->head);
+        REQUIRE(ring->dropped == 1);
+        // Later records are still received.
+        ring->size = 1024;
+        auto vec = heartbeat->data();
+        REQUIRE(mavtables_shm_write(
+                    ring, vec.data(), static_cast<uint32_t>(vec.size())) == 0);
+        interface.receive_packet(250ms);
+        REQUIRE(send_packets.size() == 1);
+        REQUIRE(send_packets[0] == *heartbeat);
+    }
+    SECTION("Records longer than the data written empty the ring.")
+    {
+        std::uint32_t length = 100;
+        std::memcpy(mavtables_shm_data(ring), &length, 4);
+        ring->head = 8;
+        interface.receive_packet(250ms);
+        REQUIRE(send_packets.empty());
+        REQUIRE(ring->tail == ring->head);
+        REQUIRE(ring->dropped == 1);
+    }
+}
+
+
+TEST_CASE("ShmInterface's are printable.", "[ShmInterface]")
+{
+    fakeit::Mock<ConnectionPool> mock_pool;
+    fakeit::Fake(Method(mock_pool, add));
+    fakeit::Mock<Connection> mock_connection;
+    ShmInterface interface(
+        std::make_unique<SharedMemory>(
+            "/mavtables_test_shm", mavtables_shm_size(1024)),
+        1024, mock_shared(mock_pool), mock_unique(mock_connection));
+    REQUIRE(
+        str(interface) ==
+        "shm {\n"
+        "    name /mavtables_test_shm;\n"
+        "    ring_size 1024;\n"
+        "}");
+}
@@ -0,0 +1,386 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch.hpp>
+
+#include "Accept.hpp"
+#include "Call.hpp"
+#include "Chain.hpp"
+#include "Connection.hpp"
+#include "Filter.hpp"
+#include "If.hpp"
+#include "Interface.hpp"
+#include "MAVAddress.hpp"
+#include "Packet.hpp"
+#include "PacketVersion2.hpp"
+#include "Reject.hpp"
+#include "Stats.hpp"
+
+#include "common_Packet.hpp"
+
+
+using namespace std::chrono_literals;
+
+
+namespace
+{
+
+#ifdef __clang__
+    #pragma clang diagnostic push
+    #pragma clang diagnostic ignored "-Wweak-vtables"
+#endif
+
+    // Interface that counts a packet each time it receives.
+    class CountingInterface : public Interface
+    {
+        public:
+            void send_packet(const std::chrono::nanoseconds &timeout) final
+            {
+                (void)timeout;
+            }
+            void receive_packet(const std::chrono::nanoseconds &timeout) final
+            {
+                (void)timeout;
+                traffic_.count(Traffic::received, 10);
+            }
+
+        protected:
+            std::ostream &print_(std::ostream &os) const final
+            {
+                os << "test {" << std::endl;
+                os << "    name \"quoted\";" << std::endl;
+                os << "}";
+                return os;
+            }
+    };
+
+#ifdef __clang__
+    #pragma clang diagnostic pop
+#endif
+
+
+    // Write the statistics to a string.
+    std::string stats()
+    {
+        std::ostringstream os;
+        Stats::write(os);
+        return os.str();
+    }
+
+}
+
+
+TEST_CASE("TrafficCounters count packets and bytes by event.", "[Stats]")
+{
+    TrafficCounters traffic;
+    traffic.count(Traffic::received, 20);
+    traffic.count(Traffic::received, 30);
+    traffic.count(Traffic::dropped, 5);
+    REQUIRE(traffic.packets(Traffic::received) == 2);
+    REQUIRE(traffic.bytes(Traffic::received) == 50);
+    REQUIRE(traffic.packets(Traffic::dropped) == 1);
+    REQUIRE(traffic.bytes(Traffic::dropped) == 5);
+    REQUIRE(traffic.packets(Traffic::sent) == 0);
+    REQUIRE(traffic.bytes(Traffic::sent) == 0);
+}
+
+
+TEST_CASE("LatencyHistograms record durations by priority.", "[Stats]")
+{
+    LatencyHistograms histograms;
+    REQUIRE(histograms.priorities().empty());
+    histograms.record(3, 5ms, 1ms);
+    histograms.record(-1, 2ms, 2ms);
+    histograms.record(3, 7ms, 3ms);
+    REQUIRE(histograms.priorities() == std::vector<int> {-1, 3});
+    REQUIRE(histograms.latency(3).count() == 2);
+    REQUIRE(histograms.latency(3).sum() == 12ms);
+    REQUIRE(histograms.sojourn(3).sum() == 4ms);
+    REQUIRE(histograms.latency(-1).max() == 2ms);
+    REQUIRE(histograms.sojourn(-1).count() == 1);
+    REQUIRE_THROWS_AS(histograms.latency(0), std::out_of_range);
+    REQUIRE_THROWS_AS(histograms.sojourn(0), std::out_of_range);
+}
+
+
+TEST_CASE("Stats counts packets by message type.", "[Stats]")
+{
+    packet_v2::Packet ping(to_vector(PingV2()));
+    auto packets = Stats::packets(Traffic::rejected, 4);
+    auto bytes = Stats::bytes(Traffic::rejected, 4);
+    Stats::count(Traffic::rejected, ping);
+    Stats::count(Traffic::rejected, ping);
+    REQUIRE(Stats::packets(Traffic::rejected, 4) == packets + 2);
+    REQUIRE(Stats::bytes(Traffic::rejected, 4) ==
+            bytes + 2 * ping.data().size());
+    REQUIRE(Stats::packets(Traffic::rejected, 0xFFFFFF) == 0);
+    REQUIRE(Stats::bytes(Traffic::rejected, 0xFFFFFF) == 0);
+}
+
+
+TEST_CASE("Stats writes the statistics of each message type.", "[Stats]")
+{
+    packet_v2::Packet ping(to_vector(PingV2()));
+    Stats::count(Traffic::received, ping);
+    auto text = stats();
+    REQUIRE(text.find(
+                "# TYPE mavtables_message_packets_total counter\n") !=
+            std::string::npos);
+    REQUIRE(text.find(
+                "mavtables_message_packets_total{message=\"PING\","
+                "event=\"received\"} ") != std::string::npos);
+    REQUIRE(text.find(
+                "mavtables_message_bytes_total{message=\"PING\","
+                "event=\"dropped\"} ") != std::string::npos);
+}
+
+
+TEST_CASE("Stats writes the statistics of registered connections.",
+          "[Stats]")
+{
+    auto filter = std::make_shared<Filter>(Chain("default"), true);
+    {
+        Connection connection("STATS TEST", filter);
+        connection.traffic().count(Traffic::received, 14);
+        connection.add_address(MAVAddress("127.1"));
+        connection.send(std::make_shared<packet_v2::Packet>(
+                            to_vector(PingV2())));
+        auto text = stats();
+        REQUIRE(text.find(
+                    "# TYPE mavtables_connection_packets_total counter\n") !=
+                std::string::npos);
+        REQUIRE(text.find(
+                    "mavtables_connection_packets_total{"
+                    "connection=\"STATS TEST\",event=\"received\"} 1\n") !=
+                std::string::npos);
+        REQUIRE(text.find(
+                    "mavtables_connection_bytes_total{"
+                    "connection=\"STATS TEST\",event=\"received\"} 14\n") !=
+                std::string::npos);
+        REQUIRE(text.find(
+                    "mavtables_connection_packets_total{"
+                    "connection=\"STATS TEST\",event=\"accepted\"} 1\n") !=
+                std::string::npos);
+        REQUIRE(text.find(
+                    "mavtables_connection_packets_total{"
+                    "connection=\"STATS TEST\",event=\"sent\"} 0\n") !=
+                std::string::npos);
+        REQUIRE(text.find(
+                    "# TYPE mavtables_connection_queue_depth gauge\n") !=
+                std::string::npos);
+        REQUIRE(text.find(
+                    "mavtables_connection_queue_depth{"
+                    "connection=\"STATS TEST\"} 1\n") != std::string::npos);
+        REQUIRE(connection.next_packet() != nullptr);
+        text = stats();
+        REQUIRE(text.find(
+                    "mavtables_connection_queue_depth{"
+                    "connection=\"STATS TEST\"} 0\n") != std::string::npos);
+        REQUIRE(text.find(
+                    "mavtables_connection_queue_high_water{"
+                    "connection=\"STATS TEST\"} 1\n") != std::string::npos);
+        REQUIRE(text.find(
+                    "mavtables_connection_packets_total{"
+                    "connection=\"STATS TEST\",event=\"sent\"} 1\n") !=
+                std::string::npos);
+    }
+    // Destroyed connections are removed.
+    REQUIRE(stats().find("STATS TEST") == std::string::npos);
+}
+
+
+TEST_CASE("Stats writes the latency of registered connections.", "[Stats]")
+{
+    auto filter = std::make_shared<Filter>(Chain("default"), true);
+    Connection connection("STATS LATENCY", filter);
+    connection.add_address(MAVAddress("127.1"));
+    auto packet = std::make_shared<packet_v2::Packet>(to_vector(PingV2()));
+    packet->timestamp(std::chrono::steady_clock::now() - 2ms);
+    connection.send(packet);
+    REQUIRE(connection.next_packet() != nullptr);
+    auto text = stats();
+    REQUIRE(text.find(
+                "# TYPE mavtables_connection_latency_seconds summary\n") !=
+            std::string::npos);
+    REQUIRE(text.find(
+                "mavtables_connection_latency_seconds{"
+                "connection=\"STATS LATENCY\",priority=\"0\","
+                "quantile=\"0.99\"} ") != std::string::npos);
+    REQUIRE(text.find(
+                "mavtables_connection_latency_seconds_count{"
+                "connection=\"STATS LATENCY\",priority=\"0\"} 1\n") !=
+            std::string::npos);
+    REQUIRE(text.find(
+                "# TYPE mavtables_connection_queue_seconds summary\n") !=
+            std::string::npos);
+    REQUIRE(text.find(
+                "mavtables_connection_queue_seconds_count{"
+                "connection=\"STATS LATENCY\",priority=\"0\"} 1\n") !=
+            std::string::npos);
+}
+
+
+TEST_CASE("Stats writes the statistics of registered interfaces.",
+          "[Stats]")
+{
+    CountingInterface interface;
+    Stats::add(interface);
+    interface.receive_packet(std::chrono::nanoseconds::zero());
+    auto text = stats();
+    REQUIRE(text.find(
+                "# TYPE mavtables_interface_packets_total counter\n") !=
+            std::string::npos);
+    // Interfaces are labeled with their configuration on a single line.
+    REQUIRE(text.find(
+                "mavtables_interface_packets_total{"
+                "interface=\"test { name \\\"quoted\\\"; }\","
+                "event=\"received\"} 1\n") != std::string::npos);
+    REQUIRE(text.find(
+                "mavtables_interface_bytes_total{"
+                "interface=\"test { name \\\"quoted\\\"; }\","
+                "event=\"received\"} 10\n") != std::string::npos);
+    REQUIRE(text.find(
+                "mavtables_interface_packets_total{"
+                "interface=\"test { name \\\"quoted\\\"; }\","
+                "event=\"sent\"} 0\n") != std::string::npos);
+    Stats::remove(interface);
+    REQUIRE(stats().find("quoted") == std::string::npos);
+}
+
+
+TEST_CASE("Stats writes the counters of registered filters.", "[Stats]")
+{
+    auto ping = packet_v2::Packet(to_vector(PingV2()));
+    auto subchain = std::make_shared<Chain>("stats_sub");
+    subchain->append(std::make_unique<Accept>(3), 20);
+    Chain chain("stats_chain");
+    chain.append(std::make_unique<Reject>(If().to("10.10")), 10);
+    chain.append(std::make_unique<Call>(subchain, If().to("192.168")), 11);
+    {
+        Filter filter(chain);
+        filter.will_accept(ping, MAVAddress("10.10"));
+        filter.will_accept(ping, MAVAddress("192.168"));
+        auto text = stats();
+        REQUIRE(text.find(
+                    "# TYPE mavtables_chain_packets_total counter\n") !=
+                std::string::npos);
+        REQUIRE(text.find(
+                    "mavtables_chain_packets_total{chain=\"stats_chain\"} "
+                    "2\n") != std::string::npos);
+        // Chains called from the default chain are included.
+        REQUIRE(text.find(
+                    "mavtables_chain_packets_total{chain=\"stats_sub\"} "
+                    "1\n") != std::string::npos);
+        REQUIRE(text.find(
+                    "mavtables_chain_evaluation_seconds_count{"
+                    "chain=\"stats_chain\"} 0\n") != std::string::npos);
+        REQUIRE(text.find(
+                    "# TYPE mavtables_rule_packets_total counter\n") !=
+                std::string::npos);
+        REQUIRE(text.find(
+                    "mavtables_rule_packets_total{chain=\"stats_chain\","
+                    "line=\"10\",rule=\"reject if to 10.10\"} 1\n") !=
+                std::string::npos);
+        REQUIRE(text.find(
+                    "mavtables_rule_packets_total{chain=\"stats_chain\","
+                    "line=\"11\",rule=\"call stats_sub if to 192.168\"} "
+                    "1\n") != std::string::npos);
+        REQUIRE(text.find(
+                    "mavtables_rule_packets_total{chain=\"stats_sub\","
+                    "line=\"20\",rule=\"accept with priority 3\"} 1\n") !=
+                std::string::npos);
+    }
+    // Destroyed filters are removed.
+    REQUIRE(stats().find("stats_chain") == std::string::npos);
+}
+
+
+TEST_CASE("Stats writes the filter rules annotated with their counters.",
+          "[Stats]")
+{
+    SECTION("From the statistics of a running filter.")
+    {
+        auto ping = packet_v2::Packet(to_vector(PingV2()));
+        Chain chain("rules_chain");
+        chain.append(std::make_unique<Reject>(If().to("10.10")), 10);
+        chain.append(std::make_unique<Accept>(), 11);
+        Filter filter(chain);
+        filter.will_accept(ping, MAVAddress("10.10"));
+        filter.will_accept(ping, MAVAddress("192.168"));
+        filter.will_accept(ping, MAVAddress("192.168"));
+        std::istringstream metrics(stats());
+        std::ostringstream os;
+        Stats::write_rules(os, metrics);
+        REQUIRE(os.str().find(
+                    "chain rules_chain (3 packets)\n"
+                    "     pkts  line  rule\n"
+                    "        1    10  reject if to 10.10;\n"
+                    "        2    11  accept;\n") != std::string::npos);
+    }
+    SECTION("With the time per packet of profiled chains.")
+    {
+        std::istringstream metrics(
+            "# HELP mavtables_chain_packets_total Packets evaluated ...\n"
+            "# TYPE mavtables_chain_packets_total counter\n"
+            "mavtables_chain_packets_total{chain=\"default\"} 1024\n"
+            "mavtables_chain_packets_total{chain=\"ap-in\"} 498\n"
+            "mavtables_chain_evaluation_seconds_sum{chain=\"default\"} "
+            "4.12e-05\n"
+            "mavtables_chain_evaluation_seconds_count{chain=\"default\"} "
+            "100\n"
+            "mavtables_chain_evaluation_seconds_sum{chain=\"ap-in\"} 0\n"
+            "mavtables_chain_evaluation_seconds_count{chain=\"ap-in\"} 0\n"
+            "mavtables_rule_packets_total{chain=\"default\",line=\"12\","
+            "rule=\"reject if HEARTBEAT from 10.10\"} 512\n"
+            "mavtables_rule_packets_total{chain=\"default\",line=\"13\","
+            "rule=\"call ap-in if from 192.168\"} 498\n"
+            "mavtables_rule_packets_total{chain=\"ap-in\",line=\"18\","
+            "rule=\"accept with priority 3\"} 498\n"
+            "mavtables_message_packets_total{message=\"PING\","
+            "event=\"received\"} 7\n");
+        std::ostringstream os;
+        Stats::write_rules(os, metrics);
+        REQUIRE(os.str() ==
+                "chain default (1024 packets, 0.412 us per packet)\n"
+                "     pkts  line  rule\n"
+                "      512    12  reject if HEARTBEAT from 10.10;\n"
+                "      498    13  call ap-in if from 192.168;\n"
+                "\n"
+                "chain ap-in (498 packets)\n"
+                "     pkts  line  rule\n"
+                "      498    18  accept with priority 3;\n");
+    }
+    SECTION("Ignores invalid lines.")
+    {
+        std::istringstream metrics(
+            "mavtables_chain_packets_total{chain=\"default\n"
+            "mavtables_chain_packets_total{chain} 3\n"
+            "mavtables_chain_packets_total{chain=\"default\"}\n"
+            "garbage\n");
+        std::ostringstream os;
+        Stats::write_rules(os, metrics);
+        REQUIRE(os.str().empty());
+    }
+}
@@ -0,0 +1,298 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <catch.hpp>
+#include <errno.h>
+#include <fakeit.hpp>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "StatsServer.hpp"
+#include "UnixSyscalls.hpp"
+
+#include "common.hpp"
+
+
+using namespace std::chrono_literals;
+
+
+TEST_CASE("StatsServer's create, bind and listen on a unix domain socket on "
+          "construction and close and remove it on destruction.",
+          "[StatsServer]")
+{
+    SECTION("Without errors.")
+    {
+        fakeit::Mock<UnixSyscalls> mock_sys;
+        fakeit::When(Method(mock_sys, socket)).Return(3);
+        fakeit::When(Method(mock_sys, unlink)).AlwaysReturn(0);
+        mock_lstat(mock_sys, S_IFSOCK);
+        struct sockaddr_un address;
+        fakeit::When(Method(mock_sys, bind)).Do(
+            [&](auto fd, auto addr, auto addrlen)
+        {
+            (void)fd;
+            std::memcpy(&address, addr, addrlen);
+            return 0;
+        });
+        fakeit::When(Method(mock_sys, listen)).Return(0);
+        fakeit::When(Method(mock_sys, close)).Return(0);
+        {
+            StatsServer server("/run/stats.sock", mock_unique(mock_sys));
+            fakeit::Verify(Method(mock_sys, socket).Matching(
+                               [&](auto family, auto type, auto protocol)
+            {
+                return family == AF_UNIX && type == SOCK_STREAM &&
+                       protocol == 0;
+            })).Once();
+            fakeit::Verify(
+                Method(mock_sys, unlink), Method(mock_sys, bind),
+                Method(mock_sys, listen)).Once();
+            REQUIRE(address.sun_family == AF_UNIX);
+            REQUIRE(std::string(address.sun_path) == "/run/stats.sock");
+            fakeit::Verify(Method(mock_sys, close)).Exactly(0);
+        }
+        fakeit::Verify(Method(mock_sys, close).Using(3)).Once();
+        fakeit::Verify(Method(mock_sys, unlink)).Exactly(2);
+    }
+    SECTION("Only removes sockets.")
+    {
+        fakeit::Mock<UnixSyscalls> mock_sys;
+        mock_lstat(mock_sys, S_IFREG);
+        REQUIRE_THROWS_AS(
+            StatsServer("/etc/passwd", mock_unique(mock_sys)),
+            std::invalid_argument);
+        REQUIRE_THROWS_WITH(
+            StatsServer("/etc/passwd", mock_unique(mock_sys)),
+            "Socket path (/etc/passwd) exists and is not a socket.");
+        fakeit::Verify(Method(mock_sys, socket)).Exactly(0);
+        fakeit::Verify(Method(mock_sys, unlink)).Exactly(0);
+    }
+    SECTION("Ensures the path is valid.")
+    {
+        fakeit::Mock<UnixSyscalls> mock_sys;
+        REQUIRE_THROWS_AS(
+            StatsServer("", mock_unique(mock_sys)), std::invalid_argument);
+        REQUIRE_THROWS_WITH(
+            StatsServer("", mock_unique(mock_sys)), "Socket path is empty.");
+        REQUIRE_THROWS_AS(
+            StatsServer(std::string(200, 'a'), mock_unique(mock_sys)),
+            std::invalid_argument);
+    }
+    SECTION("Emmits errors from 'socket' system call.")
+    {
+        fakeit::Mock<UnixSyscalls> mock_sys;
+        mock_lstat(mock_sys, S_IFSOCK);
+        fakeit::When(Method(mock_sys, unlink)).AlwaysReturn(0);
+        fakeit::When(Method(mock_sys, socket)).AlwaysReturn(-1);
+        errno = EMFILE;
+        REQUIRE_THROWS_AS(
+            StatsServer("/run/stats.sock", mock_unique(mock_sys)),
+            std::system_error);
+    }
+    SECTION("Emmits errors from 'listen' system call.")
+    {
+        fakeit::Mock<UnixSyscalls> mock_sys;
+        fakeit::When(Method(mock_sys, socket)).AlwaysReturn(4);
+        fakeit::When(Method(mock_sys, unlink)).AlwaysReturn(0);
+        mock_lstat(mock_sys, S_IFSOCK);
+        fakeit::When(Method(mock_sys, bind)).AlwaysReturn(0);
+        fakeit::When(Method(mock_sys, listen)).AlwaysReturn(-1);
+        fakeit::When(Method(mock_sys, close)).AlwaysReturn(0);
+        errno = EADDRINUSE;
+        REQUIRE_THROWS_AS(
+            StatsServer("/run/stats.sock", mock_unique(mock_sys)),
+            std::system_error);
+        fakeit::Verify(Method(mock_sys, close).Using(4)).Once();
+    }
+}
+
+
+TEST_CASE("StatsServer's 'serve' method sends the statistics to a client.",
+          "[StatsServer]")
+{
+    fakeit::Mock<UnixSyscalls> mock_sys;
+    fakeit::When(Method(mock_sys, socket)).AlwaysReturn(3);
+    fakeit::When(Method(mock_sys, unlink)).AlwaysReturn(0);
+    mock_lstat(mock_sys, S_IFSOCK);
+    fakeit::When(Method(mock_sys, bind)).AlwaysReturn(0);
+    fakeit::When(Method(mock_sys, listen)).AlwaysReturn(0);
+    fakeit::When(Method(mock_sys, close)).AlwaysReturn(0);
+    fakeit::When(Method(mock_sys, setsockopt)).AlwaysReturn(0);
+    StatsServer server("/run/stats.sock", mock_unique(mock_sys));
+    SECTION("Returns false when no client connects.")
+    {
+        fakeit::When(Method(mock_sys, poll)).AlwaysReturn(0);
+        REQUIRE_FALSE(server.serve(250ms));
+        fakeit::Verify(Method(mock_sys, poll).Matching(
+                           [](auto fds, auto nfds, auto timeout)
+        {
+            return fds->fd == 3 && fds->events == POLLIN && nfds == 1 &&
+                   timeout == 250;
+        })).Once();
+        fakeit::Verify(Method(mock_sys, accept)).Exactly(0);
+    }
+    SECTION("Writes the statistics to the client and closes it.")
+    {
+        fakeit::When(Method(mock_sys, poll)).AlwaysDo(
+            [](auto fds, auto nfds, auto timeout)
+        {
+            (void)nfds;
+            (void)timeout;
+            fds->revents = POLLIN;
+            return 1;
+        });
+        fakeit::When(Method(mock_sys, accept)).AlwaysReturn(5);
+        std::string text;
+        fakeit::When(Method(mock_sys, sendto)).AlwaysDo(
+            [&](auto fd, auto buf, auto len, auto flags,
+                auto addr, auto addrlen)
+        {
+            (void)fd;
+            (void)flags;
+            (void)addr;
+            (void)addrlen;
+            // Send in small parts.
+            auto size = std::min<std::size_t>(len, 100);
+            text.append(static_cast<const char *>(buf), size);
+            return static_cast<ssize_t>(size);
+        });
+        REQUIRE(server.serve(250ms));
+        REQUIRE(text.substr(0, 43) ==
+                "# HELP mavtables_connection_packets_total P");
+        REQUIRE(text.find(
+                    "# TYPE mavtables_message_bytes_total counter\n") !=
+                std::string::npos);
+        fakeit::Verify(Method(mock_sys, sendto).Matching(
+                           [](auto fd, auto buf, auto len, auto flags,
+                              auto addr, auto addrlen)
+        {
+            (void)buf;
+            (void)len;
+            return fd == 5 && flags == MSG_NOSIGNAL && addr == nullptr &&
+                   addrlen == 0;
+        })).AtLeastOnce();
+        fakeit::Verify(Method(mock_sys, close).Using(5)).Once();
+    }
+    SECTION("Bounds the time to send to the client.")
+    {
+        fakeit::When(Method(mock_sys, poll)).AlwaysDo(
+            [](auto fds, auto nfds, auto timeout)
+        {
+            (void)nfds;
+            (void)timeout;
+            fds->revents = POLLIN;
+            return 1;
+        });
+        fakeit::When(Method(mock_sys, accept)).AlwaysReturn(5);
+        fakeit::When(Method(mock_sys, sendto)).AlwaysReturn(-1);
+        errno = EAGAIN;
+        REQUIRE(server.serve(250ms));
+        fakeit::Verify(Method(mock_sys, setsockopt).Matching(
+                           [](auto fd, auto level, auto optname,
+                              auto optval, auto optlen)
+        {
+            auto tv = static_cast<const struct timeval *>(optval);
+            return fd == 5 && level == SOL_SOCKET &&
+                   optname == SO_SNDTIMEO && optlen == sizeof(*tv) &&
+                   tv->tv_sec == 1 && tv->tv_usec == 0;
+        })).Once();
+        fakeit::Verify(Method(mock_sys, sendto)).Once();
+        fakeit::Verify(Method(mock_sys, close).Using(5)).Once();
+    }
+    SECTION("Ignores clients that disconnect.")
+    {
+        fakeit::When(Method(mock_sys, poll)).AlwaysDo(
+            [](auto fds, auto nfds, auto timeout)
+        {
+            (void)nfds;
+            (void)timeout;
+            fds->revents = POLLIN;
+            return 1;
+        });
+        fakeit::When(Method(mock_sys, accept)).AlwaysReturn(5);
+        fakeit::When(Method(mock_sys, sendto)).AlwaysReturn(-1);
+        errno = EPIPE;
+        REQUIRE(server.serve(250ms));
+        fakeit::Verify(Method(mock_sys, sendto)).Once();
+        fakeit::Verify(Method(mock_sys, close).Using(5)).Once();
+    }
+    SECTION("Emmits errors from 'poll' system call.")
+    {
+        fakeit::When(Method(mock_sys, poll)).AlwaysReturn(-1);
+        errno = EBADF;
+        REQUIRE_THROWS_AS(server.serve(250ms), std::system_error);
+        // Except for interrupts.
+        errno = EINTR;
+        REQUIRE_FALSE(server.serve(250ms));
+    }
+}
+
+
+TEST_CASE("StatsServer's 'fetch' method reads the statistics from a server.",
+          "[StatsServer]")
+{
+    fakeit::Mock<UnixSyscalls> mock_sys;
+    fakeit::When(Method(mock_sys, socket)).AlwaysReturn(6);
+    fakeit::When(Method(mock_sys, close)).AlwaysReturn(0);
+    SECTION("Reads until the server closes the connection.")
+    {
+        struct sockaddr_un address;
+        fakeit::When(Method(mock_sys, connect)).Do(
+            [&](auto fd, auto addr, auto addrlen)
+        {
+            (void)fd;
+            std::memcpy(&address, addr, addrlen);
+            return 0;
+        });
+        fakeit::When(Method(mock_sys, read)).AlwaysDo(
+            [count = 0](auto fd, auto buf, auto len) mutable
+        {
+            (void)fd;
+            (void)len;
+
+            if (count++ < 2)
+            {
+                std::memcpy(buf, "stats\n", 6);
+                return static_cast<ssize_t>(6);
+            }
+
+            return static_cast<ssize_t>(0);
+        });
+        REQUIRE(StatsServer::fetch("/run/stats.sock", mock_unique(mock_sys)) ==
+                "stats\nstats\n");
+        REQUIRE(std::string(address.sun_path) == "/run/stats.sock");
+        fakeit::Verify(Method(mock_sys, close).Using(6)).Once();
+    }
+    SECTION("Emmits errors from 'connect' system call.")
+    {
+        fakeit::When(Method(mock_sys, connect)).AlwaysReturn(-1);
+        errno = ECONNREFUSED;
+        REQUIRE_THROWS_AS(
+            StatsServer::fetch("/run/stats.sock", mock_unique(mock_sys)),
+            std::system_error);
+        fakeit::Verify(Method(mock_sys, close).Using(6)).Once();
+    }
+}
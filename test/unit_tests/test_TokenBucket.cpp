@@ -0,0 +1,101 @@
+// MAVLink router and firewall.
+// Copyright (C) 2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <chrono>
+#include <stdexcept>
+
+#include <catch.hpp>
+#include <fake_clock.hh>
+
+#include <TokenBucket.hpp>
+
+
+using namespace std::chrono_literals;
+using namespace testing;
+
+
+TEST_CASE("TokenBucket's can be constructed.", "[TokenBucket]")
+{
+    REQUIRE_NOTHROW(TokenBucket<>(8192));
+    REQUIRE_NOTHROW(TokenBucket<>(8192, 1024));
+}
+
+
+TEST_CASE("TokenBucket's ensure the rate is non-zero.", "[TokenBucket]")
+{
+    REQUIRE_THROWS_AS(TokenBucket<>(0), std::invalid_argument);
+    REQUIRE_THROWS_WITH(
+        TokenBucket<>(0), "Token bucket rate must be non-zero.");
+}
+
+
+TEST_CASE("TokenBucket's start out full.", "[TokenBucket]")
+{
+    TokenBucket<fake_clock> bucket(1000);
+    REQUIRE(bucket.full());
+    REQUIRE(bucket.delay() == 0s);
+}
+
+
+TEST_CASE("TokenBucket's delay after being emptied (without burst).",
+          "[TokenBucket]")
+{
+    TokenBucket<fake_clock> bucket(1000);
+    bucket.consume(500);  // 0.5 seconds
+    REQUIRE_FALSE(bucket.full());
+    REQUIRE(bucket.delay() == 500ms);
+    fake_clock::advance(200ms);
+    REQUIRE(bucket.delay() == 300ms);
+    // Going further into debt.
+    bucket.consume(100);
+    REQUIRE(bucket.delay() == 400ms);
+    fake_clock::advance(400ms);
+    REQUIRE(bucket.delay() == 0s);
+    REQUIRE(bucket.full());
+    // The bucket does not fill past full.
+    fake_clock::advance(10s);
+    bucket.consume(1000);
+    REQUIRE(bucket.delay() == 1s);
+}
+
+
+TEST_CASE("TokenBucket's allow bursts.", "[TokenBucket]")
+{
+    TokenBucket<fake_clock> bucket(1000, 2000);
+    bucket.consume(1000);
+    REQUIRE_FALSE(bucket.full());
+    REQUIRE(bucket.delay() == 0s);
+    bucket.consume(1000);
+    REQUIRE(bucket.delay() == 0s);
+    bucket.consume(500);
+    REQUIRE(bucket.delay() == 500ms);
+    fake_clock::advance(500ms);
+    REQUIRE(bucket.delay() == 0s);
+    REQUIRE_FALSE(bucket.full());
+    fake_clock::advance(2s);
+    REQUIRE(bucket.full());
+}
+
+
+TEST_CASE("TokenBucket's work with the steady clock.", "[TokenBucket]")
+{
+    TokenBucket<> bucket(1000);
+    bucket.consume(100000);
+    REQUIRE_FALSE(bucket.full());
+    REQUIRE(bucket.delay() > 90s);
+    REQUIRE(bucket.delay() <= 100s);
+}
@@ -0,0 +1,102 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <stdexcept>
+
+#include <catch.hpp>
+
+#include "If.hpp"
+#include "PacketVersion1.hpp"
+#include "PacketVersion2.hpp"
+#include "Tracer.hpp"
+
+#include "common_Packet.hpp"
+
+
+TEST_CASE("Tracer's trace periods must be between 1 and 65536.", "[Tracer]")
+{
+    Tracer tracer;
+    REQUIRE_NOTHROW(tracer.add(1));
+    REQUIRE_NOTHROW(tracer.add(65536));
+    REQUIRE_THROWS_AS(tracer.add(0), std::invalid_argument);
+    REQUIRE_THROWS_WITH(
+        tracer.add(0), "Trace period (0) must be between 1 and 65536.");
+    REQUIRE_THROWS_AS(tracer.add(65537), std::invalid_argument);
+}
+
+
+TEST_CASE("Tracer's select packets to trace.", "[Tracer]")
+{
+    auto ping = packet_v2::Packet(to_vector(PingV2()));
+    auto heartbeat = packet_v1::Packet(to_vector(HeartbeatV1()));
+    Tracer tracer;
+    SECTION("No packets are traced without samples.")
+    {
+        REQUIRE_FALSE(tracer.check(ping));
+        REQUIRE_FALSE(tracer.check(heartbeat));
+    }
+    SECTION("A period of 1 traces every packet.")
+    {
+        tracer.add(1);
+        REQUIRE(tracer.check(ping));
+        REQUIRE(tracer.check(heartbeat));
+    }
+    SECTION("Only packets matching the condition are traced.")
+    {
+        tracer.add(1, If().type("PING"));
+        REQUIRE(tracer.check(ping));
+        REQUIRE_FALSE(tracer.check(heartbeat));
+    }
+    SECTION("Packets without a destination are sent to 0.0.")
+    {
+        tracer.add(1, If().to("0.0"));
+        REQUIRE_FALSE(tracer.check(ping));
+        REQUIRE(tracer.check(heartbeat));
+    }
+    SECTION("One in a period of packets is traced, by checksum.")
+    {
+        tracer.add(ping.checksum() + 1u);
+        REQUIRE_FALSE(tracer.check(ping));
+        tracer.add(ping.checksum());
+        REQUIRE(tracer.check(ping));
+    }
+    SECTION("Any sample can select the packet.")
+    {
+        tracer.add(1, If().type("HEARTBEAT"));
+        tracer.add(1, If().from("192.168"));
+        REQUIRE(tracer.check(ping));
+        REQUIRE(tracer.check(heartbeat));
+    }
+}
+
+
+TEST_CASE("Tracer's can be installed for use by all connections.",
+          "[Tracer]")
+{
+    auto ping = packet_v2::Packet(to_vector(PingV2()));
+    Tracer tracer;
+    tracer.add(1);
+    REQUIRE(Tracer::installed() == nullptr);
+    REQUIRE_FALSE(Tracer::traced(ping));
+    Tracer::install(&tracer);
+    REQUIRE(Tracer::installed() == &tracer);
+    REQUIRE(Tracer::traced(ping));
+    Tracer::install(nullptr);
+    REQUIRE(Tracer::installed() == nullptr);
+    REQUIRE_FALSE(Tracer::traced(ping));
+}
@@ -21,18 +21,26 @@
 #include <memory>
 #include <set>
 #include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 #include <catch.hpp>
 #include <fakeit.hpp>
 
+#include "AddressPool.hpp"
+#include "Connection.hpp"
 #include "ConnectionFactory.hpp"
 #include "ConnectionPool.hpp"
 #include "Filter.hpp"
 #include "IPAddress.hpp"
+#include "IPSubnet.hpp"
+#include "MAVAddress.hpp"
 #include "Packet.hpp"
 #include "PacketVersion2.hpp"
+#include "Stats.hpp"
 #include "UDPInterface.hpp"
 #include "UDPSocket.hpp"
 #include "utility.hpp"
@@ -88,6 +96,67 @@ TEST_CASE("UDPInterface's can be constructed.", "[UPDInterface]")
             UDPInterface(std::move(socket), pool, nullptr),
             "Given connection factory pointer is null.");
     }
+    SECTION("Ensures the peer weights are non-zero.")
+    {
+        REQUIRE_THROWS_AS(
+            UDPInterface(
+                std::move(socket), pool, std::move(factory),
+                {{IPSubnet("10.0.0.0/8"), 0}}),
+            std::invalid_argument);
+        socket = mock_unique(mock_socket);
+        factory = mock_unique(mock_factory);
+        REQUIRE_THROWS_WITH(
+            UDPInterface(
+                std::move(socket), pool, std::move(factory),
+                {{IPSubnet("10.0.0.0/8"), 0}}),
+            "Peer weight must be non-zero.");
+    }
+    SECTION("Ensures the multicast group is a multicast address.")
+    {
+        REQUIRE_THROWS_AS(
+            UDPInterface(
+                std::move(socket), pool, std::move(factory), {}, 120s,
+                IPAddress("10.0.0.1:14550")),
+            std::invalid_argument);
+        socket = mock_unique(mock_socket);
+        factory = mock_unique(mock_factory);
+        REQUIRE_THROWS_WITH(
+            UDPInterface(
+                std::move(socket), pool, std::move(factory), {}, 120s,
+                IPAddress("10.0.0.1:14550")),
+            "Multicast group (10.0.0.1:14550) is not a multicast address.");
+    }
+    SECTION("Ensures the multicast group has a port.")
+    {
+        REQUIRE_THROWS_WITH(
+            UDPInterface(
+                std::move(socket), pool, std::move(factory), {}, 120s,
+                IPAddress("239.1.2.3")),
+            "Multicast group (239.1.2.3) must have a port.");
+    }
+    SECTION("Ensures addresses are only preloaded with a multicast group.")
+    {
+        REQUIRE_THROWS_WITH(
+            UDPInterface(
+                std::move(socket), pool, std::move(factory), {}, 120s,
+                {}, {MAVAddress("1.1")}),
+            "Preloaded addresses require a multicast group.");
+    }
+    SECTION("Ensures the MTU can hold a MAVLink packet.")
+    {
+        REQUIRE_THROWS_AS(
+            UDPInterface(
+                std::move(socket), pool, std::move(factory), {}, 120s,
+                {}, {}, 100),
+            std::invalid_argument);
+        socket = mock_unique(mock_socket);
+        factory = mock_unique(mock_factory);
+        REQUIRE_THROWS_WITH(
+            UDPInterface(
+                std::move(socket), pool, std::move(factory), {}, 120s,
+                {}, {}, 100),
+            "MTU (100) must be at least 280 bytes.");
+    }
 }
 
 
@@ -107,6 +176,7 @@ TEST_CASE("UDPInterace's 'receive_packet' method.", "[UPDInterface]")
     auto pool = mock_shared(spy_pool);
     // Filter
     fakeit::Mock<Filter> mock_filter;
+    fakeit::When(Method(mock_filter, may_accept)).AlwaysReturn(true);
     std::multiset<packet_v2::Packet,
         bool(*)(const packet_v2::Packet &, const packet_v2::Packet &)>
         will_accept_packets([](const auto & a, const auto & b)
@@ -120,7 +190,7 @@ TEST_CASE("UDPInterace's 'receive_packet' method.", "[UPDInterface]")
         will_accept_packets.insert(
             dynamic_cast<const packet_v2::Packet &>(a));
         will_accept_addresses.insert(b);
-        return std::pair<bool, int>(true, 0);
+        return std::tuple<bool, int, unsigned int>(true, 0, 0);
     });
     auto filter = mock_shared(mock_filter);
     // Socket
@@ -409,7 +479,8 @@ TEST_CASE("UDPInterace's 'receive_packet' method.", "[UPDInterface]")
         REQUIRE(it != will_accept_packets.end());
         REQUIRE(it->connection() != nullptr);
     }
-    SECTION("Partial packets with different IP addresses should be dropped.")
+    SECTION("Partial packets with different IP addresses should not be "
+            "combined.")
     {
         // Mocks
         fakeit::When(OverloadedMethod(mock_socket, receive, receive_type)
@@ -448,6 +519,85 @@ TEST_CASE("UDPInterace's 'receive_packet' method.", "[UPDInterface]")
         fakeit::Verify(Method(mock_filter, will_accept)).Exactly(0);
         fakeit::Verify(Method(spy_pool, add)).Once();
     }
+    SECTION("Partial packets interleaved with packets from other IP addresses "
+            "should be combined and parsed.")
+    {
+        // Mocks
+        fakeit::When(OverloadedMethod(mock_socket, receive, receive_type)
+                    ).Do([](auto a, auto b)
+        {
+            (void)b;
+            auto vec = to_vector(EncapsulatedDataV2());
+            std::copy(vec.begin(), vec.end() - 10, a);
+            return IPAddress("127.0.0.1:4001");
+        }).Do([](auto a, auto b)
+        {
+            (void)b;
+            auto vec = to_vector(HeartbeatV2());
+            std::copy(vec.begin(), vec.end(), a);
+            return IPAddress("127.0.0.1:4000");
+        }).Do([](auto a, auto b)
+        {
+            (void)b;
+            auto vec = to_vector(EncapsulatedDataV2());
+            std::copy(vec.end() - 10, vec.end(), a);
+            return IPAddress("127.0.0.1:4001");
+        });
+        // Test
+        udp.receive_packet(timeout);
+        udp.receive_packet(timeout);
+        udp.receive_packet(timeout);
+        // Verification
+        fakeit::Verify(
+            OverloadedMethod(mock_socket, receive, receive_type).Matching(
+                [&](auto a, auto b)
+        {
+            (void)a;
+            return b == 250ms;
+        })).Exactly(3);
+        fakeit::Verify(Method(mock_filter, will_accept)).Once();
+        REQUIRE(will_accept_packets.count(*encapsulated_data) == 1);
+        REQUIRE(will_accept_addresses.count(MAVAddress("127.1")) == 1);
+        fakeit::Verify(Method(spy_pool, add)).Exactly(2);
+        auto it = will_accept_packets.find(*encapsulated_data);
+        REQUIRE(it != will_accept_packets.end());
+        REQUIRE(it->connection() != nullptr);
+    }
+    SECTION("Packets no connection may accept are skipped.")
+    {
+        // Mocks
+        fakeit::When(Method(mock_filter, may_accept)).AlwaysReturn(false);
+        fakeit::When(OverloadedMethod(mock_socket, receive, receive_type)
+                    ).Do([](auto a, auto b)
+        {
+            (void)b;
+            auto vec = to_vector_with_crc(HeartbeatV2());
+            std::copy(vec.begin(), vec.end(), a);
+            return IPAddress("127.0.0.1:4000");
+        }).Do([](auto a, auto b)
+        {
+            (void)b;
+            auto vec = to_vector_with_crc(EncapsulatedDataV2());
+            std::copy(vec.begin(), vec.end(), a);
+            return IPAddress("127.0.0.1:4001");
+        }).Do([](auto a, auto b)
+        {
+            (void)b;
+            auto vec = to_vector(HeartbeatV2());
+            std::copy(vec.begin(), vec.end(), a);
+            return IPAddress("127.0.0.1:4002");
+        });
+        // Test
+        udp.receive_packet(timeout);
+        udp.receive_packet(timeout);
+        udp.receive_packet(timeout);
+        // Verification
+        fakeit::Verify(Method(mock_filter, may_accept).Using(
+                           131, MAVAddress("224.255"))).Once();
+        fakeit::Verify(Method(mock_filter, will_accept)).Exactly(0);
+        // Connections are still made for the peers of valid packets.
+        fakeit::Verify(Method(spy_pool, add)).Exactly(2);
+    }
 }
 
 
@@ -461,12 +611,13 @@ TEST_CASE("UDPInterace's 'send_packet' method.", "[UPDInterface]")
         std::make_shared<packet_v2::Packet>(to_vector(EncapsulatedDataV2()));
     // Filter
     fakeit::Mock<Filter> mock_filter;
+    fakeit::When(Method(mock_filter, may_accept)).AlwaysReturn(true);
     fakeit::When(Method(mock_filter, will_accept)).AlwaysDo(
         [&](auto & a, auto & b)
     {
         (void)a;
         (void)b;
-        return std::pair<bool, int>(true, 0);
+        return std::tuple<bool, int, unsigned int>(true, 0, 0);
     });
     auto filter = mock_shared(mock_filter);
     // Socket
@@ -638,6 +789,74 @@ TEST_CASE("UDPInterace's 'send_packet' method.", "[UPDInterface]")
         REQUIRE(send_addresses.count(IPAddress("127.0.0.1:4000")) == 2);
         REQUIRE(send_addresses.count(IPAddress("127.0.0.1:4001")) == 1);
     }
+    SECTION("Rate limited connections are skipped (packets deferred).")
+    {
+        // Mocks
+        fakeit::When(OverloadedMethod(mock_socket, receive, receive_type)
+                    ).Do([](auto a, auto b)
+        {
+            // Load 127.1 mavlink address into connection.
+            (void)b;
+            auto vec = to_vector(HeartbeatV2());
+            std::copy(vec.begin(), vec.end(), a);
+            return IPAddress("127.0.0.1:4000");
+        }).Do([](auto a, auto b)
+        {
+            (void)b;
+            auto vec = to_vector(EncapsulatedDataV2());
+            std::copy(vec.begin(), vec.end(), a);
+            return IPAddress("127.0.0.1:4001");
+        }).Do([](auto a, auto b)
+        {
+            (void)b;
+            auto vec = to_vector(MissionSetCurrentV2());
+            std::copy(vec.begin(), vec.end(), a);
+            return IPAddress("127.0.0.1:4002");
+        });
+        bool limited = true;
+        fakeit::When(Method(mock_socket, send_delay)).AlwaysDo(
+            [&](auto address)
+        {
+            if (limited && address == IPAddress("127.0.0.1:4000"))
+            {
+                return std::chrono::nanoseconds(1ms);
+            }
+
+            return std::chrono::nanoseconds::zero();
+        });
+        // Test
+        udp.receive_packet(timeout);
+        udp.receive_packet(timeout);
+        udp.receive_packet(timeout);
+        udp.send_packet(timeout);
+        // Verification (only the unlimited connection is sent to).
+        fakeit::Verify(Method(spy_factory, wait_for_packet)).Once();
+        fakeit::Verify(OverloadedMethod(mock_socket, send, send_type)).Once();
+        REQUIRE(send_bytes.count(to_vector(MissionSetCurrentV2())) == 1);
+        REQUIRE(send_addresses.count(IPAddress("127.0.0.1:4001")) == 1);
+        // Test (still limited, nothing to send).
+        udp.send_packet(timeout);
+        // Verification
+        fakeit::Verify(
+            Method(spy_factory, wait_for_packet).Using(1ms)).Exactly(2);
+        fakeit::Verify(OverloadedMethod(mock_socket, send, send_type)).Once();
+        // Test (no longer limited, deferred packets are sent).
+        limited = false;
+        udp.send_packet(timeout);
+        udp.send_packet(timeout);
+        // Verification
+        fakeit::Verify(
+            Method(spy_factory, wait_for_packet).Using(1ms)).Exactly(3);
+        fakeit::Verify(
+            Method(spy_factory, wait_for_packet).Using(0s)).Once();
+        fakeit::Verify(
+            OverloadedMethod(mock_socket, send, send_type)).Exactly(3);
+        REQUIRE(send_bytes.size() == 3);
+        REQUIRE(send_bytes.count(to_vector(EncapsulatedDataV2())) == 1);
+        REQUIRE(send_bytes.count(to_vector(MissionSetCurrentV2())) == 2);
+        REQUIRE(send_addresses.count(IPAddress("127.0.0.1:4000")) == 2);
+        REQUIRE(send_addresses.count(IPAddress("127.0.0.1:4001")) == 1);
+    }
     SECTION("Multiple connections with broadcast packet.")
     {
         // Mocks
@@ -648,10 +867,10 @@ TEST_CASE("UDPInterace's 'send_packet' method.", "[UPDInterface]")
 
             if (a.name() == "MISSION_SET_CURRENT")
             {
-                return std::pair<bool, int>(true, 0);
+                return std::tuple<bool, int, unsigned int>(true, 0, 0);
             }
 
-            return std::pair<bool, int>(false, 0);
+            return std::tuple<bool, int, unsigned int>(false, 0, 0);
         });
         fakeit::When(OverloadedMethod(mock_socket, receive, receive_type)
                     ).Do([](auto a, auto b)
@@ -708,10 +927,10 @@ TEST_CASE("UDPInterace's 'send_packet' method.", "[UPDInterface]")
 
             if (a.name() == "PING")
             {
-                return std::pair<bool, int>(true, 0);
+                return std::tuple<bool, int, unsigned int>(true, 0, 0);
             }
 
-            return std::pair<bool, int>(false, 0);
+            return std::tuple<bool, int, unsigned int>(false, 0, 0);
         });
         fakeit::When(OverloadedMethod(mock_socket, receive, receive_type)
                     ).Do([](auto a, auto b)
@@ -760,6 +979,397 @@ TEST_CASE("UDPInterace's 'send_packet' method.", "[UPDInterface]")
 }
 
 
+TEST_CASE("UDPInterface's share the transmit budget between peers by "
+          "weight.", "[UPDInterface]")
+{
+    // Filter (only the bulk packets are routed).
+    fakeit::Mock<Filter> mock_filter;
+    fakeit::When(Method(mock_filter, may_accept)).AlwaysReturn(true);
+    fakeit::When(Method(mock_filter, will_accept)).AlwaysDo(
+        [&](auto & a, auto & b)
+    {
+        (void)b;
+        return std::tuple<bool, int, unsigned int>(
+                   a.name() == "ENCAPSULATED_DATA", 0, 0);
+    });
+    auto filter = mock_shared(mock_filter);
+    // Socket
+    std::multiset<IPAddress> send_addresses;
+    using receive_type =
+        IPAddress(std::back_insert_iterator<std::vector<uint8_t>>,
+                  const std::chrono::nanoseconds &);
+    using send_type =
+        void(std::vector<uint8_t>::const_iterator,
+             std::vector<uint8_t>::const_iterator,
+             const IPAddress &);
+    UDPSocket udp_socket;
+    fakeit::Mock<UDPSocket> mock_socket(udp_socket);
+    fakeit::When(OverloadedMethod(mock_socket, send, send_type)
+                ).AlwaysDo([&](auto a, auto b, auto c)
+    {
+        (void)a;
+        (void)b;
+        send_addresses.insert(c);
+    });
+    fakeit::When(OverloadedMethod(mock_socket, receive, receive_type)
+                ).Do([](auto a, auto b)
+    {
+        (void)b;
+        auto vec = to_vector(HeartbeatV2());
+        std::copy(vec.begin(), vec.end(), a);
+        return IPAddress("10.0.0.1:4000");
+    }).Do([](auto a, auto b)
+    {
+        (void)b;
+        auto vec = to_vector(HeartbeatV2());
+        std::copy(vec.begin(), vec.end(), a);
+        return IPAddress("10.0.0.2:4000");
+    }).AlwaysDo([](auto a, auto b)
+    {
+        (void)b;
+        auto vec = to_vector(EncapsulatedDataV2());
+        std::copy(vec.begin(), vec.end(), a);
+        return IPAddress("10.0.0.3:4000");
+    });
+    // Interface
+    UDPInterface udp(
+        mock_unique(mock_socket),
+        std::make_shared<ConnectionPool>(),
+        std::make_unique<ConnectionFactory<>>(filter),
+        {{IPSubnet("10.0.0.1"), 2}, {IPSubnet("10.0.0.0/8"), 1}});
+    std::chrono::nanoseconds timeout = 1ms;
+    // Queue 4 maximum length packets for each of 10.0.0.1 and 10.0.0.2.
+    for (int i = 0; i < 6; ++i)
+    {
+        udp.receive_packet(timeout);
+    }
+    // Test
+    udp.send_packet(timeout);
+    // Verification
+    REQUIRE(send_addresses.count(IPAddress("10.0.0.1:4000")) == 2);
+    REQUIRE(send_addresses.count(IPAddress("10.0.0.2:4000")) == 1);
+    // Test
+    udp.send_packet(timeout);
+    // Verification
+    REQUIRE(send_addresses.count(IPAddress("10.0.0.1:4000")) == 4);
+    REQUIRE(send_addresses.count(IPAddress("10.0.0.2:4000")) == 2);
+    // Test
+    udp.send_packet(timeout);
+    udp.send_packet(timeout);
+    udp.send_packet(timeout);
+    // Verification
+    REQUIRE(send_addresses.count(IPAddress("10.0.0.1:4000")) == 4);
+    REQUIRE(send_addresses.count(IPAddress("10.0.0.2:4000")) == 4);
+    REQUIRE(send_addresses.size() == 8);
+}
+
+
+TEST_CASE("UDPInterface's can transmit to a multicast group with a single "
+          "connection.", "[UPDInterface]")
+{
+    // Filter (accept everything).
+    fakeit::Mock<Filter> mock_filter;
+    fakeit::When(Method(mock_filter, may_accept)).AlwaysReturn(true);
+    fakeit::When(Method(mock_filter, will_accept)).AlwaysReturn(
+        std::tuple<bool, int, unsigned int>(true, 0, 0));
+    auto filter = mock_shared(mock_filter);
+    // Socket
+    std::vector<IPAddress> send_addresses;
+    using receive_type =
+        IPAddress(std::back_insert_iterator<std::vector<uint8_t>>,
+                  const std::chrono::nanoseconds &);
+    using send_type =
+        void(std::vector<uint8_t>::const_iterator,
+             std::vector<uint8_t>::const_iterator,
+             const IPAddress &);
+    UDPSocket udp_socket;
+    fakeit::Mock<UDPSocket> mock_socket(udp_socket);
+    fakeit::When(OverloadedMethod(mock_socket, send, send_type)
+                ).AlwaysDo([&](auto a, auto b, auto c)
+    {
+        (void)a;
+        (void)b;
+        send_addresses.push_back(c);
+    });
+    unsigned int peer = 0;
+    fakeit::When(OverloadedMethod(mock_socket, receive, receive_type)
+                ).AlwaysDo([&](auto a, auto b)
+    {
+        (void)b;
+        auto vec = to_vector(HeartbeatV2());
+        std::copy(vec.begin(), vec.end(), a);
+        return IPAddress("10.0.0." + std::to_string(++peer) + ":4000");
+    });
+    // Connection pool, with another connection to send packets from.
+    auto pool = std::make_shared<ConnectionPool>();
+    auto other = std::make_shared<Connection>("other", filter);
+    pool->add(other);
+    fakeit::Mock<ConnectionPool> spy_pool(*pool);
+    fakeit::Spy(Method(spy_pool, add));
+    // Packet from the other connection.
+    auto packet =
+        std::make_unique<packet_v2::Packet>(to_vector(EncapsulatedDataV2()));
+    packet->connection(other);
+    SECTION("The group's connection is made on construction.")
+    {
+        UDPInterface udp(
+            mock_unique(mock_socket), mock_shared(spy_pool),
+            std::make_unique<ConnectionFactory<>>(filter), {}, 120s,
+            IPAddress("239.1.2.3:14550"), {MAVAddress("1.1")});
+        fakeit::Verify(Method(spy_pool, add)).Once();
+        // Broadcast packets reach subscribers that never transmit.
+        pool->send(std::move(packet));
+        udp.send_packet(1ms);
+        REQUIRE(send_addresses ==
+                std::vector<IPAddress> {IPAddress("239.1.2.3:14550")});
+    }
+    SECTION("Packets are sent once to the group regardless of the number of "
+            "peers.")
+    {
+        UDPInterface udp(
+            mock_unique(mock_socket), mock_shared(spy_pool),
+            std::make_unique<ConnectionFactory<>>(filter), {}, 120s,
+            IPAddress("239.1.2.3:14550"));
+
+        for (int i = 0; i < 30; ++i)
+        {
+            udp.receive_packet(1ms);
+        }
+
+        // The peers share the connection of the group.
+        fakeit::Verify(Method(spy_pool, add)).Once();
+        pool->send(std::move(packet));
+        udp.send_packet(1ms);
+        REQUIRE(send_addresses ==
+                std::vector<IPAddress> {IPAddress("239.1.2.3:14550")});
+    }
+    SECTION("The group's connection is never removed.")
+    {
+        fakeit::When(Method(mock_socket, reachable)).AlwaysReturn(false);
+        UDPInterface udp(
+            mock_unique(mock_socket), mock_shared(spy_pool),
+            std::make_unique<ConnectionFactory<>>(filter), {}, 1ms,
+            IPAddress("239.1.2.3:14550"));
+        udp.receive_packet(1ms);
+        std::this_thread::sleep_for(10ms);
+        udp.send_packet(1ms);
+        pool->send(std::move(packet));
+        udp.send_packet(1ms);
+        REQUIRE(send_addresses ==
+                std::vector<IPAddress> {IPAddress("239.1.2.3:14550")});
+    }
+}
+
+
+TEST_CASE("UDPInterface's can aggregate packets into larger UDP packets.",
+          "[UPDInterface]")
+{
+    // Filter (accept everything).
+    fakeit::Mock<Filter> mock_filter;
+    fakeit::When(Method(mock_filter, may_accept)).AlwaysReturn(true);
+    fakeit::When(Method(mock_filter, will_accept)).AlwaysReturn(
+        std::tuple<bool, int, unsigned int>(true, 0, 0));
+    auto filter = mock_shared(mock_filter);
+    // Socket
+    std::vector<std::vector<uint8_t>> send_data;
+    using receive_type =
+        IPAddress(std::back_insert_iterator<std::vector<uint8_t>>,
+                  const std::chrono::nanoseconds &);
+    using send_type =
+        void(std::vector<uint8_t>::const_iterator,
+             std::vector<uint8_t>::const_iterator,
+             const IPAddress &);
+    UDPSocket udp_socket;
+    fakeit::Mock<UDPSocket> mock_socket(udp_socket);
+    fakeit::When(OverloadedMethod(mock_socket, send, send_type)
+                ).AlwaysDo([&](auto a, auto b, auto c)
+    {
+        (void)c;
+        send_data.emplace_back(a, b);
+    });
+    fakeit::When(OverloadedMethod(mock_socket, receive, receive_type)
+                ).AlwaysDo([](auto a, auto b)
+    {
+        (void)b;
+        auto vec = to_vector(HeartbeatV2());
+        std::copy(vec.begin(), vec.end(), a);
+        return IPAddress("10.0.0.1:4000");
+    });
+    // Connection pool, with another connection to send packets from.
+    auto pool = std::make_shared<ConnectionPool>();
+    auto other = std::make_shared<Connection>("other", filter);
+    pool->add(other);
+    // Packets from the other connection, addressed to 127.1 on the peer.
+    auto ping = to_vector(PingV2());
+    auto send_pings = [&](int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            auto packet = std::make_unique<packet_v2::Packet>(ping);
+            packet->connection(other);
+            pool->send(std::move(packet));
+        }
+    };
+    SECTION("Queued packets are sent together, up to the MTU.")
+    {
+        UDPInterface udp(
+            mock_unique(mock_socket), pool,
+            std::make_unique<ConnectionFactory<>>(filter), {}, 120s,
+            {}, {}, 280);
+        udp.receive_packet(1ms);
+        send_pings(20);
+
+        for (int i = 0; i < 20; ++i)
+        {
+            udp.send_packet(1ms);
+        }
+
+        // Every packet is sent, in order.
+        std::vector<uint8_t> all;
+        std::vector<uint8_t> expected;
+
+        for (const auto &data : send_data)
+        {
+            REQUIRE(data.size() <= 280);
+            all.insert(all.end(), data.begin(), data.end());
+        }
+
+        for (int i = 0; i < 20; ++i)
+        {
+            expected.insert(expected.end(), ping.begin(), ping.end());
+        }
+
+        REQUIRE(all == expected);
+        auto per_datagram = 280 / ping.size();
+        REQUIRE(send_data.size() == (20 + per_datagram - 1) / per_datagram);
+    }
+    SECTION("Packets are held until the flush delay.")
+    {
+        UDPInterface udp(
+            mock_unique(mock_socket), pool,
+            std::make_unique<ConnectionFactory<>>(filter), {}, 120s,
+            {}, {}, 1400, 50ms);
+        udp.receive_packet(1ms);
+        send_pings(2);
+        udp.send_packet(1ms);
+        REQUIRE(send_data.empty());
+        // Held packets are not sent yet.
+        REQUIRE(udp.traffic().packets(Traffic::sent) == 0);
+        std::this_thread::sleep_for(60ms);
+        udp.send_packet(1ms);
+        REQUIRE(send_data.size() == 1);
+        REQUIRE(send_data[0].size() == 2 * ping.size());
+        REQUIRE(udp.traffic().packets(Traffic::sent) == 2);
+        REQUIRE(udp.traffic().bytes(Traffic::sent) == 2 * ping.size());
+    }
+    SECTION("Held packets are dropped when the peer becomes unreachable.")
+    {
+        UDPInterface udp(
+            mock_unique(mock_socket), pool,
+            std::make_unique<ConnectionFactory<>>(filter), {}, 50ms,
+            {}, {}, 1400, 10s);
+        udp.receive_packet(1ms);
+        send_pings(2);
+        udp.send_packet(1ms);
+        REQUIRE(send_data.empty());
+        fakeit::When(Method(mock_socket, reachable)).AlwaysReturn(false);
+        std::this_thread::sleep_for(60ms);
+        udp.send_packet(1ms);
+        REQUIRE(send_data.empty());
+        REQUIRE(udp.traffic().packets(Traffic::sent) == 0);
+        REQUIRE(udp.traffic().packets(Traffic::dropped) == 2);
+        REQUIRE(udp.traffic().bytes(Traffic::dropped) == 2 * ping.size());
+    }
+    SECTION("Without an MTU each packet is sent separately.")
+    {
+        UDPInterface udp(
+            mock_unique(mock_socket), pool,
+            std::make_unique<ConnectionFactory<>>(filter));
+        udp.receive_packet(1ms);
+        send_pings(3);
+        udp.send_packet(1ms);
+        REQUIRE(send_data ==
+                std::vector<std::vector<uint8_t>> {ping, ping, ping});
+    }
+}
+
+
+TEST_CASE("UDPInterface's remove idle connections.", "[UPDInterface]")
+{
+    using receive_type =
+        IPAddress(std::back_insert_iterator<std::vector<uint8_t>>,
+                  const std::chrono::nanoseconds &);
+    fakeit::Mock<Filter> mock_filter;
+    fakeit::When(Method(mock_filter, may_accept)).AlwaysReturn(true);
+    auto filter = mock_shared(mock_filter);
+    // Socket
+    UDPSocket udp_socket;
+    fakeit::Mock<UDPSocket> mock_socket(udp_socket);
+    fakeit::When(OverloadedMethod(mock_socket, receive, receive_type)
+                ).AlwaysDo([](auto a, auto b)
+    {
+        (void)b;
+        auto vec = to_vector(HeartbeatV2());
+        std::copy(vec.begin(), vec.end(), a);
+        return IPAddress("127.0.0.1:4000");
+    });
+    // Connection pool
+    ConnectionPool pool_obj;
+    fakeit::Mock<ConnectionPool> spy_pool(pool_obj);
+    fakeit::Spy(Method(spy_pool, add));
+    fakeit::Spy(Method(spy_pool, remove));
+    // Connection factory (addresses expire immediately).
+    fakeit::Mock<ConnectionFactory<>> mock_factory;
+    fakeit::When(Method(mock_factory, get)).AlwaysDo([&](auto a, auto b)
+    {
+        (void)b;
+        return std::make_unique<Connection>(
+                   a, filter, false, std::make_unique<AddressPool<>>(1ms));
+    });
+    fakeit::When(Method(mock_factory, wait_for_packet)).AlwaysReturn(false);
+    SECTION("After the idle timeout.")
+    {
+        UDPInterface udp(
+            mock_unique(mock_socket), mock_shared(spy_pool),
+            mock_unique(mock_factory), {}, 50ms);
+        udp.receive_packet(1ms);
+        fakeit::Verify(Method(spy_pool, add)).Once();
+        udp.send_packet(1ms);
+        fakeit::Verify(Method(spy_pool, remove)).Exactly(0);
+        std::this_thread::sleep_for(100ms);
+        udp.send_packet(1ms);
+        fakeit::Verify(Method(spy_pool, remove)).Once();
+        // A new packet from the same peer makes a new connection.
+        udp.receive_packet(1ms);
+        fakeit::Verify(Method(spy_pool, add)).Exactly(2);
+    }
+    SECTION("Never when the idle timeout is 0.")
+    {
+        UDPInterface udp(
+            mock_unique(mock_socket), mock_shared(spy_pool),
+            mock_unique(mock_factory), {}, 0ms);
+        udp.receive_packet(1ms);
+        std::this_thread::sleep_for(10ms);
+        udp.send_packet(1ms);
+        fakeit::Verify(Method(spy_pool, remove)).Exactly(0);
+    }
+    SECTION("When the socket reports the peer is unreachable.")
+    {
+        fakeit::When(Method(mock_socket, reachable)).AlwaysReturn(false);
+        fakeit::Spy(Method(mock_socket, forget));
+        UDPInterface udp(
+            mock_unique(mock_socket), mock_shared(spy_pool),
+            mock_unique(mock_factory), {}, 0ms);
+        udp.receive_packet(1ms);
+        udp.send_packet(1ms);
+        fakeit::Verify(Method(spy_pool, remove)).Once();
+        fakeit::Verify(
+            Method(mock_socket, forget).Using(IPAddress("127.0.0.1:4000")))
+        .Once();
+    }
+}
+
+
 TEST_CASE("UDPInterface's are printable.", "[UDPInterface]")
 {
     fakeit::Mock<ConnectionPool> mock_pool;
@@ -786,6 +1396,7 @@ TEST_CASE("OLD TEST: UDPInterface's tests.", "[UPDInterface]")
     auto heartbeat =
         std::make_shared<packet_v2::Packet>(to_vector(HeartbeatV2()));
     fakeit::Mock<Filter> mock_filter;
+    fakeit::When(Method(mock_filter, may_accept)).AlwaysReturn(true);
     UDPSocket udp_socket;
     fakeit::Mock<UDPSocket> mock_socket(udp_socket);
     auto filter = mock_shared(mock_filter);
@@ -821,6 +1432,7 @@ TEST_CASE("OLD TEST: UDPInterface's 'receive_packet' method receives one or "
     auto heartbeat =
         std::make_shared<packet_v2::Packet>(to_vector(HeartbeatV2()));
     fakeit::Mock<Filter> mock_filter;
+    fakeit::When(Method(mock_filter, may_accept)).AlwaysReturn(true);
     UDPSocket udp_socket;
     fakeit::Mock<UDPSocket> mock_socket(udp_socket);
     fakeit::Mock<ConnectionPool> mock_pool;
@@ -841,8 +1453,11 @@ TEST_CASE("OLD TEST: UDPInterface's 'receive_packet' method receives one or "
         });
         fakeit::Fake(Method(mock_pool, send));
         fakeit::Fake(Method(mock_pool, add));
-        fakeit::When(Method(mock_factory, get)).AlwaysDo([&](auto a)
+        fakeit::When(Method(mock_pool, may_accept)).AlwaysReturn(true);
+        fakeit::When(Method(mock_factory, get)).AlwaysDo(
+            [&](auto a, auto b)
         {
+            (void)b;
             return std::make_unique<Connection>(a, filter);
         });
         UDPInterface udp(std::move(socket), pool, std::move(factory));
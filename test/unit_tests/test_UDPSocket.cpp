@@ -89,6 +89,24 @@ TEST_CASE("UDPSocket's 'send' method accepts two vector iterators and an "
 }
 
 
+TEST_CASE("UDPSocket's 'send_delay' method defaults to no delay.",
+          "[UDPSocket]")
+{
+    UDPSocket udp;
+    REQUIRE(udp.send_delay(IPAddress("127.0.0.1:14500")) == 0s);
+}
+
+
+TEST_CASE("UDPSocket's consider every address reachable by default.",
+          "[UDPSocket]")
+{
+    UDPSocket udp;
+    REQUIRE(udp.reachable(IPAddress("127.0.0.1:14500")));
+    REQUIRE_NOTHROW(udp.forget(IPAddress("127.0.0.1:14500")));
+    REQUIRE(udp.reachable(IPAddress("127.0.0.1:14500")));
+}
+
+
 TEST_CASE("UDPSocket's 'receive' method takes a timeout and returns a vector "
           "of bytes and the IP address that sent them.", "[UDPSocket]")
 {
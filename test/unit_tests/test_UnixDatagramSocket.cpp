@@ -0,0 +1,435 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <catch.hpp>
+#include <errno.h>
+#include <fakeit.hpp>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "UnixDatagramSocket.hpp"
+#include "UnixSyscalls.hpp"
+#include "utility.hpp"
+
+#include "common.hpp"
+
+
+using namespace std::chrono_literals;
+
+
+namespace
+{
+
+    // Mock 'recvfrom' to return a datagram sent from the given path.
+    void mock_recvfrom(
+        fakeit::Mock<UnixSyscalls> &mock_sys, std::string path,
+        std::vector<uint8_t> vec)
+    {
+        fakeit::When(Method(mock_sys, recvfrom)).AlwaysDo(
+            [path, vec](auto fd, auto buf, auto len, auto flags,
+                        auto addr, auto addrlen)
+        {
+            (void)fd;
+            (void)flags;
+            std::memcpy(buf, vec.data(), std::min(vec.size(), len));
+            struct sockaddr_un address;
+            std::memset(&address, '\0', sizeof(address));
+            address.sun_family = AF_UNIX;
+            std::memcpy(address.sun_path, path.data(), path.size());
+            std::memcpy(addr, &address, sizeof(address));
+            *addrlen = static_cast<socklen_t>(
+                           offsetof(struct sockaddr_un, sun_path) +
+                           path.size() + 1);
+            return std::min(vec.size(), len);
+        });
+    }
+
+}
+
+
+TEST_CASE("UnixDatagramSocket's create and bind a unix domain socket on "
+          "construction and close and remove it on destruction.",
+          "[UnixDatagramSocket]")
+{
+    SECTION("Without errors.")
+    {
+        fakeit::Mock<UnixSyscalls> mock_sys;
+        fakeit::When(Method(mock_sys, socket)).Return(3);
+        fakeit::When(Method(mock_sys, unlink)).AlwaysReturn(0);
+        mock_lstat(mock_sys, S_IFSOCK);
+        struct sockaddr_un address;
+        socklen_t address_length = 0;
+        fakeit::When(Method(mock_sys, bind)).Do(
+            [&](auto fd, auto addr, auto addrlen)
+        {
+            (void)fd;
+            std::memcpy(&address, addr, addrlen);
+            address_length = addrlen;
+            return 0;
+        });
+        fakeit::When(Method(mock_sys, close)).Return(0);
+        {
+            UnixDatagramSocket socket(
+                "/run/mavtables.sock", mock_unique(mock_sys));
+            fakeit::Verify(Method(mock_sys, socket).Matching(
+                               [&](auto family, auto type, auto protocol)
+            {
+                return family == AF_UNIX && type == SOCK_DGRAM &&
+                       protocol == 0;
+            })).Once();
+            // The socket of a previous run is removed before binding.
+            fakeit::Verify(
+                Method(mock_sys, unlink), Method(mock_sys, bind)).Once();
+            REQUIRE(address.sun_family == AF_UNIX);
+            REQUIRE(std::string(address.sun_path) == "/run/mavtables.sock");
+            REQUIRE(address_length ==
+                    offsetof(struct sockaddr_un, sun_path) + 20);
+            fakeit::Verify(Method(mock_sys, close).Using(3)).Exactly(0);
+        }
+        fakeit::Verify(Method(mock_sys, close).Using(3)).Once();
+        fakeit::Verify(Method(mock_sys, unlink)).Exactly(2);
+    }
+    SECTION("Only removes sockets.")
+    {
+        fakeit::Mock<UnixSyscalls> mock_sys;
+        mock_lstat(mock_sys, S_IFREG);
+        REQUIRE_THROWS_AS(
+            UnixDatagramSocket("/etc/passwd", mock_unique(mock_sys)),
+            std::invalid_argument);
+        REQUIRE_THROWS_WITH(
+            UnixDatagramSocket("/etc/passwd", mock_unique(mock_sys)),
+            "Socket path (/etc/passwd) exists and is not a socket.");
+        fakeit::Verify(Method(mock_sys, socket)).Exactly(0);
+        fakeit::Verify(Method(mock_sys, unlink)).Exactly(0);
+    }
+    SECTION("Binds without removing anything if the path does not exist.")
+    {
+        fakeit::Mock<UnixSyscalls> mock_sys;
+        fakeit::When(Method(mock_sys, lstat)).AlwaysReturn(-1);
+        fakeit::When(Method(mock_sys, socket)).Return(3);
+        fakeit::When(Method(mock_sys, bind)).Return(0);
+        fakeit::When(Method(mock_sys, close)).Return(0);
+        errno = ENOENT;
+        {
+            UnixDatagramSocket socket(
+                "/run/mavtables.sock", mock_unique(mock_sys));
+        }
+        fakeit::Verify(Method(mock_sys, unlink)).Exactly(0);
+    }
+    SECTION("Ensures the path is valid.")
+    {
+        fakeit::Mock<UnixSyscalls> mock_sys;
+        REQUIRE_THROWS_AS(
+            UnixDatagramSocket("", mock_unique(mock_sys)),
+            std::invalid_argument);
+        REQUIRE_THROWS_WITH(
+            UnixDatagramSocket("", mock_unique(mock_sys)),
+            "Socket path is empty.");
+        std::string path(200, 'a');
+        REQUIRE_THROWS_AS(
+            UnixDatagramSocket(path, mock_unique(mock_sys)),
+            std::invalid_argument);
+    }
+    SECTION("Emmits errors from 'socket' system call.")
+    {
+        fakeit::Mock<UnixSyscalls> mock_sys;
+        mock_lstat(mock_sys, S_IFSOCK);
+        fakeit::When(Method(mock_sys, unlink)).AlwaysReturn(0);
+        fakeit::When(Method(mock_sys, socket)).AlwaysReturn(-1);
+        errno = EMFILE;
+        REQUIRE_THROWS_AS(
+            UnixDatagramSocket("/run/mavtables.sock", mock_unique(mock_sys)),
+            std::system_error);
+    }
+    SECTION("Emmits errors from 'bind' system call.")
+    {
+        fakeit::Mock<UnixSyscalls> mock_sys;
+        fakeit::When(Method(mock_sys, socket)).AlwaysReturn(4);
+        fakeit::When(Method(mock_sys, unlink)).AlwaysReturn(0);
+        mock_lstat(mock_sys, S_IFSOCK);
+        fakeit::When(Method(mock_sys, bind)).AlwaysReturn(-1);
+        errno = EACCES;
+        REQUIRE_THROWS_AS(
+            UnixDatagramSocket("/run/mavtables.sock", mock_unique(mock_sys)),
+            std::system_error);
+    }
+}
+
+
+TEST_CASE("UnixDatagramSocket's give each peer a placeholder IP address.",
+          "[UnixDatagramSocket]")
+{
+    fakeit::Mock<UnixSyscalls> mock_sys;
+    fakeit::When(Method(mock_sys, socket)).AlwaysReturn(3);
+    fakeit::When(Method(mock_sys, unlink)).AlwaysReturn(0);
+    mock_lstat(mock_sys, S_IFSOCK);
+    fakeit::When(Method(mock_sys, bind)).AlwaysReturn(0);
+    fakeit::When(Method(mock_sys, close)).AlwaysReturn(0);
+    fakeit::When(Method(mock_sys, poll)).AlwaysDo(
+        [](auto fds, auto nfds, auto timeout)
+    {
+        (void)nfds;
+        (void)timeout;
+        fds->revents = POLLIN;
+        return 1;
+    });
+    fakeit::When(Method(mock_sys, ioctl)).AlwaysDo(
+        [](auto fd, auto request, auto size)
+    {
+        (void)fd;
+        (void)request;
+        *reinterpret_cast<int *>(size) = 4;
+        return 0;
+    });
+    UnixDatagramSocket socket("/run/mavtables.sock", mock_unique(mock_sys));
+    mock_recvfrom(mock_sys, "/run/a.sock", {1, 3, 3, 7});
+    auto [data_a, ip_a] = socket.receive(250ms);
+    REQUIRE(data_a == std::vector<uint8_t>({1, 3, 3, 7}));
+    REQUIRE(ip_a == IPAddress(0, 1));
+    mock_recvfrom(mock_sys, "/run/b.sock", {7, 3, 3, 1});
+    auto [data_b, ip_b] = socket.receive(250ms);
+    REQUIRE(data_b == std::vector<uint8_t>({7, 3, 3, 1}));
+    REQUIRE(ip_b == IPAddress(0, 2));
+    // The same peer keeps its address.
+    mock_recvfrom(mock_sys, "/run/a.sock", {1, 3, 3, 7});
+    REQUIRE(socket.receive(250ms).second == IPAddress(0, 1));
+    SECTION("Drops datagrams from new peers when out of addresses.")
+    {
+        unsigned int next_peer = 0;
+        fakeit::When(Method(mock_sys, recvfrom)).AlwaysDo(
+            [&](auto fd, auto buf, auto len, auto flags,
+                auto addr, auto addrlen)
+        {
+            (void)fd;
+            (void)buf;
+            (void)flags;
+            auto path = "/run/" + std::to_string(next_peer++) + ".sock";
+            struct sockaddr_un address;
+            std::memset(&address, '\0', sizeof(address));
+            address.sun_family = AF_UNIX;
+            std::memcpy(address.sun_path, path.data(), path.size());
+            std::memcpy(addr, &address, sizeof(address));
+            *addrlen = static_cast<socklen_t>(
+                           offsetof(struct sockaddr_un, sun_path) +
+                           path.size() + 1);
+            return len;
+        });
+
+        // Two addresses are already in use.
+        for (unsigned int i = 0; i < 65533; ++i)
+        {
+            socket.receive(250ms);
+        }
+
+        auto [data, ip] = socket.receive(250ms);
+        REQUIRE(data.empty());
+        REQUIRE(ip == IPAddress(0));
+        // Known peers are still received from.
+        mock_recvfrom(mock_sys, "/run/a.sock", {1, 3, 3, 7});
+        REQUIRE(socket.receive(250ms).second == IPAddress(0, 1));
+    }
+    SECTION("Sends to the peer's path.")
+    {
+        std::string path;
+        fakeit::When(Method(mock_sys, sendto)).AlwaysDo(
+            [&](auto fd, auto buf, auto len, auto flags,
+                auto addr, auto addrlen)
+        {
+            (void)fd;
+            (void)buf;
+            (void)flags;
+            (void)addrlen;
+            path = reinterpret_cast<const struct sockaddr_un *>(
+                       addr)->sun_path;
+            return len;
+        });
+        socket.send({1, 3, 3, 7}, ip_b);
+        REQUIRE(path == "/run/b.sock");
+        fakeit::Verify(Method(mock_sys, sendto).Matching(
+                           [](auto fd, auto buf, auto len, auto flags,
+                              auto addr, auto addrlen)
+        {
+            (void)buf;
+            (void)addr;
+            (void)addrlen;
+            return fd == 3 && len == 4 && flags == MSG_DONTWAIT;
+        })).Once();
+        // Unknown peers are dropped.
+        socket.send({1, 3, 3, 7}, IPAddress(0, 100));
+        fakeit::Verify(Method(mock_sys, sendto)).Once();
+    }
+    SECTION("Peers with closed sockets are unreachable.")
+    {
+        fakeit::When(Method(mock_sys, sendto)).AlwaysDo(
+            [](auto fd, auto buf, auto len, auto flags,
+               auto addr, auto addrlen)
+        {
+            (void)fd;
+            (void)buf;
+            (void)len;
+            (void)flags;
+            (void)addr;
+            (void)addrlen;
+            errno = ECONNREFUSED;
+            return -1;
+        });
+        REQUIRE(socket.reachable(ip_a));
+        REQUIRE_NOTHROW(socket.send({1, 3, 3, 7}, ip_a));
+        REQUIRE_FALSE(socket.reachable(ip_a));
+        REQUIRE(socket.reachable(ip_b));
+        // Forgetting the peer releases its address.
+        socket.forget(ip_a);
+        REQUIRE(socket.reachable(ip_a));
+        mock_recvfrom(mock_sys, "/run/c.sock", {1, 3, 3, 7});
+        REQUIRE(socket.receive(250ms).second == IPAddress(0, 3));
+        mock_recvfrom(mock_sys, "/run/a.sock", {1, 3, 3, 7});
+        REQUIRE(socket.receive(250ms).second == IPAddress(0, 4));
+    }
+    SECTION("Peers with paths that fill the address are unreachable.")
+    {
+        fakeit::When(Method(mock_sys, recvfrom)).AlwaysDo(
+            [](auto fd, auto buf, auto len, auto flags,
+               auto addr, auto addrlen)
+        {
+            (void)fd;
+            (void)buf;
+            (void)flags;
+            auto address = reinterpret_cast<struct sockaddr_un *>(addr);
+            address->sun_family = AF_UNIX;
+            std::memset(address->sun_path, 'a', sizeof(address->sun_path));
+            *addrlen = sizeof(*address);
+            return len;
+        });
+        auto ip = socket.receive(250ms).second;
+        REQUIRE(ip == IPAddress(0, 3));
+        REQUIRE_NOTHROW(socket.send({1, 3, 3, 7}, ip));
+        REQUIRE_FALSE(socket.reachable(ip));
+        fakeit::Verify(Method(mock_sys, sendto)).Exactly(0);
+    }
+    SECTION("Full peer receive queues drop the data.")
+    {
+        fakeit::When(Method(mock_sys, sendto)).AlwaysDo(
+            [](auto fd, auto buf, auto len, auto flags,
+               auto addr, auto addrlen)
+        {
+            (void)fd;
+            (void)buf;
+            (void)len;
+            (void)flags;
+            (void)addr;
+            (void)addrlen;
+            errno = EAGAIN;
+            return -1;
+        });
+        REQUIRE_NOTHROW(socket.send({1, 3, 3, 7}, ip_a));
+        REQUIRE(socket.reachable(ip_a));
+    }
+    SECTION("Emmits other errors from 'sendto' system call.")
+    {
+        fakeit::When(Method(mock_sys, sendto)).AlwaysReturn(-1);
+        errno = EBADF;
+        REQUIRE_THROWS_AS(
+            socket.send({1, 3, 3, 7}, ip_a), std::system_error);
+    }
+}
+
+
+TEST_CASE("UnixDatagramSocket's 'receive' method ignores unnamed peers and "
+          "timeouts.", "[UnixDatagramSocket]")
+{
+    fakeit::Mock<UnixSyscalls> mock_sys;
+    fakeit::When(Method(mock_sys, socket)).AlwaysReturn(3);
+    fakeit::When(Method(mock_sys, unlink)).AlwaysReturn(0);
+    mock_lstat(mock_sys, S_IFSOCK);
+    fakeit::When(Method(mock_sys, bind)).AlwaysReturn(0);
+    fakeit::When(Method(mock_sys, close)).AlwaysReturn(0);
+    UnixDatagramSocket socket("/run/mavtables.sock", mock_unique(mock_sys));
+    SECTION("Timeout, no packet (no errors).")
+    {
+        fakeit::When(Method(mock_sys, poll)).Return(0);
+        auto [data, ip] = socket.receive(250ms);
+        REQUIRE(data.empty());
+        REQUIRE(ip == IPAddress(0));
+    }
+    SECTION("Unnamed peer.")
+    {
+        fakeit::When(Method(mock_sys, poll)).Do(
+            [](auto fds, auto nfds, auto timeout)
+        {
+            (void)nfds;
+            (void)timeout;
+            fds->revents = POLLIN;
+            return 1;
+        });
+        fakeit::When(Method(mock_sys, ioctl)).Do(
+            [](auto fd, auto request, auto size)
+        {
+            (void)fd;
+            (void)request;
+            *reinterpret_cast<int *>(size) = 4;
+            return 0;
+        });
+        fakeit::When(Method(mock_sys, recvfrom)).Do(
+            [](auto fd, auto buf, auto len, auto flags,
+               auto addr, auto addrlen)
+        {
+            (void)fd;
+            (void)buf;
+            (void)flags;
+            reinterpret_cast<struct sockaddr_un *>(addr)->sun_family =
+                AF_UNIX;
+            *addrlen = sizeof(sa_family_t);
+            return len;
+        });
+        auto [data, ip] = socket.receive(250ms);
+        REQUIRE(data.empty());
+        REQUIRE(ip == IPAddress(0));
+    }
+    SECTION("Emmits errors from 'poll' system call.")
+    {
+        fakeit::When(Method(mock_sys, poll)).AlwaysReturn(-1);
+        errno = EINTR;
+        REQUIRE_THROWS_AS(socket.receive(250ms), std::system_error);
+    }
+}
+
+
+TEST_CASE("UnixDatagramSocket's are printable.", "[UnixDatagramSocket]")
+{
+    fakeit::Mock<UnixSyscalls> mock_sys;
+    fakeit::When(Method(mock_sys, socket)).Return(3);
+    fakeit::When(Method(mock_sys, unlink)).AlwaysReturn(0);
+    mock_lstat(mock_sys, S_IFSOCK);
+    fakeit::When(Method(mock_sys, bind)).Return(0);
+    fakeit::When(Method(mock_sys, close)).Return(0);
+    UnixDatagramSocket socket("/run/mavtables.sock", mock_unique(mock_sys));
+    REQUIRE(
+        str(socket) ==
+        "unix {\n"
+        "    path /run/mavtables.sock;\n"
+        "}");
+}
@@ -18,6 +18,7 @@
 #include <chrono>
 #include <cstdint>
 #include <cstring>
+#include <functional>
 #include <stdexcept>
 #include <string>
 #include <system_error>
@@ -26,6 +27,10 @@
 #include <errno.h>
 #include <fakeit.hpp>
 
+#ifdef __linux__
+#include <linux/serial.h>
+#endif
+
 #include "PartialSendError.hpp"
 #include "UnixSerialPort.hpp"
 #include "UnixSyscalls.hpp"
@@ -71,6 +76,7 @@ TEST_CASE("UnixSerialPort's open and configure a serial port on construction"
             UnixSerialPort port(
                 "/dev/ttyUSB0", 9600,
                 SerialPort::DEFAULT,
+                0, 0ms, 1024,
                 mock_unique(mock_sys));
             // Verify 'open' system call.
             fakeit::Verify(Method(mock_sys, open).Matching(
@@ -155,6 +161,7 @@ TEST_CASE("UnixSerialPort's open and configure a serial port on construction"
             UnixSerialPort port(
                 "/dev/ttyUSB0", 9600,
                 SerialPort::FLOW_CONTROL,
+                0, 0ms, 1024,
                 mock_unique(mock_sys));
             // Verify 'open' system call.
             fakeit::Verify(Method(mock_sys, open).Matching(
@@ -246,6 +253,7 @@ TEST_CASE("UnixSerialPort's open and configure a serial port on construction"
             errno = error;
             REQUIRE_THROWS_AS(UnixSerialPort(
                                   "/dev/ttyUSB0", 9600, SerialPort::DEFAULT,
+                                  0, 0ms, 1024,
                                   mock_unique(mock_sys)), std::system_error);
         }
 
@@ -267,6 +275,7 @@ TEST_CASE("UnixSerialPort's open and configure a serial port on construction"
             errno = error;
             REQUIRE_THROWS_AS(UnixSerialPort(
                                   "/dev/ttyUSB0", 9600, SerialPort::DEFAULT,
+                                  0, 0ms, 1024,
                                   mock_unique(mock_sys)), std::system_error);
         }
 
@@ -292,6 +301,7 @@ TEST_CASE("UnixSerialPort's open and configure a serial port on construction"
             errno = error;
             REQUIRE_THROWS_AS(UnixSerialPort(
                                   "/dev/ttyUSB0", 9600, SerialPort::DEFAULT,
+                                  0, 0ms, 1024,
                                   mock_unique(mock_sys)), std::system_error);
         }
 
@@ -332,6 +342,7 @@ TEST_CASE("UnixSerialPort's open method configures the baud rate.",
         UnixSerialPort port(
             "/dev/ttyUSB0", 0,
             SerialPort::DEFAULT,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(cfgetispeed(&tty) == B0);
         REQUIRE(cfgetospeed(&tty) == B0);
@@ -341,6 +352,7 @@ TEST_CASE("UnixSerialPort's open method configures the baud rate.",
         UnixSerialPort port(
             "/dev/ttyUSB0", 50,
             SerialPort::DEFAULT,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(cfgetispeed(&tty) == B50);
         REQUIRE(cfgetospeed(&tty) == B50);
@@ -350,6 +362,7 @@ TEST_CASE("UnixSerialPort's open method configures the baud rate.",
         UnixSerialPort port(
             "/dev/ttyUSB0", 75,
             SerialPort::DEFAULT,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(cfgetispeed(&tty) == B75);
         REQUIRE(cfgetospeed(&tty) == B75);
@@ -359,6 +372,7 @@ TEST_CASE("UnixSerialPort's open method configures the baud rate.",
         UnixSerialPort port(
             "/dev/ttyUSB0", 110,
             SerialPort::DEFAULT,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(cfgetispeed(&tty) == B110);
         REQUIRE(cfgetospeed(&tty) == B110);
@@ -368,6 +382,7 @@ TEST_CASE("UnixSerialPort's open method configures the baud rate.",
         UnixSerialPort port(
             "/dev/ttyUSB0", 134,
             SerialPort::DEFAULT,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(cfgetispeed(&tty) == B134);
         REQUIRE(cfgetospeed(&tty) == B134);
@@ -377,6 +392,7 @@ TEST_CASE("UnixSerialPort's open method configures the baud rate.",
         UnixSerialPort port(
             "/dev/ttyUSB0", 135,
             SerialPort::DEFAULT,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(cfgetispeed(&tty) == B134);
         REQUIRE(cfgetospeed(&tty) == B134);
@@ -386,6 +402,7 @@ TEST_CASE("UnixSerialPort's open method configures the baud rate.",
         UnixSerialPort port(
             "/dev/ttyUSB0", 150,
             SerialPort::DEFAULT,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(cfgetispeed(&tty) == B150);
         REQUIRE(cfgetospeed(&tty) == B150);
@@ -395,6 +412,7 @@ TEST_CASE("UnixSerialPort's open method configures the baud rate.",
         UnixSerialPort port(
             "/dev/ttyUSB0", 200,
             SerialPort::DEFAULT,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(cfgetispeed(&tty) == B200);
         REQUIRE(cfgetospeed(&tty) == B200);
@@ -404,6 +422,7 @@ TEST_CASE("UnixSerialPort's open method configures the baud rate.",
         UnixSerialPort port(
             "/dev/ttyUSB0", 300,
             SerialPort::DEFAULT,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(cfgetispeed(&tty) == B300);
         REQUIRE(cfgetospeed(&tty) == B300);
@@ -413,6 +432,7 @@ TEST_CASE("UnixSerialPort's open method configures the baud rate.",
         UnixSerialPort port(
             "/dev/ttyUSB0", 600,
             SerialPort::DEFAULT,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(cfgetispeed(&tty) == B600);
         REQUIRE(cfgetospeed(&tty) == B600);
@@ -422,6 +442,7 @@ TEST_CASE("UnixSerialPort's open method configures the baud rate.",
         UnixSerialPort port(
             "/dev/ttyUSB0", 1200,
             SerialPort::DEFAULT,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(cfgetispeed(&tty) == B1200);
         REQUIRE(cfgetospeed(&tty) == B1200);
@@ -431,6 +452,7 @@ TEST_CASE("UnixSerialPort's open method configures the baud rate.",
         UnixSerialPort port(
             "/dev/ttyUSB0", 1800,
             SerialPort::DEFAULT,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(cfgetispeed(&tty) == B1800);
         REQUIRE(cfgetospeed(&tty) == B1800);
@@ -440,6 +462,7 @@ TEST_CASE("UnixSerialPort's open method configures the baud rate.",
         UnixSerialPort port(
             "/dev/ttyUSB0", 2400,
             SerialPort::DEFAULT,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(cfgetispeed(&tty) == B2400);
         REQUIRE(cfgetospeed(&tty) == B2400);
@@ -449,6 +472,7 @@ TEST_CASE("UnixSerialPort's open method configures the baud rate.",
         UnixSerialPort port(
             "/dev/ttyUSB0", 4800,
             SerialPort::DEFAULT,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(cfgetispeed(&tty) == B4800);
         REQUIRE(cfgetospeed(&tty) == B4800);
@@ -458,6 +482,7 @@ TEST_CASE("UnixSerialPort's open method configures the baud rate.",
         UnixSerialPort port(
             "/dev/ttyUSB0", 9600,
             SerialPort::DEFAULT,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(cfgetispeed(&tty) == B9600);
         REQUIRE(cfgetospeed(&tty) == B9600);
@@ -467,6 +492,7 @@ TEST_CASE("UnixSerialPort's open method configures the baud rate.",
         UnixSerialPort port(
             "/dev/ttyUSB0", 19200,
             SerialPort::DEFAULT,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(cfgetispeed(&tty) == B19200);
         REQUIRE(cfgetospeed(&tty) == B19200);
@@ -476,6 +502,7 @@ TEST_CASE("UnixSerialPort's open method configures the baud rate.",
         UnixSerialPort port(
             "/dev/ttyUSB0", 38400,
             SerialPort::DEFAULT,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(cfgetispeed(&tty) == B38400);
         REQUIRE(cfgetospeed(&tty) == B38400);
@@ -485,6 +512,7 @@ TEST_CASE("UnixSerialPort's open method configures the baud rate.",
         UnixSerialPort port(
             "/dev/ttyUSB0", 57600,
             SerialPort::DEFAULT,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(cfgetispeed(&tty) == B57600);
         REQUIRE(cfgetospeed(&tty) == B57600);
@@ -494,6 +522,7 @@ TEST_CASE("UnixSerialPort's open method configures the baud rate.",
         UnixSerialPort port(
             "/dev/ttyUSB0", 115200,
             SerialPort::DEFAULT,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(cfgetispeed(&tty) == B115200);
         REQUIRE(cfgetospeed(&tty) == B115200);
@@ -503,6 +532,7 @@ TEST_CASE("UnixSerialPort's open method configures the baud rate.",
         UnixSerialPort port(
             "/dev/ttyUSB0", 230400,
             SerialPort::DEFAULT,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(cfgetispeed(&tty) == B230400);
         REQUIRE(cfgetospeed(&tty) == B230400);
@@ -512,15 +542,159 @@ TEST_CASE("UnixSerialPort's open method configures the baud rate.",
         REQUIRE_THROWS_AS(
             UnixSerialPort(
                 "/dev/ttyUSB0", 9601, SerialPort::DEFAULT,
+                0, 0ms, 1024,
                 mock_unique(mock_sys)), std::invalid_argument);
         REQUIRE_THROWS_WITH(
             UnixSerialPort(
                 "/dev/ttyUSB0", 9601, SerialPort::DEFAULT,
+                0, 0ms, 1024,
                 mock_unique(mock_sys)), "9601 bps is not a valid baud rate.");
     }
 }
 
 
+TEST_CASE("UnixSerialPort's can be tuned for receive latency.",
+          "[UnixSerialPort]")
+{
+    // Mock system calls.
+    fakeit::Mock<UnixSyscalls> mock_sys;
+    fakeit::When(Method(mock_sys, open)).AlwaysReturn(3);
+    fakeit::When(Method(mock_sys, tcgetattr)).AlwaysDo(
+        [&](auto fd, auto termios_p)
+    {
+        (void)fd;
+        std::memset(termios_p, '\0', sizeof(struct termios));
+        return 0;
+    });
+    struct termios tty;
+    fakeit::When(Method(mock_sys, tcsetattr)).AlwaysDo(
+        [&](auto fd, auto action, auto termios_p)
+    {
+        (void)fd;
+        (void)action;
+        std::memcpy(&tty, termios_p, sizeof(struct termios));
+        return 0;
+    });
+    fakeit::When(Method(mock_sys, close)).AlwaysReturn(0);
+    SECTION("Sets VMIN and VTIME (rounding up to deciseconds).")
+    {
+        UnixSerialPort port(
+            "/dev/ttyUSB0", 9600,
+            SerialPort::DEFAULT,
+            64, 150ms, 1024,
+            mock_unique(mock_sys));
+        REQUIRE(tty.c_cc[VMIN] == 64);
+        REQUIRE(tty.c_cc[VTIME] == 2);
+    }
+    SECTION("Reads up to the read buffer size at a time.")
+    {
+        UnixSerialPort port(
+            "/dev/ttyUSB0", 9600,
+            SerialPort::DEFAULT,
+            0, 0ms, 4096,
+            mock_unique(mock_sys));
+        fakeit::When(Method(mock_sys, poll)).AlwaysDo(
+            [&](auto fds_, auto nfds, auto timeout)
+        {
+            (void)nfds;
+            (void)timeout;
+            fds_->revents = POLLIN;
+            return 1;
+        });
+        fakeit::When(Method(mock_sys, read)).AlwaysDo(
+            [](auto fd, auto buf, auto count)
+        {
+            (void)fd;
+            (void)count;
+            std::memset(buf, 7, 100);
+            return 100;
+        });
+        REQUIRE(port.read(250ms) == std::vector<uint8_t>(100, 7));
+        fakeit::Verify(Method(mock_sys, read).Matching(
+                           [](auto fd, auto buf, auto count)
+        {
+            (void)buf;
+            return fd == 3 && count == 4096;
+        })).Once();
+    }
+#ifdef ASYNC_LOW_LATENCY
+    SECTION("Enables low latency mode.")
+    {
+        struct serial_struct serial;
+        std::memset(&serial, '\0', sizeof(serial));
+        fakeit::When(Method(mock_sys, ioctl)).AlwaysDo(
+            [&](auto fd, auto request, auto argp)
+        {
+            (void)fd;
+
+            if (request == TIOCGSERIAL)
+            {
+                std::memcpy(argp, &serial, sizeof(serial));
+            }
+            else if (request == TIOCSSERIAL)
+            {
+                std::memcpy(&serial, argp, sizeof(serial));
+            }
+
+            return 0;
+        });
+        UnixSerialPort port(
+            "/dev/ttyUSB0", 9600,
+            SerialPort::LOW_LATENCY,
+            0, 0ms, 1024,
+            mock_unique(mock_sys));
+        fakeit::Verify(
+            Method(mock_sys, ioctl).Using(3, TIOCGSERIAL, fakeit::_),
+            Method(mock_sys, ioctl).Using(3, TIOCSSERIAL, fakeit::_)).Once();
+        REQUIRE((serial.flags & ASYNC_LOW_LATENCY) != 0);
+    }
+    SECTION("Emits errors from 'ioctl' system call (low latency mode).")
+    {
+        fakeit::When(Method(mock_sys, ioctl)).AlwaysReturn(-1);
+        errno = ENOTTY;
+        REQUIRE_THROWS_AS(
+            UnixSerialPort(
+                "/dev/ttyUSB0", 9600, SerialPort::LOW_LATENCY,
+                0, 0ms, 1024,
+                mock_unique(mock_sys)), std::system_error);
+    }
+#endif
+    SECTION("Ensures the read settings are valid.")
+    {
+        REQUIRE_THROWS_AS(
+            UnixSerialPort(
+                "/dev/ttyUSB0", 9600, SerialPort::DEFAULT,
+                256, 100ms, 1024,
+                mock_unique(mock_sys)), std::invalid_argument);
+        REQUIRE_THROWS_WITH(
+            UnixSerialPort(
+                "/dev/ttyUSB0", 9600, SerialPort::DEFAULT,
+                256, 100ms, 1024,
+                mock_unique(mock_sys)),
+            "Minimum read size must be no more than 255 bytes.");
+        REQUIRE_THROWS_WITH(
+            UnixSerialPort(
+                "/dev/ttyUSB0", 9600, SerialPort::DEFAULT,
+                0, 25501ms, 1024,
+                mock_unique(mock_sys)),
+            "Read timeout must be between 0 and 25500 milliseconds.");
+        REQUIRE_THROWS_WITH(
+            UnixSerialPort(
+                "/dev/ttyUSB0", 9600, SerialPort::DEFAULT,
+                64, 0ms, 1024,
+                mock_unique(mock_sys)),
+            "A minimum read size requires a non-zero read timeout.");
+        REQUIRE_THROWS_WITH(
+            UnixSerialPort(
+                "/dev/ttyUSB0", 9600, SerialPort::DEFAULT,
+                0, 0ms, 0,
+                mock_unique(mock_sys)),
+            "Read buffer size must be non-zero.");
+        fakeit::Verify(Method(mock_sys, open)).Exactly(0);
+    }
+}
+
+
 TEST_CASE("UnixSerialPort's 'read' method receives data on the socket.",
           "[UnixSerialPort]")
 {
@@ -538,6 +712,7 @@ TEST_CASE("UnixSerialPort's 'read' method receives data on the socket.",
     UnixSerialPort port(
         "/dev/ttyUSB0", 9600,
         SerialPort::DEFAULT,
+        0, 0ms, 1024,
         mock_unique(mock_sys));
     SECTION("Timeout, no data (no errors).")
     {
@@ -756,6 +931,7 @@ TEST_CASE("UnixSerialPort's 'write' method sends data over the serial port.",
     UnixSerialPort port(
         "/dev/ttyUSB0", 9600,
         SerialPort::DEFAULT,
+        0, 0ms, 1024,
         mock_unique(mock_sys));
     SECTION("Without error.")
     {
@@ -816,6 +992,154 @@ TEST_CASE("UnixSerialPort's 'write' method sends data over the serial port.",
 }
 
 
+TEST_CASE("UnixSerialPort's 'write_some' method writes multiple buffers "
+          "with a single system call.", "[UnixSerialPort]")
+{
+    // Mock system calls.
+    fakeit::Mock<UnixSyscalls> mock_sys;
+    fakeit::When(Method(mock_sys, open)).AlwaysReturn(3);
+    fakeit::When(Method(mock_sys, tcgetattr)).AlwaysReturn(0);
+    fakeit::When(Method(mock_sys, tcsetattr)).AlwaysReturn(0);
+    fakeit::When(Method(mock_sys, close)).Return(0);
+    // Construct port.
+    UnixSerialPort port(
+        "/dev/ttyUSB0", 9600,
+        SerialPort::DEFAULT,
+        0, 0ms, 1024,
+        mock_unique(mock_sys));
+    std::vector<uint8_t> first = {1, 3, 3, 7};
+    std::vector<uint8_t> second = {4, 2};
+    std::vector<uint8_t> written;
+    int iovcnt = 0;
+    fakeit::When(Method(mock_sys, writev)).AlwaysDo(
+        [&](auto fd, auto iov, auto cnt)
+    {
+        (void)fd;
+        iovcnt = cnt;
+
+        for (int i = 0; i < cnt; ++i)
+        {
+            auto data = static_cast<const uint8_t *>(iov[i].iov_base);
+            written.insert(written.end(), data, data + iov[i].iov_len);
+        }
+
+        return static_cast<ssize_t>(written.size());
+    });
+    SECTION("Without an offset.")
+    {
+        REQUIRE(port.write_some({std::cref(first), std::cref(second)}) == 6);
+        fakeit::Verify(Method(mock_sys, writev)).Once();
+        REQUIRE(iovcnt == 2);
+        REQUIRE(written == std::vector<uint8_t>({1, 3, 3, 7, 4, 2}));
+    }
+    SECTION("With an offset (resuming a partial write).")
+    {
+        REQUIRE(
+            port.write_some({std::cref(first), std::cref(second)}, 5) == 1);
+        fakeit::Verify(Method(mock_sys, writev)).Once();
+        REQUIRE(iovcnt == 1);
+        REQUIRE(written == std::vector<uint8_t>({2}));
+    }
+    SECTION("Nothing left to write.")
+    {
+        REQUIRE(
+            port.write_some({std::cref(first), std::cref(second)}, 6) == 0);
+        fakeit::Verify(Method(mock_sys, writev)).Exactly(0);
+    }
+    SECTION("Emits errors from 'writev' system call.")
+    {
+        fakeit::When(Method(mock_sys, writev)).AlwaysReturn(-1);
+        errno = EIO;
+        REQUIRE_THROWS_AS(
+            port.write_some({std::cref(first), std::cref(second)}),
+            std::system_error);
+    }
+}
+
+
+TEST_CASE("UnixSerialPort's keep track of their output buffer.",
+          "[UnixSerialPort]")
+{
+    // Mock system calls.
+    fakeit::Mock<UnixSyscalls> mock_sys;
+    fakeit::When(Method(mock_sys, open)).AlwaysReturn(3);
+    fakeit::When(Method(mock_sys, tcgetattr)).AlwaysReturn(0);
+    fakeit::When(Method(mock_sys, tcsetattr)).AlwaysReturn(0);
+    fakeit::When(Method(mock_sys, close)).Return(0);
+    // Construct port (960 bytes per second).
+    UnixSerialPort port(
+        "/dev/ttyUSB0", 9600,
+        SerialPort::DEFAULT,
+        0, 0ms, 1024,
+        mock_unique(mock_sys));
+    int queued = 0;
+    fakeit::When(Method(mock_sys, ioctl)).AlwaysDo(
+        [&](auto fd, auto request, auto argp)
+    {
+        (void)fd;
+        (void)request;
+        *static_cast<int *>(argp) = queued;
+        return 0;
+    });
+    SECTION("Using the 'output_queue_size' method.")
+    {
+        queued = 100;
+        REQUIRE(port.output_queue_size() == 100);
+        fakeit::Verify(Method(mock_sys, ioctl).Matching(
+                           [](auto fd, auto request, auto argp)
+        {
+            (void)argp;
+            return fd == 3 && request == TIOCOUTQ;
+        })).Once();
+    }
+    SECTION("The 'wait_for_output' method returns immediately when the "
+            "output buffer is shallow.")
+    {
+        queued = 64;
+        auto tic = std::chrono::steady_clock::now();
+        REQUIRE(port.wait_for_output(64, 1s));
+        auto toc = std::chrono::steady_clock::now();
+        REQUIRE((toc - tic) < 100ms);
+    }
+    SECTION("The 'wait_for_output' method sleeps until the output buffer is "
+            "expected to drain.")
+    {
+        fakeit::When(Method(mock_sys, ioctl)).Do(
+            [&](auto fd, auto request, auto argp)
+        {
+            (void)fd;
+            (void)request;
+            *static_cast<int *>(argp) = 260;
+            return 0;
+        }).AlwaysDo([&](auto fd, auto request, auto argp)
+        {
+            (void)fd;
+            (void)request;
+            *static_cast<int *>(argp) = 0;
+            return 0;
+        });
+        auto tic = std::chrono::steady_clock::now();
+        REQUIRE(port.wait_for_output(20, 1s));
+        auto toc = std::chrono::steady_clock::now();
+        // 240 bytes at 960 bytes per second is 0.25 seconds.
+        REQUIRE((toc - tic) >= 200ms);
+        REQUIRE((toc - tic) < 500ms);
+        fakeit::Verify(Method(mock_sys, ioctl)).Exactly(2);
+    }
+    SECTION("The 'wait_for_output' method times out.")
+    {
+        queued = 1000;
+        REQUIRE_FALSE(port.wait_for_output(0, 10ms));
+    }
+    SECTION("Emits errors from 'ioctl' system call.")
+    {
+        fakeit::When(Method(mock_sys, ioctl)).AlwaysReturn(-1);
+        errno = EBADF;
+        REQUIRE_THROWS_AS(port.output_queue_size(), std::system_error);
+    }
+}
+
+
 TEST_CASE("UnixSerialPort's are printable.", "[UnixSerialPort]")
 {
     // Mock system calls.
@@ -847,6 +1171,7 @@ TEST_CASE("UnixSerialPort's are printable.", "[UnixSerialPort]")
         UnixSerialPort port(
             "/dev/ttyUSB0", 9600,
             SerialPort::DEFAULT,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(
             str(port) ==
@@ -861,6 +1186,7 @@ TEST_CASE("UnixSerialPort's are printable.", "[UnixSerialPort]")
         UnixSerialPort port(
             "/dev/ttyUSB0", 9600,
             SerialPort::FLOW_CONTROL,
+            0, 0ms, 1024,
             mock_unique(mock_sys));
         REQUIRE(
             str(port) ==
@@ -870,4 +1196,22 @@ TEST_CASE("UnixSerialPort's are printable.", "[UnixSerialPort]")
             "    flow_control yes;\n"
             "}");
     }
+    SECTION("With receive tuning.")
+    {
+        UnixSerialPort port(
+            "/dev/ttyUSB0", 9600,
+            SerialPort::DEFAULT,
+            64, 100ms, 4096,
+            mock_unique(mock_sys));
+        REQUIRE(
+            str(port) ==
+            "serial {\n"
+            "    device /dev/ttyUSB0;\n"
+            "    baudrate 9600;\n"
+            "    flow_control no;\n"
+            "    read_min_bytes 64;\n"
+            "    read_timeout 100;\n"
+            "    read_buffer_size 4096;\n"
+            "}");
+    }
 }
@@ -20,6 +20,7 @@
 #include <cstdint>
 #include <cstring>
 #include <system_error>
+#include <vector>
 
 #include <catch.hpp>
 #include <errno.h>
@@ -57,7 +58,8 @@ TEST_CASE("UnixUDPSocket's create and bind a UDP socket on construction and "
         fakeit::When(Method(mock_sys, close)).Return(0);
         {
             // Construct socket.
-            UnixUDPSocket socket(14050, {}, 0, mock_unique(mock_sys));
+            UnixUDPSocket socket(
+                14050, {}, 0, 0, false, false, false, mock_unique(mock_sys));
             fakeit::Verify(Method(mock_sys, socket).Matching(
                                [&](auto family, auto type, auto protocol)
             {
@@ -97,7 +99,8 @@ TEST_CASE("UnixUDPSocket's create and bind a UDP socket on construction and "
         fakeit::When(Method(mock_sys, close)).Return(0);
         {
             UnixUDPSocket socket(
-                14050, IPAddress(1234567890), 0, mock_unique(mock_sys));
+                14050, IPAddress(1234567890), 0, 0, false, false, false,
+                mock_unique(mock_sys));
             fakeit::Verify(Method(mock_sys, socket).Matching(
                                [&](auto family, auto type, auto protocol)
             {
@@ -122,6 +125,76 @@ TEST_CASE("UnixUDPSocket's create and bind a UDP socket on construction and "
         }
         fakeit::Verify(Method(mock_sys, close).Using(3)).Once();
     }
+    SECTION("With port reuse enabled (no errors).")
+    {
+        fakeit::Mock<UnixSyscalls> mock_sys;
+        fakeit::When(Method(mock_sys, socket)).Return(3);
+        int optval = 0;
+        fakeit::When(Method(mock_sys, setsockopt)).Do(
+            [&](auto fd, auto level, auto optname, auto val, auto optlen)
+        {
+            (void)fd;
+            (void)level;
+            (void)optname;
+            (void)optlen;
+            optval = *static_cast<const int *>(val);
+            return 0;
+        });
+        fakeit::When(Method(mock_sys, bind)).Return(0);
+        fakeit::When(Method(mock_sys, close)).Return(0);
+        {
+            UnixUDPSocket socket(
+                14050, {}, 0, 0, true, false, false, mock_unique(mock_sys));
+            fakeit::Verify(Method(mock_sys, setsockopt).Matching(
+                               [](auto fd, auto level, auto optname,
+                                  auto val, auto optlen)
+            {
+                (void)val;
+                return fd == 3 && level == SOL_SOCKET &&
+                       optname == SO_REUSEPORT && optlen == sizeof(int);
+            })).Once();
+            REQUIRE(optval == 1);
+            fakeit::Verify(
+                Method(mock_sys, socket), Method(mock_sys, setsockopt),
+                Method(mock_sys, bind)).Once();
+        }
+        fakeit::Verify(Method(mock_sys, close).Using(3)).Once();
+    }
+    SECTION("With kernel timestamps enabled (no errors).")
+    {
+        fakeit::Mock<UnixSyscalls> mock_sys;
+        fakeit::When(Method(mock_sys, socket)).Return(3);
+        int optval = 0;
+        fakeit::When(Method(mock_sys, setsockopt)).Do(
+            [&](auto fd, auto level, auto optname, auto val, auto optlen)
+        {
+            (void)fd;
+            (void)level;
+            (void)optname;
+            (void)optlen;
+            optval = *static_cast<const int *>(val);
+            return 0;
+        });
+        fakeit::When(Method(mock_sys, bind)).Return(0);
+        fakeit::When(Method(mock_sys, close)).Return(0);
+        {
+            UnixUDPSocket socket(
+                14050, {}, 0, 0, false, false, true, mock_unique(mock_sys));
+            fakeit::Verify(Method(mock_sys, setsockopt).Matching(
+                               [](auto fd, auto level, auto optname,
+                                  auto val, auto optlen)
+            {
+                (void)val;
+                return fd == 3 && level == SOL_SOCKET &&
+                       optname == SO_TIMESTAMPNS && optlen == sizeof(int);
+            })).Once();
+            REQUIRE(optval == 1);
+            fakeit::Verify(
+                Method(mock_sys, socket), Method(mock_sys, setsockopt),
+                Method(mock_sys, bind)).Once();
+        }
+        fakeit::Verify(Method(mock_sys, close).Using(3)).Once();
+    }
     SECTION("Emmits errors from 'socket' system call.")
     {
         fakeit::Mock<UnixSyscalls> mock_sys;
@@ -140,7 +213,9 @@ TEST_CASE("UnixUDPSocket's create and bind a UDP socket on construction and "
         {
             errno = error;
             REQUIRE_THROWS_AS(
-                UnixUDPSocket(14050, {}, 0, mock_unique(mock_sys)),
+                UnixUDPSocket(
+                    14050, {}, 0, 0, false, false, false,
+                    mock_unique(mock_sys)),
                 std::system_error);
         }
     }
@@ -149,6 +224,7 @@ TEST_CASE("UnixUDPSocket's create and bind a UDP socket on construction and "
         fakeit::Mock<UnixSyscalls> mock_sys;
         fakeit::When(Method(mock_sys, socket)).AlwaysReturn(4);
         fakeit::When(Method(mock_sys, bind)).AlwaysReturn(-1);
+        fakeit::When(Method(mock_sys, close)).AlwaysReturn(0);
         std::array<int, 13> errors{{
                 EACCES,
                 EADDRINUSE,
@@ -169,9 +245,41 @@ TEST_CASE("UnixUDPSocket's create and bind a UDP socket on construction and "
         {
             errno = error;
             REQUIRE_THROWS_AS(
-                UnixUDPSocket(14050, {}, 0, mock_unique(mock_sys)),
+                UnixUDPSocket(
+                    14050, {}, 0, 0, false, false, false,
+                    mock_unique(mock_sys)),
                 std::system_error);
         }
+
+        // The socket is not leaked.
+        fakeit::Verify(Method(mock_sys, close).Using(4)).Exactly(13);
+    }
+    SECTION("Emmits errors from 'setsockopt' system call.")
+    {
+        fakeit::Mock<UnixSyscalls> mock_sys;
+        fakeit::When(Method(mock_sys, socket)).AlwaysReturn(4);
+        fakeit::When(Method(mock_sys, setsockopt)).AlwaysReturn(-1);
+        fakeit::When(Method(mock_sys, close)).AlwaysReturn(0);
+        std::array<int, 5> errors{{
+                EBADF,
+                EFAULT,
+                EINVAL,
+                ENOPROTOOPT,
+                ENOTSOCK
+            }};
+
+        for (auto error : errors)
+        {
+            errno = error;
+            REQUIRE_THROWS_AS(
+                UnixUDPSocket(
+                    14050, {}, 0, 0, true, false, false, mock_unique(mock_sys)),
+                std::system_error);
+        }
+
+        fakeit::Verify(Method(mock_sys, bind)).Exactly(0);
+        // The socket is not leaked.
+        fakeit::Verify(Method(mock_sys, close).Using(4)).Exactly(5);
     }
 }
 
@@ -189,7 +297,8 @@ TEST_CASE("UnixUDPSocket's 'send' method sends data on the socket.",
     fakeit::When(Method(mock_sys, close)).Return(0);
     SECTION("Without error.")
     {
-        UnixUDPSocket socket(14050, {}, 0, mock_unique(mock_sys));
+        UnixUDPSocket socket(
+            14050, {}, 0, 0, false, false, false, mock_unique(mock_sys));
         // Mock 'sendto'
         std::vector<uint8_t> sent;
         struct sockaddr_in address;
@@ -227,27 +336,44 @@ TEST_CASE("UnixUDPSocket's 'send' method sends data on the socket.",
             REQUIRE(address.sin_zero[i] == '\0');
         }
     }
-    SECTION("Bitrate limit prevents writing packets too fast.")
+    SECTION("Bitrate limit delays sending (without blocking).")
     {
-        UnixUDPSocket socket(14050, {}, 128, mock_unique(mock_sys));
+        UnixUDPSocket socket(
+            14050, {}, 128, 0, false, false, false, mock_unique(mock_sys));
         fakeit::Fake(Method(mock_sys, sendto));
+        REQUIRE(socket.send_delay(IPAddress(1234567890, 14050)) == 0s);
         std::vector<uint8_t> vec = {1, 3, 3, 7}; // 4*8/128 = 0.25 seconds
-        socket.send(vec, IPAddress(1234567890, 14050));
-        fakeit::Verify(Method(mock_sys, sendto)).Once();
         auto tic = std::chrono::steady_clock::now();
         socket.send(vec, IPAddress(1234567890, 14050));
         auto toc = std::chrono::steady_clock::now();
-        REQUIRE(
-            std::chrono::duration_cast<std::chrono::milliseconds>(
-                toc - tic).count() >= 150);
-        REQUIRE(
-            std::chrono::duration_cast<std::chrono::milliseconds>(
-                toc - tic).count() <= 350);
-        fakeit::Verify(Method(mock_sys, sendto)).Exactly(2);
+        fakeit::Verify(Method(mock_sys, sendto)).Once();
+        REQUIRE((toc - tic) < 100ms);
+        // The interface limit applies to every address.
+        auto delay = socket.send_delay(IPAddress(1234567890, 14050));
+        REQUIRE(delay > 150ms);
+        REQUIRE(delay <= 250ms);
+        delay = socket.send_delay(IPAddress(987654321, 14050));
+        REQUIRE(delay > 150ms);
+        REQUIRE(delay <= 250ms);
+    }
+    SECTION("Per destination bitrate limit only delays that destination.")
+    {
+        UnixUDPSocket socket(
+            14050, {}, 0, 128, false, false, false, mock_unique(mock_sys));
+        fakeit::Fake(Method(mock_sys, sendto));
+        std::vector<uint8_t> vec = {1, 3, 3, 7}; // 4*8/128 = 0.25 seconds
+        socket.send(vec, IPAddress(1234567890, 14050));
+        fakeit::Verify(Method(mock_sys, sendto)).Once();
+        auto delay = socket.send_delay(IPAddress(1234567890, 14050));
+        REQUIRE(delay > 150ms);
+        REQUIRE(delay <= 250ms);
+        REQUIRE(socket.send_delay(IPAddress(1234567890, 14051)) == 0s);
+        REQUIRE(socket.send_delay(IPAddress(987654321, 14050)) == 0s);
     }
     SECTION("Emmits errors from 'sendto' system call.")
     {
-        UnixUDPSocket socket(14050, {}, 0, mock_unique(mock_sys));
+        UnixUDPSocket socket(
+            14050, {}, 0, 0, false, false, false, mock_unique(mock_sys));
         fakeit::When(Method(mock_sys, sendto)).AlwaysReturn(-1);
         std::array<int, 18> errors{{
                 EACCES,
@@ -293,7 +419,8 @@ TEST_CASE("UnixUDPSocket's 'receive' method receives data on the socket.",
     // Mock 'close'.
     fakeit::When(Method(mock_sys, close)).AlwaysReturn(0);
     // Construct socket.
-    UnixUDPSocket socket(14050, {}, 0, mock_unique(mock_sys));
+    UnixUDPSocket socket(
+        14050, {}, 0, 0, false, false, false, mock_unique(mock_sys));
     SECTION("Timeout, no packet (no errors).")
     {
         // Mock 'poll'.
@@ -459,6 +586,8 @@ TEST_CASE("UnixUDPSocket's 'receive' method receives data on the socket.",
             (void)addrlen;
             return fd == 3 && len >= 4 && flags == 0;
         })).Once();
+        // The receive time is only known with kernel timestamps.
+        REQUIRE_FALSE(socket.timestamp().has_value());
         REQUIRE(address_length >= sizeof(sockaddr_in));
     }
     SECTION("Packet available (not IPv4).")
@@ -718,6 +847,317 @@ TEST_CASE("UnixUDPSocket's 'receive' method receives data on the socket.",
 }
 
 
+TEST_CASE("UnixUDPSocket's can timestamp received datagrams in the kernel.",
+          "[UnixUDPSocket]")
+{
+    // Mock system calls.
+    fakeit::Mock<UnixSyscalls> mock_sys;
+    fakeit::When(Method(mock_sys, socket)).AlwaysReturn(3);
+    fakeit::When(Method(mock_sys, setsockopt)).AlwaysReturn(0);
+    fakeit::When(Method(mock_sys, bind)).AlwaysReturn(0);
+    fakeit::When(Method(mock_sys, close)).AlwaysReturn(0);
+    fakeit::When(Method(mock_sys, poll)).AlwaysDo(
+        [](auto fds, auto nfds, auto timeout)
+    {
+        (void)nfds;
+        (void)timeout;
+        fds->revents = POLLIN;
+        return 1;
+    });
+    fakeit::When(Method(mock_sys, ioctl)).AlwaysDo(
+        [](auto fd, auto request, auto size)
+    {
+        (void)fd;
+        (void)request;
+        *reinterpret_cast<int *>(size) = 4;
+        return 0;
+    });
+    // Mock 'recvmsg', the datagram arrived 10 ms ago.
+    fakeit::When(Method(mock_sys, recvmsg)).AlwaysDo(
+        [](auto fd, auto msg, auto flags)
+    {
+        (void)fd;
+        (void)flags;
+        // Write to buffer.
+        std::vector<uint8_t> vec = {1, 3, 3, 7};
+        std::memcpy(msg->msg_iov[0].iov_base, vec.data(), vec.size());
+        // Set address.
+        struct sockaddr_in address;
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(5000));
+        address.sin_addr.s_addr = htonl(static_cast<uint32_t>(1234567890));
+        memset(address.sin_zero, '\0', sizeof(address.sin_zero));
+        std::memcpy(msg->msg_name, &address, sizeof(address));
+        msg->msg_namelen = sizeof(address);
+        // Set timestamp.
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::system_clock::now().time_since_epoch() -
+                      10ms).count();
+        struct timespec time;
+        time.tv_sec = ns / 1000000000;
+        time.tv_nsec = ns % 1000000000;
+        auto cmsg = CMSG_FIRSTHDR(msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_TIMESTAMPNS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(time));
+        std::memcpy(CMSG_DATA(cmsg), &time, sizeof(time));
+        msg->msg_controllen = CMSG_SPACE(sizeof(time));
+        // Return number of received bytes.
+        return static_cast<ssize_t>(vec.size());
+    });
+    // Construct socket.
+    UnixUDPSocket socket(
+        14050, {}, 0, 0, false, false, true, mock_unique(mock_sys));
+    REQUIRE_FALSE(socket.timestamp().has_value());
+    // Test.
+    auto before = std::chrono::steady_clock::now();
+    auto [data, ip] = socket.receive(250ms);
+    auto after = std::chrono::steady_clock::now();
+    REQUIRE(data == std::vector<uint8_t>({1, 3, 3, 7}));
+    REQUIRE(ip == IPAddress(1234567890, 5000));
+    REQUIRE(socket.timestamp().has_value());
+    REQUIRE(socket.timestamp().value() <= after - 10ms);
+    REQUIRE(socket.timestamp().value() >= before - 20ms);
+    // Verify 'recvmsg'.
+    fakeit::Verify(Method(mock_sys, recvmsg).Matching(
+                       [](auto fd, auto msg, auto flags)
+    {
+        (void)msg;
+        return fd == 3 && flags == 0;
+    })).Once();
+    fakeit::Verify(Method(mock_sys, recvfrom)).Exactly(0);
+}
+
+
+TEST_CASE("UnixUDPSocket's can use a connected socket for each destination.",
+          "[UnixUDPSocket]")
+{
+    // Mock system calls.
+    fakeit::Mock<UnixSyscalls> mock_sys;
+    // Mock 'socket'.
+    int next_fd = 3;
+    fakeit::When(Method(mock_sys, socket)).AlwaysDo(
+        [&](auto family, auto type, auto protocol)
+    {
+        (void)family;
+        (void)type;
+        (void)protocol;
+        return next_fd++;
+    });
+    // Mock 'setsockopt'.
+    fakeit::When(Method(mock_sys, setsockopt)).AlwaysReturn(0);
+    // Mock 'bind'.
+    fakeit::When(Method(mock_sys, bind)).AlwaysReturn(0);
+    // Mock 'connect'.
+    struct sockaddr_in address;
+    fakeit::When(Method(mock_sys, connect)).AlwaysDo(
+        [&](auto fd, auto addr, auto addrlen)
+    {
+        (void)fd;
+        std::memcpy(&address, addr, addrlen);
+        return 0;
+    });
+    // Mock 'close'.
+    fakeit::When(Method(mock_sys, close)).AlwaysReturn(0);
+    // Construct socket.
+    UnixUDPSocket socket(
+        14050, {}, 0, 0, false, true, false, mock_unique(mock_sys));
+    fakeit::Verify(Method(mock_sys, setsockopt).Matching(
+                       [](auto fd, auto level, auto optname,
+                          auto val, auto optlen)
+    {
+        (void)val;
+        return fd == 3 && level == SOL_SOCKET &&
+               optname == SO_REUSEADDR && optlen == sizeof(int);
+    })).Once();
+    IPAddress peer(1234567890, 14050);
+    SECTION("Sends on the destination's connected socket.")
+    {
+        fakeit::When(Method(mock_sys, sendto)).AlwaysDo(
+            [](auto fd, auto buf, auto len, auto flags,
+               auto addr, auto addrlen)
+        {
+            (void)fd;
+            (void)buf;
+            (void)flags;
+            (void)addr;
+            (void)addrlen;
+            return len;
+        });
+        socket.send({1, 3, 3, 7}, peer);
+        socket.send({1, 3, 3, 7}, peer);
+        socket.send({1, 3, 3, 7}, IPAddress(987654321, 14050));
+        // One socket for each destination.
+        fakeit::Verify(Method(mock_sys, socket)).Exactly(3);
+        fakeit::Verify(Method(mock_sys, bind)).Exactly(3);
+        fakeit::Verify(Method(mock_sys, connect).Matching(
+                           [](auto fd, auto addr, auto addrlen)
+        {
+            (void)addr;
+            return fd == 4 && addrlen == sizeof(address);
+        })).Once();
+        fakeit::Verify(Method(mock_sys, connect).Matching(
+                           [](auto fd, auto addr, auto addrlen)
+        {
+            (void)addr;
+            return fd == 5 && addrlen == sizeof(address);
+        })).Once();
+        REQUIRE(address.sin_family == AF_INET);
+        REQUIRE(ntohs(address.sin_port) == 14050);
+        REQUIRE(ntohl(address.sin_addr.s_addr) == 987654321);
+        // Send without a destination address.
+        fakeit::Verify(Method(mock_sys, sendto).Matching(
+                           [](auto fd, auto buf, auto len, auto flags,
+                              auto addr, auto addrlen)
+        {
+            (void)buf;
+            return fd == 4 && len == 4 && flags == 0 &&
+                   addr == nullptr && addrlen == 0;
+        })).Exactly(2);
+        fakeit::Verify(Method(mock_sys, sendto).Matching(
+                           [](auto fd, auto buf, auto len, auto flags,
+                              auto addr, auto addrlen)
+        {
+            (void)buf;
+            (void)len;
+            (void)flags;
+            return fd == 5 && addr == nullptr && addrlen == 0;
+        })).Once();
+        REQUIRE(socket.reachable(peer));
+    }
+    SECTION("Destinations that refuse the connection are unreachable.")
+    {
+        fakeit::When(Method(mock_sys, sendto)).AlwaysDo(
+            [](auto fd, auto buf, auto len, auto flags,
+               auto addr, auto addrlen)
+        {
+            (void)fd;
+            (void)buf;
+            (void)len;
+            (void)flags;
+            (void)addr;
+            (void)addrlen;
+            errno = ECONNREFUSED;
+            return -1;
+        });
+        REQUIRE_NOTHROW(socket.send({1, 3, 3, 7}, peer));
+        REQUIRE_FALSE(socket.reachable(peer));
+        // Data sent to an unreachable destination is dropped.
+        socket.send({1, 3, 3, 7}, peer);
+        fakeit::Verify(Method(mock_sys, sendto)).Once();
+        // Forgetting the destination closes it's socket on the next receive.
+        socket.forget(peer);
+        REQUIRE(socket.reachable(peer));
+        fakeit::Verify(Method(mock_sys, close).Using(4)).Exactly(0);
+        fakeit::When(Method(mock_sys, poll)).Return(0);
+        socket.receive(0ms);
+        fakeit::Verify(Method(mock_sys, close).Using(4)).Once();
+    }
+    SECTION("Destinations that can not be connected to are unreachable.")
+    {
+        fakeit::When(Method(mock_sys, connect)).AlwaysDo(
+            [](auto fd, auto addr, auto addrlen)
+        {
+            (void)fd;
+            (void)addr;
+            (void)addrlen;
+            errno = ENETUNREACH;
+            return -1;
+        });
+        REQUIRE_NOTHROW(socket.send({1, 3, 3, 7}, peer));
+        REQUIRE_FALSE(socket.reachable(peer));
+        fakeit::Verify(Method(mock_sys, close).Using(4)).Once();
+        // Data sent to an unreachable destination is dropped.
+        socket.send({1, 3, 3, 7}, peer);
+        fakeit::Verify(Method(mock_sys, socket)).Exactly(2);
+        fakeit::Verify(Method(mock_sys, sendto)).Exactly(0);
+    }
+    SECTION("Errors on a connected socket make the destination unreachable.")
+    {
+        fakeit::Fake(Method(mock_sys, sendto));
+        socket.send({1, 3, 3, 7}, peer);
+        nfds_t polled = 0;
+        fakeit::When(Method(mock_sys, poll)).AlwaysDo(
+            [&](auto fds, auto nfds, auto timeout)
+        {
+            (void)timeout;
+            polled = nfds;
+
+            if (nfds > 1)
+            {
+                fds[0].revents = 0;
+                fds[1].revents = POLLERR;
+                return 1;
+            }
+
+            return 0;
+        });
+        auto [data, ip] = socket.receive(250ms);
+        REQUIRE(polled == 2);
+        REQUIRE(data.empty());
+        REQUIRE(ip == IPAddress(0));
+        REQUIRE_FALSE(socket.reachable(peer));
+        // The socket is no longer polled and is closed on the next receive.
+        socket.receive(0ms);
+        REQUIRE(polled == 1);
+        fakeit::Verify(Method(mock_sys, close).Using(4)).Once();
+    }
+    SECTION("Receives on the connected sockets.")
+    {
+        fakeit::Fake(Method(mock_sys, sendto));
+        socket.send({1, 3, 3, 7}, peer);
+        fakeit::When(Method(mock_sys, poll)).Do(
+            [&](auto fds, auto nfds, auto timeout)
+        {
+            (void)nfds;
+            (void)timeout;
+            fds[0].revents = 0;
+            fds[1].revents = POLLIN;
+            return 1;
+        });
+        fakeit::When(Method(mock_sys, ioctl)).Do(
+            [](auto fd, auto request, auto size)
+        {
+            (void)fd;
+            (void)request;
+            *reinterpret_cast<int *>(size) = 4;
+            return 0;
+        });
+        fakeit::When(Method(mock_sys, recvfrom)).Do(
+            [&](auto fd, auto buf, auto len, auto flags,
+                auto addr, auto addrlen)
+        {
+            (void)fd;
+            (void)flags;
+            std::vector<uint8_t> vec = {1, 3, 3, 7};
+            std::memcpy(buf, vec.data(), std::min(vec.size(), len));
+            struct sockaddr_in from;
+            from.sin_family = AF_INET;
+            from.sin_port = htons(static_cast<uint16_t>(14050));
+            from.sin_addr.s_addr = htonl(static_cast<uint32_t>(1234567890));
+            memset(from.sin_zero, '\0', sizeof(from.sin_zero));
+            std::memcpy(addr, &from, sizeof(from));
+            *addrlen = sizeof(from);
+            return std::min(vec.size(), len);
+        });
+        auto [data, ip] = socket.receive(250ms);
+        REQUIRE(data == std::vector<uint8_t>({1, 3, 3, 7}));
+        REQUIRE(ip == peer);
+        fakeit::Verify(Method(mock_sys, recvfrom).Matching(
+                           [](auto fd, auto buf, auto len, auto flags,
+                              auto addr, auto addrlen)
+        {
+            (void)buf;
+            (void)len;
+            (void)flags;
+            (void)addr;
+            (void)addrlen;
+            return fd == 4;
+        })).Once();
+    }
+}
+
+
 TEST_CASE("UnixUDPSocket's are printable.", "[UnixUDPSocket]")
 {
     // Mock system calls.
@@ -737,7 +1177,8 @@ TEST_CASE("UnixUDPSocket's are printable.", "[UnixUDPSocket]")
     fakeit::When(Method(mock_sys, close)).Return(0);
     SECTION("Without explicit IP address.")
     {
-        UnixUDPSocket socket(14050, {}, 0, mock_unique(mock_sys));
+        UnixUDPSocket socket(
+            14050, {}, 0, 0, false, false, false, mock_unique(mock_sys));
         REQUIRE(
             str(socket) ==
             "udp {\n"
@@ -747,7 +1188,8 @@ TEST_CASE("UnixUDPSocket's are printable.", "[UnixUDPSocket]")
     SECTION("With explicit IP address.")
     {
         UnixUDPSocket socket(
-            14050, IPAddress("127.0.0.1"), 0, mock_unique(mock_sys));
+            14050, IPAddress("127.0.0.1"), 0, 0, false, false, false,
+            mock_unique(mock_sys));
         REQUIRE(
             str(socket) ==
             "udp {\n"
@@ -757,7 +1199,8 @@ TEST_CASE("UnixUDPSocket's are printable.", "[UnixUDPSocket]")
     }
     SECTION("Without explicit IP address (and maximum bitrate).")
     {
-        UnixUDPSocket socket(14050, {}, 8192, mock_unique(mock_sys));
+        UnixUDPSocket socket(
+            14050, {}, 8192, 0, false, false, false, mock_unique(mock_sys));
         REQUIRE(
             str(socket) ==
             "udp {\n"
@@ -768,7 +1211,8 @@ TEST_CASE("UnixUDPSocket's are printable.", "[UnixUDPSocket]")
     SECTION("With explicit IP address (and maximum bitrate).")
     {
         UnixUDPSocket socket(
-            14050, IPAddress("127.0.0.1"), 8192, mock_unique(mock_sys));
+            14050, IPAddress("127.0.0.1"), 8192, 0, false, false, false,
+            mock_unique(mock_sys));
         REQUIRE(
             str(socket) ==
             "udp {\n"
@@ -777,4 +1221,39 @@ TEST_CASE("UnixUDPSocket's are printable.", "[UnixUDPSocket]")
             "    max_bitrate 8192;\n"
             "}");
     }
+    SECTION("With per destination maximum bitrate.")
+    {
+        UnixUDPSocket socket(
+            14050, {}, 0, 4096, false, false, false, mock_unique(mock_sys));
+        REQUIRE(
+            str(socket) ==
+            "udp {\n"
+            "    port 14050;\n"
+            "    peer_max_bitrate 4096;\n"
+            "}");
+    }
+    SECTION("With connected sockets for each destination.")
+    {
+        fakeit::When(Method(mock_sys, setsockopt)).Return(0);
+        UnixUDPSocket socket(
+            14050, {}, 0, 0, false, true, false, mock_unique(mock_sys));
+        REQUIRE(
+            str(socket) ==
+            "udp {\n"
+            "    port 14050;\n"
+            "    connect_peers yes;\n"
+            "}");
+    }
+    SECTION("With kernel timestamps.")
+    {
+        fakeit::When(Method(mock_sys, setsockopt)).Return(0);
+        UnixUDPSocket socket(
+            14050, {}, 0, 0, false, false, true, mock_unique(mock_sys));
+        REQUIRE(
+            str(socket) ==
+            "udp {\n"
+            "    port 14050;\n"
+            "    kernel_timestamps yes;\n"
+            "}");
+    }
 }
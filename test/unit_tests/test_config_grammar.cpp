@@ -125,6 +125,151 @@ TEST_CASE("Parse global 'default_action' statement.", "[config]")
 }
 
 
+TEST_CASE("Parse global 'deduplicate' statement.", "[config]")
+{
+    SECTION("Parses the deduplication window.")
+    {
+        tao::pegtl::string_input<> in("deduplicate 250;", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(str(*root) == ":001:  deduplicate 250\n");
+    }
+    SECTION("Parses the deduplication window (with comments).")
+    {
+        tao::pegtl::string_input<> in("deduplicate 250;# comment", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(str(*root) == ":001:  deduplicate 250\n");
+    }
+    SECTION("Missing end of statement.")
+    {
+        tao::pegtl::string_input<> in("deduplicate 250", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":1:15(15): expected end of statement ';' character");
+    }
+    SECTION("Invalid deduplication window.")
+    {
+        tao::pegtl::string_input<> in("deduplicate fast;", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":1:12(12): expected a valid window in milliseconds");
+    }
+    SECTION("Missing deduplication window.")
+    {
+        tao::pegtl::string_input<> in("deduplicate;", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":1:11(11): expected a valid window in milliseconds");
+    }
+}
+
+
+TEST_CASE("Parse global 'profile' statement.", "[config]")
+{
+    SECTION("Parses the sampling period.")
+    {
+        tao::pegtl::string_input<> in("profile 1000;", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(str(*root) == ":001:  profile 1000\n");
+    }
+    SECTION("Missing end of statement.")
+    {
+        tao::pegtl::string_input<> in("profile 1000", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":1:12(12): expected end of statement ';' character");
+    }
+    SECTION("Invalid sampling period.")
+    {
+        tao::pegtl::string_input<> in("profile often;", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":1:8(8): expected a valid sampling period");
+    }
+}
+
+
+TEST_CASE("Parse global 'trace' statement.", "[config]")
+{
+    SECTION("Parses the trace period.")
+    {
+        tao::pegtl::string_input<> in("trace 100;", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(
+            str(*root) ==
+            ":001:  trace\n"
+            ":001:  |  trace_period 100\n");
+    }
+    SECTION("Parses the trace period and condition.")
+    {
+        tao::pegtl::string_input<> in(
+            "trace 1 if HEARTBEAT from 192.168/8;\n"
+            "trace 1000;", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(
+            str(*root) ==
+            ":001:  trace\n"
+            ":001:  |  trace_period 1\n"
+            ":001:  |  condition\n"
+            ":001:  |  |  packet_type HEARTBEAT\n"
+            ":001:  |  |  source 192.168/8\n"
+            ":002:  trace\n"
+            ":002:  |  trace_period 1000\n");
+    }
+    SECTION("Missing end of statement.")
+    {
+        tao::pegtl::string_input<> in("trace 100", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":1:9(9): expected end of statement ';' character");
+    }
+    SECTION("Invalid trace period.")
+    {
+        tao::pegtl::string_input<> in("trace often;", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in), ":1:6(6): expected a valid trace period");
+    }
+}
+
+
+TEST_CASE("Parse global 'stats' statement.", "[config]")
+{
+    SECTION("Parses the statistics socket path.")
+    {
+        tao::pegtl::string_input<> in("stats /run/mavtables.sock;", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(str(*root) == ":001:  stats /run/mavtables.sock\n");
+    }
+    SECTION("Missing end of statement.")
+    {
+        tao::pegtl::string_input<> in("stats /run/mavtables.sock", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":1:25(25): expected end of statement ';' character");
+    }
+    SECTION("Invalid statistics socket path.")
+    {
+        tao::pegtl::string_input<> in("stats *;", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in), ":1:6(6): expected a valid socket path");
+    }
+}
+
+
 TEST_CASE("UDP configuration block.", "[config]")
 {
     SECTION("Empty UDP blocks are allowed (single line).")
@@ -184,279 +329,865 @@ TEST_CASE("UDP configuration block.", "[config]")
         REQUIRE_THROWS_WITH(
             config::parse(in), ":1:3(3): expected opening brace '{'");
     }
-    SECTION("Missing closing brace.")
+    SECTION("Missing closing brace.")
+    {
+        tao::pegtl::string_input<> in("udp {", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in), ":1:5(5): expected closing brace '}'");
+    }
+}
+
+
+TEST_CASE("UDP port setting.", "[config]")
+{
+    SECTION("Parses port number setting.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    port 14500;\n"
+            "}", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(
+            str(*root) ==
+            ":001:  udp\n"
+            ":002:  |  port 14500\n");
+    }
+    SECTION("Parses port number setting (with comments).")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {# comment\n"
+            "    port 14500;# comment\n"
+            "}# comment", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(
+            str(*root) ==
+            ":001:  udp\n"
+            ":002:  |  port 14500\n");
+    }
+    SECTION("Missing end of statement.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    port 14500\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":3:0(21): expected end of statement ';' character");
+    }
+    SECTION("Invalid port number.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    port a35;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in), ":2:9(15): expected a valid port number");
+    }
+    SECTION("Missing port number.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    port;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in), ":2:8(14): expected a valid port number");
+    }
+}
+
+
+TEST_CASE("UDP IP address setting.", "[config]")
+{
+    SECTION("Parses IP address setting.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    address 127.0.0.1;\n"
+            "}", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(
+            str(*root) ==
+            ":001:  udp\n"
+            ":002:  |  address 127.0.0.1\n");
+    }
+    SECTION("Parses IP address setting (with comments).")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {# comment\n"
+            "    address 127.0.0.1;# comment\n"
+            "}# comment", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(
+            str(*root) ==
+            ":001:  udp\n"
+            ":002:  |  address 127.0.0.1\n");
+    }
+    SECTION("Missing end of statement.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    address 127.0.0.1\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":3:0(28): expected end of statement ';' character");
+    }
+    SECTION("Invalid IP address [1].")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    address 127.0.0.1.;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":2:21(27): expected end of statement ';' character");
+    }
+    SECTION("Invalid IP address [2].")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    address 127.0.0.;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in), ":2:20(26): expected a valid IP address");
+    }
+    SECTION("Invalid IP address [3].")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    address 127.0.0;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in), ":2:19(25): expected a valid IP address");
+    }
+    SECTION("Invalid IP address [4].")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    address 127.0.;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in), ":2:18(24): expected a valid IP address");
+    }
+    SECTION("Invalid IP address [5].")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    address 127.0;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in), ":2:17(23): expected a valid IP address");
+    }
+    SECTION("Invalid IP address [6].")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    address 127.;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in), ":2:16(22): expected a valid IP address");
+    }
+    SECTION("Invalid IP address [7].")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    address 127;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in), ":2:15(21): expected a valid IP address");
+    }
+    SECTION("Invalid IP address [8].")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    address 127:0:0:1;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in), ":2:15(21): expected a valid IP address");
+    }
+    SECTION("Invalid IP address [9].")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    address 127.a.0.1;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in), ":2:16(22): expected a valid IP address");
+    }
+    SECTION("Missing IP address.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    address;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in), ":2:11(17): expected a valid IP address");
+    }
+}
+
+
+TEST_CASE("UDP max_bitrate setting.", "[config]")
+{
+    SECTION("Parses max bitrate setting.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    max_bitrate 8192;\n"
+            "}", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(
+            str(*root) ==
+            ":001:  udp\n"
+            ":002:  |  max_bitrate 8192\n");
+    }
+    SECTION("Parses max bitrate setting (with comments).")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {# comment\n"
+            "    max_bitrate 8192;# comment\n"
+            "}# comment", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(
+            str(*root) ==
+            ":001:  udp\n"
+            ":002:  |  max_bitrate 8192\n");
+    }
+    SECTION("Missing end of statement.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    max_bitrate 8192\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":3:0(27): expected end of statement ';' character");
+    }
+    SECTION("Invalid bitrate.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    max_bitrate a512;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in), ":2:16(22): expected a valid bitrate");
+    }
+    SECTION("Missing bitrate.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    max_bitrate;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in), ":2:15(21): expected a valid bitrate");
+    }
+}
+
+
+TEST_CASE("UDP peer_max_bitrate setting.", "[config]")
+{
+    SECTION("Parses per destination max bitrate setting.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    peer_max_bitrate 8192;\n"
+            "}", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(
+            str(*root) ==
+            ":001:  udp\n"
+            ":002:  |  peer_max_bitrate 8192\n");
+    }
+    SECTION("Missing end of statement.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    peer_max_bitrate 8192\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":3:0(32): expected end of statement ';' character");
+    }
+    SECTION("Invalid bitrate.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    peer_max_bitrate a512;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in), ":2:21(27): expected a valid bitrate");
+    }
+    SECTION("Missing bitrate.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    peer_max_bitrate;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in), ":2:20(26): expected a valid bitrate");
+    }
+}
+
+
+TEST_CASE("UDP threads setting.", "[config]")
+{
+    SECTION("Parses threads setting.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    threads 4;\n"
+            "}", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(
+            str(*root) ==
+            ":001:  udp\n"
+            ":002:  |  threads 4\n");
+    }
+    SECTION("Parses threads setting (with comments).")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {# comment\n"
+            "    threads 4;# comment\n"
+            "}# comment", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(
+            str(*root) ==
+            ":001:  udp\n"
+            ":002:  |  threads 4\n");
+    }
+    SECTION("Missing end of statement.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    threads 4\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":3:0(20): expected end of statement ';' character");
+    }
+    SECTION("Invalid number of threads.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    threads a4;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":2:12(18): expected a valid number of threads");
+    }
+    SECTION("Missing number of threads.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    threads;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":2:11(17): expected a valid number of threads");
+    }
+}
+
+
+TEST_CASE("UDP idle timeout setting.", "[config]")
+{
+    SECTION("Parses idle timeout setting.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    idle_timeout 30000;\n"
+            "}", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(
+            str(*root) ==
+            ":001:  udp\n"
+            ":002:  |  idle_timeout 30000\n");
+    }
+    SECTION("Invalid idle timeout.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    idle_timeout 30s;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":2:19(25): expected end of statement ';' character");
+    }
+    SECTION("Missing idle timeout.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    idle_timeout;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":2:16(22): expected a valid timeout in milliseconds");
+    }
+}
+
+
+TEST_CASE("UDP connected peer sockets setting.", "[config]")
+{
+    SECTION("Parses connected peer sockets setting (yes).")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    connect_peers yes;\n"
+            "}", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(
+            str(*root) ==
+            ":001:  udp\n"
+            ":002:  |  connect_peers yes\n");
+    }
+    SECTION("Parses connected peer sockets setting (no).")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    connect_peers no;\n"
+            "}", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(
+            str(*root) ==
+            ":001:  udp\n"
+            ":002:  |  connect_peers no\n");
+    }
+    SECTION("Invalid connected peer sockets setting.")
     {
-        tao::pegtl::string_input<> in("udp {", "");
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    connect_peers maybe;\n"
+            "}", "");
         REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
         REQUIRE_THROWS_WITH(
-            config::parse(in), ":1:5(5): expected closing brace '}'");
+            config::parse(in),
+            ":2:18(24): expected 'yes' or 'no'");
     }
 }
 
 
-TEST_CASE("UDP port setting.", "[config]")
+
+TEST_CASE("UDP kernel timestamps setting.", "[config]")
 {
-    SECTION("Parses port number setting.")
+    SECTION("Parses kernel timestamps setting (yes).")
     {
         tao::pegtl::string_input<> in(
             "udp {\n"
-            "    port 14500;\n"
+            "    kernel_timestamps yes;\n"
             "}", "");
         auto root = config::parse(in);
         REQUIRE(root != nullptr);
         REQUIRE(
             str(*root) ==
             ":001:  udp\n"
-            ":002:  |  port 14500\n");
+            ":002:  |  kernel_timestamps yes\n");
     }
-    SECTION("Parses port number setting (with comments).")
+    SECTION("Parses kernel timestamps setting (no).")
     {
         tao::pegtl::string_input<> in(
-            "udp {# comment\n"
-            "    port 14500;# comment\n"
-            "}# comment", "");
+            "udp {\n"
+            "    kernel_timestamps no;\n"
+            "}", "");
         auto root = config::parse(in);
         REQUIRE(root != nullptr);
         REQUIRE(
             str(*root) ==
             ":001:  udp\n"
-            ":002:  |  port 14500\n");
+            ":002:  |  kernel_timestamps no\n");
     }
-    SECTION("Missing end of statement.")
+    SECTION("Invalid kernel timestamps setting.")
     {
         tao::pegtl::string_input<> in(
             "udp {\n"
-            "    port 14500\n"
+            "    kernel_timestamps maybe;\n"
             "}", "");
         REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
         REQUIRE_THROWS_WITH(
             config::parse(in),
-            ":3:0(21): expected end of statement ';' character");
+            ":2:22(28): expected 'yes' or 'no'");
     }
-    SECTION("Invalid port number.")
+}
+
+TEST_CASE("UDP multicast group setting.", "[config]")
+{
+    SECTION("Parses multicast group.")
     {
         tao::pegtl::string_input<> in(
             "udp {\n"
-            "    port a35;\n"
+            "    multicast 239.1.2.3;\n"
             "}", "");
-        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
-        REQUIRE_THROWS_WITH(
-            config::parse(in), ":2:9(15): expected a valid port number");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(
+            str(*root) ==
+            ":001:  udp\n"
+            ":002:  |  multicast 239.1.2.3\n");
     }
-    SECTION("Missing port number.")
+    SECTION("Parses multicast group with port and preloaded addresses.")
     {
         tao::pegtl::string_input<> in(
             "udp {\n"
-            "    port;\n"
+            "    multicast 239.1.2.3:14550;\n"
+            "    preload 255.1;\n"
+            "}", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(
+            str(*root) ==
+            ":001:  udp\n"
+            ":002:  |  multicast 239.1.2.3:14550\n"
+            ":003:  |  preload 255.1\n");
+    }
+    SECTION("Invalid multicast group.")
+    {
+        tao::pegtl::string_input<> in(
+            "udp {\n"
+            "    multicast 239.1.2;\n"
             "}", "");
         REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
         REQUIRE_THROWS_WITH(
-            config::parse(in), ":2:8(14): expected a valid port number");
+            config::parse(in),
+            ":2:21(27): expected a valid multicast group");
     }
 }
 
 
-TEST_CASE("UDP IP address setting.", "[config]")
+TEST_CASE("UDP packet aggregation settings.", "[config]")
 {
-    SECTION("Parses IP address setting.")
+    SECTION("Parses aggregation MTU and delay.")
     {
         tao::pegtl::string_input<> in(
             "udp {\n"
-            "    address 127.0.0.1;\n"
+            "    aggregate 1400;\n"
+            "    aggregate_delay 10;\n"
             "}", "");
         auto root = config::parse(in);
         REQUIRE(root != nullptr);
         REQUIRE(
             str(*root) ==
             ":001:  udp\n"
-            ":002:  |  address 127.0.0.1\n");
-    }
-    SECTION("Parses IP address setting (with comments).")
-    {
-        tao::pegtl::string_input<> in(
-            "udp {# comment\n"
-            "    address 127.0.0.1;# comment\n"
-            "}# comment", "");
-        auto root = config::parse(in);
-        REQUIRE(root != nullptr);
-        REQUIRE(
-            str(*root) ==
-            ":001:  udp\n"
-            ":002:  |  address 127.0.0.1\n");
+            ":002:  |  aggregate 1400\n"
+            ":003:  |  aggregate_delay 10\n");
     }
-    SECTION("Missing end of statement.")
+    SECTION("Invalid aggregation MTU.")
     {
         tao::pegtl::string_input<> in(
             "udp {\n"
-            "    address 127.0.0.1\n"
+            "    aggregate large;\n"
             "}", "");
         REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
         REQUIRE_THROWS_WITH(
             config::parse(in),
-            ":3:0(28): expected end of statement ';' character");
+            ":2:14(20): expected a valid number of bytes");
     }
-    SECTION("Invalid IP address [1].")
+    SECTION("Invalid aggregation delay.")
     {
         tao::pegtl::string_input<> in(
             "udp {\n"
-            "    address 127.0.0.1.;\n"
+            "    aggregate_delay 1.5;\n"
             "}", "");
         REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
         REQUIRE_THROWS_WITH(
             config::parse(in),
             ":2:21(27): expected end of statement ';' character");
     }
-    SECTION("Invalid IP address [2].")
+}
+
+
+TEST_CASE("UDP peer weight setting.", "[config]")
+{
+    SECTION("Parses peer weight settings.")
     {
         tao::pegtl::string_input<> in(
             "udp {\n"
-            "    address 127.0.0.;\n"
+            "    weight 192.168.0.0/16 4;\n"
+            "    weight 10.0.0.7 2;\n"
             "}", "");
-        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
-        REQUIRE_THROWS_WITH(
-            config::parse(in), ":2:20(26): expected a valid IP address");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(
+            str(*root) ==
+            ":001:  udp\n"
+            ":002:  |  peer_weight\n"
+            ":002:  |  |  subnet 192.168.0.0/16\n"
+            ":002:  |  |  weight 4\n"
+            ":003:  |  peer_weight\n"
+            ":003:  |  |  subnet 10.0.0.7\n"
+            ":003:  |  |  weight 2\n");
     }
-    SECTION("Invalid IP address [3].")
+    SECTION("Missing end of statement.")
     {
         tao::pegtl::string_input<> in(
             "udp {\n"
-            "    address 127.0.0;\n"
+            "    weight 10.0.0.0/8 4\n"
             "}", "");
         REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
         REQUIRE_THROWS_WITH(
-            config::parse(in), ":2:19(25): expected a valid IP address");
+            config::parse(in),
+            ":3:0(30): expected end of statement ';' character");
     }
-    SECTION("Invalid IP address [4].")
+    SECTION("Invalid subnet.")
     {
         tao::pegtl::string_input<> in(
             "udp {\n"
-            "    address 127.0.;\n"
+            "    weight 10.0 4;\n"
             "}", "");
         REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
         REQUIRE_THROWS_WITH(
-            config::parse(in), ":2:18(24): expected a valid IP address");
+            config::parse(in), ":2:11(17): expected a valid IP subnet");
     }
-    SECTION("Invalid IP address [5].")
+    SECTION("Invalid weight.")
     {
         tao::pegtl::string_input<> in(
             "udp {\n"
-            "    address 127.0;\n"
+            "    weight 10.0.0.0/8 x;\n"
             "}", "");
         REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
         REQUIRE_THROWS_WITH(
-            config::parse(in), ":2:17(23): expected a valid IP address");
+            config::parse(in), ":2:22(28): expected a valid weight");
     }
-    SECTION("Invalid IP address [6].")
+    SECTION("Missing weight.")
     {
         tao::pegtl::string_input<> in(
             "udp {\n"
-            "    address 127.;\n"
+            "    weight 10.0.0.0/8;\n"
             "}", "");
         REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
         REQUIRE_THROWS_WITH(
-            config::parse(in), ":2:16(22): expected a valid IP address");
+            config::parse(in), ":2:21(27): expected a valid weight");
     }
-    SECTION("Invalid IP address [7].")
+}
+
+
+TEST_CASE("Unix domain socket configuration block.", "[config]")
+{
+    SECTION("Empty unix domain socket blocks are allowed.")
+    {
+        tao::pegtl::string_input<> in("unix {\n}", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(str(*root) == ":001:  unix\n");
+    }
+    SECTION("Parses path and idle timeout settings.")
     {
         tao::pegtl::string_input<> in(
-            "udp {\n"
-            "    address 127;\n"
+            "unix {\n"
+            "    path /run/mavtables-1.sock;\n"
+            "    idle_timeout 30000;\n"
             "}", "");
-        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
-        REQUIRE_THROWS_WITH(
-            config::parse(in), ":2:15(21): expected a valid IP address");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(
+            str(*root) ==
+            ":001:  unix\n"
+            ":002:  |  path /run/mavtables-1.sock\n"
+            ":003:  |  idle_timeout 30000\n");
     }
-    SECTION("Invalid IP address [8].")
+    SECTION("Invalid path.")
     {
         tao::pegtl::string_input<> in(
-            "udp {\n"
-            "    address 127:0:0:1;\n"
+            "unix {\n"
+            "    path /run/mav tables.sock;\n"
             "}", "");
         REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
         REQUIRE_THROWS_WITH(
-            config::parse(in), ":2:15(21): expected a valid IP address");
+            config::parse(in),
+            ":2:18(25): expected end of statement ';' character");
     }
-    SECTION("Invalid IP address [9].")
+    SECTION("Missing path.")
     {
         tao::pegtl::string_input<> in(
-            "udp {\n"
-            "    address 127.a.0.1;\n"
+            "unix {\n"
+            "    path;\n"
             "}", "");
         REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
         REQUIRE_THROWS_WITH(
-            config::parse(in), ":2:16(22): expected a valid IP address");
+            config::parse(in),
+            ":2:8(15): expected a valid socket path");
     }
-    SECTION("Missing IP address.")
+    SECTION("Missing closing brace.")
     {
-        tao::pegtl::string_input<> in(
-            "udp {\n"
-            "    address;\n"
-            "}", "");
+        tao::pegtl::string_input<> in("unix {", "");
         REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
         REQUIRE_THROWS_WITH(
-            config::parse(in), ":2:11(17): expected a valid IP address");
+            config::parse(in), ":1:6(6): expected closing brace '}'");
     }
 }
 
 
-TEST_CASE("UDP max_bitrate setting.", "[config]")
+TEST_CASE("Shared memory configuration block.", "[config]")
 {
-    SECTION("Parses max bitrate setting.")
+    SECTION("Empty shared memory blocks are allowed.")
+    {
+        tao::pegtl::string_input<> in("shm {\n}", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(str(*root) == ":001:  shm\n");
+    }
+    SECTION("Parses name and ring size settings.")
     {
         tao::pegtl::string_input<> in(
-            "udp {\n"
-            "    max_bitrate 8192;\n"
+            "shm {\n"
+            "    name /mavtables-gcs_1.0;\n"
+            "    ring_size 65536;\n"
             "}", "");
         auto root = config::parse(in);
         REQUIRE(root != nullptr);
         REQUIRE(
             str(*root) ==
-            ":001:  udp\n"
-            ":002:  |  max_bitrate 8192\n");
+            ":001:  shm\n"
+            ":002:  |  name /mavtables-gcs_1.0\n"
+            ":003:  |  ring_size 65536\n");
     }
-    SECTION("Parses max bitrate setting (with comments).")
+    SECTION("Invalid name.")
     {
         tao::pegtl::string_input<> in(
-            "udp {# comment\n"
-            "    max_bitrate 8192;# comment\n"
-            "}# comment", "");
+            "shm {\n"
+            "    name mavtables;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":2:9(15): expected a valid shared memory name");
+    }
+    SECTION("Missing name.")
+    {
+        tao::pegtl::string_input<> in(
+            "shm {\n"
+            "    name;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":2:8(14): expected a valid shared memory name");
+    }
+    SECTION("Invalid ring size.")
+    {
+        tao::pegtl::string_input<> in(
+            "shm {\n"
+            "    ring_size large;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in), ":2:14(20): expected a valid ring size");
+    }
+    SECTION("Missing closing brace.")
+    {
+        tao::pegtl::string_input<> in("shm {", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in), ":1:5(5): expected closing brace '}'");
+    }
+}
+
+
+
+
+TEST_CASE("Decision log configuration block.", "[config]")
+{
+    SECTION("Parses path, records and files settings.")
+    {
+        tao::pegtl::string_input<> in(
+            "decision_log {\n"
+            "    path /var/log/mavtables/decisions.log;\n"
+            "    records 65536;\n"
+            "    files 2;\n"
+            "}", "");
         auto root = config::parse(in);
         REQUIRE(root != nullptr);
         REQUIRE(
             str(*root) ==
-            ":001:  udp\n"
-            ":002:  |  max_bitrate 8192\n");
+            ":001:  decision_log\n"
+            ":002:  |  path /var/log/mavtables/decisions.log\n"
+            ":003:  |  records 65536\n"
+            ":004:  |  files 2\n");
     }
-    SECTION("Missing end of statement.")
+    SECTION("Invalid number of records.")
     {
         tao::pegtl::string_input<> in(
-            "udp {\n"
-            "    max_bitrate 8192\n"
+            "decision_log {\n"
+            "    records many;\n"
             "}", "");
         REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
         REQUIRE_THROWS_WITH(
             config::parse(in),
-            ":3:0(27): expected end of statement ';' character");
+            ":2:12(27): expected a valid number of records");
     }
-    SECTION("Invalid bitrate.")
+    SECTION("Invalid number of files.")
     {
         tao::pegtl::string_input<> in(
-            "udp {\n"
-            "    max_bitrate a512;\n"
+            "decision_log {\n"
+            "    files;\n"
             "}", "");
         REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
         REQUIRE_THROWS_WITH(
-            config::parse(in), ":2:16(22): expected a valid bitrate");
+            config::parse(in), ":2:9(24): expected a valid number of files");
     }
-    SECTION("Missing bitrate.")
+}
+
+
+TEST_CASE("Flight recorder configuration block.", "[config]")
+{
+    SECTION("Parses path and records settings.")
     {
         tao::pegtl::string_input<> in(
-            "udp {\n"
-            "    max_bitrate;\n"
+            "flight_recorder {\n"
+            "    path /var/log/mavtables/flight.log;\n"
+            "    records 4096;\n"
+            "}", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(
+            str(*root) ==
+            ":001:  flight_recorder\n"
+            ":002:  |  path /var/log/mavtables/flight.log\n"
+            ":003:  |  records 4096\n");
+    }
+    SECTION("Invalid number of records.")
+    {
+        tao::pegtl::string_input<> in(
+            "flight_recorder {\n"
+            "    records many;\n"
             "}", "");
         REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
         REQUIRE_THROWS_WITH(
-            config::parse(in), ":2:15(21): expected a valid bitrate");
+            config::parse(in),
+            ":2:12(30): expected a valid number of records");
     }
 }
 
@@ -775,6 +1506,74 @@ TEST_CASE("Serial port flow control setting.", "[config]")
 }
 
 
+TEST_CASE("Serial port receive tuning settings.", "[config]")
+{
+    SECTION("Parses receive tuning settings.")
+    {
+        tao::pegtl::string_input<> in(
+            "serial {\n"
+            "    low_latency yes;\n"
+            "    read_min_bytes 64;\n"
+            "    read_timeout 100;\n"
+            "    read_buffer_size 4096;\n"
+            "}", "");
+        auto root = config::parse(in);
+        REQUIRE(root != nullptr);
+        REQUIRE(
+            str(*root) ==
+            ":001:  serial\n"
+            ":002:  |  low_latency yes\n"
+            ":003:  |  read_min_bytes 64\n"
+            ":004:  |  read_timeout 100\n"
+            ":005:  |  read_buffer_size 4096\n");
+    }
+    SECTION("Invalid low latency setting.")
+    {
+        tao::pegtl::string_input<> in(
+            "serial {\n"
+            "    low_latency maybe;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":2:16(25): expected 'yes' or 'no'");
+    }
+    SECTION("Invalid minimum read size.")
+    {
+        tao::pegtl::string_input<> in(
+            "serial {\n"
+            "    read_min_bytes x;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":2:19(28): expected a valid number of bytes");
+    }
+    SECTION("Invalid read timeout.")
+    {
+        tao::pegtl::string_input<> in(
+            "serial {\n"
+            "    read_timeout x;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":2:17(26): expected a valid timeout in milliseconds");
+    }
+    SECTION("Invalid read buffer size.")
+    {
+        tao::pegtl::string_input<> in(
+            "serial {\n"
+            "    read_buffer_size x;\n"
+            "}", "");
+        REQUIRE_THROWS_AS(config::parse(in), tao::pegtl::parse_error);
+        REQUIRE_THROWS_WITH(
+            config::parse(in),
+            ":2:21(30): expected a valid number of bytes");
+    }
+}
+
+
 TEST_CASE("Serial address preload.", "[config]")
 {
     SECTION("Parses a preload address.")
@@ -0,0 +1,102 @@
+// MAVLink router and firewall.
+// Copyright (C) 2017-2018  Michael R. Shannon <mrshannon.aerospace@gmail.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <catch.hpp>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "unix_socket.hpp"
+#include "UnixSyscalls.hpp"
+
+
+TEST_CASE("'unix_address' builds unix domain socket addresses.",
+          "[unix_socket]")
+{
+    struct sockaddr_un addr;
+    auto offset = offsetof(struct sockaddr_un, sun_path);
+    SECTION("Filesystem paths are null terminated.")
+    {
+        REQUIRE(unix_address("/run/mavtables.sock", addr) == offset + 20);
+        REQUIRE(addr.sun_family == AF_UNIX);
+        REQUIRE(std::string(addr.sun_path) == "/run/mavtables.sock");
+    }
+    SECTION("Abstract names are used as is.")
+    {
+        std::string name("\0mavtables", 10);
+        REQUIRE(unix_address(name, addr) == offset + 10);
+        REQUIRE(addr.sun_family == AF_UNIX);
+        REQUIRE(std::string(addr.sun_path, 10) == name);
+    }
+    SECTION("Abstract names may fill the address.")
+    {
+        std::string name(sizeof(addr.sun_path), 'a');
+        name[0] = '\0';
+        REQUIRE(unix_address(name, addr) == sizeof(addr));
+    }
+    SECTION("Ensures the path is valid.")
+    {
+        REQUIRE_THROWS_AS(unix_address("", addr), std::invalid_argument);
+        REQUIRE_THROWS_WITH(unix_address("", addr), "Socket path is empty.");
+        std::string path(sizeof(addr.sun_path), 'a');
+        REQUIRE_THROWS_AS(unix_address(path, addr), std::invalid_argument);
+        REQUIRE_THROWS_WITH(
+            unix_address(path, addr),
+            "Socket path (" + path + ") is longer than " +
+            std::to_string(sizeof(addr.sun_path) - 1) + " characters.");
+        REQUIRE_NOTHROW(unix_address(path.substr(1), addr));
+    }
+}
+
+
+TEST_CASE("'remove_socket' only removes unix domain sockets.",
+          "[unix_socket]")
+{
+    UnixSyscalls syscalls;
+    std::string path("unix_socket_test.sock");
+    std::remove(path.c_str());
+    SECTION("Sockets are removed.")
+    {
+        struct sockaddr_un addr;
+        auto addrlen = unix_address(path, addr);
+        int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+        REQUIRE(fd >= 0);
+        REQUIRE(bind(
+                    fd, reinterpret_cast<struct sockaddr *>(&addr),
+                    addrlen) == 0);
+        close(fd);
+        REQUIRE(remove_socket(syscalls, path));
+        REQUIRE_FALSE(std::ifstream(path).good());
+        REQUIRE(std::remove(path.c_str()) != 0);
+    }
+    SECTION("Other files are kept.")
+    {
+        std::ofstream(path) << "keep";
+        REQUIRE_FALSE(remove_socket(syscalls, path));
+        REQUIRE(std::remove(path.c_str()) == 0);
+    }
+    SECTION("Missing files are already removed.")
+    {
+        REQUIRE(remove_socket(syscalls, path));
+    }
+}